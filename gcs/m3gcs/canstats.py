@@ -0,0 +1,94 @@
+from .packets import register_packet
+from .m3can_msgs import CAN_ID_M3FC, CAN_ID_M3PSU, CAN_ID_M3PYRO, \
+    CAN_ID_M3RADIO, CAN_ID_M3DL, CAN_MSG_ID_M3FC_CAN_STATS, \
+    CAN_MSG_ID_M3PSU_CAN_STATS, CAN_MSG_ID_M3PYRO_CAN_STATS, \
+    CAN_MSG_ID_M3RADIO_CAN_STATS, CAN_MSG_ID_M3DL_CAN_STATS, MESSAGES
+import struct
+
+BOARD_NAMES = {1: "m3fc", 2: "m3psu", 3: "m3pyro", 4: "m3radio", 5: "m3imu",
+               6: "m3dl", 7: "ground"}
+
+# Latest report from each board, built up from all three frame types
+stats = {}
+
+
+def id_name(sid):
+    if sid == 0xFFFF:
+        return "other"
+    if sid in MESSAGES:
+        m = MESSAGES[sid]
+        return "{}.{}".format(m.board, m.name)
+    board = BOARD_NAMES.get(sid & 0x1F, str(sid & 0x1F))
+    return "{}.{}".format(board, sid >> 5)
+
+
+def decode(board, data):
+    # See shared/m3can/m3can_stats.c for the frame layout
+    s = stats.setdefault(board, {'ids': {}})
+    kind = data[0] & 3
+
+    if kind == 0:
+        util, peak, fps = struct.unpack("<HHH", bytes(data[1:7]))
+        s['util'] = util / 100.0
+        s['peak'] = peak / 100.0
+        s['fps'] = fps
+        s['overflows'] = data[7]
+        # The load frame starts each report, so forget the old top IDs
+        s['ids'] = {}
+    elif kind == 1:
+        s['tec'], s['rec'], esr = data[1], data[2], data[3]
+        s['bus_errors'], s['tx_blocked'] = struct.unpack(
+            "<HH", bytes(data[4:8]))
+        if esr & 4:
+            s['state'] = "bus off"
+        elif esr & 2:
+            s['state'] = "error passive"
+        elif esr & 1:
+            s['state'] = "error warning"
+        else:
+            s['state'] = "ok"
+    elif kind == 2:
+        sid, fps, share = struct.unpack("<HHH", bytes(data[1:7]))
+        s['ids'][data[0] >> 2] = (sid, fps, share / 100.0, data[7])
+
+    lines = []
+    if 'util' in s:
+        lines.append("Load {:.1f}% (peak {:.1f}%), {} frames/s".format(
+            s['util'], s['peak'], s['fps']))
+        if s['overflows']:
+            lines.append("RX overflows: {}".format(s['overflows']))
+    if 'state' in s:
+        lines.append("{}, TEC {} REC {}, {} bus errors, TX full {}".format(
+            s['state'], s['tec'], s['rec'], s['bus_errors'],
+            s['tx_blocked']))
+    for rank in sorted(s['ids']):
+        sid, fps, share, direction = s['ids'][rank]
+        lines.append("{} {}: {} frames/s, {:.1f}%".format(
+            {1: "RX", 2: "TX", 3: "RX/TX"}.get(direction, "?"),
+            id_name(sid), fps, share))
+    return "\n".join(lines)
+
+
+@register_packet("CAN Bus", CAN_MSG_ID_M3FC_CAN_STATS, "M3FC")
+def m3fc_canstats(data):
+    return decode(CAN_ID_M3FC, data)
+
+
+@register_packet("CAN Bus", CAN_MSG_ID_M3PSU_CAN_STATS, "M3PSU")
+def m3psu_canstats(data):
+    return decode(CAN_ID_M3PSU, data)
+
+
+@register_packet("CAN Bus", CAN_MSG_ID_M3PYRO_CAN_STATS, "M3PYRO")
+def m3pyro_canstats(data):
+    return decode(CAN_ID_M3PYRO, data)
+
+
+@register_packet("CAN Bus", CAN_MSG_ID_M3RADIO_CAN_STATS, "M3RADIO")
+def m3radio_canstats(data):
+    return decode(CAN_ID_M3RADIO, data)
+
+
+@register_packet("CAN Bus", CAN_MSG_ID_M3DL_CAN_STATS, "M3DL")
+def m3dl_canstats(data):
+    return decode(CAN_ID_M3DL, data)
@@ -5,7 +5,7 @@ import multiprocessing
 from queue import Queue, Empty
 
 from . import usbcan
-from .packets import registered_packets, registered_commands
+from .packets import packet_processors, registered_commands
 
 txq = multiprocessing.Queue()
 rxq = multiprocessing.Queue()
@@ -17,13 +17,15 @@ def update_state(state, sid, parent, name, logstring):
     state[parent] = tmp
 
 def find_processor(sid):
-    for name,parent in registered_packets.items():
-        if sid in parent:
-            return name, parent[sid]
+    return packet_processors.get(sid)
 
 def process(parent, name, arg):
     can_id, data = registered_commands[parent][name][0](arg)
-    txq.put(usbcan.CANFrame(can_id, False, len(data), data))
+    # Commands with no data ask for the message with a remote frame
+    rtr = data is None
+    if rtr:
+        data = []
+    txq.put(usbcan.CANFrame(can_id, rtr, len(data), data))
 
 errors = []
 
@@ -0,0 +1,67 @@
+from .packets import register_packet, register_command
+from .m3can_msgs import CAN_MSG_ID_STATUS, CAN_MSG_ID_M3FC_STATUS_DIGEST, \
+    CAN_MSG_ID_M3PSU_STATUS_DIGEST, CAN_MSG_ID_M3PYRO_STATUS_DIGEST, \
+    CAN_MSG_ID_M3RADIO_STATUS_DIGEST, CAN_MSG_ID_M3DL_STATUS_DIGEST, \
+    CAN_MSG_ID_M3FC_STATUS_BATCH, CAN_MSG_ID_M3PSU_STATUS_BATCH, \
+    CAN_MSG_ID_M3PYRO_STATUS_BATCH, CAN_MSG_ID_M3RADIO_STATUS_BATCH, \
+    CAN_MSG_ID_M3DL_STATUS_BATCH, \
+    CAN_ID_M3FC, CAN_ID_M3PSU, CAN_ID_M3PYRO, CAN_ID_M3RADIO, CAN_ID_M3DL, \
+    MESSAGES
+
+# Boards only send a status packet when a component changes, and this
+# digest every second, see shared/m3status/m3status.h
+STATUS_DIGEST = MESSAGES[CAN_MSG_ID_M3FC_STATUS_DIGEST].struct
+STATUS_BATCH = MESSAGES[CAN_MSG_ID_M3FC_STATUS_BATCH].struct
+
+STATUSES = {0: "OK", 1: "INIT", 2: "ERROR"}
+
+BOARDS = {"M3FC": CAN_ID_M3FC, "M3PSU": CAN_ID_M3PSU,
+          "M3PYRO": CAN_ID_M3PYRO, "M3RADIO": CAN_ID_M3RADIO,
+          "M3DL": CAN_ID_M3DL}
+
+
+def decode(data):
+    overall, components, initialising, errors, changes = \
+        STATUS_DIGEST.unpack_from(bytes(data))
+    # Starts with the overall state for the web interface's colours
+    return "{}: {} components, {} initialising, {} in error, {} changes" \
+        .format(STATUSES.get(overall, "Unknown"), components, initialising,
+                errors, changes)
+
+
+def decode_batch(data):
+    # 2 bits per component from `first`, 3 for one that isn't reporting
+    overall, first, *states = STATUS_BATCH.unpack_from(bytes(data))
+    parts = []
+    for i in range(24):
+        state = (states[i // 4] >> (2 * (i % 4))) & 3
+        if state != 3:
+            parts.append("{} {}".format(first + i, STATUSES[state]))
+    return "{}: {}".format(STATUSES.get(overall, "Unknown"),
+                           ", ".join(parts) or "none reporting")
+
+
+@register_packet("Status Digest", CAN_MSG_ID_M3FC_STATUS_DIGEST, "M3FC")
+@register_packet("Status Digest", CAN_MSG_ID_M3PSU_STATUS_DIGEST, "M3PSU")
+@register_packet("Status Digest", CAN_MSG_ID_M3PYRO_STATUS_DIGEST, "M3PYRO")
+@register_packet("Status Digest", CAN_MSG_ID_M3RADIO_STATUS_DIGEST,
+                 "M3RADIO")
+@register_packet("Status Digest", CAN_MSG_ID_M3DL_STATUS_DIGEST, "M3DL")
+def status_digest(data):
+    return decode(data)
+
+
+@register_packet("Status Batch", CAN_MSG_ID_M3FC_STATUS_BATCH, "M3FC")
+@register_packet("Status Batch", CAN_MSG_ID_M3PSU_STATUS_BATCH, "M3PSU")
+@register_packet("Status Batch", CAN_MSG_ID_M3PYRO_STATUS_BATCH, "M3PYRO")
+@register_packet("Status Batch", CAN_MSG_ID_M3RADIO_STATUS_BATCH, "M3RADIO")
+@register_packet("Status Batch", CAN_MSG_ID_M3DL_STATUS_BATCH, "M3DL")
+def status_batch(data):
+    return decode_batch(data)
+
+
+@register_command("Status Digest", "Request full status", list(BOARDS))
+def request_status(data):
+    # A remote frame for a board's status sends a batch of every
+    # component's state, then each component in error
+    return BOARDS[data] | CAN_MSG_ID_STATUS, None
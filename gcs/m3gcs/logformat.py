@@ -0,0 +1,429 @@
+"""
+Read M3DL log files of either version, see m3dl/firmware/logformat.h.
+
+read_frames(path) yields (sid, rtr, dlc, data, timestamp) for every frame
+logged, with data always 8 bytes and the timestamp in 1/10000 s systicks.
+Reading stops at the first block which doesn't belong to the file, such as
+the unused end of a preallocated file after a power loss; `LogReader.error`
+then says why.
+
+read_frames(path, start, end, ids) only yields frames timestamped from
+start to end inclusive, with IDs in ids. Version 2 logs are then only read
+where their index blocks show such frames may be: from the first block
+after start, found by binary search, and skipping regions without the IDs.
+Reading stops at the first block starting after end.
+
+Version 2 logs are decoded by m3dl_logdecode if it has been built (in
+m3dl/logdecode, or set M3DL_LOGDECODE to its path), and otherwise here,
+much more slowly.
+
+Only the standard library is used, so this can be imported on its own.
+"""
+
+import os
+import shutil
+import struct
+import subprocess
+import zlib
+
+MAGIC = 0x4C44334D
+VERSION = 2
+BLOCK_SIZE = 4096
+BLOCK_SCHEMA = 1
+BLOCK_DATA = 2
+BLOCK_INDEX = 3
+BLOCK_FOOTER = 4
+
+INDEX_INTERVAL = 64
+INDEX_BLOCKS = INDEX_INTERVAL - 1
+ID_BYTES = 2048 // 8
+OTHER_IDS = 0xFFFF
+
+HEADER = struct.Struct("<IBBHIIIIIHHI")
+SCHEMA_ENTRY = struct.Struct("<HBH")
+INDEX_HEADER = struct.Struct("<IIHHHH")
+ID_REGIONS = struct.Struct("<HHH")
+V1_RECORD = struct.Struct("<HBB8sI")
+
+HEAD_EXT = 0x0800
+HEAD_TIME_ESC = 15
+EXT_RTR = 0x80
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+LOGDECODE = os.path.join(HERE, "..", "..", "m3dl", "logdecode",
+                         "m3dl_logdecode")
+
+
+class LogError(Exception):
+    pass
+
+
+class Index:
+    """An index or footer block: the times of each data block in its
+    region as (earliest, latest), the IDs in any of them, and for the
+    footer, {sid: (first region, last region)}"""
+
+    def __init__(self, btype, body):
+        if len(body) < INDEX_HEADER.size:
+            raise LogError("bad record")
+        (self.file_min, self.file_max, self.region, blocks, regions,
+         ids) = INDEX_HEADER.unpack_from(body)
+        if btype != BLOCK_FOOTER:
+            regions = ids = 0
+        pos = INDEX_HEADER.size
+        if blocks > INDEX_BLOCKS or len(body) != pos + 8 * blocks + \
+                ID_BYTES + ID_REGIONS.size * ids:
+            raise LogError("bad record")
+        self.times = list(struct.iter_unpack("<II", body[pos:pos + 8 * blocks]))
+        pos += 8 * blocks
+        self.ids = int.from_bytes(body[pos:pos + ID_BYTES], "little")
+        pos += ID_BYTES
+        self.regions = regions
+        self.id_regions = {sid: (first, last) for sid, first, last in
+                           ID_REGIONS.iter_unpack(body[pos:])}
+
+
+def log_version(path):
+    with open(path, "rb") as f:
+        head = f.read(4)
+    if len(head) == 4 and struct.unpack("<I", head)[0] == MAGIC:
+        return VERSION
+    return 1
+
+
+def find_logdecode():
+    """Path of the C decoder, or None if it hasn't been built"""
+    path = os.environ.get("M3DL_LOGDECODE")
+    if path:
+        return path
+    if os.access(LOGDECODE, os.X_OK):
+        return LOGDECODE
+    return shutil.which("m3dl_logdecode")
+
+
+def _varint(buf, pos, end):
+    out = 0
+    shift = 0
+    while pos < end and shift < 35:
+        b = buf[pos]
+        pos += 1
+        out |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return out, pos
+        shift += 7
+    raise LogError("bad record")
+
+
+def _unzigzag(z):
+    return (z >> 1) ^ -(z & 1)
+
+
+def _fields(code):
+    """Byte widths of the delta coded fields packed in `code`"""
+    widths = []
+    while code:
+        widths.append(1 << ((code & 3) - 1))
+        code >>= 2
+    return widths
+
+
+class LogReader:
+    """Decodes a version 2 log one block at a time"""
+
+    def __init__(self):
+        self.session = None
+        self.sequence = 0
+        self.schema = None
+        self.error = None
+        self.block = None
+        self.min_timestamp = None
+
+    def check_block(self, block):
+        """Header of `block` if it is the next block of this file, after
+        checking its CRC, or raise LogError"""
+        if len(block) != BLOCK_SIZE:
+            raise LogError("not a log block")
+        (magic, version, btype, length, session, sequence, timestamp,
+         self.min_timestamp, _, records, _, crc) = HEADER.unpack_from(block)
+        if magic != MAGIC or version != VERSION or \
+                length > BLOCK_SIZE - HEADER.size:
+            raise LogError("not a log block")
+        crc_at = HEADER.size - 4
+        calc = zlib.crc32(block[:crc_at])
+        calc = zlib.crc32(b"\0\0\0\0", calc)
+        calc = zlib.crc32(block[crc_at + 4:], calc)
+        if calc != crc:
+            raise LogError("bad CRC")
+        if sequence != self.sequence:
+            raise LogError("block out of sequence")
+        if sequence == 0:
+            self.session = session
+        elif session != self.session:
+            raise LogError("block from another file")
+        self.sequence += 1
+        return btype, length, timestamp, records
+
+    def decode_block(self, block):
+        """Frames in the next `block` of the file, as a list"""
+        btype, length, timestamp, records = self.check_block(block)
+        body = block[HEADER.size:HEADER.size + length]
+        if btype == BLOCK_SCHEMA:
+            self.schema = {}
+            for sid, dlc, fields in SCHEMA_ENTRY.iter_unpack(body):
+                self.schema[sid] = (dlc, _fields(fields))
+            return []
+        elif btype == BLOCK_DATA:
+            if self.schema is None:
+                raise LogError("no schema block")
+            frames = self._decode_data(body, timestamp)
+            if len(frames) != records:
+                raise LogError("bad record")
+            return frames
+        return []
+
+    def _decode_data(self, body, timestamp):
+        frames = []
+        delta = {}
+        pos = 0
+        end = len(body)
+        schema = self.schema
+        while pos < end:
+            if end - pos < 2:
+                raise LogError("bad record")
+            head = body[pos] | (body[pos + 1] << 8)
+            pos += 2
+            sid = head & 0x7FF
+            entry = schema.get(sid)
+            if head & HEAD_EXT:
+                if pos >= end:
+                    raise LogError("bad record")
+                ext = body[pos]
+                pos += 1
+                rtr = 1 if ext & EXT_RTR else 0
+                dlc = ext & 0x0F
+                plain = False
+                if ext & 0x70 or dlc > 8:
+                    raise LogError("bad record")
+            else:
+                if entry is None:
+                    raise LogError("bad record")
+                rtr = 0
+                dlc = entry[0]
+                plain = True
+
+            fields = entry[1] if plain else None
+            state = delta.get(sid) if fields else None
+
+            z = head >> 12
+            if z == HEAD_TIME_ESC:
+                z, pos = _varint(body, pos, end)
+            if state is not None:
+                predicted = state[0] + state[1]
+            else:
+                predicted = timestamp
+            ts = (predicted + _unzigzag(z)) & 0xFFFFFFFF
+
+            if state is not None:
+                data = bytearray(8)
+                prev = state[2]
+                i = 0
+                for n in fields:
+                    z, pos = _varint(body, pos, end)
+                    v = int.from_bytes(prev[i:i + n], "little") + \
+                        _unzigzag(z)
+                    data[i:i + n] = (v & ((1 << (8 * n)) - 1)).to_bytes(
+                        n, "little")
+                    i += n
+                data = bytes(data)
+            elif rtr:
+                data = bytes(8)
+            else:
+                if end - pos < dlc:
+                    raise LogError("bad record")
+                data = body[pos:pos + dlc] + bytes(8 - dlc)
+                pos += dlc
+
+            if fields:
+                interval = (ts - state[0]) & 0xFFFFFFFF \
+                    if state is not None else 0
+                delta[sid] = (ts, interval, data)
+            timestamp = ts
+            frames.append((sid, rtr, dlc, data, ts))
+        return frames
+
+    def frames(self, f):
+        """Every frame in the open file `f`"""
+        while True:
+            block = f.read(BLOCK_SIZE)
+            if not block:
+                return
+            try:
+                frames = self.decode_block(block)
+            except LogError as e:
+                self.error = str(e)
+                return
+            for frame in frames:
+                yield frame
+
+    def _read(self, f, seq):
+        """Decode block `seq` out of order, or return None past the end"""
+        f.seek(seq * BLOCK_SIZE)
+        self.block = f.read(BLOCK_SIZE)
+        if not self.block:
+            return None
+        self.sequence = seq
+        return self.decode_block(self.block)
+
+    def _index(self, f, seq, btype):
+        """Index or footer block `seq`, or None if it isn't one"""
+        try:
+            if self._read(f, seq) is None:
+                return None
+            _, _, block_type, length = HEADER.unpack_from(self.block)[:4]
+            if block_type != btype:
+                return None
+            return Index(btype, self.block[HEADER.size:HEADER.size + length])
+        except LogError:
+            return None
+
+    def select(self, f, start=0, end=0xFFFFFFFF, ids=None):
+        """Frames in the open file `f` timestamped from `start` to `end`
+        with IDs in `ids`, reading only the blocks which may hold them"""
+        f.seek(0, os.SEEK_END)
+        file_blocks = f.tell() // BLOCK_SIZE
+        ids = None if ids is None else set(ids)
+
+        def wanted(frame):
+            return start <= frame[4] <= end and \
+                (ids is None or frame[0] in ids)
+
+        try:
+            if self._read(f, 0) is None:
+                return
+        except LogError as e:
+            self.error = str(e)
+            return
+        footer = None
+        if file_blocks > 1:
+            footer = self._index(f, file_blocks - 1, BLOCK_FOOTER)
+
+        # First region whose index shows the file reached start by its end
+        lo = 0
+        hi = footer.region if footer else (file_blocks - 1) // INDEX_INTERVAL
+        while start > 0 and lo < hi:
+            mid = (lo + hi) // 2
+            index = self._index(f, (mid + 1) * INDEX_INTERVAL, BLOCK_INDEX)
+            if index is None or index.file_max >= start:
+                hi = mid
+            else:
+                lo = mid + 1
+        region = lo
+        last_region = None
+        id_bits = 0
+
+        if ids is not None:
+            for sid in ids:
+                id_bits |= 1 << sid
+            if footer:
+                # IDs outside the file's schema share one entry
+                ranges = [footer.id_regions.get(
+                    sid if sid in self.schema else OTHER_IDS) for sid in ids]
+                ranges = [r for r in ranges if r is not None]
+                if not ranges:
+                    return
+                region = max(region, min(r[0] for r in ranges))
+                last_region = max(r[1] for r in ranges)
+
+        while last_region is None or region <= last_region:
+            if footer and region == footer.region:
+                index = footer
+            else:
+                index = self._index(f, (region + 1) * INDEX_INTERVAL,
+                                    BLOCK_INDEX)
+                if index is not None and index.region != region:
+                    index = None
+            if index is not None and ids is not None and \
+                    not index.ids & id_bits:
+                region += 1
+                continue
+
+            # Skip data blocks wholly before the range, and end at the first
+            # after it. Without an index, read them all.
+            for i in range(len(index.times) if index else INDEX_BLOCKS):
+                if index is not None:
+                    bmin, bmax = index.times[i]
+                    if bmin > end:
+                        return
+                    if bmax < start:
+                        continue
+                try:
+                    frames = self._read(f, region * INDEX_INTERVAL + 1 + i)
+                except LogError as e:
+                    self.error = str(e)
+                    return
+                if frames is None:
+                    return
+                for frame in frames:
+                    if wanted(frame):
+                        yield frame
+                if frames and self.min_timestamp > end:
+                    return
+            if index is not None and len(index.times) < INDEX_BLOCKS:
+                return
+            region += 1
+
+
+def _v1_frames(f):
+    while True:
+        packet = f.read(V1_RECORD.size)
+        if len(packet) != V1_RECORD.size:
+            return
+        yield V1_RECORD.unpack(packet)
+
+
+def _logdecode_frames(path, logdecode, args):
+    proc = subprocess.Popen([logdecode] + args + [path, "-"],
+                            stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL)
+    try:
+        for frame in _v1_frames(proc.stdout):
+            yield frame
+    finally:
+        proc.stdout.close()
+        proc.wait()
+
+
+def read_frames(path, start=None, end=None, ids=None, use_logdecode=True):
+    """Yield (sid, rtr, dlc, data, timestamp) for each frame in the log,
+    only those from systick `start` to `end` and with IDs in `ids` if
+    given"""
+    select = start is not None or end is not None or ids is not None
+    start = 0 if start is None else start
+    end = 0xFFFFFFFF if end is None else end
+
+    if log_version(path) == 1:
+        with open(path, "rb") as f:
+            for frame in _v1_frames(f):
+                if not select or (start <= frame[4] <= end and
+                                  (ids is None or frame[0] in ids)):
+                    yield frame
+        return
+
+    logdecode = find_logdecode() if use_logdecode else None
+    if logdecode is not None:
+        args = []
+        if select:
+            args = ["-s", "{:.4f}".format(start / 10000),
+                    "-t", "{:.4f}".format(end / 10000)]
+        if ids is not None:
+            if not ids:
+                return
+            args += ["-i", ",".join(str(sid) for sid in ids)]
+        yield from _logdecode_frames(path, logdecode, args)
+        return
+
+    with open(path, "rb") as f:
+        if select:
+            yield from LogReader().select(f, start, end, ids)
+        else:
+            yield from LogReader().frames(f)
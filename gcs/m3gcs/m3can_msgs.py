@@ -0,0 +1,766 @@
+"""
+Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+
+MESSAGES maps each CAN ID to a Message, whose decode() returns the
+scaled payload fields as a dict, and whose struct can be used
+directly to unpack the raw values in bulk.
+"""
+
+import struct
+
+
+def msg_id(x):
+    return x << 5
+
+
+CAN_ID_M3FC = 1
+CAN_ID_M3PSU = 2
+CAN_ID_M3PYRO = 3
+CAN_ID_M3RADIO = 4
+CAN_ID_M3IMU = 5
+CAN_ID_M3DL = 6
+CAN_ID_GROUND = 7
+
+CAN_MSG_ID_STATUS = msg_id(0)
+CAN_MSG_ID_STATUS_DIGEST = msg_id(40)
+CAN_MSG_ID_STATUS_BATCH = msg_id(41)
+CAN_MSG_ID_BULK_DATA = msg_id(45)
+CAN_MSG_ID_BULK_FLOW = msg_id(46)
+CAN_MSG_ID_CAN_STATS = msg_id(47)
+CAN_MSG_ID_THREAD_STATS = msg_id(61)
+CAN_MSG_ID_PROFILE = msg_id(62)
+CAN_MSG_ID_VERSION = msg_id(63)
+CAN_MSG_ID_M3FC_STATUS = CAN_ID_M3FC | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3FC_STATUS_DIGEST = CAN_ID_M3FC | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3FC_STATUS_BATCH = CAN_ID_M3FC | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3FC_BULK_DATA = CAN_ID_M3FC | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3FC_BULK_FLOW = CAN_ID_M3FC | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3FC_CAN_STATS = CAN_ID_M3FC | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3FC_THREAD_STATS = CAN_ID_M3FC | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3FC_PROFILE = CAN_ID_M3FC | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3FC_VERSION = CAN_ID_M3FC | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3PSU_STATUS = CAN_ID_M3PSU | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3PSU_STATUS_DIGEST = CAN_ID_M3PSU | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3PSU_STATUS_BATCH = CAN_ID_M3PSU | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3PSU_BULK_DATA = CAN_ID_M3PSU | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3PSU_BULK_FLOW = CAN_ID_M3PSU | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3PSU_CAN_STATS = CAN_ID_M3PSU | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3PSU_THREAD_STATS = CAN_ID_M3PSU | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3PSU_PROFILE = CAN_ID_M3PSU | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3PSU_VERSION = CAN_ID_M3PSU | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3PYRO_STATUS = CAN_ID_M3PYRO | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3PYRO_STATUS_DIGEST = CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3PYRO_STATUS_BATCH = CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3PYRO_BULK_DATA = CAN_ID_M3PYRO | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3PYRO_BULK_FLOW = CAN_ID_M3PYRO | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3PYRO_CAN_STATS = CAN_ID_M3PYRO | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3PYRO_THREAD_STATS = CAN_ID_M3PYRO | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3PYRO_PROFILE = CAN_ID_M3PYRO | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3PYRO_VERSION = CAN_ID_M3PYRO | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3RADIO_STATUS = CAN_ID_M3RADIO | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3RADIO_STATUS_DIGEST = CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3RADIO_STATUS_BATCH = CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3RADIO_BULK_DATA = CAN_ID_M3RADIO | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3RADIO_BULK_FLOW = CAN_ID_M3RADIO | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3RADIO_CAN_STATS = CAN_ID_M3RADIO | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3RADIO_THREAD_STATS = CAN_ID_M3RADIO | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3RADIO_PROFILE = CAN_ID_M3RADIO | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3RADIO_VERSION = CAN_ID_M3RADIO | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3IMU_STATUS = CAN_ID_M3IMU | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3IMU_STATUS_DIGEST = CAN_ID_M3IMU | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3IMU_STATUS_BATCH = CAN_ID_M3IMU | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3IMU_BULK_DATA = CAN_ID_M3IMU | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3IMU_BULK_FLOW = CAN_ID_M3IMU | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3IMU_CAN_STATS = CAN_ID_M3IMU | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3IMU_THREAD_STATS = CAN_ID_M3IMU | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3IMU_PROFILE = CAN_ID_M3IMU | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3IMU_VERSION = CAN_ID_M3IMU | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3DL_STATUS = CAN_ID_M3DL | CAN_MSG_ID_STATUS
+CAN_MSG_ID_M3DL_STATUS_DIGEST = CAN_ID_M3DL | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_M3DL_STATUS_BATCH = CAN_ID_M3DL | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_M3DL_BULK_DATA = CAN_ID_M3DL | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_M3DL_BULK_FLOW = CAN_ID_M3DL | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_M3DL_CAN_STATS = CAN_ID_M3DL | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_M3DL_THREAD_STATS = CAN_ID_M3DL | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_M3DL_PROFILE = CAN_ID_M3DL | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_M3DL_VERSION = CAN_ID_M3DL | CAN_MSG_ID_VERSION
+CAN_MSG_ID_GROUND_STATUS = CAN_ID_GROUND | CAN_MSG_ID_STATUS
+CAN_MSG_ID_GROUND_STATUS_DIGEST = CAN_ID_GROUND | CAN_MSG_ID_STATUS_DIGEST
+CAN_MSG_ID_GROUND_STATUS_BATCH = CAN_ID_GROUND | CAN_MSG_ID_STATUS_BATCH
+CAN_MSG_ID_GROUND_BULK_DATA = CAN_ID_GROUND | CAN_MSG_ID_BULK_DATA
+CAN_MSG_ID_GROUND_BULK_FLOW = CAN_ID_GROUND | CAN_MSG_ID_BULK_FLOW
+CAN_MSG_ID_GROUND_CAN_STATS = CAN_ID_GROUND | CAN_MSG_ID_CAN_STATS
+CAN_MSG_ID_GROUND_THREAD_STATS = CAN_ID_GROUND | CAN_MSG_ID_THREAD_STATS
+CAN_MSG_ID_GROUND_PROFILE = CAN_ID_GROUND | CAN_MSG_ID_PROFILE
+CAN_MSG_ID_GROUND_VERSION = CAN_ID_GROUND | CAN_MSG_ID_VERSION
+CAN_MSG_ID_M3RADIO_GPS_LATLNG = CAN_ID_M3RADIO | msg_id(48)
+CAN_MSG_ID_M3RADIO_GPS_ALT = CAN_ID_M3RADIO | msg_id(49)
+CAN_MSG_ID_M3RADIO_GPS_TIME = CAN_ID_M3RADIO | msg_id(50)
+CAN_MSG_ID_M3RADIO_GPS_STATUS = CAN_ID_M3RADIO | msg_id(51)
+CAN_MSG_ID_M3RADIO_PACKET_COUNT = CAN_ID_M3RADIO | msg_id(53)
+CAN_MSG_ID_M3RADIO_PACKET_STATS = CAN_ID_M3RADIO | msg_id(54)
+CAN_MSG_ID_M3RADIO_PING = CAN_ID_M3RADIO | msg_id(55)
+CAN_MSG_ID_M3RADIO_SET_FREQ = CAN_ID_M3RADIO | msg_id(56)
+CAN_MSG_ID_M3PSU_TOGGLE_PYROS = CAN_ID_M3PSU | msg_id(16)
+CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL = CAN_ID_M3PSU | msg_id(17)
+CAN_MSG_ID_M3PSU_TOGGLE_CHARGER = CAN_ID_M3PSU | msg_id(18)
+CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER = CAN_ID_M3PSU | msg_id(19)
+CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT = CAN_ID_M3PSU | msg_id(20)
+CAN_MSG_ID_M3PSU_PYRO_STATUS = CAN_ID_M3PSU | msg_id(48)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12 = CAN_ID_M3PSU | msg_id(49)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34 = CAN_ID_M3PSU | msg_id(50)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56 = CAN_ID_M3PSU | msg_id(51)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78 = CAN_ID_M3PSU | msg_id(52)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910 = CAN_ID_M3PSU | msg_id(53)
+CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112 = CAN_ID_M3PSU | msg_id(54)
+CAN_MSG_ID_M3PSU_CHARGER_STATUS = CAN_ID_M3PSU | msg_id(55)
+CAN_MSG_ID_M3PSU_BATT_VOLTAGES = CAN_ID_M3PSU | msg_id(56)
+CAN_MSG_ID_M3PSU_CAPACITY = CAN_ID_M3PSU | msg_id(57)
+CAN_MSG_ID_M3PSU_AWAKE_TIME = CAN_ID_M3PSU | msg_id(58)
+CAN_MSG_ID_M3FC_SET_CFG_PROFILE = CAN_ID_M3FC | msg_id(1)
+CAN_MSG_ID_M3FC_SET_CFG_PYROS = CAN_ID_M3FC | msg_id(2)
+CAN_MSG_ID_M3FC_LOAD_CFG = CAN_ID_M3FC | msg_id(3)
+CAN_MSG_ID_M3FC_SAVE_CFG = CAN_ID_M3FC | msg_id(4)
+CAN_MSG_ID_M3FC_MOCK_ENABLE = CAN_ID_M3FC | msg_id(5)
+CAN_MSG_ID_M3FC_MOCK_ACCEL = CAN_ID_M3FC | msg_id(6)
+CAN_MSG_ID_M3FC_MOCK_BARO = CAN_ID_M3FC | msg_id(7)
+CAN_MSG_ID_M3FC_ARM = CAN_ID_M3FC | msg_id(8)
+CAN_MSG_ID_M3FC_FIRE = CAN_ID_M3FC | msg_id(9)
+CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X = CAN_ID_M3FC | msg_id(10)
+CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y = CAN_ID_M3FC | msg_id(11)
+CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z = CAN_ID_M3FC | msg_id(12)
+CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ = CAN_ID_M3FC | msg_id(13)
+CAN_MSG_ID_M3FC_SET_CFG_CRC = CAN_ID_M3FC | msg_id(14)
+CAN_MSG_ID_M3FC_TIMESYNC = CAN_ID_M3FC | msg_id(15)
+CAN_MSG_ID_M3FC_MISSION_STATE = CAN_ID_M3FC | msg_id(32)
+CAN_MSG_ID_M3FC_ACCEL = CAN_ID_M3FC | msg_id(48)
+CAN_MSG_ID_M3FC_BARO = CAN_ID_M3FC | msg_id(49)
+CAN_MSG_ID_M3FC_SE_T_H = CAN_ID_M3FC | msg_id(50)
+CAN_MSG_ID_M3FC_SE_V_A = CAN_ID_M3FC | msg_id(51)
+CAN_MSG_ID_M3FC_SE_VAR_H = CAN_ID_M3FC | msg_id(52)
+CAN_MSG_ID_M3FC_SE_VAR_V_A = CAN_ID_M3FC | msg_id(53)
+CAN_MSG_ID_M3FC_CFG_PROFILE = CAN_ID_M3FC | msg_id(54)
+CAN_MSG_ID_M3FC_CFG_PYROS = CAN_ID_M3FC | msg_id(55)
+CAN_MSG_ID_M3FC_CFG_ACCEL_X = CAN_ID_M3FC | msg_id(56)
+CAN_MSG_ID_M3FC_CFG_ACCEL_Y = CAN_ID_M3FC | msg_id(57)
+CAN_MSG_ID_M3FC_CFG_ACCEL_Z = CAN_ID_M3FC | msg_id(58)
+CAN_MSG_ID_M3FC_CFG_RADIO_FREQ = CAN_ID_M3FC | msg_id(59)
+CAN_MSG_ID_M3FC_CFG_CRC = CAN_ID_M3FC | msg_id(60)
+CAN_MSG_ID_M3DL_FREE_SPACE = CAN_ID_M3DL | msg_id(32)
+CAN_MSG_ID_M3DL_RATE = CAN_ID_M3DL | msg_id(33)
+CAN_MSG_ID_M3DL_TEMP_1_2 = CAN_ID_M3DL | msg_id(48)
+CAN_MSG_ID_M3DL_TEMP_3_4 = CAN_ID_M3DL | msg_id(49)
+CAN_MSG_ID_M3DL_TEMP_5_6 = CAN_ID_M3DL | msg_id(50)
+CAN_MSG_ID_M3DL_TEMP_7_8 = CAN_ID_M3DL | msg_id(51)
+CAN_MSG_ID_M3DL_TEMP_9 = CAN_ID_M3DL | msg_id(52)
+CAN_MSG_ID_M3DL_PRESSURE = CAN_ID_M3DL | msg_id(53)
+CAN_MSG_ID_M3PYRO_FIRE_COMMAND = CAN_ID_M3PYRO | msg_id(1)
+CAN_MSG_ID_M3PYRO_ARM_COMMAND = CAN_ID_M3PYRO | msg_id(2)
+CAN_MSG_ID_M3PYRO_FIRE_STATUS = CAN_ID_M3PYRO | msg_id(16)
+CAN_MSG_ID_M3PYRO_ARM_STATUS = CAN_ID_M3PYRO | msg_id(17)
+CAN_MSG_ID_M3PYRO_CONTINUITY = CAN_ID_M3PYRO | msg_id(48)
+CAN_MSG_ID_M3PYRO_SUPPLY_STATUS = CAN_ID_M3PYRO | msg_id(49)
+CAN_MSG_ID_GROUND_PACKET_COUNT = CAN_ID_GROUND | msg_id(53)
+CAN_MSG_ID_GROUND_PACKET_STATS = CAN_ID_GROUND | msg_id(54)
+CAN_MSG_ID_GROUND_PACKET_FRAMES = CAN_ID_GROUND | msg_id(55)
+
+
+class Message:
+    def __init__(self, board, name, fmt, fields):
+        self.board = board
+        self.name = name
+        self.struct = struct.Struct(fmt)
+        self.size = self.struct.size
+        # (name, first value, number of values or None, scale, unit)
+        self.fields = fields
+
+    def decode(self, data):
+        """Scaled fields of `data` by name, or None if it is too
+        short. Arrays decode to lists and text to str."""
+        if len(data) < self.size:
+            return None
+        raw = self.struct.unpack_from(bytes(data))
+        out = {}
+        for name, i, n, scale, _ in self.fields:
+            if n is None:
+                v = raw[i]
+                out[name] = v if scale == 1 else v * scale
+            elif n == 0:
+                out[name] = raw[i].split(b"\0", 1)[0].decode(
+                    "ascii", "replace")
+            else:
+                vs = raw[i:i+n]
+                out[name] = list(vs) if scale == 1 else [
+                    v * scale for v in vs]
+        return out
+
+
+def decode(sid, data):
+    """Decode a frame with CAN ID `sid`, returning the message and a
+    dict of its fields, or None if it isn't known."""
+    msg = MESSAGES.get(sid)
+    if msg is None:
+        return None
+    return msg, msg.decode(data)
+
+
+MESSAGES = {
+    CAN_MSG_ID_M3FC_STATUS: Message('m3fc', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_STATUS_DIGEST: Message('m3fc', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_STATUS_BATCH: Message('m3fc', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_BULK_DATA: Message('m3fc', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_BULK_FLOW: Message('m3fc', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_CAN_STATS: Message('m3fc', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_THREAD_STATS: Message('m3fc', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_PROFILE: Message('m3fc', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_VERSION: Message('m3fc', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_STATUS: Message('m3psu', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_STATUS_DIGEST: Message('m3psu', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_STATUS_BATCH: Message('m3psu', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_BULK_DATA: Message('m3psu', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_BULK_FLOW: Message('m3psu', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CAN_STATS: Message('m3psu', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_THREAD_STATS: Message('m3psu', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_PROFILE: Message('m3psu', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_VERSION: Message('m3psu', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_STATUS: Message('m3pyro', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_STATUS_DIGEST: Message('m3pyro', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_STATUS_BATCH: Message('m3pyro', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_BULK_DATA: Message('m3pyro', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_BULK_FLOW: Message('m3pyro', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_CAN_STATS: Message('m3pyro', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_THREAD_STATS: Message('m3pyro', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_PROFILE: Message('m3pyro', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_VERSION: Message('m3pyro', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_STATUS: Message('m3radio', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_STATUS_DIGEST: Message('m3radio', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_STATUS_BATCH: Message('m3radio', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_BULK_DATA: Message('m3radio', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_BULK_FLOW: Message('m3radio', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_CAN_STATS: Message('m3radio', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_THREAD_STATS: Message('m3radio', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_PROFILE: Message('m3radio', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_VERSION: Message('m3radio', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_STATUS: Message('m3imu', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_STATUS_DIGEST: Message('m3imu', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_STATUS_BATCH: Message('m3imu', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_BULK_DATA: Message('m3imu', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_BULK_FLOW: Message('m3imu', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_CAN_STATS: Message('m3imu', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_THREAD_STATS: Message('m3imu', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_PROFILE: Message('m3imu', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3IMU_VERSION: Message('m3imu', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_STATUS: Message('m3dl', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_STATUS_DIGEST: Message('m3dl', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_STATUS_BATCH: Message('m3dl', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_BULK_DATA: Message('m3dl', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_BULK_FLOW: Message('m3dl', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_CAN_STATS: Message('m3dl', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_THREAD_STATS: Message('m3dl', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_PROFILE: Message('m3dl', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_VERSION: Message('m3dl', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_STATUS: Message('ground', 'status', '<BBB', [
+        ('overall', 0, None, 1, ''),
+        ('component', 1, None, 1, ''),
+        ('state', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_STATUS_DIGEST: Message('ground', 'status_digest', '<BBBBH', [
+        ('overall', 0, None, 1, ''),
+        ('components', 1, None, 1, ''),
+        ('initialising', 2, None, 1, ''),
+        ('errors', 3, None, 1, ''),
+        ('changes', 4, None, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_STATUS_BATCH: Message('ground', 'status_batch', '<BB6B', [
+        ('overall', 0, None, 1, ''),
+        ('first', 1, None, 1, ''),
+        ('states', 2, 6, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_BULK_DATA: Message('ground', 'bulk_data', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_BULK_FLOW: Message('ground', 'bulk_flow', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_CAN_STATS: Message('ground', 'can_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_THREAD_STATS: Message('ground', 'thread_stats', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_PROFILE: Message('ground', 'profile', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_VERSION: Message('ground', 'version', '<8s', [
+        ('version', 0, 0, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_GPS_LATLNG: Message('m3radio', 'gps_latlng', '<ii', [
+        ('lat', 0, None, 1e-07, 'deg'),
+        ('lng', 1, None, 1e-07, 'deg'),
+    ]),
+    CAN_MSG_ID_M3RADIO_GPS_ALT: Message('m3radio', 'gps_alt', '<ii', [
+        ('height', 0, None, 0.001, 'm'),
+        ('h_msl', 1, None, 0.001, 'm'),
+    ]),
+    CAN_MSG_ID_M3RADIO_GPS_TIME: Message('m3radio', 'gps_time', '<HBBBBBB', [
+        ('year', 0, None, 1, ''),
+        ('month', 1, None, 1, ''),
+        ('day', 2, None, 1, ''),
+        ('hour', 3, None, 1, ''),
+        ('minute', 4, None, 1, ''),
+        ('second', 5, None, 1, ''),
+        ('valid', 6, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_GPS_STATUS: Message('m3radio', 'gps_status', '<BBB', [
+        ('fix_type', 0, None, 1, ''),
+        ('flags', 1, None, 1, ''),
+        ('num_sv', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_PACKET_COUNT: Message('m3radio', 'packet_count', '<II', [
+        ('tx_count', 0, None, 1, ''),
+        ('rx_count', 1, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_PACKET_STATS: Message('m3radio', 'packet_stats', '<hhHH', [
+        ('rssi', 0, None, 1, 'dBm'),
+        ('freq_offset', 1, None, 1, 'Hz'),
+        ('bit_errors', 2, None, 1, ''),
+        ('ldpc_iters', 3, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3RADIO_PING: Message('m3radio', 'ping', '<', [
+    ]),
+    CAN_MSG_ID_M3RADIO_SET_FREQ: Message('m3radio', 'set_freq', '<I', [
+        ('freq', 0, None, 1, 'Hz'),
+    ]),
+    CAN_MSG_ID_M3PSU_TOGGLE_PYROS: Message('m3psu', 'toggle_pyros', '<B', [
+        ('enable', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL: Message('m3psu', 'toggle_channel', '<BB', [
+        ('enable', 0, None, 1, ''),
+        ('channel', 1, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_TOGGLE_CHARGER: Message('m3psu', 'toggle_charger', '<B', [
+        ('enable', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER: Message('m3psu', 'toggle_lowpower', '<B', [
+        ('enable', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT: Message('m3psu', 'toggle_battleshort', '<B', [
+        ('enable', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_PYRO_STATUS: Message('m3psu', 'pyro_status', '<HHHB', [
+        ('voltage', 0, None, 0.001, 'V'),
+        ('current', 1, None, 0.001, 'A'),
+        ('power', 2, None, 0.001, 'W'),
+        ('enabled', 3, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12: Message('m3psu', 'channel_status_12', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34: Message('m3psu', 'channel_status_34', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56: Message('m3psu', 'channel_status_56', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78: Message('m3psu', 'channel_status_78', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910: Message('m3psu', 'channel_status_910', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112: Message('m3psu', 'channel_status_1112', '<BBBBBBBB', [
+        ('voltage_a', 0, None, 0.03, 'V'),
+        ('current_a', 1, None, 0.003, 'A'),
+        ('power_a', 2, None, 0.02, 'W'),
+        ('reserved_a', 3, None, 1, ''),
+        ('voltage_b', 4, None, 0.03, 'V'),
+        ('current_b', 5, None, 0.003, 'A'),
+        ('power_b', 6, None, 0.02, 'W'),
+        ('reserved_b', 7, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PSU_CHARGER_STATUS: Message('m3psu', 'charger_status', '<hBH', [
+        ('current', 0, None, 0.001, 'A'),
+        ('flags', 1, None, 1, ''),
+        ('temperature', 2, None, 0.1, 'K'),
+    ]),
+    CAN_MSG_ID_M3PSU_BATT_VOLTAGES: Message('m3psu', 'batt_voltages', '<HHH', [
+        ('cell1', 0, None, 0.01, 'V'),
+        ('cell2', 1, None, 0.01, 'V'),
+        ('battery', 2, None, 0.01, 'V'),
+    ]),
+    CAN_MSG_ID_M3PSU_CAPACITY: Message('m3psu', 'capacity', '<hB', [
+        ('minutes', 0, None, 1, 'min'),
+        ('percent', 1, None, 1, '%'),
+    ]),
+    CAN_MSG_ID_M3PSU_AWAKE_TIME: Message('m3psu', 'awake_time', '<HB', [
+        ('seconds', 0, None, 1, 's'),
+        ('flags', 1, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_PROFILE: Message('m3fc', 'set_cfg_profile', '<BBBBBBBB', [
+        ('position', 0, None, 1, ''),
+        ('accel_axis', 1, None, 1, ''),
+        ('ignition_accel', 2, None, 1, 'm/s/s'),
+        ('burnout_timeout', 3, None, 0.1, 's'),
+        ('apogee_timeout', 4, None, 1, 's'),
+        ('main_altitude', 5, None, 10, 'm'),
+        ('main_timeout', 6, None, 1, 's'),
+        ('land_timeout', 7, None, 10, 's'),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_PYROS: Message('m3fc', 'set_cfg_pyros', '<8B', [
+        ('pyros', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_LOAD_CFG: Message('m3fc', 'load_cfg', '<', [
+    ]),
+    CAN_MSG_ID_M3FC_SAVE_CFG: Message('m3fc', 'save_cfg', '<', [
+    ]),
+    CAN_MSG_ID_M3FC_MOCK_ENABLE: Message('m3fc', 'mock_enable', '<', [
+    ]),
+    CAN_MSG_ID_M3FC_MOCK_ACCEL: Message('m3fc', 'mock_accel', '<hhh', [
+        ('x', 0, None, 0.038245935, 'm/s/s'),
+        ('y', 1, None, 0.038245935, 'm/s/s'),
+        ('z', 2, None, 0.038245935, 'm/s/s'),
+    ]),
+    CAN_MSG_ID_M3FC_MOCK_BARO: Message('m3fc', 'mock_baro', '<ii', [
+        ('temperature', 0, None, 0.01, 'degC'),
+        ('pressure', 1, None, 1, 'Pa'),
+    ]),
+    CAN_MSG_ID_M3FC_ARM: Message('m3fc', 'arm', '<', [
+    ]),
+    CAN_MSG_ID_M3FC_FIRE: Message('m3fc', 'fire', '<B', [
+        ('usage', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X: Message('m3fc', 'set_cfg_accel_x', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y: Message('m3fc', 'set_cfg_accel_y', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z: Message('m3fc', 'set_cfg_accel_z', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ: Message('m3fc', 'set_cfg_radio_freq', '<I', [
+        ('freq', 0, None, 1, 'Hz'),
+    ]),
+    CAN_MSG_ID_M3FC_SET_CFG_CRC: Message('m3fc', 'set_cfg_crc', '<I', [
+        ('crc', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_TIMESYNC: Message('m3fc', 'timesync', '<IBB', [
+        ('time', 0, None, 0.0001, 's'),
+        ('time_seq', 1, None, 1, ''),
+        ('seq', 2, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_MISSION_STATE: Message('m3fc', 'mission_state', '<IB', [
+        ('met', 0, None, 0.001, 's'),
+        ('state', 1, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_ACCEL: Message('m3fc', 'accel', '<hhhH', [
+        ('x', 0, None, 0.038245935, 'm/s/s'),
+        ('y', 1, None, 0.038245935, 'm/s/s'),
+        ('z', 2, None, 0.038245935, 'm/s/s'),
+        ('time', 3, None, 0.0001, 's'),
+    ]),
+    CAN_MSG_ID_M3FC_BARO: Message('m3fc', 'baro', '<ii', [
+        ('temperature', 0, None, 0.01, 'degC'),
+        ('pressure', 1, None, 1, 'Pa'),
+    ]),
+    CAN_MSG_ID_M3FC_SE_T_H: Message('m3fc', 'se_t_h', '<ff', [
+        ('dt', 0, None, 1, 's'),
+        ('h', 1, None, 1, 'm'),
+    ]),
+    CAN_MSG_ID_M3FC_SE_V_A: Message('m3fc', 'se_v_a', '<ff', [
+        ('v', 0, None, 1, 'm/s'),
+        ('a', 1, None, 1, 'm/s/s'),
+    ]),
+    CAN_MSG_ID_M3FC_SE_VAR_H: Message('m3fc', 'se_var_h', '<f', [
+        ('var_h', 0, None, 1, 'm^2'),
+    ]),
+    CAN_MSG_ID_M3FC_SE_VAR_V_A: Message('m3fc', 'se_var_v_a', '<ff', [
+        ('var_v', 0, None, 1, '(m/s)^2'),
+        ('var_a', 1, None, 1, '(m/s/s)^2'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_PROFILE: Message('m3fc', 'cfg_profile', '<BBBBBBBB', [
+        ('position', 0, None, 1, ''),
+        ('accel_axis', 1, None, 1, ''),
+        ('ignition_accel', 2, None, 1, 'm/s/s'),
+        ('burnout_timeout', 3, None, 0.1, 's'),
+        ('apogee_timeout', 4, None, 1, 's'),
+        ('main_altitude', 5, None, 10, 'm'),
+        ('main_timeout', 6, None, 1, 's'),
+        ('land_timeout', 7, None, 10, 's'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_PYROS: Message('m3fc', 'cfg_pyros', '<8B', [
+        ('pyros', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_ACCEL_X: Message('m3fc', 'cfg_accel_x', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_ACCEL_Y: Message('m3fc', 'cfg_accel_y', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_ACCEL_Z: Message('m3fc', 'cfg_accel_z', '<ff', [
+        ('scale', 0, None, 1, 'g/LSB'),
+        ('offset', 1, None, 1, 'LSB'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_RADIO_FREQ: Message('m3fc', 'cfg_radio_freq', '<I', [
+        ('freq', 0, None, 1, 'Hz'),
+    ]),
+    CAN_MSG_ID_M3FC_CFG_CRC: Message('m3fc', 'cfg_crc', '<I', [
+        ('crc', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_FREE_SPACE: Message('m3dl', 'free_space', '<I', [
+        ('free_clusters', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_RATE: Message('m3dl', 'rate', '<I', [
+        ('packet_rate', 0, None, 1, '/s'),
+    ]),
+    CAN_MSG_ID_M3DL_TEMP_1_2: Message('m3dl', 'temp_1_2', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_TEMP_3_4: Message('m3dl', 'temp_3_4', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_TEMP_5_6: Message('m3dl', 'temp_5_6', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_TEMP_7_8: Message('m3dl', 'temp_7_8', '<8B', [
+        ('data', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_TEMP_9: Message('m3dl', 'temp_9', '<4B', [
+        ('data', 0, 4, 1, ''),
+    ]),
+    CAN_MSG_ID_M3DL_PRESSURE: Message('m3dl', 'pressure', '<HHHH', [
+        ('p1', 0, None, 1.25, 'kPa'),
+        ('p2', 1, None, 1.25, 'kPa'),
+        ('p3', 2, None, 1.25, 'kPa'),
+        ('p4', 3, None, 1.25, 'kPa'),
+    ]),
+    CAN_MSG_ID_M3PYRO_FIRE_COMMAND: Message('m3pyro', 'fire_command', '<8B', [
+        ('channels', 0, 8, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_ARM_COMMAND: Message('m3pyro', 'arm_command', '<B', [
+        ('arm', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_FIRE_STATUS: Message('m3pyro', 'fire_status', '<4B', [
+        ('channels', 0, 4, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_ARM_STATUS: Message('m3pyro', 'arm_status', '<B', [
+        ('armed', 0, None, 1, ''),
+    ]),
+    CAN_MSG_ID_M3PYRO_CONTINUITY: Message('m3pyro', 'continuity', '<8B', [
+        ('resistance', 0, 8, 2, 'ohm'),
+    ]),
+    CAN_MSG_ID_M3PYRO_SUPPLY_STATUS: Message('m3pyro', 'supply_status', '<BB', [
+        ('supply', 0, None, 0.1, 'V'),
+        ('bus', 1, None, 0.1, 'V'),
+    ]),
+    CAN_MSG_ID_GROUND_PACKET_COUNT: Message('ground', 'packet_count', '<II', [
+        ('tx_count', 0, None, 1, ''),
+        ('rx_count', 1, None, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_PACKET_STATS: Message('ground', 'packet_stats', '<hhHH', [
+        ('rssi', 0, None, 1, 'dBm'),
+        ('freq_offset', 1, None, 1, 'Hz'),
+        ('bit_errors', 2, None, 1, ''),
+        ('ldpc_iters', 3, None, 1, ''),
+    ]),
+    CAN_MSG_ID_GROUND_PACKET_FRAMES: Message('ground', 'packet_frames', '<BB', [
+        ('this_packet', 0, None, 1, ''),
+        ('in_queue', 1, None, 1, ''),
+    ]),
+}
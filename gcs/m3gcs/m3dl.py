@@ -19,7 +19,8 @@ CAN_MSG_ID_M3DL_PRESSURE = CAN_ID_M3DL | msg_id(53)
 components = {
     1: "Temperature",
     2: "SD Card",
-    3: "Pressure"
+    3: "Pressure",
+    255: "CAN",
 }
 
 component_errors = {
@@ -28,10 +29,12 @@ component_errors = {
     3: "SD Card Connection", 4: "SD Card Mounting",
     5: "SD Card File Open", 6: "SD Card Inc File Open",
     7: "SD Card Write", 8: "Logging Cache Flush", 9: "SD Card FULL", 
+    10: "Logging Overflow",
     16: "T1 Invalid", 17: "T2 Invalid", 18: "T3 Invalid",
     19: "T4 Invalid", 20: "T5 Invalid", 21: "T6 Invalid",
     22: "T4 Invalid", 23: "T5 Invalid", 24: "T9 Invalid",
-    25: "CRC Failure", 32: "Pressure Timeout"
+    25: "CRC Failure", 32: "Pressure Timeout",
+    253: "CAN Bad Length", 254: "CAN TX Dropped", 255: "CAN TX Overflow",
 }
 
 compstatus = {k: {"state": 0, "reason": "Unknown"} for k in components}
@@ -43,7 +46,7 @@ def status(data):
     # interface watches for these and applies special treatment (colours)
     statuses = {0: "OK", 1: "INIT", 2: "ERROR"}
     overall, comp, comp_state = data[:3]
-    if len(data) == 4:
+    if len(data) >= 4:
         comp_error = data[3]
     else:
         comp_error = 0
@@ -53,7 +56,16 @@ def status(data):
                                  components.get(comp, "Unknown"),
                                  statuses.get(comp_state, "Unknown"))
     if comp_error != 0:
-        string += " {})".format(component_errors.get(comp_error, "Unknown"))
+        string += " {}".format(component_errors.get(comp_error, "Unknown"))
+        if comp == 255 and len(data) == 8:
+            # TX queue overflow and dropped frame counts, see m3can.c
+            string += " {} overflows, {} dropped".format(
+                data[4] | (data[5] << 8), data[6] | (data[7] << 8))
+        elif comp == 255 and comp_error == 253 and len(data) == 7:
+            # Frame rejected by m3can_dispatch, see m3can_util.c
+            string += " ID 0x{:03x} length {}".format(
+                data[4] | (data[5] << 8), data[6])
+        string += ")"
     else:
         string += ")"
 
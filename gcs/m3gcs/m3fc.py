@@ -1,37 +1,30 @@
 from .packets import register_packet, register_command
-import struct
+from .m3can_msgs import MESSAGES, CAN_MSG_ID_M3FC_STATUS, \
+    CAN_MSG_ID_M3FC_MISSION_STATE, CAN_MSG_ID_M3FC_ACCEL, \
+    CAN_MSG_ID_M3FC_BARO, CAN_MSG_ID_M3FC_SE_T_H, CAN_MSG_ID_M3FC_SE_V_A, \
+    CAN_MSG_ID_M3FC_SE_VAR_H, CAN_MSG_ID_M3FC_SE_VAR_V_A, \
+    CAN_MSG_ID_M3FC_CFG_PROFILE, CAN_MSG_ID_M3FC_CFG_PYROS, \
+    CAN_MSG_ID_M3FC_CFG_ACCEL_X, CAN_MSG_ID_M3FC_CFG_ACCEL_Y, \
+    CAN_MSG_ID_M3FC_CFG_ACCEL_Z, CAN_MSG_ID_M3FC_CFG_RADIO_FREQ, \
+    CAN_MSG_ID_M3FC_CFG_CRC, CAN_MSG_ID_M3FC_SET_CFG_PROFILE, \
+    CAN_MSG_ID_M3FC_SET_CFG_PYROS, CAN_MSG_ID_M3FC_LOAD_CFG, \
+    CAN_MSG_ID_M3FC_SAVE_CFG, CAN_MSG_ID_M3FC_MOCK_ENABLE, \
+    CAN_MSG_ID_M3FC_MOCK_ACCEL, CAN_MSG_ID_M3FC_MOCK_BARO, \
+    CAN_MSG_ID_M3FC_ARM, CAN_MSG_ID_M3FC_FIRE, CAN_MSG_ID_M3FC_TIMESYNC
 from math import sqrt
 
-
-def msg_id(x):
-    return x << 5
-
-
-CAN_ID_M3FC = 1
-CAN_MSG_ID_M3FC_STATUS = CAN_ID_M3FC | msg_id(0)
-CAN_MSG_ID_M3FC_MISSION_STATE = CAN_ID_M3FC | msg_id(32)
-CAN_MSG_ID_M3FC_ACCEL = CAN_ID_M3FC | msg_id(48)
-CAN_MSG_ID_M3FC_BARO = CAN_ID_M3FC | msg_id(49)
-CAN_MSG_ID_M3FC_SE_T_H = CAN_ID_M3FC | msg_id(50)
-CAN_MSG_ID_M3FC_SE_V_A = CAN_ID_M3FC | msg_id(51)
-CAN_MSG_ID_M3FC_SE_VAR_H = CAN_ID_M3FC | msg_id(52)
-CAN_MSG_ID_M3FC_SE_VAR_V_A = CAN_ID_M3FC | msg_id(53)
-CAN_MSG_ID_M3FC_CFG_PROFILE = CAN_ID_M3FC | msg_id(54)
-CAN_MSG_ID_M3FC_CFG_PYROS = CAN_ID_M3FC | msg_id(55)
-CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_X = CAN_ID_M3FC | msg_id(56)
-CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_Y = CAN_ID_M3FC | msg_id(57)
-CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_Z = CAN_ID_M3FC | msg_id(58)
-CAN_MSG_ID_M3FC_CFG_RADIO_FREQ = CAN_ID_M3FC | msg_id(59)
-CAN_MSG_ID_M3FC_CFG_CRC = CAN_ID_M3FC | msg_id(60)
-CAN_MSG_ID_M3FC_SET_CFG_PROFILE = CAN_ID_M3FC | msg_id(1)
-CAN_MSG_ID_M3FC_SET_CFG_PYROS = CAN_ID_M3FC | msg_id(2)
-CAN_MSG_ID_M3FC_LOAD_CFG = CAN_ID_M3FC | msg_id(3)
-CAN_MSG_ID_M3FC_SAVE_CFG = CAN_ID_M3FC | msg_id(4)
-CAN_MSG_ID_M3FC_MOCK_ENABLE = CAN_ID_M3FC | msg_id(5)
-CAN_MSG_ID_M3FC_MOCK_ACCEL = CAN_ID_M3FC | msg_id(6)
-CAN_MSG_ID_M3FC_MOCK_BARO = CAN_ID_M3FC | msg_id(7)
-CAN_MSG_ID_M3FC_ARM = CAN_ID_M3FC | msg_id(8)
-CAN_MSG_ID_M3FC_FIRE = CAN_ID_M3FC | msg_id(9)
+# Payload layouts generated from shared/m3can/messages.yaml
+MISSION_STATE = MESSAGES[CAN_MSG_ID_M3FC_MISSION_STATE].struct
+TIMESYNC = MESSAGES[CAN_MSG_ID_M3FC_TIMESYNC].struct
+MOCK_ACCEL = MESSAGES[CAN_MSG_ID_M3FC_MOCK_ACCEL].struct
+BARO = MESSAGES[CAN_MSG_ID_M3FC_BARO].struct
+SE_T_H = MESSAGES[CAN_MSG_ID_M3FC_SE_T_H].struct
+SE_V_A = MESSAGES[CAN_MSG_ID_M3FC_SE_V_A].struct
+SE_VAR_H = MESSAGES[CAN_MSG_ID_M3FC_SE_VAR_H].struct
+SE_VAR_V_A = MESSAGES[CAN_MSG_ID_M3FC_SE_VAR_V_A].struct
+CFG_ACCEL = MESSAGES[CAN_MSG_ID_M3FC_CFG_ACCEL_X].struct
+CFG_RADIO_FREQ = MESSAGES[CAN_MSG_ID_M3FC_CFG_RADIO_FREQ].struct
+CFG_CRC = MESSAGES[CAN_MSG_ID_M3FC_CFG_CRC].struct
 
 components = {
     1: "Mission Control",
@@ -45,6 +38,7 @@ components = {
     9: "Pyros",
     10: "Mock",
     11: "PSU",
+    255: "CAN",
 }
 
 component_errors = {
@@ -55,7 +49,8 @@ component_errors = {
     13: "Accel Axis", 14: "SE Pressure", 15: "Pyro Arm", 4: "Pyro Continuity",
     5: "Pyro Supply", 16: "Mock Enabled", 17: "CAN Bad Command",
     18: "Config Check Accel Cal", 19: "Config Check Radio Freq",
-    20: "Config Check CRC", 21: "Battleshort",
+    20: "Config Check CRC", 21: "Battleshort", 22: "SE Queue Full",
+    253: "CAN Bad Length", 254: "CAN TX Dropped", 255: "CAN TX Overflow",
 }
 
 compstatus = {k: {"state": 0, "reason": "Unknown"} for k in components}
@@ -68,7 +63,7 @@ def status(data):
     # interface watches for these and applies special treatment (colours)
     statuses = {0: "OK", 1: "INIT", 2: "ERROR"}
     overall, comp, comp_state = data[:3]
-    if len(data) == 4:
+    if len(data) >= 4:
         comp_error = data[3]
     else:
         comp_error = 0
@@ -78,7 +73,16 @@ def status(data):
                                  components.get(comp, "Unknown"),
                                  statuses.get(comp_state, "Unknown"))
     if comp_error != 0:
-        string += " {})".format(component_errors.get(comp_error, "Unknown"))
+        string += " {}".format(component_errors.get(comp_error, "Unknown"))
+        if comp == 255 and len(data) == 8:
+            # TX queue overflow and dropped frame counts, see m3can.c
+            string += " {} overflows, {} dropped".format(
+                data[4] | (data[5] << 8), data[6] | (data[7] << 8))
+        elif comp == 255 and comp_error == 253 and len(data) == 7:
+            # Frame rejected by m3can_dispatch, see m3can_util.c
+            string += " ID 0x{:03x} length {}".format(
+                data[4] | (data[5] << 8), data[6])
+        string += ")"
     else:
         string += ")"
 
@@ -100,20 +104,29 @@ def status(data):
 @register_packet("m3fc", CAN_MSG_ID_M3FC_MISSION_STATE, "Mission State")
 def mission_state(data):
     # 5 bytes total. 4 bytes met, 1 byte can_state
-    met, can_state = struct.unpack("IB", bytes(data[:5]))
+    met, can_state = MISSION_STATE.unpack_from(bytes(data))
     states = ["Init", "Pad", "Ignition", "Powered Ascent", "Burnout",
               "Free Ascent", "Apogee", "Drogue Descent",
               "Release Main", "Main Descent", "Land", "Landed"]
     return "MET: {: 9.3f} s, State: {}".format(met/1000.0, states[can_state])
 
 
+@register_packet("m3fc", CAN_MSG_ID_M3FC_TIMESYNC, "Time Sync")
+def timesync(data):
+    # 4 bytes of M3FC time when sync frame `time_seq` was sent, then the
+    # sequence numbers of that frame and this one
+    time, time_seq, seq = TIMESYNC.unpack_from(bytes(data))
+    return "Sync {} sent at {:.4f} s".format(time_seq, time / 10000.0)
+
+
 @register_packet("m3fc", CAN_MSG_ID_M3FC_MOCK_ACCEL, "Mock Accelerometer")
 @register_packet("m3fc", CAN_MSG_ID_M3FC_ACCEL, "Acceleration")
 def accel(data):
-    # 6 bytes, 3 int16_ts for 3 accelerations
+    # 6 bytes, 3 int16_ts for 3 accelerations, then for M3FC's own frames
+    # 2 bytes of sample time
     # 3.9 MSB per milli-g
     factor = 3.9 / 1000.0 * 9.80665
-    accel1, accel2, accel3 = struct.unpack("hhh", bytes(data[0:6]))
+    accel1, accel2, accel3 = MOCK_ACCEL.unpack_from(bytes(data))
     accel1, accel2, accel3 = accel1*factor, accel2*factor, accel3*factor
     return "{: 3.1f} m/s/s {: 3.1f} m/s/s {: 3.1f} m/s/s".format(
         accel1, accel2, accel3)
@@ -124,7 +137,7 @@ def accel(data):
 def baro(data):
     # 8 bytes: 4 bytes of temperature in centidegrees celcius,
     # 4 bytes of pressure in Pascals
-    temperature, pressure = struct.unpack("ii", bytes(data))
+    temperature, pressure = BARO.unpack_from(bytes(data))
     return "Temperature: {: 4.1f}'C, Pressure: {: 6.0f} Pa".format(
         temperature / 100.0, pressure)
 
@@ -132,26 +145,26 @@ def baro(data):
 @register_packet("m3fc", CAN_MSG_ID_M3FC_SE_T_H, "State Estimate T,H")
 def se_t_h(data):
     # 8 bytes, 2 float32s
-    dt, h = struct.unpack("ff", bytes(data))
+    dt, h = SE_T_H.unpack_from(bytes(data))
     return "dt: {: 6.4f} s, altitude: {: 5.0f} m".format(dt, h)
 
 
 @register_packet("m3fc", CAN_MSG_ID_M3FC_SE_V_A, "State Estimate V,A")
 def se_v_a(data):
-    v, a = struct.unpack("ff", bytes(data))
+    v, a = SE_V_A.unpack_from(bytes(data))
     return "velocity: {: 6.1f} m/s, acceleration: {: 5.1f} m/s/s".format(v, a)
 
 
 @register_packet("m3fc", CAN_MSG_ID_M3FC_SE_VAR_H, "State Estimate var(H)")
 def se_var_h(data):
-    (var_h,) = struct.unpack("f", bytes(data[0:4]))
+    (var_h,) = SE_VAR_H.unpack_from(bytes(data))
     return "SD(altitude): {: 7.3f} m".format(sqrt(var_h))
 
 
 @register_packet("m3fc", CAN_MSG_ID_M3FC_SE_VAR_V_A,
                  "State Estimate var(V),var(A)")
 def se_var_v_var_a(data):
-    var_v, var_a = struct.unpack("ff", bytes(data))
+    var_v, var_a = SE_VAR_V_A.unpack_from(bytes(data))
     return ("SD(velocity): {: 6.3f} m/s, SD_acceleration: {: 5.3f} m/s/s"
             .format(sqrt(var_v), sqrt(var_a)))
 
@@ -199,26 +212,32 @@ def cfg_pyros(data):
                     p7u, p7t, p7c, p8u, p8t, p8c))
 
 
-@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_X, "Accel Cal X")
-@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_Y, "Accel Cal Y")
-@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_CAL_Z, "Accel Cal Z")
+@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_X, "Accel Cal X")
+@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_Y, "Accel Cal Y")
+@register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_ACCEL_Z, "Accel Cal Z")
 def cfg_accel_cal(data):
-    scale, offset = struct.unpack("<ff", bytes(data))
+    scale, offset = CFG_ACCEL.unpack_from(bytes(data))
     return "Scale {:.6f}g/LSB, Offset {:.3f}LSB".format(scale, offset)
 
 
 @register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_RADIO_FREQ, "Radio Freq")
 def cfg_radio_freq(data):
-    freq = struct.unpack("<I", bytes(data[:4]))[0]
+    (freq,) = CFG_RADIO_FREQ.unpack_from(bytes(data))
     return "{:.6f} MHz".format(freq/1e6)
 
 
 @register_packet("m3fc", CAN_MSG_ID_M3FC_CFG_CRC, "Config CRC")
 def cfg_crc(data):
-    crc = struct.unpack("<I", bytes(data[:4]))[0]
+    (crc,) = CFG_CRC.unpack_from(bytes(data))
     return hex(crc)
 
 
+@register_command("m3fc", "Request config", ["Request config"])
+def request_config(data):
+    # Sent again in full for a remote frame, otherwise only once it changes
+    return CAN_MSG_ID_M3FC_CFG_PROFILE, None
+
+
 @register_packet("m3fc", CAN_MSG_ID_M3FC_LOAD_CFG, "Load config")
 def load_config(data):
     return "Load config from flash"
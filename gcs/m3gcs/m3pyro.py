@@ -21,13 +21,15 @@ components = {
     2: "Self Test",
     3: "Continuity",
     4: "Firing",
+    255: "CAN",
 }
 
 component_errors = {
     0: "No Error",
     1: "ADC", 2: "Bad Channel", 3: "Discharge", 4: "Continuity", 5: "1A",
     6: "3A", 7: "Supply", 8: "EStop", 9: "Fire Type Unknown",
-    10: "Fire Supply Unknown", 11: "Fire Supply Fault", 12: "Fire Bad Msg"
+    10: "Fire Supply Unknown", 11: "Fire Supply Fault", 12: "Fire Bad Msg",
+    253: "CAN Bad Length", 254: "CAN TX Dropped", 255: "CAN TX Overflow",
 }
 
 compstatus = {k: {"state": 0, "reason": "Unknown"} for k in components}
@@ -39,7 +41,7 @@ def status(data):
     # interface watches for these and applies special treatment (colours)
     statuses = {0: "OK", 1: "INIT", 2: "ERROR"}
     overall, comp, comp_state = data[:3]
-    if len(data) == 4:
+    if len(data) >= 4:
         comp_error = data[3]
     else:
         comp_error = 0
@@ -49,7 +51,16 @@ def status(data):
                                  components.get(comp, "Unknown"),
                                  statuses.get(comp_state, "Unknown"))
     if comp_error != 0:
-        string += " {})".format(component_errors.get(comp_error, "Unknown"))
+        string += " {}".format(component_errors.get(comp_error, "Unknown"))
+        if comp == 255 and len(data) == 8:
+            # TX queue overflow and dropped frame counts, see m3can.c
+            string += " {} overflows, {} dropped".format(
+                data[4] | (data[5] << 8), data[6] | (data[7] << 8))
+        elif comp == 255 and comp_error == 253 and len(data) == 7:
+            # Frame rejected by m3can_dispatch, see m3can_util.c
+            string += " ID 0x{:03x} length {}".format(
+                data[4] | (data[5] << 8), data[6])
+        string += ")"
     else:
         string += ")"
 
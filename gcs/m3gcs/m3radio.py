@@ -25,6 +25,7 @@ components = {
     2: "Si4460",
     3: "GPS Antenna",
     4: "Packet Processor",
+    255: "CAN",
 }
 
 component_errors = {
@@ -32,7 +33,8 @@ component_errors = {
     1: "uBlox Checksum", 2: "uBlox Timeout", 3: "uBlox UART",
     4: "uBlox Config", 5: "uBlox Decode", 6: "uBlox Flight Mode",
     7: "uBlox NAK",
-    8: "Si4460 Config"
+    8: "Si4460 Config",
+    253: "CAN Bad Length", 254: "CAN TX Dropped", 255: "CAN TX Overflow",
 }
 
 compstatus = {k: {"state": 0, "reason": "Unknown"} for k in components}
@@ -46,7 +48,7 @@ def status(data):
     # interface watches for these and applies special treatment (colours)
     statuses = {0: "OK", 1: "INIT", 2: "ERROR"}
     overall, comp, comp_state = data[:3]
-    if len(data) == 4:
+    if len(data) >= 4:
         comp_error = data[3]
     else:
         comp_error = 0
@@ -56,7 +58,16 @@ def status(data):
                                  components.get(comp, "Unknown"),
                                  statuses.get(comp_state, "Unknown"))
     if comp_error != 0:
-        string += " {})".format(component_errors.get(comp_error, "Unknown"))
+        string += " {}".format(component_errors.get(comp_error, "Unknown"))
+        if comp == 255 and len(data) == 8:
+            # TX queue overflow and dropped frame counts, see m3can.c
+            string += " {} overflows, {} dropped".format(
+                data[4] | (data[5] << 8), data[6] | (data[7] << 8))
+        elif comp == 255 and comp_error == 253 and len(data) == 7:
+            # Frame rejected by m3can_dispatch, see m3can_util.c
+            string += " ID 0x{:03x} length {}".format(
+                data[4] | (data[5] << 8), data[6])
+        string += ")"
     else:
         string += ")"
 
@@ -1,12 +1,17 @@
 registered_packets = {}
 registered_commands = {}
 
+# Every registered packet by CAN ID, as (parent, (name, processor)), so each
+# received frame is one dict lookup
+packet_processors = {}
+
 
 def register_packet(parent, msg_id, name):
     def wrap(f):
         if parent not in registered_packets:
             registered_packets[parent] = {}
         registered_packets[parent][msg_id] = (name, f)
+        packet_processors.setdefault(msg_id, (parent, (name, f)))
         return f
     return wrap
 
@@ -0,0 +1,77 @@
+from .packets import register_packet
+from .m3can_msgs import CAN_ID_M3FC, CAN_ID_M3RADIO, CAN_ID_M3DL, \
+    CAN_MSG_ID_M3FC_PROFILE, CAN_MSG_ID_M3RADIO_PROFILE, \
+    CAN_MSG_ID_M3DL_PROFILE
+import struct
+
+
+# All boards run from a 168MHz core clock
+CPU_MHZ = 168.0
+
+# Probe IDs from shared/m3prof/m3prof.h
+probes = {
+    CAN_ID_M3FC: {
+        0: "SE get_state",
+        1: "SE fuse",
+        2: "ADXL345 batch",
+        3: "MS5611 sample",
+    },
+    CAN_ID_M3RADIO: {
+        0: "Router fillbuf",
+    },
+    CAN_ID_M3DL: {
+        0: "Log packet",
+        1: "SD write",
+    },
+}
+
+hist_bins = ["<1.5us", "<12us", "<98us", "<780us", ">=780us"]
+
+# Latest statistics for each board's probes, built up from both frame types
+stats = {board: {} for board in probes}
+
+
+def decode(board, data):
+    # See shared/m3prof/m3prof.c for the frame layout
+    probe = data[0] >> 1
+    s = stats[board].setdefault(probe, {})
+
+    if data[0] & 1 == 0:
+        shift = data[1]
+        t_min, t_mean, t_max = struct.unpack("<HHH", bytes(data[2:8]))
+        s['min'] = (t_min << shift) / CPU_MHZ
+        s['mean'] = (t_mean << shift) / CPU_MHZ
+        s['max'] = (t_max << shift) / CPU_MHZ
+    else:
+        s['count'] = data[1] | (data[2] << 8)
+        s['hist'] = [x * 100.0 / 255.0 for x in data[3:]]
+
+    lines = []
+    for pid in sorted(stats[board]):
+        s = stats[board][pid]
+        parts = [probes[board].get(pid, "Probe {}".format(pid)) + ":"]
+        if 'mean' in s:
+            parts.append("{:.1f}/{:.1f}/{:.1f}us".format(
+                s['min'], s['mean'], s['max']))
+        if 'count' in s:
+            # Reports are sent once a second
+            parts.append("x{}/s".format(s['count']))
+            parts += ["{}:{:.0f}%".format(b, h)
+                      for b, h in zip(hist_bins, s['hist']) if h > 0]
+        lines.append(" ".join(parts))
+    return "\n".join(lines)
+
+
+@register_packet("Profile", CAN_MSG_ID_M3FC_PROFILE, "M3FC")
+def m3fc_profile(data):
+    return decode(CAN_ID_M3FC, data)
+
+
+@register_packet("Profile", CAN_MSG_ID_M3RADIO_PROFILE, "M3RADIO")
+def m3radio_profile(data):
+    return decode(CAN_ID_M3RADIO, data)
+
+
+@register_packet("Profile", CAN_MSG_ID_M3DL_PROFILE, "M3DL")
+def m3dl_profile(data):
+    return decode(CAN_ID_M3DL, data)
@@ -0,0 +1,73 @@
+from .packets import register_packet
+import struct
+
+
+def msg_id(x):
+    return x << 5
+
+CAN_ID_M3FC = 1
+CAN_ID_M3PSU = 2
+CAN_ID_M3PYRO = 3
+CAN_ID_M3RADIO = 4
+CAN_ID_M3DL = 6
+
+CAN_MSG_ID_M3FC_THREAD_STATS = CAN_ID_M3FC | msg_id(61)
+CAN_MSG_ID_M3PSU_THREAD_STATS = CAN_ID_M3PSU | msg_id(61)
+CAN_MSG_ID_M3PYRO_THREAD_STATS = CAN_ID_M3PYRO | msg_id(61)
+CAN_MSG_ID_M3RADIO_THREAD_STATS = CAN_ID_M3RADIO | msg_id(61)
+CAN_MSG_ID_M3DL_THREAD_STATS = CAN_ID_M3DL | msg_id(61)
+
+# Latest figures for each board's threads, built up from both frame types
+threads = {}
+
+
+def decode(board, data):
+    # See shared/m3monitor/m3monitor.c for the frame layout
+    idx = data[0] >> 1
+    t = threads.setdefault(board, {}).setdefault(idx, {})
+
+    if data[0] & 1 == 0:
+        cpu, used, size = struct.unpack("<HHH", bytes(data[1:7]))
+        t['cpu'] = cpu / 100.0
+        t['used'] = used
+        t['size'] = size
+        t['prio'] = data[7]
+    else:
+        t['name'] = bytes(data[1:]).split(b"\x00")[0].decode(errors="replace")
+
+    lines = []
+    for idx in sorted(threads[board]):
+        t = threads[board][idx]
+        line = "{}:".format(t.get('name', "thread {}".format(idx)))
+        if 'cpu' in t:
+            line += " {:.1f}% CPU, stack {}/{}".format(
+                t['cpu'], t['used'], t['size'])
+            if t['size'] > 0 and t['used'] * 10 > t['size'] * 9:
+                line += " (low)"
+        lines.append(line)
+    return "\n".join(lines)
+
+
+@register_packet("Threads", CAN_MSG_ID_M3FC_THREAD_STATS, "M3FC")
+def m3fc_threads(data):
+    return decode(CAN_ID_M3FC, data)
+
+
+@register_packet("Threads", CAN_MSG_ID_M3PSU_THREAD_STATS, "M3PSU")
+def m3psu_threads(data):
+    return decode(CAN_ID_M3PSU, data)
+
+
+@register_packet("Threads", CAN_MSG_ID_M3PYRO_THREAD_STATS, "M3PYRO")
+def m3pyro_threads(data):
+    return decode(CAN_ID_M3PYRO, data)
+
+
+@register_packet("Threads", CAN_MSG_ID_M3RADIO_THREAD_STATS, "M3RADIO")
+def m3radio_threads(data):
+    return decode(CAN_ID_M3RADIO, data)
+
+
+@register_packet("Threads", CAN_MSG_ID_M3DL_THREAD_STATS, "M3DL")
+def m3dl_threads(data):
+    return decode(CAN_ID_M3DL, data)
@@ -1,35 +1,44 @@
 #!/usr/bin/env python3
 
-import sys
+import argparse
 from m3gcs.usbcan import CANFrame
 from m3gcs.command_processor import find_processor
+from m3gcs.logformat import read_frames
 
-if len(sys.argv) != 2:
-    print("Usage: {} <logfile.bin>".format(sys.argv[0]))
-    sys.exit(1)
+parser = argparse.ArgumentParser(description="Print a datalogger log")
+parser.add_argument("logfile", help="log_xxxxx.bin to print")
+parser.add_argument("-s", "--start", type=float,
+                    help="only frames from this many seconds")
+parser.add_argument("-e", "--end", type=float,
+                    help="only frames up to this many seconds")
+parser.add_argument("-i", "--id", type=lambda x: int(x, 0), action="append",
+                    dest="ids", metavar="ID",
+                    help="only frames with this ID, may be repeated")
+args = parser.parse_args()
 
-with open(sys.argv[1], 'rb') as f:
-    while True:
-        packet = f.read(16)
-        if len(packet) != 16:
-            break
+# Logs with an index are only read where such frames may be
+start = None if args.start is None else round(args.start * 10000)
+end = None if args.end is None else round(args.end * 10000)
+ids = None if args.ids is None else set(args.ids)
 
-        frame = CANFrame.from_buf(packet[:12])
+for sid, rtr, dlc, data, timestamp in read_frames(args.logfile, start, end,
+                                                  ids):
+    frame = CANFrame(sid, rtr, dlc, data)
 
-        # Systicks since datalogger startup, 1/10000 s
-        timestamp = (packet[12] | (packet[13] << 8) | (packet[14] << 16) |
-                     (packet[15] << 24))
-        timestamp /= 10000.0
+    # When the data was produced, in systicks of the M3FC time master,
+    # 1/10000 s. Frames logged before the datalogger synchronised to
+    # M3FC are in its own systicks since startup.
+    timestamp /= 10000.0
 
-        # See if we have a processor for this type of packet
-        result = find_processor(frame.sid)
-        if result is None:
-            message = "No handler for frame: " + str(frame)
-            source = ""
-        else:
-            parent, (processor_name, processor_func) = result
-            message = processor_func(frame.data)
-            source = " {}: {}".format(parent, processor_name)
+    # See if we have a processor for this type of packet
+    result = find_processor(frame.sid)
+    if result is None:
+        message = "No handler for frame: " + str(frame)
+        source = ""
+    else:
+        parent, (processor_name, processor_func) = result
+        message = processor_func(frame.data)
+        source = " {}: {}".format(parent, processor_name)
 
-        string = "[{:010.4f}{}] {}".format(timestamp, source, message)
-        print(string.replace("\n", " "))
+    string = "[{:010.4f}{}] {}".format(timestamp, source, message)
+    print(string.replace("\n", " "))
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""
+Cut a datalogger log file back to its last valid block.
+
+M3DL preallocates its log files and only truncates them to what it wrote
+when it closes them. After a power loss the file is still the preallocated
+size, and past the last block written holds whatever was on the card
+before: usually zeros, sometimes an older log.
+
+Blocks are checked from the start of the file, and the file is truncated
+at the first one that isn't the next block of this file with a good CRC,
+see m3dl/firmware/logformat.h. In version 1 logs, which have no blocks,
+it is truncated at the first sector holding anything but logged frames: a
+standard ID from a board, RTR 0 or 1, a length up to 8 with the unused
+data bytes zero, and a timestamp within a minute of the frame before.
+"""
+
+import os
+import sys
+import struct
+import argparse
+
+from m3gcs.logformat import LogReader, LogError, log_version, \
+    BLOCK_SIZE, BLOCK_DATA
+
+SECTOR = 512
+PACKET = 16
+
+# Timestamps are in 1/10000 s
+MAX_JUMP = 60 * 10000
+
+
+def sector_ok(sector, last_ts):
+    """
+    Check one sector's packets, given the timestamp of the packet before.
+    Returns whether they are all valid, and the last timestamp.
+    """
+    if len(sector) == 0 or len(sector) % PACKET != 0:
+        return False, last_ts
+    for sid, rtr, dlc, data, ts in struct.iter_unpack("<HBB8sI", sector):
+        if sid >= 0x800 or sid & 0x1F == 0 or rtr > 1 or dlc > 8:
+            return False, last_ts
+        if any(data[dlc:]):
+            return False, last_ts
+        if last_ts is not None and abs(ts - last_ts) > MAX_JUMP:
+            return False, last_ts
+        last_ts = ts
+    return True, last_ts
+
+
+def valid_length_v1(f):
+    """Length of the valid run of sectors at the start of `f`."""
+    length = 0
+    last_ts = None
+    while True:
+        sector = f.read(SECTOR)
+        ok, last_ts = sector_ok(sector, last_ts)
+        if not ok:
+            return length
+        length += len(sector)
+
+
+def valid_length(f):
+    """Length of the valid run of blocks at the start of `f`, and the
+    number of frames in it."""
+    reader = LogReader()
+    length = 0
+    frames = 0
+    while True:
+        block = f.read(BLOCK_SIZE)
+        try:
+            btype, _, _, records = reader.check_block(block)
+        except LogError:
+            return length, frames
+        if btype == BLOCK_DATA:
+            frames += records
+        length += BLOCK_SIZE
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("logfile", nargs="+", help="log_xxxxx.bin to recover")
+    parser.add_argument("-n", "--dry-run", action="store_true",
+                        help="only report what would be truncated")
+    args = parser.parse_args()
+
+    for path in args.logfile:
+        size = os.path.getsize(path)
+        version = log_version(path)
+        with open(path, "r+b" if not args.dry_run else "rb") as f:
+            if version == 1:
+                length = valid_length_v1(f)
+                frames = length // PACKET
+            else:
+                length, frames = valid_length(f)
+            if length < size and not args.dry_run:
+                f.truncate(length)
+        print("{}: {} frames in {} bytes, {}".format(
+            path, frames, length,
+            "complete" if length == size else
+            "{} bytes {}".format(size - length, "to cut" if args.dry_run
+                                 else "cut")))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
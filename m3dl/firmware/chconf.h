@@ -414,7 +414,8 @@
  * @details User fields added to the end of the @p thread_t structure.
  */
 #define CH_CFG_THREAD_EXTRA_FIELDS                                          \
-  /* Add threads custom fields here.*/
+  /* Working area size, for m3monitor.*/                                    \
+  size_t wa_size;
 
 /**
  * @brief   Threads initialization hook.
@@ -424,7 +425,10 @@
  *          the threads creation APIs.
  */
 #define CH_CFG_THREAD_INIT_HOOK(tp) {                                       \
-  /* Add threads initialization code here.*/                                \
+  /* Record the working area size for m3monitor. The thread_t is at the     \
+     bottom of the working area and the initial context at the top.*/       \
+  (tp)->wa_size = (size_t)((uint8_t *)(tp)->p_ctx.r13 +                     \
+                           sizeof(struct port_intctx) - (uint8_t *)(tp));   \
 }
 
 /**
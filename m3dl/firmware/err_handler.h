@@ -15,6 +15,7 @@
 #define M3DL_ERROR_SD_CARD_WRITE            0x07
 #define M3DL_ERROR_LOGGING_WRITE            0x08
 #define M3DL_ERROR_SD_CARD_FULL             0x09
+#define M3DL_ERROR_LOGGING_OVERFLOW         0x0A
 
 #define M3DL_ERROR_TEMP1_INVALID            0x10
 #define M3DL_ERROR_TEMP2_INVALID            0x11
@@ -65,6 +66,10 @@ void err(uint8_t arg);
  *
  *  0x09 = microsd_write - SD card full [microsd.c]
  *
+ *  0x0A = log_can - Packets dropped as the
+ *         ring was full, with the total
+ *         dropped as detail [logging.c]
+ *
  *  0x10
  *   to  = log_temp - Invalid temperature
  *  0x18   data [LTC2983.c]
@@ -0,0 +1,636 @@
+/*
+ * M3DL log file format encoder and decoder
+ * See logformat.h for the layout.
+ */
+
+#include <string.h>
+
+#include "logformat.h"
+
+#define LOGFORMAT_DATA_SIZE     (LOGFORMAT_BLOCK_SIZE - LOGFORMAT_HEADER_SIZE)
+#define LOGFORMAT_HEAD_EXT      (0x0800)
+#define LOGFORMAT_HEAD_TIME_ESC (15)
+#define LOGFORMAT_EXT_RTR       (0x80)
+#define LOGFORMAT_EXT_LEN_MASK  (0x0F)
+
+/* CRC-32 table for polynomial 0xEDB88320, as zlib */
+static const uint32_t logformat_crc_table[256] = {
+    0x00000000UL, 0x77073096UL, 0xEE0E612CUL, 0x990951BAUL,
+    0x076DC419UL, 0x706AF48FUL, 0xE963A535UL, 0x9E6495A3UL,
+    0x0EDB8832UL, 0x79DCB8A4UL, 0xE0D5E91EUL, 0x97D2D988UL,
+    0x09B64C2BUL, 0x7EB17CBDUL, 0xE7B82D07UL, 0x90BF1D91UL,
+    0x1DB71064UL, 0x6AB020F2UL, 0xF3B97148UL, 0x84BE41DEUL,
+    0x1ADAD47DUL, 0x6DDDE4EBUL, 0xF4D4B551UL, 0x83D385C7UL,
+    0x136C9856UL, 0x646BA8C0UL, 0xFD62F97AUL, 0x8A65C9ECUL,
+    0x14015C4FUL, 0x63066CD9UL, 0xFA0F3D63UL, 0x8D080DF5UL,
+    0x3B6E20C8UL, 0x4C69105EUL, 0xD56041E4UL, 0xA2677172UL,
+    0x3C03E4D1UL, 0x4B04D447UL, 0xD20D85FDUL, 0xA50AB56BUL,
+    0x35B5A8FAUL, 0x42B2986CUL, 0xDBBBC9D6UL, 0xACBCF940UL,
+    0x32D86CE3UL, 0x45DF5C75UL, 0xDCD60DCFUL, 0xABD13D59UL,
+    0x26D930ACUL, 0x51DE003AUL, 0xC8D75180UL, 0xBFD06116UL,
+    0x21B4F4B5UL, 0x56B3C423UL, 0xCFBA9599UL, 0xB8BDA50FUL,
+    0x2802B89EUL, 0x5F058808UL, 0xC60CD9B2UL, 0xB10BE924UL,
+    0x2F6F7C87UL, 0x58684C11UL, 0xC1611DABUL, 0xB6662D3DUL,
+    0x76DC4190UL, 0x01DB7106UL, 0x98D220BCUL, 0xEFD5102AUL,
+    0x71B18589UL, 0x06B6B51FUL, 0x9FBFE4A5UL, 0xE8B8D433UL,
+    0x7807C9A2UL, 0x0F00F934UL, 0x9609A88EUL, 0xE10E9818UL,
+    0x7F6A0DBBUL, 0x086D3D2DUL, 0x91646C97UL, 0xE6635C01UL,
+    0x6B6B51F4UL, 0x1C6C6162UL, 0x856530D8UL, 0xF262004EUL,
+    0x6C0695EDUL, 0x1B01A57BUL, 0x8208F4C1UL, 0xF50FC457UL,
+    0x65B0D9C6UL, 0x12B7E950UL, 0x8BBEB8EAUL, 0xFCB9887CUL,
+    0x62DD1DDFUL, 0x15DA2D49UL, 0x8CD37CF3UL, 0xFBD44C65UL,
+    0x4DB26158UL, 0x3AB551CEUL, 0xA3BC0074UL, 0xD4BB30E2UL,
+    0x4ADFA541UL, 0x3DD895D7UL, 0xA4D1C46DUL, 0xD3D6F4FBUL,
+    0x4369E96AUL, 0x346ED9FCUL, 0xAD678846UL, 0xDA60B8D0UL,
+    0x44042D73UL, 0x33031DE5UL, 0xAA0A4C5FUL, 0xDD0D7CC9UL,
+    0x5005713CUL, 0x270241AAUL, 0xBE0B1010UL, 0xC90C2086UL,
+    0x5768B525UL, 0x206F85B3UL, 0xB966D409UL, 0xCE61E49FUL,
+    0x5EDEF90EUL, 0x29D9C998UL, 0xB0D09822UL, 0xC7D7A8B4UL,
+    0x59B33D17UL, 0x2EB40D81UL, 0xB7BD5C3BUL, 0xC0BA6CADUL,
+    0xEDB88320UL, 0x9ABFB3B6UL, 0x03B6E20CUL, 0x74B1D29AUL,
+    0xEAD54739UL, 0x9DD277AFUL, 0x04DB2615UL, 0x73DC1683UL,
+    0xE3630B12UL, 0x94643B84UL, 0x0D6D6A3EUL, 0x7A6A5AA8UL,
+    0xE40ECF0BUL, 0x9309FF9DUL, 0x0A00AE27UL, 0x7D079EB1UL,
+    0xF00F9344UL, 0x8708A3D2UL, 0x1E01F268UL, 0x6906C2FEUL,
+    0xF762575DUL, 0x806567CBUL, 0x196C3671UL, 0x6E6B06E7UL,
+    0xFED41B76UL, 0x89D32BE0UL, 0x10DA7A5AUL, 0x67DD4ACCUL,
+    0xF9B9DF6FUL, 0x8EBEEFF9UL, 0x17B7BE43UL, 0x60B08ED5UL,
+    0xD6D6A3E8UL, 0xA1D1937EUL, 0x38D8C2C4UL, 0x4FDFF252UL,
+    0xD1BB67F1UL, 0xA6BC5767UL, 0x3FB506DDUL, 0x48B2364BUL,
+    0xD80D2BDAUL, 0xAF0A1B4CUL, 0x36034AF6UL, 0x41047A60UL,
+    0xDF60EFC3UL, 0xA867DF55UL, 0x316E8EEFUL, 0x4669BE79UL,
+    0xCB61B38CUL, 0xBC66831AUL, 0x256FD2A0UL, 0x5268E236UL,
+    0xCC0C7795UL, 0xBB0B4703UL, 0x220216B9UL, 0x5505262FUL,
+    0xC5BA3BBEUL, 0xB2BD0B28UL, 0x2BB45A92UL, 0x5CB36A04UL,
+    0xC2D7FFA7UL, 0xB5D0CF31UL, 0x2CD99E8BUL, 0x5BDEAE1DUL,
+    0x9B64C2B0UL, 0xEC63F226UL, 0x756AA39CUL, 0x026D930AUL,
+    0x9C0906A9UL, 0xEB0E363FUL, 0x72076785UL, 0x05005713UL,
+    0x95BF4A82UL, 0xE2B87A14UL, 0x7BB12BAEUL, 0x0CB61B38UL,
+    0x92D28E9BUL, 0xE5D5BE0DUL, 0x7CDCEFB7UL, 0x0BDBDF21UL,
+    0x86D3D2D4UL, 0xF1D4E242UL, 0x68DDB3F8UL, 0x1FDA836EUL,
+    0x81BE16CDUL, 0xF6B9265BUL, 0x6FB077E1UL, 0x18B74777UL,
+    0x88085AE6UL, 0xFF0F6A70UL, 0x66063BCAUL, 0x11010B5CUL,
+    0x8F659EFFUL, 0xF862AE69UL, 0x616BFFD3UL, 0x166CCF45UL,
+    0xA00AE278UL, 0xD70DD2EEUL, 0x4E048354UL, 0x3903B3C2UL,
+    0xA7672661UL, 0xD06016F7UL, 0x4969474DUL, 0x3E6E77DBUL,
+    0xAED16A4AUL, 0xD9D65ADCUL, 0x40DF0B66UL, 0x37D83BF0UL,
+    0xA9BCAE53UL, 0xDEBB9EC5UL, 0x47B2CF7FUL, 0x30B5FFE9UL,
+    0xBDBDF21CUL, 0xCABAC28AUL, 0x53B39330UL, 0x24B4A3A6UL,
+    0xBAD03605UL, 0xCDD70693UL, 0x54DE5729UL, 0x23D967BFUL,
+    0xB3667A2EUL, 0xC4614AB8UL, 0x5D681B02UL, 0x2A6F2B94UL,
+    0xB40BBE37UL, 0xC30C8EA1UL, 0x5A05DF1BUL, 0x2D02EF8DUL,
+};
+
+uint32_t logformat_crc32(uint32_t crc, const uint8_t* data, size_t n)
+{
+    crc = ~crc;
+    while(n--) {
+        crc = logformat_crc_table[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static inline uint32_t logformat_zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t logformat_unzigzag(uint32_t z)
+{
+    return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+static inline uint8_t* logformat_put_varint(uint8_t* p, uint32_t v)
+{
+    while(v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/* Read a varint from <p>, not past <end>. Returns NULL if it runs over. */
+static inline const uint8_t* logformat_get_varint(const uint8_t* p,
+                                                  const uint8_t* end,
+                                                  uint32_t* v)
+{
+    uint32_t out = 0;
+    int shift;
+    for(shift=0; shift<35 && p<end; shift+=7) {
+        uint8_t b = *p++;
+        out |= (uint32_t)(b & 0x7F) << shift;
+        if(!(b & 0x80)) {
+            *v = out;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+/* Bytes in a field of width code <code> */
+static inline int logformat_field_bytes(uint16_t code)
+{
+    return 1 << ((code & 3) - 1);
+}
+
+static inline uint32_t logformat_get_le(const uint8_t* p, int n)
+{
+    uint32_t v = 0;
+    int i;
+    for(i=n-1; i>=0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void logformat_put_le(uint8_t* p, int n, uint32_t v)
+{
+    int i;
+    for(i=0; i<n; i++) {
+        p[i] = (uint8_t)v;
+        v >>= 8;
+    }
+}
+
+/* Difference of an <n> byte field from <prev>, sign extended */
+static inline int32_t logformat_field_diff(uint32_t cur, uint32_t prev, int n)
+{
+    int shift = 32 - 8 * n;
+    return (int32_t)((cur - prev) << shift) >> shift;
+}
+
+void logformat_begin(struct logformat_encoder* enc, uint8_t* block,
+                     uint8_t* ids)
+{
+    enc->block = block;
+    enc->ids = ids;
+    enc->length = 0;
+    enc->records = 0;
+    enc->valid = 0;
+    if(ids != NULL) {
+        memset(ids, 0, LOGFORMAT_ID_BYTES);
+    }
+}
+
+bool logformat_add(struct logformat_encoder* enc, uint16_t sid, bool rtr,
+                   uint8_t len, const uint8_t* data, uint32_t timestamp)
+{
+    const struct logformat_schema_entry* e = NULL;
+    struct logformat_delta* d = NULL;
+    uint8_t* p;
+    uint8_t* q;
+    uint32_t predicted, z, bit = 0;
+    bool plain, coded = false;
+    uint16_t head;
+
+    if(LOGFORMAT_DATA_SIZE - enc->length < LOGFORMAT_RECORD_MAX) {
+        return false;
+    }
+
+    sid &= 0x7FF;
+    if(len > 8) {
+        len = 8;
+    }
+    if(logformat_schema_index[sid] != 0) {
+        e = &logformat_schema[logformat_schema_index[sid] - 1];
+    }
+    plain = e != NULL && !rtr && len == e->length;
+    if(plain && e->delta != 0) {
+        d = &enc->delta[e->delta - 1];
+        bit = 1UL << (e->delta - 1);
+        coded = (enc->valid & bit) != 0;
+    }
+
+    if(enc->records == 0) {
+        enc->first = timestamp;
+        enc->timestamp = timestamp;
+        enc->min = timestamp;
+        enc->max = timestamp;
+    }
+    predicted = coded ? d->timestamp + d->interval : enc->timestamp;
+    z = logformat_zigzag((int32_t)(timestamp - predicted));
+
+    p = enc->block + LOGFORMAT_HEADER_SIZE + enc->length;
+    q = p + 2;
+    head = sid | (plain ? 0 : LOGFORMAT_HEAD_EXT);
+    if(z < LOGFORMAT_HEAD_TIME_ESC) {
+        head |= z << 12;
+    } else {
+        head |= LOGFORMAT_HEAD_TIME_ESC << 12;
+    }
+    p[0] = (uint8_t)head;
+    p[1] = (uint8_t)(head >> 8);
+    if(!plain) {
+        *q++ = (rtr ? LOGFORMAT_EXT_RTR : 0) | len;
+    }
+    if(z >= LOGFORMAT_HEAD_TIME_ESC) {
+        q = logformat_put_varint(q, z);
+    }
+
+    if(coded) {
+        uint16_t f;
+        const uint8_t* cur = data;
+        const uint8_t* prev = d->data;
+        for(f=e->fields; f!=LOGFORMAT_FIELD_END; f>>=2) {
+            int n = logformat_field_bytes(f);
+            int32_t diff = logformat_field_diff(logformat_get_le(cur, n),
+                                                logformat_get_le(prev, n), n);
+            q = logformat_put_varint(q, logformat_zigzag(diff));
+            cur += n;
+            prev += n;
+        }
+    } else if(!rtr) {
+        memcpy(q, data, len);
+        q += len;
+    }
+
+    if(d != NULL) {
+        d->interval = coded ? timestamp - d->timestamp : 0;
+        d->timestamp = timestamp;
+        memcpy(d->data, data, len);
+        enc->valid |= bit;
+    }
+
+    if(timestamp < enc->min) {
+        enc->min = timestamp;
+    } else if(timestamp > enc->max) {
+        enc->max = timestamp;
+    }
+    if(enc->ids != NULL) {
+        enc->ids[sid / 8] |= 1 << (sid % 8);
+    }
+
+    enc->timestamp = timestamp;
+    enc->length += q - p;
+    enc->records++;
+    return true;
+}
+
+void logformat_finish(struct logformat_encoder* enc)
+{
+    struct logformat_header h = {
+        .magic = LOGFORMAT_MAGIC, .version = LOGFORMAT_VERSION,
+        .type = LOGFORMAT_BLOCK_DATA, .length = enc->length,
+        .timestamp = enc->first, .min_timestamp = enc->min,
+        .max_timestamp = enc->max, .records = enc->records,
+    };
+    memcpy(enc->block, &h, sizeof(h));
+}
+
+void logformat_schema_block(uint8_t* block)
+{
+    uint8_t* p = block + LOGFORMAT_HEADER_SIZE;
+    uint16_t i;
+
+    for(i=0; i<logformat_schema_len; i++) {
+        const struct logformat_schema_entry* e = &logformat_schema[i];
+        logformat_put_le(p, 2, e->sid);
+        p[2] = e->length;
+        logformat_put_le(p + 3, 2, e->fields);
+        p += LOGFORMAT_SCHEMA_ENTRY_SIZE;
+    }
+
+    struct logformat_header h = {
+        .magic = LOGFORMAT_MAGIC, .version = LOGFORMAT_VERSION,
+        .type = LOGFORMAT_BLOCK_SCHEMA,
+        .length = logformat_schema_len * LOGFORMAT_SCHEMA_ENTRY_SIZE,
+        .records = logformat_schema_len,
+    };
+    memcpy(block, &h, sizeof(h));
+}
+
+void logformat_seal(uint8_t* block, uint32_t session, uint32_t sequence)
+{
+    struct logformat_header* h = (struct logformat_header*)block;
+    uint16_t length = h->length;
+
+    memset(block + LOGFORMAT_HEADER_SIZE + length, 0,
+           LOGFORMAT_DATA_SIZE - length);
+    h->session = session;
+    h->sequence = sequence;
+    h->crc = 0;
+    h->crc = logformat_crc32(0, block, LOGFORMAT_BLOCK_SIZE);
+}
+
+void logformat_index_init(struct logformat_index* idx)
+{
+    memset(idx, 0, sizeof(*idx));
+    idx->file_min = UINT32_MAX;
+    memset(idx->first, 0xFF, sizeof(idx->first));
+    memset(idx->last, 0xFF, sizeof(idx->last));
+}
+
+bool logformat_index_add(struct logformat_index* idx, const uint8_t* block,
+                         const uint8_t* ids)
+{
+    const struct logformat_header* h = (const struct logformat_header*)block;
+    int i;
+
+    idx->times[idx->blocks][0] = h->min_timestamp;
+    idx->times[idx->blocks][1] = h->max_timestamp;
+    idx->blocks++;
+    if(h->records > 0) {
+        if(h->min_timestamp < idx->file_min) {
+            idx->file_min = h->min_timestamp;
+        }
+        if(h->max_timestamp > idx->file_max) {
+            idx->file_max = h->max_timestamp;
+        }
+    }
+    for(i=0; i<LOGFORMAT_ID_BYTES; i++) {
+        idx->ids[i] |= ids[i];
+    }
+    return idx->blocks == LOGFORMAT_INDEX_BLOCKS;
+}
+
+/* Fill in an index or footer block for the current region, returning the
+ * end of what was written */
+static uint8_t* logformat_index_body(struct logformat_index* idx,
+                                     uint8_t* block)
+{
+    struct logformat_index_header ih = {
+        .file_min = idx->file_min, .file_max = idx->file_max,
+        .region = idx->region, .blocks = idx->blocks,
+    };
+    uint8_t* p = block + LOGFORMAT_HEADER_SIZE;
+    int i;
+
+    memcpy(p, &ih, sizeof(ih));
+    p += sizeof(ih);
+    memcpy(p, idx->times, idx->blocks * sizeof(idx->times[0]));
+    p += idx->blocks * sizeof(idx->times[0]);
+    memcpy(p, idx->ids, LOGFORMAT_ID_BYTES);
+    p += LOGFORMAT_ID_BYTES;
+
+    /* Note the region against each ID in it */
+    for(i=0; i<LOGFORMAT_ID_BYTES; i++) {
+        uint8_t bits = idx->ids[i];
+        while(bits) {
+            int b = __builtin_ctz(bits);
+            uint8_t entry = logformat_schema_index[i * 8 + b];
+            if(idx->first[entry] == LOGFORMAT_NO_REGION) {
+                idx->first[entry] = idx->region;
+            }
+            idx->last[entry] = idx->region;
+            bits &= bits - 1;
+        }
+    }
+    return p;
+}
+
+static void logformat_index_header(uint8_t* block, uint8_t type,
+                                   uint8_t* end)
+{
+    struct logformat_header h = {
+        .magic = LOGFORMAT_MAGIC, .version = LOGFORMAT_VERSION,
+        .type = type, .length = end - block - LOGFORMAT_HEADER_SIZE,
+    };
+    memcpy(block, &h, sizeof(h));
+}
+
+void logformat_index_block(struct logformat_index* idx, uint8_t* block)
+{
+    uint8_t* end = logformat_index_body(idx, block);
+    logformat_index_header(block, LOGFORMAT_BLOCK_INDEX, end);
+    idx->region++;
+    idx->blocks = 0;
+    memset(idx->ids, 0, sizeof(idx->ids));
+}
+
+void logformat_footer_block(struct logformat_index* idx, uint8_t* block)
+{
+    struct logformat_index_header* ih =
+        (struct logformat_index_header*)(block + LOGFORMAT_HEADER_SIZE);
+    uint8_t* end = logformat_index_body(idx, block);
+    uint16_t n = 0;
+    int i;
+
+    for(i=0; i<256; i++) {
+        struct logformat_id_regions r;
+        if(idx->first[i] == LOGFORMAT_NO_REGION) {
+            continue;
+        }
+        r.sid = i == 0 ? LOGFORMAT_OTHER_IDS : logformat_schema[i - 1].sid;
+        r.first = idx->first[i];
+        r.last = idx->last[i];
+        memcpy(end, &r, sizeof(r));
+        end += sizeof(r);
+        n++;
+    }
+    ih->regions = idx->region + 1;
+    ih->ids = n;
+    logformat_index_header(block, LOGFORMAT_BLOCK_FOOTER, end);
+}
+
+int logformat_read_index(const uint8_t* block,
+                         struct logformat_index_info* info)
+{
+    const struct logformat_header* h = (const struct logformat_header*)block;
+    const uint8_t* p = block + LOGFORMAT_HEADER_SIZE;
+    size_t n;
+
+    if(h->length < sizeof(info->h)) {
+        return LOGFORMAT_BAD_RECORD;
+    }
+    memcpy(&info->h, p, sizeof(info->h));
+    if(h->type != LOGFORMAT_BLOCK_FOOTER) {
+        info->h.regions = 0;
+        info->h.ids = 0;
+    }
+    if(info->h.blocks > LOGFORMAT_INDEX_BLOCKS || info->h.ids > 256) {
+        return LOGFORMAT_BAD_RECORD;
+    }
+    n = sizeof(info->h) + info->h.blocks * sizeof(info->times[0]) +
+        LOGFORMAT_ID_BYTES + info->h.ids * sizeof(info->regions[0]);
+    if(h->length != n) {
+        return LOGFORMAT_BAD_RECORD;
+    }
+    p += sizeof(info->h);
+    memcpy(info->times, p, info->h.blocks * sizeof(info->times[0]));
+    p += info->h.blocks * sizeof(info->times[0]);
+    memcpy(info->ids, p, LOGFORMAT_ID_BYTES);
+    p += LOGFORMAT_ID_BYTES;
+    memcpy(info->regions, p, info->h.ids * sizeof(info->regions[0]));
+    return LOGFORMAT_OK;
+}
+
+void logformat_decoder_init(struct logformat_decoder* dec)
+{
+    memset(dec, 0, sizeof(*dec));
+}
+
+static int logformat_decode_schema(struct logformat_decoder* dec,
+                                   const struct logformat_header* h,
+                                   const uint8_t* p)
+{
+    uint16_t i;
+
+    if(h->records * LOGFORMAT_SCHEMA_ENTRY_SIZE != h->length) {
+        return LOGFORMAT_BAD_RECORD;
+    }
+    memset(dec->length, 0xFF, sizeof(dec->length));
+    memset(dec->fields, 0, sizeof(dec->fields));
+    for(i=0; i<h->records; i++) {
+        uint16_t sid = logformat_get_le(p, 2);
+        uint16_t fields = logformat_get_le(p + 3, 2);
+        uint16_t f;
+        int n = 0;
+        for(f=fields; f!=LOGFORMAT_FIELD_END; f>>=2) {
+            n += logformat_field_bytes(f);
+        }
+        if(sid > 0x7FF || p[2] > 8 || (fields != 0 && n != p[2])) {
+            return LOGFORMAT_BAD_RECORD;
+        }
+        dec->length[sid] = p[2];
+        dec->fields[sid] = fields;
+        p += LOGFORMAT_SCHEMA_ENTRY_SIZE;
+    }
+    dec->have_schema = true;
+    return LOGFORMAT_OK;
+}
+
+static int logformat_decode_data(struct logformat_decoder* dec,
+                                 const struct logformat_header* h,
+                                 const uint8_t* p, logformat_frame_cb cb,
+                                 void* arg)
+{
+    const uint8_t* end = p + h->length;
+    uint32_t timestamp = h->timestamp;
+    uint16_t records = 0;
+
+    if(!dec->have_schema) {
+        return LOGFORMAT_NO_SCHEMA;
+    }
+    memset(dec->valid, 0, sizeof(dec->valid));
+
+    while(p < end) {
+        struct logformat_frame fr;
+        struct logformat_delta* d = NULL;
+        uint32_t predicted, z, bit = 0;
+        bool plain, coded = false;
+        uint16_t head, sid;
+
+        if(end - p < 2) {
+            return LOGFORMAT_BAD_RECORD;
+        }
+        head = p[0] | (p[1] << 8);
+        p += 2;
+        sid = head & 0x7FF;
+        plain = !(head & LOGFORMAT_HEAD_EXT);
+        if(plain) {
+            if(dec->length[sid] > 8) {
+                return LOGFORMAT_BAD_RECORD;
+            }
+            fr.rtr = false;
+            fr.len = dec->length[sid];
+        } else {
+            if(p >= end || (*p & ~(LOGFORMAT_EXT_RTR |
+                                   LOGFORMAT_EXT_LEN_MASK)) ||
+               (*p & LOGFORMAT_EXT_LEN_MASK) > 8) {
+                return LOGFORMAT_BAD_RECORD;
+            }
+            fr.rtr = (*p & LOGFORMAT_EXT_RTR) != 0;
+            fr.len = *p & LOGFORMAT_EXT_LEN_MASK;
+            p++;
+        }
+        fr.sid = sid;
+
+        if(plain && dec->fields[sid] != 0) {
+            d = &dec->delta[sid];
+            bit = 1UL << (sid % 32);
+            coded = (dec->valid[sid / 32] & bit) != 0;
+        }
+
+        z = head >> 12;
+        if(z == LOGFORMAT_HEAD_TIME_ESC) {
+            p = logformat_get_varint(p, end, &z);
+            if(p == NULL) {
+                return LOGFORMAT_BAD_RECORD;
+            }
+        }
+        predicted = coded ? d->timestamp + d->interval : timestamp;
+        fr.timestamp = predicted + (uint32_t)logformat_unzigzag(z);
+
+        memset(fr.data, 0, sizeof(fr.data));
+        if(coded) {
+            uint16_t f;
+            uint8_t* cur = fr.data;
+            const uint8_t* prev = d->data;
+            for(f=dec->fields[sid]; f!=LOGFORMAT_FIELD_END; f>>=2) {
+                int n = logformat_field_bytes(f);
+                p = logformat_get_varint(p, end, &z);
+                if(p == NULL) {
+                    return LOGFORMAT_BAD_RECORD;
+                }
+                logformat_put_le(cur, n, logformat_get_le(prev, n) +
+                                 (uint32_t)logformat_unzigzag(z));
+                cur += n;
+                prev += n;
+            }
+        } else if(!fr.rtr) {
+            if(end - p < fr.len) {
+                return LOGFORMAT_BAD_RECORD;
+            }
+            memcpy(fr.data, p, fr.len);
+            p += fr.len;
+        }
+
+        if(d != NULL) {
+            d->interval = coded ? fr.timestamp - d->timestamp : 0;
+            d->timestamp = fr.timestamp;
+            memcpy(d->data, fr.data, fr.len);
+            dec->valid[sid / 32] |= bit;
+        }
+        timestamp = fr.timestamp;
+        records++;
+
+        cb(&fr, arg);
+    }
+
+    return records == h->records ? LOGFORMAT_OK : LOGFORMAT_BAD_RECORD;
+}
+
+int logformat_decode_block(struct logformat_decoder* dec,
+                           const uint8_t* block, logformat_frame_cb cb,
+                           void* arg)
+{
+    struct logformat_header h;
+    uint8_t zero[4] = {0};
+    uint32_t crc;
+    size_t crc_at = offsetof(struct logformat_header, crc);
+
+    memcpy(&h, block, sizeof(h));
+    if(h.magic != LOGFORMAT_MAGIC || h.version != LOGFORMAT_VERSION ||
+       h.length > LOGFORMAT_DATA_SIZE) {
+        return LOGFORMAT_BAD_HEADER;
+    }
+
+    crc = logformat_crc32(0, block, crc_at);
+    crc = logformat_crc32(crc, zero, sizeof(zero));
+    crc = logformat_crc32(crc, block + crc_at + 4,
+                          LOGFORMAT_BLOCK_SIZE - crc_at - 4);
+    if(crc != h.crc) {
+        return LOGFORMAT_BAD_CRC;
+    }
+
+    if(h.sequence != dec->sequence) {
+        return LOGFORMAT_BAD_SEQUENCE;
+    }
+    if(h.sequence == 0) {
+        dec->session = h.session;
+    } else if(h.session != dec->session) {
+        return LOGFORMAT_BAD_SESSION;
+    }
+    dec->sequence++;
+
+    if(h.type == LOGFORMAT_BLOCK_SCHEMA) {
+        return logformat_decode_schema(dec, &h, block + LOGFORMAT_HEADER_SIZE);
+    } else if(h.type == LOGFORMAT_BLOCK_DATA) {
+        return logformat_decode_data(dec, &h, block + LOGFORMAT_HEADER_SIZE,
+                                     cb, arg);
+    }
+
+    /* Block types added later are skipped */
+    return LOGFORMAT_OK;
+}
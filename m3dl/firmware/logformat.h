@@ -0,0 +1,287 @@
+/*
+ * M3DL log file format
+ *
+ * A log file is a sequence of LOGFORMAT_BLOCK_SIZE byte blocks, each
+ * starting with a struct logformat_header. The first block of every file
+ * is a schema block listing the payload length of each known message and
+ * how the delta coded ones are split into fields, so a log decodes without
+ * the messages.yaml it was written with. Data blocks follow, each holding
+ * whole records and decoding on its own, so a damaged block loses only its
+ * own frames.
+ *
+ * Every LOGFORMAT_INDEX_INTERVAL'th block, from block LOGFORMAT_INDEX_INTERVAL,
+ * is an index block for the data blocks since the one before: the earliest
+ * and latest timestamp of each, the IDs logged in any of them, and the
+ * latest timestamp in the file so far. Being at fixed places, readers can
+ * binary search them for a time. A file closed cleanly ends with a footer
+ * block, which indexes the data blocks since the last index block in the
+ * same way, and lists the first and last region each ID was logged in,
+ * a region being the data blocks one index block covers.
+ *
+ * Each record is:
+ *     u16 head     bits 0-10 standard ID
+ *                  bit 11 set if an extended byte follows
+ *                  bits 12-15 time residual, zigzag coded, 15 if a varint
+ *                  follows instead
+ *     [u8 ext]     bit 7 RTR, bits 0-3 length; without it the frame is not
+ *                  a remote frame and has its message's schema length
+ *     [varint]     time residual, zigzag coded
+ *     payload      none for remote frames, each field's difference from the
+ *                  previous payload as a zigzag varint for delta coded
+ *                  messages seen before in the block, otherwise raw
+ *
+ * The time residual is the frame's timestamp less a prediction: the
+ * previous frame's timestamp, or for delta coded messages seen before in
+ * the block, their previous timestamp plus the interval before that one.
+ * Only frames with the schema length update a message's delta state.
+ *
+ * Version 1 logs are headerless runs of 16 byte records: u16 ID, u8 RTR,
+ * u8 length, 8 data bytes and a u32 timestamp.
+ */
+
+#ifndef LOGFORMAT_H
+#define LOGFORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LOGFORMAT_MAGIC         (0x4C44334DUL)  /* "M3DL" */
+#define LOGFORMAT_VERSION       (2)
+#define LOGFORMAT_BLOCK_SIZE    (4096)
+
+#define LOGFORMAT_BLOCK_SCHEMA  (1)
+#define LOGFORMAT_BLOCK_DATA    (2)
+#define LOGFORMAT_BLOCK_INDEX   (3)
+#define LOGFORMAT_BLOCK_FOOTER  (4)
+
+/* An index block every 256KB, after the 63 data blocks it covers */
+#define LOGFORMAT_INDEX_INTERVAL    (64)
+#define LOGFORMAT_INDEX_BLOCKS      (LOGFORMAT_INDEX_INTERVAL - 1)
+
+/* Bytes in a bitmap of every standard ID */
+#define LOGFORMAT_ID_BYTES      (2048 / 8)
+
+/* Footer entry for IDs with no schema entry */
+#define LOGFORMAT_OTHER_IDS     (0xFFFF)
+#define LOGFORMAT_NO_REGION     (0xFFFF)
+
+/* Longest record: head, ext, 5 byte time varint and 8 delta coded bytes */
+#define LOGFORMAT_RECORD_MAX    (24)
+
+/* Most messages the firmware may delta code */
+#define LOGFORMAT_MAX_DELTA     (16)
+
+/* Delta coded field widths, two bits per field from the first */
+#define LOGFORMAT_FIELD_END     (0)
+#define LOGFORMAT_FIELD_U8      (1)
+#define LOGFORMAT_FIELD_U16     (2)
+#define LOGFORMAT_FIELD_U32     (3)
+
+struct logformat_header {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t type;
+    /* Bytes used after the header */
+    uint16_t length;
+    /* Random for each file, so blocks left on the card by an older one
+     * aren't mistaken for its own */
+    uint32_t session;
+    /* Position of the block in the file, from 0 */
+    uint32_t sequence;
+    /* Data blocks: timestamp of the first record, the earliest and the
+     * latest */
+    uint32_t timestamp;
+    uint32_t min_timestamp;
+    uint32_t max_timestamp;
+    /* Data blocks: records, schema blocks: entries */
+    uint16_t records;
+    uint16_t reserved;
+    /* CRC-32 (as zlib) of the whole block with this field zero */
+    uint32_t crc;
+} __attribute__((packed));
+
+#define LOGFORMAT_HEADER_SIZE   (sizeof(struct logformat_header))
+
+/* Schema entry, generated from messages.yaml into logformat_schema.c.
+ * delta is the message's delta state slot from 1, or 0 if it isn't delta
+ * coded. The file only stores sid, length and fields.
+ */
+struct logformat_schema_entry {
+    uint16_t sid;
+    uint8_t length;
+    uint8_t delta;
+    uint16_t fields;
+};
+
+#define LOGFORMAT_SCHEMA_ENTRY_SIZE (5)
+
+extern const struct logformat_schema_entry logformat_schema[];
+extern const uint16_t logformat_schema_len;
+/* Entry for each ID from 1, or 0 if it has none */
+extern const uint8_t logformat_schema_index[2048];
+
+/* Start of an index or footer block's contents, followed by the earliest
+ * and latest timestamp of each data block as pairs of u32, then a
+ * LOGFORMAT_ID_BYTES bitmap of the IDs in them, and for footers, <ids>
+ * struct logformat_id_regions.
+ */
+struct logformat_index_header {
+    /* Earliest and latest timestamp in the file up to here */
+    uint32_t file_min;
+    uint32_t file_max;
+    /* This region's number, from 0, and how many data blocks it has */
+    uint16_t region;
+    uint16_t blocks;
+    /* Footers: regions in the file, including this last one, and ID
+     * entries */
+    uint16_t regions;
+    uint16_t ids;
+} __attribute__((packed));
+
+struct logformat_id_regions {
+    uint16_t sid;
+    uint16_t first;
+    uint16_t last;
+} __attribute__((packed));
+
+/* Delta state of one message within a block */
+struct logformat_delta {
+    uint32_t timestamp;
+    uint32_t interval;
+    uint8_t data[8];
+};
+
+/* Fills one data block. Owned by a single producer. */
+struct logformat_encoder {
+    uint8_t* block;
+    /* Bitmap of the IDs in the block, if wanted */
+    uint8_t* ids;
+    uint16_t length;
+    uint16_t records;
+    /* First, latest, earliest and greatest timestamps */
+    uint32_t first;
+    uint32_t timestamp;
+    uint32_t min;
+    uint32_t max;
+    /* Bit for each delta slot seen in this block */
+    uint32_t valid;
+    struct logformat_delta delta[LOGFORMAT_MAX_DELTA];
+};
+
+/* Builds the index and footer blocks as data blocks are written.
+ * first and last are the regions each schema entry's ID was first and last
+ * logged in, with entry 0 for IDs with none.
+ */
+struct logformat_index {
+    uint32_t file_min;
+    uint32_t file_max;
+    uint16_t region;
+    uint16_t blocks;
+    uint32_t times[LOGFORMAT_INDEX_BLOCKS][2];
+    uint8_t ids[LOGFORMAT_ID_BYTES];
+    uint16_t first[256];
+    uint16_t last[256];
+};
+
+/* Index or footer block, as read back */
+struct logformat_index_info {
+    struct logformat_index_header h;
+    uint32_t times[LOGFORMAT_INDEX_BLOCKS][2];
+    uint8_t ids[LOGFORMAT_ID_BYTES];
+    struct logformat_id_regions regions[256];
+};
+
+/* Decoded frame */
+struct logformat_frame {
+    uint16_t sid;
+    bool rtr;
+    uint8_t len;
+    uint8_t data[8];
+    uint32_t timestamp;
+};
+
+/* Reads one file. The schema comes from its first block. */
+struct logformat_decoder {
+    uint32_t session;
+    uint32_t sequence;
+    bool have_schema;
+    uint8_t length[2048];
+    uint16_t fields[2048];
+    uint32_t valid[2048 / 32];
+    struct logformat_delta delta[2048];
+};
+
+/* Decoder results */
+#define LOGFORMAT_OK            (0)
+#define LOGFORMAT_BAD_HEADER    (-1)
+#define LOGFORMAT_BAD_CRC       (-2)
+#define LOGFORMAT_BAD_SESSION   (-3)
+#define LOGFORMAT_BAD_SEQUENCE  (-4)
+#define LOGFORMAT_BAD_RECORD    (-5)
+#define LOGFORMAT_NO_SCHEMA     (-6)
+
+typedef void (*logformat_frame_cb)(const struct logformat_frame* frame,
+                                   void* arg);
+
+/* Start filling <block>, and marking its IDs in <ids> unless it is NULL */
+void logformat_begin(struct logformat_encoder* enc, uint8_t* block,
+                     uint8_t* ids);
+
+/* Append a frame, returning false with nothing stored if the block is full */
+bool logformat_add(struct logformat_encoder* enc, uint16_t sid, bool rtr,
+                   uint8_t len, const uint8_t* data, uint32_t timestamp);
+
+/* Fill in the block's header, after which it only needs sealing */
+void logformat_finish(struct logformat_encoder* enc);
+
+/* Write the schema block into <block> */
+void logformat_schema_block(uint8_t* block);
+
+/* Zero the unused end of a finished <block>, set its place in the file and
+ * its CRC, ready to write */
+void logformat_seal(uint8_t* block, uint32_t session, uint32_t sequence);
+
+/* Start indexing a new file */
+void logformat_index_init(struct logformat_index* idx);
+
+/* Add the finished data <block> holding <ids> to the index, before it is
+ * written. Returns true once it is the last in its region, when the index
+ * block is to be written next.
+ */
+bool logformat_index_add(struct logformat_index* idx, const uint8_t* block,
+                         const uint8_t* ids);
+
+/* Write the index block for the region just finished into <block> */
+void logformat_index_block(struct logformat_index* idx, uint8_t* block);
+
+/* Write the footer block into <block>, to end the file */
+void logformat_footer_block(struct logformat_index* idx, uint8_t* block);
+
+/* Read a good index or footer <block> into <info> */
+int logformat_read_index(const uint8_t* block,
+                         struct logformat_index_info* info);
+
+/* Sequence number of region <region>'s first data block and index block */
+#define LOGFORMAT_REGION_START(region) \
+    ((uint32_t)(region) * LOGFORMAT_INDEX_INTERVAL + 1)
+#define LOGFORMAT_REGION_INDEX(region) \
+    ((uint32_t)((region) + 1) * LOGFORMAT_INDEX_INTERVAL)
+
+/* Continue a CRC-32 (as zlib) over <n> bytes */
+uint32_t logformat_crc32(uint32_t crc, const uint8_t* data, size_t n);
+
+/* Start decoding a file */
+void logformat_decoder_init(struct logformat_decoder* dec);
+
+/* Decode the next <block> of the file, calling <cb> for each frame.
+ * Returns LOGFORMAT_OK or the first problem found; frames before a bad
+ * record have already been passed to <cb>. Index and footer blocks are
+ * only checked. To read a block out of order, set dec->sequence to its
+ * number first.
+ */
+int logformat_decode_block(struct logformat_decoder* dec,
+                           const uint8_t* block, logformat_frame_cb cb,
+                           void* arg);
+
+#endif /* LOGFORMAT_H */
@@ -0,0 +1,282 @@
+/*
+ * Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+ * Every message's payload length for the datalogger's log format,
+ * with the field widths of those marked log_delta.
+ */
+
+#include "m3can.h"
+#include "logformat.h"
+
+const struct logformat_schema_entry logformat_schema[] = {
+    {CAN_ID_M3FC | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_STATUS, 3, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_PROFILE, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_FIRE_COMMAND, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_PYROS, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_ARM_COMMAND, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_LOAD_CFG, 0, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SAVE_CFG, 0, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_MOCK_ENABLE, 0, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_MOCK_ACCEL, 6, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_MOCK_BARO, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_ARM, 0, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_FIRE, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SET_CFG_CRC, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_TIMESYNC, 6, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_TOGGLE_PYROS, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_FIRE_STATUS, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL, 2, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_ARM_STATUS, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_TOGGLE_CHARGER, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT, 1, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_MISSION_STATE, 5, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_FREE_SPACE, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_RATE, 4, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_STATUS_DIGEST, 6, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_STATUS_BATCH, 8, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_BULK_DATA, 8, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_BULK_FLOW, 8, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_CAN_STATS, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_ACCEL, 8, 1, 0x00AA},
+    {CAN_MSG_ID_M3PSU_PYRO_STATUS, 7, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_CONTINUITY, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_GPS_LATLNG, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_TEMP_1_2, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_BARO, 8, 2, 0x000F},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PYRO_SUPPLY_STATUS, 2, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_GPS_ALT, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_TEMP_3_4, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SE_T_H, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_GPS_TIME, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_TEMP_5_6, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SE_V_A, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_GPS_STATUS, 3, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_TEMP_7_8, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SE_VAR_H, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_TEMP_9, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_SE_VAR_V_A, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_PACKET_COUNT, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3DL_PRESSURE, 8, 3, 0x00AA},
+    {CAN_MSG_ID_GROUND_PACKET_COUNT, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_PROFILE, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_PACKET_STATS, 8, 0, 0x0000},
+    {CAN_MSG_ID_GROUND_PACKET_STATS, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_PYROS, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CHARGER_STATUS, 5, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_PING, 0, 0, 0x0000},
+    {CAN_MSG_ID_GROUND_PACKET_FRAMES, 2, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_ACCEL_X, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_BATT_VOLTAGES, 6, 0, 0x0000},
+    {CAN_MSG_ID_M3RADIO_SET_FREQ, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_ACCEL_Y, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_CAPACITY, 3, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_ACCEL_Z, 8, 0, 0x0000},
+    {CAN_MSG_ID_M3PSU_AWAKE_TIME, 3, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_RADIO_FREQ, 4, 0, 0x0000},
+    {CAN_MSG_ID_M3FC_CFG_CRC, 4, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_THREAD_STATS, 8, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_PROFILE, 8, 0, 0x0000},
+    {CAN_ID_M3FC | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_M3PSU | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_M3PYRO | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_M3RADIO | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_M3IMU | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_M3DL | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+    {CAN_ID_GROUND | CAN_MSG_ID_VERSION, 8, 0, 0x0000},
+};
+
+const uint16_t logformat_schema_len = 133;
+
+const uint8_t logformat_schema_index[2048] = {
+    [CAN_ID_M3FC | CAN_MSG_ID_STATUS] = 1,
+    [CAN_ID_M3PSU | CAN_MSG_ID_STATUS] = 2,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_STATUS] = 3,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_STATUS] = 4,
+    [CAN_ID_M3IMU | CAN_MSG_ID_STATUS] = 5,
+    [CAN_ID_M3DL | CAN_MSG_ID_STATUS] = 6,
+    [CAN_ID_GROUND | CAN_MSG_ID_STATUS] = 7,
+    [CAN_MSG_ID_M3FC_SET_CFG_PROFILE] = 8,
+    [CAN_MSG_ID_M3PYRO_FIRE_COMMAND] = 9,
+    [CAN_MSG_ID_M3FC_SET_CFG_PYROS] = 10,
+    [CAN_MSG_ID_M3PYRO_ARM_COMMAND] = 11,
+    [CAN_MSG_ID_M3FC_LOAD_CFG] = 12,
+    [CAN_MSG_ID_M3FC_SAVE_CFG] = 13,
+    [CAN_MSG_ID_M3FC_MOCK_ENABLE] = 14,
+    [CAN_MSG_ID_M3FC_MOCK_ACCEL] = 15,
+    [CAN_MSG_ID_M3FC_MOCK_BARO] = 16,
+    [CAN_MSG_ID_M3FC_ARM] = 17,
+    [CAN_MSG_ID_M3FC_FIRE] = 18,
+    [CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X] = 19,
+    [CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y] = 20,
+    [CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z] = 21,
+    [CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ] = 22,
+    [CAN_MSG_ID_M3FC_SET_CFG_CRC] = 23,
+    [CAN_MSG_ID_M3FC_TIMESYNC] = 24,
+    [CAN_MSG_ID_M3PSU_TOGGLE_PYROS] = 25,
+    [CAN_MSG_ID_M3PYRO_FIRE_STATUS] = 26,
+    [CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL] = 27,
+    [CAN_MSG_ID_M3PYRO_ARM_STATUS] = 28,
+    [CAN_MSG_ID_M3PSU_TOGGLE_CHARGER] = 29,
+    [CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER] = 30,
+    [CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT] = 31,
+    [CAN_MSG_ID_M3FC_MISSION_STATE] = 32,
+    [CAN_MSG_ID_M3DL_FREE_SPACE] = 33,
+    [CAN_MSG_ID_M3DL_RATE] = 34,
+    [CAN_ID_M3FC | CAN_MSG_ID_STATUS_DIGEST] = 35,
+    [CAN_ID_M3PSU | CAN_MSG_ID_STATUS_DIGEST] = 36,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_DIGEST] = 37,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_DIGEST] = 38,
+    [CAN_ID_M3IMU | CAN_MSG_ID_STATUS_DIGEST] = 39,
+    [CAN_ID_M3DL | CAN_MSG_ID_STATUS_DIGEST] = 40,
+    [CAN_ID_GROUND | CAN_MSG_ID_STATUS_DIGEST] = 41,
+    [CAN_ID_M3FC | CAN_MSG_ID_STATUS_BATCH] = 42,
+    [CAN_ID_M3PSU | CAN_MSG_ID_STATUS_BATCH] = 43,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_BATCH] = 44,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_STATUS_BATCH] = 45,
+    [CAN_ID_M3IMU | CAN_MSG_ID_STATUS_BATCH] = 46,
+    [CAN_ID_M3DL | CAN_MSG_ID_STATUS_BATCH] = 47,
+    [CAN_ID_GROUND | CAN_MSG_ID_STATUS_BATCH] = 48,
+    [CAN_ID_M3FC | CAN_MSG_ID_BULK_DATA] = 49,
+    [CAN_ID_M3PSU | CAN_MSG_ID_BULK_DATA] = 50,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_BULK_DATA] = 51,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_BULK_DATA] = 52,
+    [CAN_ID_M3IMU | CAN_MSG_ID_BULK_DATA] = 53,
+    [CAN_ID_M3DL | CAN_MSG_ID_BULK_DATA] = 54,
+    [CAN_ID_GROUND | CAN_MSG_ID_BULK_DATA] = 55,
+    [CAN_ID_M3FC | CAN_MSG_ID_BULK_FLOW] = 56,
+    [CAN_ID_M3PSU | CAN_MSG_ID_BULK_FLOW] = 57,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_BULK_FLOW] = 58,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_BULK_FLOW] = 59,
+    [CAN_ID_M3IMU | CAN_MSG_ID_BULK_FLOW] = 60,
+    [CAN_ID_M3DL | CAN_MSG_ID_BULK_FLOW] = 61,
+    [CAN_ID_GROUND | CAN_MSG_ID_BULK_FLOW] = 62,
+    [CAN_ID_M3FC | CAN_MSG_ID_CAN_STATS] = 63,
+    [CAN_ID_M3PSU | CAN_MSG_ID_CAN_STATS] = 64,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_CAN_STATS] = 65,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_CAN_STATS] = 66,
+    [CAN_ID_M3IMU | CAN_MSG_ID_CAN_STATS] = 67,
+    [CAN_ID_M3DL | CAN_MSG_ID_CAN_STATS] = 68,
+    [CAN_ID_GROUND | CAN_MSG_ID_CAN_STATS] = 69,
+    [CAN_MSG_ID_M3FC_ACCEL] = 70,
+    [CAN_MSG_ID_M3PSU_PYRO_STATUS] = 71,
+    [CAN_MSG_ID_M3PYRO_CONTINUITY] = 72,
+    [CAN_MSG_ID_M3RADIO_GPS_LATLNG] = 73,
+    [CAN_MSG_ID_M3DL_TEMP_1_2] = 74,
+    [CAN_MSG_ID_M3FC_BARO] = 75,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12] = 76,
+    [CAN_MSG_ID_M3PYRO_SUPPLY_STATUS] = 77,
+    [CAN_MSG_ID_M3RADIO_GPS_ALT] = 78,
+    [CAN_MSG_ID_M3DL_TEMP_3_4] = 79,
+    [CAN_MSG_ID_M3FC_SE_T_H] = 80,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34] = 81,
+    [CAN_MSG_ID_M3RADIO_GPS_TIME] = 82,
+    [CAN_MSG_ID_M3DL_TEMP_5_6] = 83,
+    [CAN_MSG_ID_M3FC_SE_V_A] = 84,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56] = 85,
+    [CAN_MSG_ID_M3RADIO_GPS_STATUS] = 86,
+    [CAN_MSG_ID_M3DL_TEMP_7_8] = 87,
+    [CAN_MSG_ID_M3FC_SE_VAR_H] = 88,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78] = 89,
+    [CAN_MSG_ID_M3DL_TEMP_9] = 90,
+    [CAN_MSG_ID_M3FC_SE_VAR_V_A] = 91,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910] = 92,
+    [CAN_MSG_ID_M3RADIO_PACKET_COUNT] = 93,
+    [CAN_MSG_ID_M3DL_PRESSURE] = 94,
+    [CAN_MSG_ID_GROUND_PACKET_COUNT] = 95,
+    [CAN_MSG_ID_M3FC_CFG_PROFILE] = 96,
+    [CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112] = 97,
+    [CAN_MSG_ID_M3RADIO_PACKET_STATS] = 98,
+    [CAN_MSG_ID_GROUND_PACKET_STATS] = 99,
+    [CAN_MSG_ID_M3FC_CFG_PYROS] = 100,
+    [CAN_MSG_ID_M3PSU_CHARGER_STATUS] = 101,
+    [CAN_MSG_ID_M3RADIO_PING] = 102,
+    [CAN_MSG_ID_GROUND_PACKET_FRAMES] = 103,
+    [CAN_MSG_ID_M3FC_CFG_ACCEL_X] = 104,
+    [CAN_MSG_ID_M3PSU_BATT_VOLTAGES] = 105,
+    [CAN_MSG_ID_M3RADIO_SET_FREQ] = 106,
+    [CAN_MSG_ID_M3FC_CFG_ACCEL_Y] = 107,
+    [CAN_MSG_ID_M3PSU_CAPACITY] = 108,
+    [CAN_MSG_ID_M3FC_CFG_ACCEL_Z] = 109,
+    [CAN_MSG_ID_M3PSU_AWAKE_TIME] = 110,
+    [CAN_MSG_ID_M3FC_CFG_RADIO_FREQ] = 111,
+    [CAN_MSG_ID_M3FC_CFG_CRC] = 112,
+    [CAN_ID_M3FC | CAN_MSG_ID_THREAD_STATS] = 113,
+    [CAN_ID_M3PSU | CAN_MSG_ID_THREAD_STATS] = 114,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_THREAD_STATS] = 115,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_THREAD_STATS] = 116,
+    [CAN_ID_M3IMU | CAN_MSG_ID_THREAD_STATS] = 117,
+    [CAN_ID_M3DL | CAN_MSG_ID_THREAD_STATS] = 118,
+    [CAN_ID_GROUND | CAN_MSG_ID_THREAD_STATS] = 119,
+    [CAN_ID_M3FC | CAN_MSG_ID_PROFILE] = 120,
+    [CAN_ID_M3PSU | CAN_MSG_ID_PROFILE] = 121,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_PROFILE] = 122,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_PROFILE] = 123,
+    [CAN_ID_M3IMU | CAN_MSG_ID_PROFILE] = 124,
+    [CAN_ID_M3DL | CAN_MSG_ID_PROFILE] = 125,
+    [CAN_ID_GROUND | CAN_MSG_ID_PROFILE] = 126,
+    [CAN_ID_M3FC | CAN_MSG_ID_VERSION] = 127,
+    [CAN_ID_M3PSU | CAN_MSG_ID_VERSION] = 128,
+    [CAN_ID_M3PYRO | CAN_MSG_ID_VERSION] = 129,
+    [CAN_ID_M3RADIO | CAN_MSG_ID_VERSION] = 130,
+    [CAN_ID_M3IMU | CAN_MSG_ID_VERSION] = 131,
+    [CAN_ID_M3DL | CAN_MSG_ID_VERSION] = 132,
+    [CAN_ID_GROUND | CAN_MSG_ID_VERSION] = 133,
+};
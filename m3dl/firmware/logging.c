@@ -8,201 +8,302 @@
 #include <string.h>
 
 #include "logging.h"
+#include "logformat.h"
 #include "microsd.h"
 #include "LTC2983.h"
 #include "logging.h"
 #include "err_handler.h"
 
 #include "m3can.h"
+#include "m3can_timesync.h"
 #include "m3status.h"
+#include "m3prof.h"
 
-#define LOG_MEMPOOL_ITEMS 3072      // 1K
-#define LOG_CACHE_SIZE    16384     // 16KB
+#define LOG_BLOCK_COUNT   19        // 76KB, 80KB with the schema/index block
 
-/* Datalogger Packet */
-typedef struct DLPacket {
+/* Log files are preallocated this much at a time, about 10 minutes at full
+ * bus load, so writes only touch data sectors
+ */
+#define LOG_PREALLOC_SIZE (64UL * 1024 * 1024)
 
-    uint16_t ID;
-	uint8_t RTR;
-	uint8_t len;
-	uint8_t data[8];
-	systime_t timestamp;
-} __attribute__((packed)) DLPacket;
+/* The directory entry is synced this often, or after this much data */
+#define LOG_SYNC_INTERVAL_MS 1000
+#define LOG_SYNC_BYTES       (1024UL * 1024)
 
 
 /* Function Prototypes */
-static void mem_init(void);
 void logging_init(void);
-static void _log(DLPacket *packet);
+static void log_open(SDFILE* file, SDFS* file_system);
+static SDRESULT log_write_once(SDFILE* file, uint8_t* blocks, uint32_t n);
+static SDRESULT log_write_data(SDFILE* file, uint8_t* blocks,
+                               uint8_t (*ids)[LOGFORMAT_ID_BYTES], uint32_t n);
+static void log_write(SDFILE* file, SDFS* file_system, uint8_t* blocks,
+                      uint8_t (*ids)[LOGFORMAT_ID_BYTES], uint32_t n);
 
 
 /* Logging Enabled/Disabled */
-static bool logging_enable = TRUE;
-
-/* Data cache to ensure SD writes are done LOG_CACHE_SIZE bytes at a time */
-static volatile char log_cache[LOG_CACHE_SIZE];
-
-/* Memory pool for allocating space for incoming data to be queued */
-static memory_pool_t log_mempool;
-
-/* Mailbox (queue) for storing pointers to data (packets) */
-static mailbox_t log_mailbox;
-
-/* Statically allocated memory used for the memory pool */
-static volatile char mempool_buffer[LOG_MEMPOOL_ITEMS * sizeof(DLPacket)]
-                     __attribute__((aligned(sizeof(stkalign_t))))
-                     __attribute__((section(".ccm")));
-
-/* Statically allocated memory used for the queue in mailbox */
-static volatile msg_t mailbox_buffer[LOG_MEMPOOL_ITEMS]
-                      __attribute__((section(".ccm")));
+static volatile bool logging_enable = TRUE;
+
+/* Set by log_can While it is Storing a Frame */
+static volatile bool log_busy;
+
+/* Packets dropped because the ring was full */
+static volatile uint32_t log_dropped;
+
+/* Ring of log format blocks (see logformat.h), filled by the CAN receive
+ * thread in log_can and written to the SD card by the datalogging thread.
+ * It is in main SRAM so the SDIO DMA can read it.
+ *
+ * log_can encodes frames into the block at log_head, and moves log_head on
+ * when the block is full; only it writes log_head or log_encoder.
+ * log_tail is the next block to write to the card and is only written by
+ * the datalogging thread. The ring is empty when they are equal and full
+ * when log_head is just behind log_tail, so one block is always being
+ * filled.
+ */
+static uint8_t log_ring[LOG_BLOCK_COUNT][LOGFORMAT_BLOCK_SIZE]
+    __attribute__((aligned(512)));
+static uint32_t log_head;
+static uint32_t log_tail;
+static struct logformat_encoder log_encoder;
+
+/* IDs in each ring block, for the file's index. Only the CPU reads them, so
+ * they can go in core coupled memory.
+ */
+static uint8_t log_ring_ids[LOG_BLOCK_COUNT][LOGFORMAT_ID_BYTES]
+    __attribute__((section(".ram4")));
+
+/* Signalled each time log_can completes a block */
+static BSEMAPHORE_DECL(log_block_ready, true);
+
+/* Schema Block Starting Each File, Then its Index Blocks and Footer */
+static uint8_t log_meta[LOGFORMAT_BLOCK_SIZE] __attribute__((aligned(512)));
+
+/* Current File's Session, Next Block Number and Index */
+static uint32_t log_session;
+static uint32_t log_sequence;
+static struct logformat_index log_index __attribute__((section(".ram4")));
 
 
 /* Datalogging Thread */
-static THD_WORKING_AREA(logging_wa, 3072);
+static THD_WORKING_AREA(logging_wa, 2048);
 THD_FUNCTION(datalogging_thread, arg) {
 
     (void)arg;
     chRegSetThreadName("Datalogging");
 
-    /* Packet Size */
-    static const int packet_size = sizeof(DLPacket);
-    
-    /* Pointer to Keep Track of Cache */
-    volatile char* cache_ptr = log_cache;
-    
     /* File System Variables */
     SDFS file_system;
     FATFS *fsp;
     SDFILE file;
-    SDRESULT write_res;
-    SDRESULT open_res;
-    
+
     /* Number of Avaliable 16KB Clusters */
-    uint32_t free_clusters;    
-    
-    /* Mailbox Variables */             
-    msg_t mailbox_res;       
-    intptr_t data_msg;     
-
-    /* Initalise Memory */
-    mem_init();
-
-    /* Attempt to Open log_xxxxx.bin */
-    while (microsd_open_file_inc(&file, "log", "bin", &file_system) != FR_OK);
-    
+    uint32_t free_clusters;
+
+    /* Ring Position and Drops Already Reported */
+    uint32_t head, tail, n;
+    uint32_t dropped, reported = 0;
+    bool stop = false;
+
+    /* Data Written Since the Last Sync */
+    systime_t last_sync = chVTGetSystemTime();
+    uint32_t unsynced = 0;
+
+    /* Open log_xxxxx.bin and Write its Schema */
+    log_open(&file, &file_system);
+
     /* SD Card Initilised and File Opened */
     m3status_set_ok(M3DL_COMPONENT_SD_CARD);
 
-    /* Begin Logging */
-    while (logging_enable) {
-
-        /* Wait for Message to be Avaliable */
-        mailbox_res = chMBFetch(&log_mailbox, (msg_t*)&data_msg, MS2ST(100));
-
-        /* Re-attempt if Mailbox was Reset or Fetch Failed */
-        if (mailbox_res != MSG_OK || data_msg == 0) continue;
-
-        /* Put Packet in Static Cache and Free From Memory Pool */
-        memcpy((void*)cache_ptr, (void*)data_msg, packet_size);
-        chPoolFree(&log_mempool, (void*)data_msg);
-
-        /* Detect Full Cache and Write to SD Card */
-        if(cache_ptr + packet_size >= log_cache + LOG_CACHE_SIZE) {
-            
-            /* Attempt to Write Cache */
-            write_res = microsd_write(&file, (char*)log_cache, LOG_CACHE_SIZE);
-                             
-            while (write_res != FR_OK) {
-            
-                /* Signal Failed Write */           
-                err(M3DL_ERROR_SD_CARD_WRITE);
-                m3status_set_error(M3DL_COMPONENT_SD_CARD, M3DL_ERROR_SD_CARD_WRITE);
-                
-                /* Attempt to Re-open File */
-                microsd_close_file(&file);
-                open_res = microsd_open_file_inc(&file, "log", "bin", &file_system);
-                
-                if(open_res == FR_OK) {
-                    
-                    /* Re-attempt to Write Cache */
-                    write_res = microsd_write(&file, (char*)log_cache, LOG_CACHE_SIZE);
-                }
-            }
-
-            /* Reset Cache Pointer */
-            cache_ptr = log_cache;
-                
-            /* Report Free Space Over CAN */
-            if(f_getfree("/", &free_clusters, &fsp) == FR_OK) {    
-                m3can_send(CAN_MSG_ID_M3DL_FREE_SPACE, FALSE, (uint8_t*)(&free_clusters), 4);
-            }
-            
-            /* Cache written to SD card succesfully */
-            m3status_set_ok(M3DL_COMPONENT_SD_CARD);            
-        
+    while (!stop) {
+
+        /* Wait for a Full Block, or Check for Logging Being Disabled */
+        chBSemWaitTimeout(&log_block_ready, MS2ST(100));
+        stop = !__atomic_load_n(&logging_enable, __ATOMIC_SEQ_CST);
+
+        /* Once Stopped, Wait for log_can to Finish any Frame it was
+         * Storing, After Which log_head Won't Move Again
+         */
+        while (stop && __atomic_load_n(&log_busy, __ATOMIC_SEQ_CST)) {
+            chThdSleepMilliseconds(1);
+        }
+
+        head = __atomic_load_n(&log_head, __ATOMIC_ACQUIRE);
+        tail = log_tail;
+        if (head == tail) continue;
+
+        /* Write Every Full Block, up to the End of the Ring in One Go */
+        while (tail != head) {
+            n = (head > tail ? head : LOG_BLOCK_COUNT) - tail;
+
+            M3PROF_START(M3PROF_M3DL_SD_WRITE);
+            log_write(&file, &file_system, log_ring[tail], &log_ring_ids[tail],
+                      n);
+            M3PROF_STOP(M3PROF_M3DL_SD_WRITE);
+
+            /* Hand the Written Blocks Back to log_can */
+            tail = (tail + n) % LOG_BLOCK_COUNT;
+            __atomic_store_n(&log_tail, tail, __ATOMIC_RELEASE);
+            unsynced += n * LOGFORMAT_BLOCK_SIZE;
+        }
+
+        /* Sync Once a Second or Every Megabyte. The Data is on the Card
+         * Already, This Only Updates the Directory Entry.
+         */
+        if (unsynced >= LOG_SYNC_BYTES ||
+            chVTTimeElapsedSinceX(last_sync) >= MS2ST(LOG_SYNC_INTERVAL_MS)) {
+            microsd_sync(&file);
+            last_sync = chVTGetSystemTime();
+            unsynced = 0;
+        }
+
+        /* Report Free Space Over CAN */
+        if(f_getfree("/", &free_clusters, &fsp) == FR_OK) {
+            m3can_send(CAN_MSG_ID_M3DL_FREE_SPACE, FALSE, (uint8_t*)(&free_clusters), 4);
+        }
+
+        /* Blocks written to SD card succesfully, report any packets lost
+         * since the last write */
+        dropped = log_dropped;
+        if (dropped != reported) {
+            m3status_set_error_data(M3DL_COMPONENT_SD_CARD,
+                                    M3DL_ERROR_LOGGING_OVERFLOW,
+                                    (uint8_t*)&dropped, 4);
+            reported = dropped;
         } else {
-        
-            /* Increment Cache Pointer */
-            cache_ptr += packet_size;
+            m3status_set_ok(M3DL_COMPONENT_SD_CARD);
         }
     }
 
+    /* Write the Partly Filled Block log_can Left */
+    if (log_encoder.records > 0) {
+        logformat_finish(&log_encoder);
+        log_write(&file, &file_system, log_ring[log_head],
+                  &log_ring_ids[log_head], 1);
+    }
 
-    /* Logging Disabled - Attempt to Flush Remainder of Cache to Disk */
-    write_res = microsd_write(&file, (char*)log_cache, (cache_ptr - log_cache));
+    /* End With the Footer, Which Indexes the Last Blocks. Without it the
+     * File Still Reads, Just Without the Last Region Indexed.
+     */
+    logformat_footer_block(&log_index, log_meta);
+    log_write_once(&file, log_meta, 1);
 
-    while (write_res != FR_OK) {
+    /* Close File and Disconnect From SD Card */
+    microsd_close_file(&file);
+}
+
+
+/* Open the Next log_xxxxx.bin and Write its Schema Block */
+static void log_open(SDFILE* file, SDFS* file_system) {
+
+    while (true) {
 
-        /* Signal Failed Write */           
+        /* Attempt to Open log_xxxxx.bin */
+        while (microsd_open_file_inc(file, "log", "bin", file_system) != FR_OK);
+
+        /* The Cycle Counter Varies With How Long the Card Took to Start,
+         * Enough to Tell This File's Blocks From an Older One's
+         */
+        log_session = chSysGetRealtimeCounterX() ^ chVTGetSystemTime();
+        log_sequence = 0;
+        logformat_index_init(&log_index);
+
+        logformat_schema_block(log_meta);
+        if (log_write_once(file, log_meta, 1) == FR_OK) return;
+
+        /* Signal Failed Write and Try the Next File */
         err(M3DL_ERROR_SD_CARD_WRITE);
         m3status_set_error(M3DL_COMPONENT_SD_CARD, M3DL_ERROR_SD_CARD_WRITE);
+        microsd_close_file(file);
+    }
+}
 
-        /* Attempt to Re-open File */
-        microsd_close_file(&file);
-        open_res = microsd_open_file_inc(&file, "log", "bin", &file_system);
 
-        if(open_res == FR_OK) {
-            
-            /* Re-attempt to Write Cache */
-            write_res = microsd_write(&file, (char*)log_cache, (cache_ptr - log_cache));
-        }
+/* Seal and Write <n> Blocks, Preallocating More of the File First if
+ * Needed
+ */
+static SDRESULT log_write_once(SDFILE* file, uint8_t* blocks, uint32_t n) {
+
+    SDRESULT res;
+    DWORD btw = n * LOGFORMAT_BLOCK_SIZE;
+    uint32_t i;
+
+    for (i = 0; i < n; i++) {
+        logformat_seal(blocks + i * LOGFORMAT_BLOCK_SIZE, log_session,
+                       log_sequence + i);
     }
-    
-    /* Cache written to SD card succesfully */
-    m3status_set_ok(M3DL_COMPONENT_SD_CARD);
-    
-    /* Close File and Disconnect From SD Card */
-    microsd_close_file(&file);
+
+    if (f_tell(file) + btw > f_size(file)) {
+        res = microsd_preallocate(file, f_tell(file) + btw + LOG_PREALLOC_SIZE);
+        if (res != FR_OK) return res;
+    }
+
+    res = microsd_write(file, (const char*)blocks, btw);
+    if (res == FR_OK) {
+        log_sequence += n;
+    }
+    return res;
 }
 
-/* Initialise Mailbox and Memorypool */
-static void mem_init(void) {
-    
-    chMBObjectInit(&log_mailbox, (msg_t*)mailbox_buffer, LOG_MEMPOOL_ITEMS);
-    chPoolObjectInit(&log_mempool, sizeof(DLPacket), NULL);
 
-    /* Fill Memory Pool with Statically Allocated Bits of Memory */
-    chPoolLoadArray(&log_mempool, (void*)mempool_buffer, LOG_MEMPOOL_ITEMS);
+/* Write <n> Data Blocks Holding <ids>, With an Index Block After Each
+ * Region's Last
+ */
+static SDRESULT log_write_data(SDFILE* file, uint8_t* blocks,
+                               uint8_t (*ids)[LOGFORMAT_ID_BYTES], uint32_t n) {
+
+    SDRESULT res;
+    uint32_t i, m;
+    bool full = false;
+
+    while (n > 0) {
+
+        /* Up to the End of the Region */
+        m = LOGFORMAT_INDEX_BLOCKS - log_index.blocks;
+        if (m > n) m = n;
+
+        res = log_write_once(file, blocks, m);
+        if (res != FR_OK) return res;
+
+        for (i = 0; i < m; i++) {
+            full = logformat_index_add(&log_index,
+                                       blocks + i * LOGFORMAT_BLOCK_SIZE,
+                                       ids[i]);
+        }
+        if (full) {
+            logformat_index_block(&log_index, log_meta);
+            res = log_write_once(file, log_meta, 1);
+            if (res != FR_OK) return res;
+        }
+
+        blocks += m * LOGFORMAT_BLOCK_SIZE;
+        ids += m;
+        n -= m;
+    }
+
+    return FR_OK;
 }
 
 
-/* Allocate and Post a Formatted Packet to the Mailbox */
-static void _log(DLPacket *packet) {
+/* Write <n> Data Blocks, Re-opening the File Until it Succeeds */
+static void log_write(SDFILE* file, SDFS* file_system, uint8_t* blocks,
+                      uint8_t (*ids)[LOGFORMAT_ID_BYTES], uint32_t n) {
+
+    SDRESULT write_res;
 
-    void* msg;
-    msg_t retval;
+    /* Attempt to Write Blocks */
+    write_res = log_write_data(file, blocks, ids, n);
 
-    /* Allocate Space for Packet and Copy it into a Mailbox Message */
-    msg = chPoolAlloc(&log_mempool);
-    if (msg == NULL) return;
-    memcpy(msg, (void*)packet, sizeof(DLPacket));
+    while (write_res != FR_OK) {
 
-    /* Put it in the Mailbox Buffer */
-    retval = chMBPost(&log_mailbox, (intptr_t)msg, TIME_IMMEDIATE);
-    if (retval != MSG_OK) {
-        chPoolFree(&log_mempool, msg);
-        return;
+        /* Signal Failed Write */
+        err(M3DL_ERROR_SD_CARD_WRITE);
+        m3status_set_error(M3DL_COMPONENT_SD_CARD, M3DL_ERROR_SD_CARD_WRITE);
+
+        /* Attempt to Re-open File, Then Re-attempt to Write Blocks */
+        microsd_close_file(file);
+        log_open(file, file_system);
+        write_res = log_write_data(file, blocks, ids, n);
     }
 }
 
@@ -210,27 +311,79 @@ static void _log(DLPacket *packet) {
 /* Init Logging */
 void logging_init(void) {
 
-    /* Create Datalogging Thread */
+    logformat_begin(&log_encoder, log_ring[0], log_ring_ids[0]);
+
+    /* Create Datalogging Thread, Below the CAN Receive Thread so Storing
+     * Packets Pre-empts Waiting on the Card
+     */
     chThdCreateStatic(logging_wa, sizeof(logging_wa),
-                      HIGHPRIO, datalogging_thread, NULL);
+                      NORMALPRIO, datalogging_thread, NULL);
 }
 
 
 /* Disable Logging */
 void disable_logging(void) {
-    logging_enable = FALSE;
+    __atomic_store_n(&logging_enable, FALSE, __ATOMIC_SEQ_CST);
+    chBSemSignal(&log_block_ready);
 }
 
 
-/* Log a CAN Packet */
-void log_can(uint16_t ID, bool RTR, uint8_t len, uint8_t* data) {
-    
-    DLPacket pkt = {
-        .ID = ID, .RTR = RTR,
-        .len = len, .timestamp = chVTGetSystemTime()};
-    memset(pkt.data,0,8);
-    memcpy(pkt.data,data,len);
-    _log(&pkt);
+/* Packets Dropped So Far */
+uint32_t logging_dropped(void) {
+    return log_dropped;
 }
 
 
+/* Log a CAN Packet
+ * Only called from the CAN receive thread, the ring's one producer.
+ */
+void log_can(uint16_t ID, bool RTR, uint8_t len, uint8_t* data) {
+
+    uint32_t head, next;
+    systime_t timestamp;
+
+    /* Mark the Frame as Being Stored, Then Check Logging Hasn't Stopped */
+    __atomic_store_n(&log_busy, TRUE, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&logging_enable, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&log_busy, FALSE, __ATOMIC_RELEASE);
+        return;
+    }
+
+    M3PROF_START(M3PROF_M3DL_LOG_PACKET);
+
+    /* When the frame's data was produced, in the common timebase of
+     * m3can_timesync: taken from the frame for those which carry it, and
+     * otherwise the time it was received here.
+     */
+    timestamp = m3can_timesync_now();
+
+    /* Accelerometer frames carry the low bits of their sample time */
+    if(ID == CAN_MSG_ID_M3FC_ACCEL && !RTR &&
+       len == sizeof(struct m3can_msg_m3fc_accel)) {
+        struct m3can_msg_m3fc_accel* accel =
+            (struct m3can_msg_m3fc_accel*)data;
+        timestamp = m3can_timesync_unwrap16(timestamp, accel->time);
+    }
+
+    /* Once the Block is Full, Hand it to the Datalogging Thread and Start
+     * the Next, Dropping the Frame if the Card Hasn't Kept Up
+     */
+    if (!logformat_add(&log_encoder, ID, RTR, len, data, timestamp)) {
+        head = log_head;
+        next = head + 1 < LOG_BLOCK_COUNT ? head + 1 : 0;
+        if (next == __atomic_load_n(&log_tail, __ATOMIC_ACQUIRE)) {
+            log_dropped++;
+        } else {
+            logformat_finish(&log_encoder);
+            __atomic_store_n(&log_head, next, __ATOMIC_RELEASE);
+            chBSemSignal(&log_block_ready);
+
+            logformat_begin(&log_encoder, log_ring[next], log_ring_ids[next]);
+            logformat_add(&log_encoder, ID, RTR, len, data, timestamp);
+        }
+    }
+
+    M3PROF_STOP(M3PROF_M3DL_LOG_PACKET);
+
+    __atomic_store_n(&log_busy, FALSE, __ATOMIC_RELEASE);
+}
@@ -7,6 +7,9 @@ void logging_init(void);
 /* Disable Logging */
 void disable_logging(void);
 
+/* Packets Dropped Because Logging Couldn't Keep Up */
+uint32_t logging_dropped(void);
+
 /* Main Datalogging Thread */
 void datalogging_thread(void* arg);
 
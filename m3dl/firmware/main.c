@@ -12,6 +12,10 @@
 
 #include "m3can.h"
 #include "m3status.h"
+#include "m3prof.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
+#include "m3can_bulk.h"
 
 #define LTC2983_ATTACHED        FALSE
 #define BAROMETERS_ATTACHED     FALSE
@@ -110,6 +114,17 @@ int main(void) {
 
     /* Turn on the CAN System, listen to all messages */
     m3can_init(CAN_ID_M3DL, NULL, 0);
+    m3prof_init();
+    m3monitor_init();
+    m3can_stats_init();
+
+    /* Accept the Si446x configuration from M3Radio. The frames are logged
+     * like any other, so the blob itself needn't be kept.
+     */
+    m3can_bulk_register_rx(M3CAN_BULK_PORT_SI446X_PARAMS, NULL, 0, NULL);
+
+    /* Likewise M3FC's full rate accelerometer capture from the launch */
+    m3can_bulk_register_rx(M3CAN_BULK_PORT_M3FC_ACCEL_BURST, NULL, 0, NULL);
         
     /* Enable CAN Feedback */
     m3can_set_loopback(TRUE);
@@ -18,6 +18,12 @@ static void microsd_card_deinit(void);
 /* Driver Working Area */
 static uint8_t sd_scratchpad[512];
 
+/* Cluster Link Map for Fast Seek in the Open File, Two Entries per
+ * Fragment of its Cluster Chain
+ */
+#define MICROSD_LINKMAP_SIZE 32
+static DWORD microsd_linkmap[MICROSD_LINKMAP_SIZE];
+
 /* SD Card Config */
 static const SDCConfig sdccfg = {
   sd_scratchpad,
@@ -151,11 +157,56 @@ SDRESULT microsd_open_file_inc(FIL* fp, const char* path, const char* ext, SDFS*
 SDRESULT microsd_close_file(SDFILE* fp) {
     
     SDRESULT sderr;
+
+    /* Cut a Preallocated File Back to What was Written */
+    if(fp->cltbl != NULL) {
+        fp->cltbl = NULL;
+        f_truncate(fp);
+    }
+
     sderr = f_close(fp);
     microsd_card_deinit();
     return sderr;
 }
 
+/* Preallocate <fp> up to <size> Bytes */
+SDRESULT microsd_preallocate(SDFILE* fp, DWORD size) {
+
+    SDRESULT sderr;
+    DWORD pos = f_tell(fp);
+
+    /* Seeking Past the End in Write Mode Allocates the Clusters, but Only
+     * Without Fast Seek. If the Card Fills Up the File Just Stops Short.
+     */
+    fp->cltbl = NULL;
+    sderr = f_lseek(fp, size);
+    if(sderr == FR_OK) {
+        sderr = f_lseek(fp, pos);
+    }
+
+    /* Put the FAT and New Size on the Card Before any Data Goes There */
+    if(sderr == FR_OK) {
+        sderr = f_sync(fp);
+    }
+
+    if(sderr != FR_OK) {
+        err(M3DL_ERROR_SD_CARD_WRITE);
+        m3status_set_error(M3DL_COMPONENT_SD_CARD, M3DL_ERROR_SD_CARD_WRITE);
+        return sderr;
+    }
+
+    /* Map the Clusters so Writes Find Them Without Reading the FAT. A File
+     * Too Fragmented for the Map Just Goes Without.
+     */
+    microsd_linkmap[0] = MICROSD_LINKMAP_SIZE;
+    fp->cltbl = microsd_linkmap;
+    if(f_lseek(fp, CREATE_LINKMAP) != FR_OK) {
+        fp->cltbl = NULL;
+    }
+
+    return FR_OK;
+}
+
 /* Write <btw> Bytes From <buf> to <fp> */
 SDRESULT microsd_write(SDFILE* fp, const char* buf, unsigned int btw) {
     
@@ -164,7 +215,6 @@ SDRESULT microsd_write(SDFILE* fp, const char* buf, unsigned int btw) {
 
     /* Write to SD Card */
     sderr = f_write(fp, (void*) buf, btw, &bytes_written);
-    f_sync(fp);
 
     /* Test for SD Card Space */
 	if(bytes_written < btw) {
@@ -180,3 +230,17 @@ SDRESULT microsd_write(SDFILE* fp, const char* buf, unsigned int btw) {
 	
     return sderr;
 }
+
+/* Flush <fp>'s Cached Data and Directory Entry to the Card */
+SDRESULT microsd_sync(SDFILE* fp) {
+
+    SDRESULT sderr;
+
+    sderr = f_sync(fp);
+    if(sderr != FR_OK) {
+		err(M3DL_ERROR_SD_CARD_WRITE);
+		m3status_set_error(M3DL_COMPONENT_SD_CARD, M3DL_ERROR_SD_CARD_WRITE);
+	}
+
+    return sderr;
+}
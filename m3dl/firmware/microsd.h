@@ -2,7 +2,8 @@
  * This is a non-thread-safe "device driver" for the micro sd card and file
  * system, pretty much acts as a file system access layer.
  *
- * Note: Assumes _LFN_UNICODE == 0 in FatFS config (ie. sizeof(TCHAR) == 1).
+ * Note: Assumes _LFN_UNICODE == 0 in FatFS config (ie. sizeof(TCHAR) == 1),
+ * and _USE_FASTSEEK == 1 for preallocated files.
  */
 
 #ifndef MICROSD_H
@@ -59,14 +60,31 @@ SDRESULT microsd_open_file(SDFILE* fp, const char* path, SDMODE mode,
 SDRESULT microsd_open_file_inc(SDFILE* fp, const char* path, const char* ext,
     SDFS* sd);
 
-/* Close file object <fp> */
+/* Close file object <fp>, truncating it to the file pointer if it was
+ * preallocated */
 SDRESULT microsd_close_file(SDFILE* fp);
 
+/* 
+ * Assumes file is open for writing.
+ * Allocates clusters for <fp> up to <size> bytes, or until disk is full,
+ * without moving the file pointer, and syncs the FAT. Writes within the
+ * allocation then only touch data sectors, using fast seek to find them.
+ * FatFs allocates the next free clusters, so on a card that has only been
+ * written sequentially the file is contiguous.
+ */
+
+SDRESULT microsd_preallocate(SDFILE* fp, DWORD size);
+
 /* 
  * Assumes file is open.
  * Writes exactly <btw> bytes from <buff> to <fp>, or until disk is full.
+ * Whole sectors from a word aligned buffer go straight to the card as
+ * multiple block writes. Doesn't sync, see microsd_sync.
  */
  
 SDRESULT microsd_write(SDFILE* fp, const char* buff, unsigned int btw);
 
+/* Flush cached data and the directory entry of <fp> to the card */
+SDRESULT microsd_sync(SDFILE* fp);
+
 #endif /* MICROSD_H */
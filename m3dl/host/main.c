@@ -0,0 +1,93 @@
+/*
+ * M3DL firmware as a Linux process on a virtual CAN bus
+ * See shared/m3host/README.md
+ *
+ * Logs every CAN frame through the unmodified logging and microsd modules,
+ * with the SD card being the working directory, so log_00001.bin and on
+ * appear there. On SIGINT/SIGTERM or at the end of M3HOST_DURATION logging
+ * is disabled and the logging thread flushes what it holds before exit.
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "logging.h"
+#include "err_handler.h"
+
+#include "m3can.h"
+#include "m3can_bulk.h"
+#include "m3host.h"
+#include "m3status.h"
+
+/* Packet Counter */
+static uint32_t pkt_rate;
+
+/* Heartbeat Thread */
+static THD_WORKING_AREA(hbt_wa, 128);
+static THD_FUNCTION(hbt_thd, arg) {
+
+    (void)arg;
+    chRegSetThreadName("Heartbeat");
+
+    while (true) {
+
+        /* Flash HBT LED */
+        palSetPad(GPIOB, GPIOB_LED1_GREEN);
+        chThdSleepMilliseconds(100);
+        palClearPad(GPIOB, GPIOB_LED1_GREEN);
+        chThdSleepMilliseconds(900);
+
+        /* Send Current Packet Rate */
+        m3can_send(CAN_MSG_ID_M3DL_RATE, FALSE, (uint8_t*)(&pkt_rate), 4);
+
+        /* Reset Packet Rate Counter */
+        pkt_rate = 0;
+    }
+}
+
+/* Function Called on CAN Packet Reception */
+void m3can_recv(uint16_t ID, bool RTR, uint8_t* data, uint8_t len) {
+
+    /* Log Incoming CAN Packet */
+    log_can(ID, RTR, len, data);
+
+    /* Update Packet Rate */
+    pkt_rate += 1;
+}
+
+int main(void) {
+    m3host_init("m3dl");
+
+    halInit();
+    chSysInit();
+
+    /* Turn on the CAN System, listen to all messages. The firmware starts
+     * logging first, but here the "card" is ready at once and the logging
+     * thread would report to m3status before CAN is up.
+     */
+    m3can_init(CAN_ID_M3DL, NULL, 0);
+    m3can_bulk_register_rx(M3CAN_BULK_PORT_SI446X_PARAMS, NULL, 0, NULL);
+    m3can_bulk_register_rx(M3CAN_BULK_PORT_M3FC_ACCEL_BURST, NULL, 0, NULL);
+
+    /* Datalogging Init */
+    logging_init();
+
+    /* Init Heartbeat */
+    chThdCreateStatic(hbt_wa, sizeof(hbt_wa), NORMALPRIO, hbt_thd, NULL);
+
+    /* Enable CAN Feedback */
+    m3can_set_loopback(TRUE);
+
+    m3status_set_init(M3DL_COMPONENT_SD_CARD);
+
+    while(!m3host_should_stop()) {
+        chThdSleepMilliseconds(100);
+    }
+
+    /* Flush the log ring to the log file before exiting */
+    disable_logging();
+    if(!m3host_join("Datalogging", MS2ST(1000))) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,542 @@
+/*
+ * Log format test and benchmark
+ * M3DL
+ * Cambridge University Spaceflight
+ *
+ * Encodes frames with the firmware's encoder and checks the decoder gives
+ * every one back unchanged: a recorded version 1 log given on the command
+ * line, and a synthetic flight with the accelerometer at 1kHz and the
+ * barometer and state estimates at 100Hz, plus remote frames, frames of
+ * unexpected lengths and IDs with no schema, timestamps that step back and
+ * jump, and readings that wrap. Checks each is at most half the size of
+ * version 1, and that corrupt blocks, blocks from another file and blocks
+ * out of order are all rejected.
+ *
+ * Then writes a ten minute log with its index blocks and footer, and checks
+ * logreader gives exactly the frames in a time range or with given IDs
+ * while reading only a few of its blocks, with and without the footer.
+ *
+ * Then times encoding and decoding.
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "m3can.h"
+#include "logformat.h"
+#include "logreader.h"
+
+#define FLIGHT_MS       (20000)
+#define LONG_MS         (600000)
+#define V1_RECORD       (16)
+#define TEST_FILE       "logformat_test.bin"
+
+static int failures;
+
+static void check(const char* name, bool ok)
+{
+    if(!ok) {
+        failures++;
+    }
+    printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+}
+
+static uint32_t lcg = 1;
+static uint32_t rnd(uint32_t n)
+{
+    lcg = lcg * 1103515245 + 12345;
+    return (lcg >> 16) % n;
+}
+
+static struct logformat_frame* frames;
+static uint32_t num_frames, max_frames;
+
+static void add(uint16_t sid, bool rtr, uint8_t len, const void* data,
+                uint32_t timestamp)
+{
+    if(num_frames == max_frames) {
+        max_frames = max_frames ? 2 * max_frames : 4096;
+        frames = realloc(frames, max_frames * sizeof(*frames));
+    }
+    struct logformat_frame* f = &frames[num_frames++];
+    memset(f, 0, sizeof(*f));
+    f->sid = sid;
+    f->rtr = rtr;
+    f->len = len;
+    if(!rtr) {
+        memcpy(f->data, data, len);
+    }
+    f->timestamp = timestamp;
+}
+
+/* Encode every frame into blocks as M3DL writes them: schema first, index
+ * blocks after every region, then the footer. Returns how many.
+ */
+static uint8_t* blocks;
+static struct logformat_index idx;
+static uint8_t ids[LOGFORMAT_ID_BYTES];
+
+static uint8_t* block_at(uint32_t n)
+{
+    return blocks + (size_t)n * LOGFORMAT_BLOCK_SIZE;
+}
+
+/* Seal the data block at <n>, and the index block after it if due */
+static uint32_t end_block(struct logformat_encoder* enc, uint32_t session,
+                          uint32_t n)
+{
+    logformat_finish(enc);
+    bool full = logformat_index_add(&idx, enc->block, ids);
+    logformat_seal(enc->block, session, n++);
+    if(full) {
+        logformat_index_block(&idx, block_at(n));
+        logformat_seal(block_at(n), session, n);
+        n++;
+    }
+    return n;
+}
+
+static uint32_t encode(uint32_t session)
+{
+    struct logformat_encoder enc;
+    uint32_t n = 1;
+
+    /* Every block holds at least a hundred frames */
+    free(blocks);
+    blocks = malloc((size_t)(num_frames / 50 + 4) * LOGFORMAT_BLOCK_SIZE);
+    logformat_schema_block(blocks);
+    logformat_seal(blocks, session, 0);
+    logformat_index_init(&idx);
+
+    logformat_begin(&enc, block_at(n), ids);
+    for(uint32_t i=0; i<num_frames; i++) {
+        const struct logformat_frame* f = &frames[i];
+        if(!logformat_add(&enc, f->sid, f->rtr, f->len, f->data,
+                          f->timestamp)) {
+            n = end_block(&enc, session, n);
+            logformat_begin(&enc, block_at(n), ids);
+            logformat_add(&enc, f->sid, f->rtr, f->len, f->data,
+                          f->timestamp);
+        }
+    }
+    n = end_block(&enc, session, n);
+    logformat_footer_block(&idx, block_at(n));
+    logformat_seal(block_at(n), session, n);
+    return n + 1;
+}
+
+/* Decode <n> blocks, checking them against the frames */
+static uint32_t decoded, wrong;
+static void compare(const struct logformat_frame* f, void* arg)
+{
+    (void)arg;
+    const struct logformat_frame* e = &frames[decoded];
+    if(decoded >= num_frames || f->sid != e->sid || f->rtr != e->rtr ||
+       f->len != e->len || f->timestamp != e->timestamp ||
+       memcmp(f->data, e->data, 8) != 0) {
+        if(wrong++ < 5) {
+            printf("  frame %u: %03x len %u t %u, expected %03x len %u t %u\n",
+                   (unsigned)decoded, f->sid, f->len, (unsigned)f->timestamp,
+                   e->sid, e->len, (unsigned)e->timestamp);
+        }
+    }
+    decoded++;
+}
+
+static int decode(const uint8_t* data, uint32_t n)
+{
+    static struct logformat_decoder dec;
+    int rv = LOGFORMAT_OK;
+
+    logformat_decoder_init(&dec);
+    decoded = 0;
+    wrong = 0;
+    for(uint32_t i=0; i<n && rv == LOGFORMAT_OK; i++) {
+        rv = logformat_decode_block(&dec, data + (size_t)i *
+                                    LOGFORMAT_BLOCK_SIZE, compare, NULL);
+    }
+    return rv;
+}
+
+static void check_round_trip(const char* name)
+{
+    uint32_t n = encode(1234);
+    int rv = decode(blocks, n);
+    /* The schema and footer are once per file, not per frame */
+    double ratio = (double)num_frames * V1_RECORD /
+                   ((double)(n - 2) * LOGFORMAT_BLOCK_SIZE);
+    char label[64];
+
+    snprintf(label, sizeof(label), "%s: %u frames", name,
+             (unsigned)num_frames);
+    check(label, rv == LOGFORMAT_OK && decoded == num_frames && wrong == 0);
+    snprintf(label, sizeof(label), "%s: %.2fx smaller than v1",
+             name, ratio);
+    check(label, ratio >= 2.0);
+}
+
+/* A recorded version 1 log */
+static bool load_log(const char* path)
+{
+    struct logreader r;
+    struct logformat_frame f;
+
+    num_frames = 0;
+    if(logreader_open(&r, path) != 0) {
+        perror(path);
+        return false;
+    }
+    while(logreader_next(&r, &f)) {
+        add(f.sid, f.rtr, f.len, f.data, f.timestamp);
+    }
+    logreader_close(&r);
+    return r.version == 1 && num_frames > 0;
+}
+
+/* A noisy reading around <v> */
+static int32_t noisy(int32_t v, int32_t noise)
+{
+    return v + (int32_t)rnd(2 * noise + 1) - noise;
+}
+
+static void make_flight(void)
+{
+    uint32_t t0 = 0xFFFF0000UL;
+    int32_t pressure = 101325, temperature = 2150;
+    float h = 0.0f;
+
+    num_frames = 0;
+    for(uint32_t ms=0; ms<FLIGHT_MS; ms++) {
+        uint32_t t = t0 + ms * 10;
+
+        /* Accelerometer, saturating and wrapping through a burn */
+        struct m3can_msg_m3fc_accel a = {
+            .x = noisy(0, 3), .y = noisy(0, 3), .z = noisy(256, 4),
+            .time = (uint16_t)t,
+        };
+        if(ms > 5000 && ms < 8000) {
+            a.z = ms % 2 ? 32767 : -32768;
+        }
+        add(CAN_MSG_ID_M3FC_ACCEL, false, sizeof(a), &a, t);
+
+        if(ms % 10 == 0) {
+            pressure -= ms > 5000 && ms < 15000 ? 8 : 0;
+            struct m3can_msg_m3fc_baro b = {
+                .temperature = noisy(temperature, 2),
+                .pressure = noisy(pressure, 20),
+            };
+            add(CAN_MSG_ID_M3FC_BARO, false, sizeof(b), &b, t + rnd(20));
+
+            h += 1.5f;
+            struct m3can_msg_m3fc_se_t_h s = {.dt = 0.01f, .h = h};
+            add(CAN_MSG_ID_M3FC_SE_T_H, false, sizeof(s), &s, t + 3);
+
+            /* Pressures from the datalogger's own clock, a little behind */
+            uint16_t p[4] = {noisy(81, 1), noisy(82, 1), 80, noisy(81, 1)};
+            add(CAN_MSG_ID_M3DL_PRESSURE, false, sizeof(p), p, t - 40);
+        }
+
+        if(ms % 1000 == 0) {
+            /* Status in error with detail, a remote frame, no schema and a
+             * short accelerometer frame */
+            uint8_t st[8] = {2, 1, 2, 7, 1, 2, 3, 4};
+            add(CAN_ID_M3PSU | CAN_MSG_ID_STATUS, false, 8, st, t);
+            add(CAN_ID_M3FC | CAN_MSG_ID_STATUS, true, 0, NULL, t);
+            add(CAN_ID_M3PYRO | CAN_MSG_ID_STATUS, true, 3, NULL, t);
+            add(0x7FF, false, 5, st, t + 1);
+            add(CAN_MSG_ID_M3FC_ACCEL, false, 6, &st, t + 1);
+        }
+
+        if(ms == 12000) {
+            /* Time sync moving the clock a long way */
+            t0 += 0x80000000UL;
+        }
+    }
+}
+
+static void check_rejects(void)
+{
+    static struct logformat_decoder dec;
+    uint32_t n = encode(99);
+    size_t bs = LOGFORMAT_BLOCK_SIZE;
+    uint8_t* copy = malloc(n * bs);
+    struct logformat_header h;
+
+    /* One flipped bit anywhere */
+    memcpy(copy, blocks, n * bs);
+    copy[3 * bs + 1000] ^= 0x10;
+    check("corrupt block rejected", decode(copy, n) == LOGFORMAT_BAD_CRC &&
+          decoded < num_frames && wrong == 0);
+
+    /* A block of another file written at this one's place, as after a
+     * power loss */
+    memcpy(copy, blocks, n * bs);
+    memcpy(&h, blocks + 2 * bs, sizeof(h));
+    logformat_seal(copy + 2 * bs, 100, h.sequence);
+    check("block from another file rejected",
+          decode(copy, n) == LOGFORMAT_BAD_SESSION);
+
+    /* A block missing */
+    check("block out of sequence rejected",
+          decode(blocks + bs, n - 1) == LOGFORMAT_BAD_SEQUENCE);
+
+    /* Blocks of a file missing its schema */
+    logformat_decoder_init(&dec);
+    dec.session = 99;
+    dec.sequence = 1;
+    check("data before schema rejected",
+          logformat_decode_block(&dec, blocks + bs, compare, NULL) ==
+          LOGFORMAT_NO_SCHEMA);
+
+    free(copy);
+}
+
+/* Ten minutes on the pad and in flight, with the clock only moving
+ * forward: the accelerometer at 1kHz, barometer and state estimates at
+ * 100Hz, status once a second, a fire command half way through and one
+ * frame with no schema entry.
+ */
+static void make_long(void)
+{
+    uint8_t fire[8] = {1, 0, 0, 0, 0, 0, 0, 0};
+    uint8_t st[8] = {0};
+
+    num_frames = 0;
+    for(uint32_t ms=0; ms<LONG_MS; ms++) {
+        uint32_t t = 1000 + ms * 10;
+        struct m3can_msg_m3fc_accel a = {
+            .x = noisy(0, 3), .y = noisy(0, 3), .z = noisy(256, 4),
+            .time = (uint16_t)t,
+        };
+        add(CAN_MSG_ID_M3FC_ACCEL, false, sizeof(a), &a, t);
+
+        if(ms % 10 == 0) {
+            struct m3can_msg_m3fc_baro b = {
+                .temperature = noisy(2150, 2), .pressure = noisy(101325, 20),
+            };
+            add(CAN_MSG_ID_M3FC_BARO, false, sizeof(b), &b, t + rnd(20));
+            struct m3can_msg_m3fc_se_t_h s = {.dt = 0.01f, .h = ms * 0.1f};
+            add(CAN_MSG_ID_M3FC_SE_T_H, false, sizeof(s), &s, t + 3);
+        }
+        if(ms % 1000 == 0) {
+            add(CAN_ID_M3PSU | CAN_MSG_ID_STATUS, false, 3, st, t);
+        }
+        if(ms >= 300000 && ms < 300500 && ms % 100 == 0) {
+            add(CAN_MSG_ID_M3PYRO_FIRE_COMMAND, false, 8, fire, t + 5);
+        }
+        if(ms == 450000) {
+            add(0x7FF, false, 2, st, t + 5);
+        }
+    }
+}
+
+/* Read the file through logreader with a selection, checking it gives
+ * exactly the frames selected and stops with <expect_error>, and returning
+ * how many blocks it read
+ */
+static int expect_error = LOGFORMAT_OK;
+static uint32_t check_select(const char* name, uint32_t start, uint32_t end,
+                             const uint16_t* sids, int num_sids,
+                             uint32_t* selected)
+{
+    static struct logreader r;
+    static uint8_t want[LOGFORMAT_ID_BYTES];
+    struct logformat_frame f;
+    uint32_t i = 0, n = 0, bad = 0;
+    char label[64];
+
+    memset(want, 0, sizeof(want));
+    for(int j=0; j<num_sids; j++) {
+        want[sids[j] / 8] |= 1 << (sids[j] % 8);
+    }
+    if(logreader_open(&r, TEST_FILE) != 0) {
+        perror(TEST_FILE);
+        return UINT32_MAX;
+    }
+    logreader_select(&r, start, end, num_sids ? want : NULL);
+    while(logreader_next(&r, &f)) {
+        /* The next frame the selection should give */
+        for(; i<num_frames; i++) {
+            const struct logformat_frame* e = &frames[i];
+            if(e->timestamp >= start && e->timestamp <= end &&
+               (!num_sids || (want[e->sid / 8] & (1 << (e->sid % 8))))) {
+                break;
+            }
+        }
+        if(i == num_frames || memcmp(&f, &frames[i], sizeof(f)) != 0) {
+            bad++;
+        }
+        i++;
+        n++;
+    }
+    for(; i<num_frames; i++) {
+        const struct logformat_frame* e = &frames[i];
+        if(e->timestamp >= start && e->timestamp <= end &&
+           (!num_sids || (want[e->sid / 8] & (1 << (e->sid % 8))))) {
+            bad++;
+        }
+    }
+    logreader_close(&r);
+
+    snprintf(label, sizeof(label), "%s: %u frames, %u blocks read", name,
+             (unsigned)n, (unsigned)r.blocks);
+    check(label, bad == 0 && r.error == expect_error);
+    *selected = n;
+    return r.blocks;
+}
+
+static bool write_file(uint32_t n, uint32_t zeros)
+{
+    static uint8_t zero[LOGFORMAT_BLOCK_SIZE];
+    FILE* f = fopen(TEST_FILE, "wb");
+    bool ok = f != NULL &&
+              fwrite(blocks, LOGFORMAT_BLOCK_SIZE, n, f) == n;
+    for(uint32_t i=0; ok && i<zeros; i++) {
+        ok = fwrite(zero, sizeof(zero), 1, f) == 1;
+    }
+    if(f != NULL) {
+        ok = fclose(f) == 0 && ok;
+    }
+    if(!ok) {
+        perror(TEST_FILE);
+    }
+    return ok;
+}
+
+static void check_seek(void)
+{
+    const uint16_t fire[] = {CAN_MSG_ID_M3PYRO_FIRE_COMMAND};
+    const uint16_t other[] = {0x7FF};
+    const uint16_t never[] = {CAN_MSG_ID_M3PYRO_ARM_COMMAND};
+    const uint16_t psu[] = {CAN_ID_M3PSU | CAN_MSG_ID_STATUS};
+    uint32_t n, got, blocks_read;
+    char label[64];
+
+    make_long();
+    n = encode(4321);
+    struct logformat_header h;
+    memcpy(&h, block_at(n - 1), sizeof(h));
+    snprintf(label, sizeof(label), "long log: %u blocks, %u regions",
+             (unsigned)n, (unsigned)(n / LOGFORMAT_INDEX_INTERVAL + 1));
+    check(label, h.type == LOGFORMAT_BLOCK_FOOTER &&
+          n > 8 * LOGFORMAT_INDEX_INTERVAL);
+    if(!write_file(n, 0)) {
+        failures++;
+        return;
+    }
+
+    blocks_read = check_select("whole log", 0, UINT32_MAX, NULL, 0, &got);
+    check("  every block read once", blocks_read == n &&
+          got == num_frames);
+
+    /* A second of flight is a few blocks, found in about log2(regions) */
+    blocks_read = check_select("one second", 3001000, 3011000, NULL, 0, &got);
+    check("  found by binary search", got > 1000 && blocks_read <= 12);
+
+    blocks_read = check_select("fire command", 0, UINT32_MAX, fire, 1, &got);
+    check("  only its region read", got == 5 &&
+          blocks_read <= LOGFORMAT_INDEX_INTERVAL + 3);
+
+    blocks_read = check_select("no schema", 0, UINT32_MAX, other, 1, &got);
+    check("  only its region read", got == 1 &&
+          blocks_read <= LOGFORMAT_INDEX_INTERVAL + 3);
+
+    blocks_read = check_select("never logged", 0, UINT32_MAX, never, 1, &got);
+    check("  nothing read", got == 0 && blocks_read <= 2);
+
+    blocks_read = check_select("status, one minute", 1001000, 1601000, psu, 1,
+                               &got);
+    check("  time and IDs together", got == 61 &&
+          blocks_read < 4 * LOGFORMAT_INDEX_INTERVAL);
+
+    /* After a power loss: no footer, and the rest of the preallocated file
+     * zeros, where reading stops if it gets that far */
+    if(!write_file(n - 1, 2 * LOGFORMAT_INDEX_INTERVAL)) {
+        failures++;
+        return;
+    }
+    expect_error = LOGFORMAT_OK;
+    blocks_read = check_select("no footer, one second", 3001000, 3011000,
+                               NULL, 0, &got);
+    check("  found by binary search", got > 1000 && blocks_read <= 14);
+    /* The last region has no index, so is read through */
+    expect_error = LOGFORMAT_BAD_HEADER;
+    blocks_read = check_select("no footer, fire command", 0, UINT32_MAX,
+                               fire, 1, &got);
+    check("  only its region and the last read", got == 5 &&
+          blocks_read <= 2 * LOGFORMAT_INDEX_INTERVAL +
+                         n / LOGFORMAT_INDEX_INTERVAL + 2);
+    expect_error = LOGFORMAT_OK;
+
+    remove(TEST_FILE);
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench(void)
+{
+    const int reps = 20;
+    double t0, t_enc, t_dec;
+    uint32_t n = 0;
+
+    t0 = now_s();
+    for(int i=0; i<reps; i++) {
+        n = encode(i);
+    }
+    t_enc = now_s() - t0;
+
+    t0 = now_s();
+    for(int i=0; i<reps; i++) {
+        decode(blocks, n);
+    }
+    t_dec = now_s() - t0;
+
+    printf("Flight, %u frames in %u blocks:\n", (unsigned)num_frames,
+           (unsigned)n);
+    printf("  encode %6.1fns/frame\n", t_enc * 1e9 / reps / num_frames);
+    printf("  decode %6.1fns/frame, %.0fMB/s of log\n",
+           t_dec * 1e9 / reps / num_frames,
+           (double)n * LOGFORMAT_BLOCK_SIZE * reps / t_dec / 1e6);
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc >= 2) {
+        bool loaded = load_log(argv[1]);
+        check("recorded log loaded", loaded);
+        if(loaded) {
+            check_round_trip("recorded log");
+        }
+    }
+
+    make_flight();
+    check_round_trip("synthetic flight");
+    check_rejects();
+
+    if(argc < 3 || strcmp(argv[2], "-q") != 0) {
+        bench();
+    }
+
+    check_seek();
+
+    free(frames);
+    free(blocks);
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
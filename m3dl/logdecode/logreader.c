@@ -0,0 +1,348 @@
+/*
+ * M3DL log file reader
+ * See logreader.h.
+ */
+
+#include <string.h>
+
+#include "logreader.h"
+
+/* Version 1 record */
+struct logreader_v1 {
+    uint16_t sid;
+    uint8_t rtr;
+    uint8_t len;
+    uint8_t data[8];
+    uint32_t timestamp;
+} __attribute__((packed));
+
+static void logreader_store(const struct logformat_frame* frame, void* arg);
+
+/* Read and check block <seq>, passing any frames to <cb>. Returns a
+ * LOGFORMAT_* result, or 1 past the end of the file.
+ */
+static int logreader_read(struct logreader* r, uint32_t seq,
+                          logformat_frame_cb cb)
+{
+    size_t got;
+
+    if(seq != r->at + 1 &&
+       fseek(r->f, (long)seq * LOGFORMAT_BLOCK_SIZE, SEEK_SET) != 0) {
+        return 1;
+    }
+    r->at = seq;
+    got = fread(r->block, 1, LOGFORMAT_BLOCK_SIZE, r->f);
+    if(got == 0) {
+        return 1;
+    } else if(got < LOGFORMAT_BLOCK_SIZE) {
+        return LOGFORMAT_BAD_HEADER;
+    }
+    r->blocks++;
+    r->dec.sequence = seq;
+    return logformat_decode_block(&r->dec, r->block, cb, r);
+}
+
+/* Read the index or footer block <seq> into <info>, returning whether it
+ * is one */
+static bool logreader_read_index(struct logreader* r, uint32_t seq,
+                                 uint8_t type,
+                                 struct logformat_index_info* info)
+{
+    const struct logformat_header* h = (struct logformat_header*)r->block;
+    return seq < r->file_blocks &&
+           logreader_read(r, seq, logreader_store) == LOGFORMAT_OK &&
+           h->type == type &&
+           logformat_read_index(r->block, info) == LOGFORMAT_OK;
+}
+
+int logreader_open(struct logreader* r, const char* path)
+{
+    uint32_t magic;
+    long size;
+
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if(r->f == NULL) {
+        return -1;
+    }
+
+    if(fread(&magic, sizeof(magic), 1, r->f) == 1 &&
+       magic == LOGFORMAT_MAGIC) {
+        r->version = LOGFORMAT_VERSION;
+    } else {
+        r->version = 1;
+    }
+    logformat_decoder_init(&r->dec);
+    r->end = UINT32_MAX;
+    r->last_region = UINT32_MAX;
+
+    if(r->version == 1 || fseek(r->f, 0, SEEK_END) != 0 ||
+       (size = ftell(r->f)) < 0) {
+        rewind(r->f);
+        return 0;
+    }
+    r->file_blocks = size / LOGFORMAT_BLOCK_SIZE;
+
+    /* The schema, then the footer if there is one */
+    rewind(r->f);
+    r->at = UINT32_MAX;
+    r->error = logreader_read(r, 0, logreader_store);
+    if(r->error == 1) {
+        r->error = LOGFORMAT_OK;
+        r->done = true;
+    }
+    if(r->error == LOGFORMAT_OK && r->file_blocks > 1) {
+        r->have_footer = logreader_read_index(r, r->file_blocks - 1,
+                                              LOGFORMAT_BLOCK_FOOTER,
+                                              &r->footer);
+    }
+    return 0;
+}
+
+/* First region to read from for the selected IDs, with the footer */
+static void logreader_select_ids(struct logreader* r)
+{
+    const struct logformat_index_info* ft = &r->footer;
+    uint32_t first = UINT32_MAX, last = 0;
+    int i, j;
+
+    for(i=0; i<2048; i++) {
+        uint16_t sid = i;
+        if(!(r->ids[i / 8] & (1 << (i % 8)))) {
+            continue;
+        }
+        /* IDs outside the file's schema share one entry */
+        if(r->dec.length[i] > 8) {
+            sid = LOGFORMAT_OTHER_IDS;
+        }
+        for(j=0; j<ft->h.ids; j++) {
+            if(ft->regions[j].sid == sid) {
+                if(ft->regions[j].first < first) {
+                    first = ft->regions[j].first;
+                }
+                if(ft->regions[j].last > last) {
+                    last = ft->regions[j].last;
+                }
+            }
+        }
+    }
+
+    if(first == UINT32_MAX) {
+        r->done = true;
+    } else {
+        if(first > r->region) {
+            r->region = first;
+        }
+        r->last_region = last;
+    }
+}
+
+void logreader_select(struct logreader* r, uint32_t start, uint32_t end,
+                      const uint8_t* ids)
+{
+    struct logformat_index_info* info = &r->index;
+    uint32_t lo = 0, hi, mid;
+
+    r->select = true;
+    r->start = start;
+    r->end = end;
+    r->select_ids = ids != NULL;
+    if(ids != NULL) {
+        memcpy(r->ids, ids, LOGFORMAT_ID_BYTES);
+    }
+    if(r->version == 1 || r->error != LOGFORMAT_OK) {
+        return;
+    }
+
+    /* First region whose index shows the file reached <start> by its end,
+     * or the last region */
+    if(r->have_footer) {
+        hi = r->footer.h.region;
+    } else {
+        hi = (r->file_blocks - 1) / LOGFORMAT_INDEX_INTERVAL;
+    }
+    while(start > 0 && lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if(!logreader_read_index(r, LOGFORMAT_REGION_INDEX(mid),
+                                 LOGFORMAT_BLOCK_INDEX, info) ||
+           info->h.file_max >= start) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    r->region = lo;
+
+    if(r->select_ids && r->have_footer) {
+        logreader_select_ids(r);
+    }
+}
+
+void logreader_close(struct logreader* r)
+{
+    if(r->f != NULL) {
+        fclose(r->f);
+        r->f = NULL;
+    }
+}
+
+static bool logreader_selected(const struct logreader* r,
+                               const struct logformat_frame* frame)
+{
+    return !r->select ||
+           (frame->timestamp >= r->start && frame->timestamp <= r->end &&
+            (!r->select_ids ||
+             (r->ids[frame->sid / 8] & (1 << (frame->sid % 8)))));
+}
+
+static void logreader_store(const struct logformat_frame* frame, void* arg)
+{
+    struct logreader* r = arg;
+    if(logreader_selected(r, frame)) {
+        r->frames[r->n++] = *frame;
+    }
+}
+
+/* Whether the region's index shows none of the selected IDs */
+static bool logreader_skip_region(const struct logreader* r)
+{
+    int i;
+    if(!r->select_ids) {
+        return false;
+    }
+    for(i=0; i<LOGFORMAT_ID_BYTES; i++) {
+        if(r->index.ids[i] & r->ids[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Number of the next data block to read, or 0 at the end */
+static uint32_t logreader_plan(struct logreader* r)
+{
+    uint32_t i;
+
+    while(!r->done) {
+        /* Look up each region's index as it is reached */
+        if(!r->region_ready) {
+            if(r->region > r->last_region) {
+                break;
+            }
+            if(r->have_footer && r->region == r->footer.h.region) {
+                r->index = r->footer;
+                r->have_index = true;
+            } else {
+                r->have_index = r->select &&
+                    logreader_read_index(r, LOGFORMAT_REGION_INDEX(r->region),
+                                         LOGFORMAT_BLOCK_INDEX, &r->index) &&
+                    r->index.h.region == r->region;
+            }
+            r->region_ready = true;
+            r->next_block = 0;
+            if(r->have_index && logreader_skip_region(r)) {
+                r->region++;
+                r->region_ready = false;
+                continue;
+            }
+        }
+
+        /* Skip data blocks wholly before the range, and end at the first
+         * after it. Without an index, read them all. */
+        if(r->have_index) {
+            while(r->next_block < r->index.h.blocks) {
+                i = r->next_block++;
+                if(r->index.times[i][0] > r->end) {
+                    r->done = true;
+                    return 0;
+                }
+                if(r->index.times[i][1] >= r->start) {
+                    return LOGFORMAT_REGION_START(r->region) + i;
+                }
+            }
+            if(r->index.h.blocks < LOGFORMAT_INDEX_BLOCKS) {
+                break;
+            }
+        } else if(r->next_block < LOGFORMAT_INDEX_BLOCKS) {
+            return LOGFORMAT_REGION_START(r->region) + r->next_block++;
+        }
+        r->region++;
+        r->region_ready = false;
+    }
+
+    r->done = true;
+    return 0;
+}
+
+/* Decode blocks until one holds frames. Returns 0 at the end. */
+static int logreader_fill(struct logreader* r)
+{
+    const struct logformat_header* h = (struct logformat_header*)r->block;
+    uint32_t seq;
+    int rv;
+
+    r->n = 0;
+    r->next = 0;
+    while(r->n == 0 && r->error == LOGFORMAT_OK) {
+        seq = logreader_plan(r);
+        if(seq == 0) {
+            return 0;
+        }
+        rv = logreader_read(r, seq, logreader_store);
+        if(rv == 1) {
+            r->done = true;
+            return 0;
+        }
+        r->error = rv;
+        if(rv == LOGFORMAT_OK && h->type == LOGFORMAT_BLOCK_DATA &&
+           h->min_timestamp > r->end) {
+            r->done = true;
+        }
+    }
+    return r->n;
+}
+
+int logreader_next(struct logreader* r, struct logformat_frame* frame)
+{
+    if(r->version == 1) {
+        struct logreader_v1 p;
+        do {
+            if(fread(&p, sizeof(p), 1, r->f) != 1) {
+                return 0;
+            }
+            frame->sid = p.sid;
+            frame->rtr = p.rtr != 0;
+            frame->len = p.len <= 8 ? p.len : 8;
+            memcpy(frame->data, p.data, 8);
+            frame->timestamp = p.timestamp;
+        } while(!logreader_selected(r, frame));
+        return 1;
+    }
+
+    if(r->next == r->n && logreader_fill(r) == 0) {
+        return 0;
+    }
+    *frame = r->frames[r->next++];
+    return 1;
+}
+
+const char* logreader_strerror(int error)
+{
+    switch(error) {
+    case LOGFORMAT_OK:
+        return "ok";
+    case LOGFORMAT_BAD_HEADER:
+        return "not a log block";
+    case LOGFORMAT_BAD_CRC:
+        return "bad CRC";
+    case LOGFORMAT_BAD_SESSION:
+        return "block from another file";
+    case LOGFORMAT_BAD_SEQUENCE:
+        return "block out of sequence";
+    case LOGFORMAT_BAD_RECORD:
+        return "bad record";
+    case LOGFORMAT_NO_SCHEMA:
+        return "no schema block";
+    }
+    return "unknown error";
+}
@@ -0,0 +1,85 @@
+/*
+ * M3DL log file reader
+ *
+ * Reads frames from a log file of either version in order, for the host
+ * tools. Stops at the end of the file, or at the first block that doesn't
+ * belong to it, such as the unused end of a preallocated file after a power
+ * loss.
+ *
+ * logreader_select limits reading to a time range and set of IDs. For
+ * version 2 logs the index blocks are used to go straight to the first
+ * block with frames after the start, by binary search, and to skip regions
+ * without the IDs wanted; with a footer, reading also starts at the first
+ * region any of them were logged in and stops after the last. Reading stops
+ * at the first block starting after the end of the range, so a log whose
+ * clock stepped back into the range later is cut short there. Version 1
+ * logs are filtered frame by frame.
+ */
+
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "logformat.h"
+
+/* Most records one block can hold */
+#define LOGREADER_MAX_FRAMES    (LOGFORMAT_BLOCK_SIZE / 2)
+
+struct logreader {
+    FILE* f;
+    int version;
+    /* Why reading stopped before the end of the file, LOGFORMAT_OK if it
+     * didn't */
+    int error;
+    /* For version 2: blocks read, the number of the last, and how many
+     * the file has */
+    uint32_t blocks;
+    uint32_t at;
+    uint32_t file_blocks;
+    struct logformat_decoder dec;
+    uint8_t block[LOGFORMAT_BLOCK_SIZE];
+    struct logformat_frame frames[LOGREADER_MAX_FRAMES];
+    int n, next;
+
+    /* Selection, see logreader_select */
+    bool select;
+    uint32_t start, end;
+    bool select_ids;
+    uint8_t ids[LOGFORMAT_ID_BYTES];
+
+    /* Where reading has got to: the region, whether it has been looked up
+     * and has an index, the next data block in it, and the last region to
+     * read */
+    uint32_t region;
+    bool region_ready;
+    bool have_index;
+    uint32_t next_block;
+    uint32_t last_region;
+    bool done;
+    struct logformat_index_info index;
+
+    /* The footer, if the file was closed cleanly */
+    bool have_footer;
+    struct logformat_index_info footer;
+};
+
+/* Open <path>, returning 0, or -1 with errno set */
+int logreader_open(struct logreader* r, const char* path);
+
+/* Only read frames timestamped from <start> to <end> inclusive, and if
+ * <ids> isn't NULL, with IDs set in that bitmap. Call before reading.
+ */
+void logreader_select(struct logreader* r, uint32_t start, uint32_t end,
+                      const uint8_t* ids);
+
+/* Read the next frame into <frame>, returning 1, or 0 at the end */
+int logreader_next(struct logreader* r, struct logformat_frame* frame);
+
+void logreader_close(struct logreader* r);
+
+/* Description of a LOGFORMAT_* result */
+const char* logreader_strerror(int error);
+
+#endif /* LOGREADER_H */
@@ -0,0 +1,221 @@
+/*
+ * M3DL log file converter
+ *
+ * m3dl_logdecode <log> <out>
+ *     Decodes a log of either version to version 1 records, which the older
+ *     tools read, or to stdout if <out> is -.
+ * m3dl_logdecode -e <log> <out>
+ *     Encodes a log to the current version as M3DL would have written it.
+ *
+ * Either way, only frames from -s <start> to -t <end> seconds, and with
+ * -i <ID>[,<ID>...], only those IDs, are converted. Indexed logs are only
+ * read where they can hold such frames.
+ *
+ * Reports the frames read and anything that stopped it early on stderr.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logformat.h"
+#include "logreader.h"
+
+struct v1_record {
+    uint16_t sid;
+    uint8_t rtr;
+    uint8_t len;
+    uint8_t data[8];
+    uint32_t timestamp;
+} __attribute__((packed));
+
+static uint8_t block[LOGFORMAT_BLOCK_SIZE];
+static uint8_t block_ids[LOGFORMAT_ID_BYTES];
+static struct logformat_index idx;
+
+static bool write_block(FILE* out, uint32_t session, uint32_t* sequence)
+{
+    logformat_seal(block, session, (*sequence)++);
+    return fwrite(block, sizeof(block), 1, out) == 1;
+}
+
+/* Write the finished data block, then its region's index block if due */
+static bool write_data(FILE* out, struct logformat_encoder* enc,
+                       uint32_t session, uint32_t* sequence)
+{
+    bool full;
+
+    logformat_finish(enc);
+    full = logformat_index_add(&idx, block, block_ids);
+    if(!write_block(out, session, sequence)) {
+        return false;
+    }
+    if(full) {
+        logformat_index_block(&idx, block);
+        return write_block(out, session, sequence);
+    }
+    return true;
+}
+
+static bool encode(struct logreader* r, FILE* out, uint32_t* frames)
+{
+    struct logformat_encoder enc;
+    struct logformat_frame fr;
+    uint32_t session = (uint32_t)time(NULL), sequence = 0;
+
+    logformat_schema_block(block);
+    if(!write_block(out, session, &sequence)) {
+        return false;
+    }
+    logformat_index_init(&idx);
+
+    logformat_begin(&enc, block, block_ids);
+    while(logreader_next(r, &fr)) {
+        if(!logformat_add(&enc, fr.sid, fr.rtr, fr.len, fr.data,
+                          fr.timestamp)) {
+            if(!write_data(out, &enc, session, &sequence)) {
+                return false;
+            }
+            logformat_begin(&enc, block, block_ids);
+            logformat_add(&enc, fr.sid, fr.rtr, fr.len, fr.data,
+                          fr.timestamp);
+        }
+        (*frames)++;
+    }
+    if(enc.records > 0 && !write_data(out, &enc, session, &sequence)) {
+        return false;
+    }
+    logformat_footer_block(&idx, block);
+    return write_block(out, session, &sequence);
+}
+
+static bool decode(struct logreader* r, FILE* out, uint32_t* frames)
+{
+    struct logformat_frame fr;
+    struct v1_record rec;
+
+    while(logreader_next(r, &fr)) {
+        rec.sid = fr.sid;
+        rec.rtr = fr.rtr;
+        rec.len = fr.len;
+        memset(rec.data, 0, sizeof(rec.data));
+        if(!fr.rtr) {
+            memcpy(rec.data, fr.data, fr.len);
+        }
+        rec.timestamp = fr.timestamp;
+        if(fwrite(&rec, sizeof(rec), 1, out) != 1) {
+            return false;
+        }
+        (*frames)++;
+    }
+    return true;
+}
+
+/* Parse a comma separated list of IDs into <ids> */
+static bool parse_ids(char* list, uint8_t* ids)
+{
+    char* end;
+    for(char* tok=strtok(list, ","); tok!=NULL; tok=strtok(NULL, ",")) {
+        unsigned long sid = strtoul(tok, &end, 0);
+        if(*end != '\0' || sid > 0x7FF) {
+            return false;
+        }
+        ids[sid / 8] |= 1 << (sid % 8);
+    }
+    return true;
+}
+
+/* Seconds to systicks, clamped to a timestamp */
+static uint32_t parse_time(const char* s, bool* ok)
+{
+    char* end;
+    double t = strtod(s, &end) * 10000.0;
+    *ok = *ok && *end == '\0';
+    if(t < 0.0) {
+        return 0;
+    } else if(t > UINT32_MAX) {
+        return UINT32_MAX;
+    }
+    return (uint32_t)(t + 0.5);
+}
+
+int main(int argc, char* argv[])
+{
+    static struct logreader r;
+    static uint8_t ids[LOGFORMAT_ID_BYTES];
+    bool encoding = false, select = false, select_ids = false, args = true;
+    uint32_t start = 0, end = UINT32_MAX;
+    uint32_t frames = 0;
+    FILE* out;
+    bool ok;
+    int opt;
+
+    while((opt = getopt(argc, argv, "es:t:i:")) != -1) {
+        switch(opt) {
+        case 'e':
+            encoding = true;
+            break;
+        case 's':
+            start = parse_time(optarg, &args);
+            select = true;
+            break;
+        case 't':
+            end = parse_time(optarg, &args);
+            select = true;
+            break;
+        case 'i':
+            args = parse_ids(optarg, ids) && args;
+            select = select_ids = true;
+            break;
+        default:
+            args = false;
+        }
+    }
+    if(argc - optind != 2 || !args) {
+        fprintf(stderr, "Usage: %s [-e] [-s start] [-t end] [-i ID,...] "
+                "<log file> <output file or ->\n", argv[0]);
+        return 1;
+    }
+    const char* in_path = argv[optind];
+    const char* out_path = argv[optind + 1];
+
+    if(logreader_open(&r, in_path) != 0) {
+        perror(in_path);
+        return 1;
+    }
+    if(select) {
+        logreader_select(&r, start, end, select_ids ? ids : NULL);
+    }
+    if(strcmp(out_path, "-") == 0) {
+        out = stdout;
+    } else if((out = fopen(out_path, "wb")) == NULL) {
+        perror(out_path);
+        logreader_close(&r);
+        return 1;
+    }
+
+    ok = encoding ? encode(&r, out, &frames) : decode(&r, out, &frames);
+    if(out != stdout) {
+        ok = fclose(out) == 0 && ok;
+    } else {
+        ok = fflush(out) == 0 && ok;
+    }
+    if(!ok) {
+        perror(out_path);
+    }
+
+    fprintf(stderr, "%s: version %d, %u frames", in_path, r.version,
+            (unsigned)frames);
+    if(r.error != LOGFORMAT_OK) {
+        fprintf(stderr, ", stopped at block %u: %s", (unsigned)r.at,
+                logreader_strerror(r.error));
+    }
+    fprintf(stderr, "\n");
+
+    logreader_close(&r);
+    return ok ? 0 : 1;
+}
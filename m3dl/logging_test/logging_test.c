@@ -0,0 +1,362 @@
+/*
+ * Logging throughput test
+ * M3DL
+ * Cambridge University Spaceflight
+ *
+ * Runs the unmodified logging and microsd modules against a model SD card
+ * and feeds them frames at the most a 1Mbit/s bus carries, 9000 8 byte
+ * frames a second. The card writes at 4MB/s, but stalls for 500ms, the
+ * longest an SDXC card may stay busy, after every 256KB. Checks no
+ * frame is dropped, every write is of whole sectors from a sector aligned
+ * buffer so FatFs can pass it straight to the card, and the file is
+ * preallocated and synced about once a second rather than after every
+ * write. Then stalls the card for far longer, checks the drops are counted
+ * and reported through m3status, and that the closed log file decodes to
+ * exactly every frame that wasn't dropped, in order, with an index block
+ * ending every region and the footer ending the file.
+ *
+ * Built against the shared/m3host ChibiOS shim, run at M3HOST_SPEEDUP
+ * (default 4). Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ch.h"
+#include "ff.h"
+#include "m3host.h"
+#include "m3can.h"
+#include "m3can_timesync.h"
+#include "m3status.h"
+
+#include "logging.h"
+#include "logformat.h"
+#include "err_handler.h"
+
+#define FRAMES_PER_MS       (9)
+#define FULL_LOAD_MS        (10000)
+#define OVERLOAD_MS         (2000)
+
+#define CARD_BYTES_PER_MS   (4096)
+#define CARD_SYNC_MS        (2)
+#define CARD_EXTEND_MS      (100)
+#define CARD_STALL_EVERY    (256 * 1024)
+#define CARD_STALL_MS       (500)
+#define CARD_OVERLOAD_MS    (1500)
+
+/* Room for the first preallocation and more */
+#define CARD_SIZE   (128 * 1024 * 1024)
+
+static int failures;
+
+static void check(const char* name, bool ok)
+{
+    if(!ok) {
+        failures++;
+    }
+    printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+}
+
+/* Model SD card: one file, kept in memory. The file's size is what is
+ * allocated, card_len what was actually written.
+ */
+static uint8_t* card;
+static DWORD card_len;
+static DWORD card_next_stall = CARD_STALL_EVERY;
+static volatile int card_stall_ms = CARD_STALL_MS;
+static int card_unaligned;
+static int card_syncs;
+static int card_extends;
+static DWORD card_fsize;
+
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt)
+{
+    (void)path;
+    (void)opt;
+    if(fs != NULL) {
+        fs->fs_type = 3;
+        fs->csize = M3HOST_FF_CLUSTER_SECTORS;
+    }
+    return FR_OK;
+}
+
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode)
+{
+    (void)path;
+    fp->fs = NULL;
+    fp->fd = 0;
+    fp->flag = mode;
+    fp->fptr = 0;
+    fp->fsize = 0;
+    fp->cltbl = NULL;
+    card_len = 0;
+    return FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+    card_fsize = fp->fsize;
+    return FR_OK;
+}
+
+/* Writes past the allocation are cut short, as with fast seek */
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+    if(btw > fp->fsize - fp->fptr) {
+        btw = fp->fsize - fp->fptr;
+    }
+    if((uintptr_t)buff % 512 != 0 || btw % 512 != 0) {
+        card_unaligned++;
+    }
+    chThdSleepMilliseconds((btw + CARD_BYTES_PER_MS - 1) / CARD_BYTES_PER_MS);
+    if(fp->fptr + btw >= card_next_stall) {
+        chThdSleepMilliseconds(card_stall_ms);
+        card_next_stall += CARD_STALL_EVERY;
+    }
+    memcpy(card + fp->fptr, buff, btw);
+    fp->fptr += btw;
+    if(fp->fptr > card_len) {
+        card_len = fp->fptr;
+    }
+    *bw = btw;
+    return FR_OK;
+}
+
+FRESULT f_lseek(FIL *fp, DWORD ofs)
+{
+    if(fp->cltbl != NULL && ofs == CREATE_LINKMAP) {
+        fp->cltbl[0] = 4;
+        fp->cltbl[1] = fp->fsize / (M3HOST_FF_CLUSTER_SECTORS * 512);
+        fp->cltbl[2] = 2;
+        fp->cltbl[3] = 0;
+        return FR_OK;
+    }
+    if(ofs > fp->fsize && fp->cltbl == NULL) {
+        /* Allocating clusters, writing the FAT as it goes */
+        if(ofs > CARD_SIZE) {
+            ofs = CARD_SIZE;
+        }
+        chThdSleepMilliseconds(CARD_EXTEND_MS);
+        card_extends++;
+        fp->fsize = ofs;
+    } else if(ofs > fp->fsize) {
+        ofs = fp->fsize;
+    }
+    fp->fptr = ofs;
+    return FR_OK;
+}
+
+FRESULT f_truncate(FIL *fp)
+{
+    fp->fsize = fp->fptr;
+    return FR_OK;
+}
+
+FRESULT f_sync(FIL *fp)
+{
+    (void)fp;
+    card_syncs++;
+    chThdSleepMilliseconds(CARD_SYNC_MS);
+    return FR_OK;
+}
+
+FRESULT f_getfree(const TCHAR *path, DWORD *nclst, FATFS **fatfs)
+{
+    static FATFS fs;
+    f_mount(&fs, path, 0);
+    fs.free_clust = (CARD_SIZE - card_len) / (M3HOST_FF_CLUSTER_SECTORS * 512);
+    *nclst = fs.free_clust;
+    *fatfs = &fs;
+    return FR_OK;
+}
+
+/* Only the SD card's reports are recorded */
+static uint8_t sd_errorcode;
+static int sd_overflow_reports;
+static uint32_t sd_dropped;
+
+void m3status_set_init(uint8_t component)
+{
+    (void)component;
+}
+
+void m3status_set_ok(uint8_t component)
+{
+    if(component == M3DL_COMPONENT_SD_CARD) {
+        sd_errorcode = 0;
+    }
+}
+
+void m3status_set_error(uint8_t component, uint8_t errorcode)
+{
+    m3status_set_error_data(component, errorcode, NULL, 0);
+}
+
+void m3status_set_error_data(uint8_t component, uint8_t errorcode,
+                             const uint8_t* data, uint8_t datalen)
+{
+    if(component == M3DL_COMPONENT_SD_CARD) {
+        sd_errorcode = errorcode;
+        if(errorcode == M3DL_ERROR_LOGGING_OVERFLOW && datalen == 4) {
+            sd_overflow_reports++;
+            memcpy(&sd_dropped, data, 4);
+        }
+    }
+}
+
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)msg_id;
+    (void)can_rtr;
+    (void)data;
+    (void)datalen;
+}
+
+systime_t m3can_timesync_now(void)
+{
+    return chVTGetSystemTimeX();
+}
+
+systime_t m3can_timesync_unwrap16(systime_t now, uint16_t time16)
+{
+    (void)time16;
+    return now;
+}
+
+/* Checks the frames decoded from the card */
+struct log_check {
+    uint32_t full_load;
+    uint32_t n;
+    uint32_t last;
+    int wrong;
+};
+
+static void log_check_frame(const struct logformat_frame* f, void* arg)
+{
+    struct log_check* c = arg;
+    uint32_t seq;
+    memcpy(&seq, f->data, 4);
+    if(f->sid != CAN_MSG_ID_M3DL_RATE || f->rtr || f->len != 8 ||
+       (c->n < c->full_load && seq != c->n) || (c->n > 0 && seq <= c->last)) {
+        c->wrong++;
+    }
+    c->last = seq;
+    c->n++;
+}
+
+/* Log FRAMES_PER_MS frames every millisecond for `ms`, numbered from `seq` */
+static uint32_t feed(uint32_t seq, int ms)
+{
+    systime_t t = chVTGetSystemTimeX();
+    uint8_t data[8] = {0};
+
+    for(int i=0; i<ms; i++) {
+        for(int j=0; j<FRAMES_PER_MS; j++) {
+            memcpy(data, &seq, 4);
+            log_can(CAN_MSG_ID_M3DL_RATE, false, 8, data);
+            seq++;
+        }
+        t += MS2ST(1);
+        chThdSleepUntil(t);
+    }
+    return seq;
+}
+
+int main(void)
+{
+    setenv("M3HOST_SPEEDUP", "4", 0);
+    m3host_init("m3dl");
+    chSysInit();
+
+    card = calloc(1, CARD_SIZE);
+    logging_init();
+
+    /* Full load through the card's worst case stalls */
+    uint32_t sent = feed(0, FULL_LOAD_MS);
+    chThdSleepMilliseconds(200);
+    char label[64];
+    snprintf(label, sizeof(label), "%u frames at full load, 500ms stalls",
+             (unsigned)sent);
+    check(label, logging_dropped() == 0 && sd_overflow_reports == 0 &&
+          sd_errorcode == 0);
+    check("writes are whole aligned sectors", card_unaligned == 0);
+    check("file preallocated once, synced once a second",
+          card_extends == 1 && card_syncs <= FULL_LOAD_MS / 1000 + 2);
+    if(logging_dropped() != 0) {
+        printf("  %u dropped\n", (unsigned)logging_dropped());
+    }
+
+    /* A stall nothing could ride out */
+    uint32_t full_load = sent;
+    card_stall_ms = CARD_OVERLOAD_MS;
+    card_next_stall = card_len;
+    sent = feed(sent, OVERLOAD_MS);
+    card_stall_ms = CARD_STALL_MS;
+    chThdSleepMilliseconds(CARD_OVERLOAD_MS);
+    uint32_t dropped = logging_dropped();
+    check("drops counted and reported, then cleared",
+          dropped > 0 && sd_overflow_reports > 0 && sd_dropped == dropped &&
+          sd_errorcode == 0);
+
+    disable_logging();
+    bool joined = m3host_join("Datalogging", MS2ST(5000));
+    check("logging stops and closes the file", joined);
+    check("final block written whole", card_unaligned == 0 &&
+          card_len % LOGFORMAT_BLOCK_SIZE == 0);
+
+    /* Every frame logged is whole and in order, with none missing from the
+     * full load */
+    static struct logformat_decoder dec;
+    struct log_check c = {.full_load = full_load};
+    int rv = LOGFORMAT_OK;
+    logformat_decoder_init(&dec);
+    for(DWORD ofs=0; ofs<card_len && rv==LOGFORMAT_OK;
+        ofs+=LOGFORMAT_BLOCK_SIZE) {
+        rv = logformat_decode_block(&dec, card + ofs, log_check_frame, &c);
+    }
+    snprintf(label, sizeof(label), "log holds %u of %u frames in order",
+             (unsigned)c.n, (unsigned)sent);
+    check(label, joined && rv == LOGFORMAT_OK && card_fsize == card_len &&
+          c.n == sent - dropped && c.wrong == 0);
+    printf("  %u frames in %u bytes, %.1f per frame\n", (unsigned)c.n,
+           (unsigned)card_len, (double)card_len / c.n);
+
+    /* Index blocks at their places, then the footer, covering every data
+     * block */
+    uint32_t n = card_len / LOGFORMAT_BLOCK_SIZE, indexes = 0, misplaced = 0;
+    uint32_t indexed = 0;
+    static struct logformat_index_info info;
+    for(uint32_t seq=1; seq<n; seq++) {
+        struct logformat_header h;
+        memcpy(&h, card + (size_t)seq * LOGFORMAT_BLOCK_SIZE, sizeof(h));
+        bool index_place = seq % LOGFORMAT_INDEX_INTERVAL == 0;
+        bool footer_place = seq == n - 1;
+        if(h.type == LOGFORMAT_BLOCK_INDEX ||
+           h.type == LOGFORMAT_BLOCK_FOOTER) {
+            if(logformat_read_index(card + (size_t)seq * LOGFORMAT_BLOCK_SIZE,
+                                    &info) != LOGFORMAT_OK) {
+                misplaced++;
+            }
+            indexed += info.h.blocks;
+            indexes++;
+        }
+        misplaced += (h.type == LOGFORMAT_BLOCK_INDEX) != index_place;
+        misplaced += (h.type == LOGFORMAT_BLOCK_FOOTER) != footer_place;
+    }
+    snprintf(label, sizeof(label), "%u index blocks and footer",
+             (unsigned)indexes - 1);
+    check(label, n > 2 * LOGFORMAT_INDEX_INTERVAL && misplaced == 0 &&
+          indexed == n - 1 - indexes);
+
+    free(card);
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -3,13 +3,17 @@
  * 2014, 2016 Adam Greig, Cambridge University Spaceflight
  */
 
+#include <math.h>
 #include "ch.h"
 #include "hal.h"
 #include "m3can.h"
+#include "m3can_bulk.h"
+#include "m3can_timesync.h"
 #include "m3fc_config.h"
 #include "m3fc_status.h"
 #include "m3fc_state_estimation.h"
 #include "m3fc_mock.h"
+#include "m3prof.h"
 #include "adxl345.h"
 
 #define ADXL345_REG_DEVID               0x00
@@ -29,8 +33,12 @@
 #define ADXL345_REG_FIFO_STATUS         0x39
 
 #define ADXL345_BWRATE_RATE_800HZ       ((1<<0) | (1<<2) | (1<<3))
+#define ADXL345_BWRATE_RATE_3200HZ      ((1<<0) | (1<<1) | (1<<2) | (1<<3))
 #define ADXL345_POWER_CTL_MEASURE       (1<<3)
 #define ADXL345_INT_ENABLE_DATA_READY   (1<<7)
+#define ADXL345_INT_ENABLE_WATERMARK    (1<<1)
+#define ADXL345_FIFO_CTL_MODE_STREAM    (1<<7)
+#define ADXL345_FIFO_STATUS_ENTRIES     (0x3F)
 #define ADXL345_DATA_FORMAT_RANGE_16G   ((1<<0) | (1<<1))
 #define ADXL345_DATA_FORMAT_JUSTIFY     (1<<2)
 #define ADXL345_DATA_FORMAT_FULL_RES    (1<<3)
@@ -40,24 +48,76 @@
 #define ADXL345_READ                    (1<<7)
 #define ADXL345_MULTIBYTE               (1<<6)
 
+/* In flight we run at 3200Hz ODR with the FIFO in stream mode, and are
+ * interrupted when it holds ADXL345_FIFO_WATERMARK samples (every 5ms).
+ * Each batch is averaged into a single state estimation update, and every
+ * ADXL345_CAN_DECIMATION samples are averaged into one CAN frame, keeping
+ * the accelerometer CAN traffic at 800Hz.
+ */
+#define ADXL345_FIFO_WATERMARK          (16)
+#define ADXL345_FIFO_DEPTH              (33)
+#define ADXL345_CAN_DECIMATION          (4)
+
+/* Half the 3200Hz sample period, 156.25us, as a fraction */
+#define ADXL345_HALF_SAMPLE_US_NUM      (5000)
+#define ADXL345_HALF_SAMPLE_US_DEN      (32)
+
+/* Raw full scale at +-16G full resolution. A batch containing a sample
+ * clipped to either end on any axis is not used for state estimation, as
+ * its average would read below full scale.
+ */
+#define ADXL345_RAW_MIN                 (-4096)
+#define ADXL345_RAW_MAX                 (4095)
+
+/* Before the burst trigger every raw sample goes into a ring, so it always
+ * holds the last ADXL345_BURST_SAMPLES. Once triggered it keeps going until
+ * all but ADXL345_BURST_PRETRIGGER of them were taken since, then freezes.
+ */
+#define ADXL345_BURST_PRETRIGGER        (512)
+
+typedef enum {
+    ADXL345_BURST_RECORDING = 0,
+    ADXL345_BURST_TRIGGERED,
+    ADXL345_BURST_FROZEN,
+    ADXL345_BURST_SENT,
+} adxl345_burst_state_t;
+
 static bool adxl345_check_id(void);
 static void adxl345_read_u8(uint8_t adr, uint8_t* reg);
 static void adxl345_write_u8(uint8_t adr, uint8_t val);
 static void adxl345_read_accel(int16_t accels[3]);
+static uint8_t adxl345_read_fifo(int16_t accels[][3], uint8_t max);
 static void adxl345_configure(void);
 static bool adxl345_self_test(void);
 static void adxl345_accels_to_mss(int16_t accels[3], float faccels[3]);
+static void adxl345_burst_record(int16_t accels[3], systime_t t_sample);
+static void adxl345_burst_reverse(uint16_t first, uint16_t last);
 
 static SPIDriver* adxl345_spid;
 static binary_semaphore_t adxl345_thd_sem;
 
+/* Full rate launch capture, written by the ADXL345 thread until it is
+ * frozen and then only read by the burst thread.
+ */
+static struct adxl345_burst adxl345_burst;
+static uint16_t adxl345_burst_next, adxl345_burst_remaining;
+static volatile adxl345_burst_state_t adxl345_burst_state;
+static binary_semaphore_t adxl345_burst_sem;
+
+/* SPI clock is APB1/16 = 2.625MHz, as the ADXL345 requires at least 2MHz
+ * to keep up with 3200Hz ODR (and at most 5MHz).
+ */
 static SPIConfig spi_cfg = {
     .end_cb = NULL,
     .ssport = 0,
     .sspad  = 0,
-    .cr1    = SPI_CR1_BR_2 | SPI_CR1_CPOL | SPI_CR1_CPHA
+    .cr1    = SPI_CR1_BR_1 | SPI_CR1_BR_0 | SPI_CR1_CPOL | SPI_CR1_CPHA
 };
 
+/* DMA buffers for reading one FIFO entry: address byte then six data bytes */
+static uint8_t adxl345_fifo_tx[7];
+static uint8_t adxl345_fifo_rx[7];
+
 /*
  * Read a register at address `adr` on the ADXL345.
  * The register's value is returned via reg.
@@ -99,6 +159,41 @@ static void adxl345_read_accel(int16_t* accels)
     spiUnselect(adxl345_spid);
 }
 
+/*
+ * Drain up to `max` samples from the ADXL345 FIFO into `accels`.
+ * Returns the number of samples read.
+ *
+ * The FIFO pops one entry each time chip select is released after reading
+ * the data registers, so each entry is its own 7-byte DMA exchange. The
+ * datasheet requires 5us between the end of one read and the start of the
+ * next for the FIFO to update.
+ */
+static uint8_t adxl345_read_fifo(int16_t accels[][3], uint8_t max)
+{
+    uint8_t status, n, i;
+
+    adxl345_read_u8(ADXL345_REG_FIFO_STATUS, &status);
+    n = status & ADXL345_FIFO_STATUS_ENTRIES;
+    if(n > max) {
+        n = max;
+    }
+
+    adxl345_fifo_tx[0] = ADXL345_REG_DATAX0 | ADXL345_READ | ADXL345_MULTIBYTE;
+
+    for(i=0; i<n; i++) {
+        chSysPolledDelayX(US2RTC(STM32_HCLK, 5));
+        spiSelect(adxl345_spid);
+        spiExchange(adxl345_spid, 7, adxl345_fifo_tx, adxl345_fifo_rx);
+        spiUnselect(adxl345_spid);
+
+        accels[i][0] = (int16_t)(adxl345_fifo_rx[1] | adxl345_fifo_rx[2]<<8);
+        accels[i][1] = (int16_t)(adxl345_fifo_rx[3] | adxl345_fifo_rx[4]<<8);
+        accels[i][2] = (int16_t)(adxl345_fifo_rx[5] | adxl345_fifo_rx[6]<<8);
+    }
+
+    return n;
+}
+
 /*
  * Run the ADXL345 self test, returns true on success or false on failure.
  */
@@ -187,21 +282,24 @@ static bool adxl345_check_id()
 
 /*
  * Initialise the ADXL345 device.
- * Sets registers for 800Hz operation in high power mode,
- * enables measurement, and runs a self test to verify device performance.
+ * Sets registers for 3200Hz operation in high power mode with the FIFO in
+ * stream mode and the watermark interrupt on INT1, and enables measurement.
  */
 static void adxl345_configure()
 {
-    /* Set 800Hz ODR and disable low power mode */
-    adxl345_write_u8(ADXL345_REG_BWRATE, ADXL345_BWRATE_RATE_800HZ);
+    /* Set 3200Hz ODR and disable low power mode */
+    adxl345_write_u8(ADXL345_REG_BWRATE, ADXL345_BWRATE_RATE_3200HZ);
 
     /* Set +-16G range and full resolution */
     adxl345_write_u8(ADXL345_REG_DATA_FORMAT,
         ADXL345_DATA_FORMAT_FULL_RES  |
         ADXL345_DATA_FORMAT_RANGE_16G);
 
-    /* Enable DATA_READY interrupt on INT1 */
-    adxl345_write_u8(ADXL345_REG_INT_ENABLE, ADXL345_INT_ENABLE_DATA_READY);
+    /* Stream mode, watermark interrupt on INT1 */
+    adxl345_write_u8(ADXL345_REG_FIFO_CTL,
+        ADXL345_FIFO_CTL_MODE_STREAM | ADXL345_FIFO_WATERMARK);
+    adxl345_write_u8(ADXL345_REG_INT_MAP, 0);
+    adxl345_write_u8(ADXL345_REG_INT_ENABLE, ADXL345_INT_ENABLE_WATERMARK);
 
     /* Enable MEASURE mode */
     adxl345_write_u8(ADXL345_REG_POWER_CTL, ADXL345_POWER_CTL_MEASURE);
@@ -224,7 +322,9 @@ static void adxl345_accels_to_mss(int16_t accels[3], float faccels[3]) {
                  * m3fc_config.accel_cal.z_scale * g;
 }
 
-/* ISR triggered by the EXTI peripheral when DRDY gets asserted.
+/* ISR triggered by the EXTI peripheral when the FIFO watermark interrupt
+ * gets asserted. It stays asserted until we drain the FIFO below the
+ * watermark, so the thread always drains it completely.
  */
 void adxl345_interrupt(EXTDriver *extp, expchannel_t channel)
 {
@@ -239,12 +339,17 @@ void adxl345_interrupt(EXTDriver *extp, expchannel_t channel)
 /*
  * ADXL345 main thread.
  */
-static THD_WORKING_AREA(adxl345_thd_wa, 256);
+static THD_WORKING_AREA(adxl345_thd_wa, 512);
 static THD_FUNCTION(adxl345_thd, arg)
 {
     (void)arg;
+    static int16_t fifo[ADXL345_FIFO_DEPTH][3];
+    int32_t sums[3], can_sums[3] = {0, 0, 0};
     int16_t accels[3];
     float faccels[3];
+    uint8_t i, j, n, can_n = 0;
+    bool saturated;
+    systime_t t_read, t_sample;
     msg_t wait_result;
 
     chRegSetThreadName("ADXL345");
@@ -264,27 +369,73 @@ static THD_FUNCTION(adxl345_thd, arg)
     adxl345_configure();
 
     while(true) {
-        adxl345_read_accel(accels);
-
-        /* If we're doing hardware-in-the-loop mocking, discard the just-read
-         * value and use the latest mock value instead.
-         */
-        if(m3fc_mock_get_enabled()) {
-            m3fc_mock_get_accel(accels);
+        M3PROF_START(M3PROF_M3FC_ADXL345_BATCH);
+
+        n = adxl345_read_fifo(fifo, ADXL345_FIFO_DEPTH);
+        t_read = m3can_timesync_now();
+
+        sums[0] = sums[1] = sums[2] = 0;
+        saturated = false;
+        for(i=0; i<n; i++) {
+            /* If we're doing hardware-in-the-loop mocking, discard the
+             * just-read value and use the latest mock value instead.
+             */
+            if(m3fc_mock_get_enabled()) {
+                m3fc_mock_get_accel(fifo[i]);
+            }
+
+            for(j=0; j<3; j++) {
+                if(fifo[i][j] <= ADXL345_RAW_MIN ||
+                   fifo[i][j] >= ADXL345_RAW_MAX) {
+                    saturated = true;
+                }
+                sums[j] += fifo[i][j];
+                can_sums[j] += fifo[i][j];
+            }
+
+            /* The newest sample in the FIFO was taken just before the read */
+            adxl345_burst_record(fifo[i], t_read -
+                US2ST((uint32_t)(2 * (n - 1 - i) + 1) *
+                      ADXL345_HALF_SAMPLE_US_NUM / ADXL345_HALF_SAMPLE_US_DEN));
+
+            /* Send the average of every few samples over CAN */
+            if(++can_n == ADXL345_CAN_DECIMATION) {
+                for(j=0; j<3; j++) {
+                    accels[j] = can_sums[j] / ADXL345_CAN_DECIMATION;
+                    can_sums[j] = 0;
+                }
+                can_n = 0;
+
+                /* Stamp the frame with the middle of its samples, the
+                 * newest in the FIFO having been taken just before the read.
+                 */
+                t_sample = t_read - US2ST((uint32_t)(2 * (n - i) + 1) *
+                                          ADXL345_HALF_SAMPLE_US_NUM /
+                                          ADXL345_HALF_SAMPLE_US_DEN);
+                m3can_send_m3fc_accel(accels[0], accels[1], accels[2],
+                                      (uint16_t)t_sample);
+            }
         }
 
-        /* Convert int16 readings to m/s/s accelerations */
-        adxl345_accels_to_mss(accels, faccels);
-
-        /* Submit readings to state estimation.
-         * Maximum reading is 16G = 156.96m/s/s.
-         * RMS noise is around 1.1LSB at 100Hz ODR, increases by sqrt(2) each
-         * time the ODR doubles, so we have 1.1LSB * sqrt(2)^3 = 3.1LSB,
-         * scale is 3.9mg/LSB giving 12.09mg or 0.1186m/s/s.
-         */
-        m3fc_state_estimation_new_accels(faccels, 156.96f, 0.1186f);
+        if(n > 0 && !saturated) {
+            /* Convert the batch average to m/s/s accelerations */
+            for(j=0; j<3; j++) {
+                accels[j] = sums[j] / n;
+            }
+            adxl345_accels_to_mss(accels, faccels);
+
+            /* Submit the batch to state estimation.
+             * Maximum reading is 16G = 156.96m/s/s.
+             * RMS noise is around 1.1LSB at 100Hz ODR, increases by sqrt(2)
+             * each time the ODR doubles, so we have 1.1LSB * sqrt(2)^5 =
+             * 6.2LSB at 3200Hz, scale is 3.9mg/LSB giving 24.3mg or
+             * 0.2385m/s/s per sample, reduced by sqrt(n) by averaging.
+             */
+            m3fc_state_estimation_new_accels(faccels, 156.96f,
+                                             0.2385f / sqrtf((float)n));
+        }
 
-        m3can_send(CAN_MSG_ID_M3FC_ACCEL, false, (uint8_t*)accels, 6);
+        M3PROF_STOP(M3PROF_M3FC_ADXL345_BATCH);
 
         wait_result = chBSemWaitTimeout(&adxl345_thd_sem, MS2ST(100));
 
@@ -296,6 +447,108 @@ static THD_FUNCTION(adxl345_thd, arg)
     }
 }
 
+/*
+ * Store one raw sample taken at `t_sample` in the burst ring, until the
+ * capture is complete.
+ */
+static void adxl345_burst_record(int16_t accels[3], systime_t t_sample)
+{
+    adxl345_burst_state_t state = adxl345_burst_state;
+    uint8_t j;
+
+    if(state == ADXL345_BURST_FROZEN || state == ADXL345_BURST_SENT) {
+        return;
+    }
+
+    for(j=0; j<3; j++) {
+        adxl345_burst.samples[adxl345_burst_next][j] = accels[j];
+    }
+    adxl345_burst_next = (adxl345_burst_next + 1) % ADXL345_BURST_SAMPLES;
+
+    if(state == ADXL345_BURST_TRIGGERED && --adxl345_burst_remaining == 0) {
+        /* The oldest sample is the one we would overwrite next */
+        adxl345_burst.t_first = t_sample -
+            US2ST((uint32_t)(ADXL345_BURST_SAMPLES - 1) * 2 *
+                  ADXL345_HALF_SAMPLE_US_NUM / ADXL345_HALF_SAMPLE_US_DEN);
+        adxl345_burst_state = ADXL345_BURST_FROZEN;
+    }
+}
+
+/*
+ * Reverse the order of burst samples `first` to `last` inclusive.
+ */
+static void adxl345_burst_reverse(uint16_t first, uint16_t last)
+{
+    int16_t tmp;
+    uint8_t j;
+
+    while(first < last) {
+        for(j=0; j<3; j++) {
+            tmp = adxl345_burst.samples[first][j];
+            adxl345_burst.samples[first][j] = adxl345_burst.samples[last][j];
+            adxl345_burst.samples[last][j] = tmp;
+        }
+        first++;
+        last--;
+    }
+}
+
+/*
+ * Burst thread. Once asked to send a frozen capture, rotates the ring so
+ * the oldest sample comes first and sends it to M3DL to be logged.
+ */
+static THD_WORKING_AREA(adxl345_burst_thd_wa, 512);
+static THD_FUNCTION(adxl345_burst_thd, arg)
+{
+    (void)arg;
+    uint16_t oldest;
+    int attempts;
+
+    chRegSetThreadName("ADXL345 burst");
+
+    while(true) {
+        chBSemWait(&adxl345_burst_sem);
+        if(adxl345_burst_state != ADXL345_BURST_FROZEN) {
+            continue;
+        }
+
+        oldest = adxl345_burst_next;
+        if(oldest != 0) {
+            adxl345_burst_reverse(0, oldest - 1);
+            adxl345_burst_reverse(oldest, ADXL345_BURST_SAMPLES - 1);
+            adxl345_burst_reverse(0, ADXL345_BURST_SAMPLES - 1);
+        }
+        adxl345_burst.n_samples = ADXL345_BURST_SAMPLES;
+        adxl345_burst.trigger = ADXL345_BURST_PRETRIGGER;
+        adxl345_burst_state = ADXL345_BURST_SENT;
+
+        for(attempts=0; attempts<3; attempts++) {
+            if(m3can_bulk_send(CAN_ID_M3DL, M3CAN_BULK_PORT_M3FC_ACCEL_BURST,
+                               (const uint8_t*)&adxl345_burst,
+                               sizeof(adxl345_burst)) == M3CAN_BULK_OK) {
+                break;
+            }
+            chThdSleepMilliseconds(1000);
+        }
+    }
+}
+
+void adxl345_burst_trigger(void)
+{
+    chSysLock();
+    if(adxl345_burst_state == ADXL345_BURST_RECORDING) {
+        adxl345_burst_remaining = ADXL345_BURST_SAMPLES -
+                                  ADXL345_BURST_PRETRIGGER;
+        adxl345_burst_state = ADXL345_BURST_TRIGGERED;
+    }
+    chSysUnlock();
+}
+
+void adxl345_burst_send(void)
+{
+    chBSemSignal(&adxl345_burst_sem);
+}
+
 void adxl345_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad)
 {
     m3status_set_init(M3FC_COMPONENT_ACCEL);
@@ -304,6 +557,10 @@ void adxl345_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad)
     spi_cfg.sspad  = sspad;
     adxl345_spid   = spid;
 
+    chBSemObjectInit(&adxl345_burst_sem, true);
+
     chThdCreateStatic(adxl345_thd_wa, sizeof(adxl345_thd_wa),
                       NORMALPRIO, adxl345_thd, NULL);
+    chThdCreateStatic(adxl345_burst_thd_wa, sizeof(adxl345_burst_thd_wa),
+                      LOWPRIO, adxl345_burst_thd, NULL);
 }
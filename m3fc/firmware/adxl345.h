@@ -5,11 +5,42 @@
 #ifndef ADXL345_H
 #define ADXL345_H
 
+#include <stdint.h>
+
+/* Full rate (3200Hz) raw samples kept around launch, 640ms */
+#define ADXL345_BURST_SAMPLES   (2048)
+
+/* A launch capture, as sent to M3DL in one bulk transfer on
+ * M3CAN_BULK_PORT_M3FC_ACCEL_BURST. Little endian, packed by layout.
+ */
+struct adxl345_burst {
+    /* Common time of the first sample, in system ticks */
+    uint32_t t_first;
+    uint16_t n_samples;
+    /* Index of the first sample taken after the trigger */
+    uint16_t trigger;
+    /* Raw X, Y, Z readings 312.5us apart, before calibration */
+    int16_t samples[ADXL345_BURST_SAMPLES][3];
+};
+
 /*
  * Initialise the ADXL345 and start a thread that will collect samples from it.
  */
 void adxl345_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad);
 
+/*
+ * Capture a burst of full rate samples around now, including those from
+ * just before. Mission control calls this at ignition. Only the first
+ * call has any effect.
+ */
+void adxl345_burst_trigger(void);
+
+/*
+ * Send the burst to M3DL once it has been captured, from a low priority
+ * thread. Mission control calls this after landing.
+ */
+void adxl345_burst_send(void);
+
 /*
  * Interrupt callbacks for EXTI. Register against the ADXL interrupt pin.
  */
@@ -0,0 +1,52 @@
+/*
+ * Pressure to altitude conversion
+ * M3FC
+ * 2017 Adam Greig, Cambridge University Spaceflight
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "m3fc_altitude.h"
+#include "m3fc_altitude_table.h"
+
+/* Mantissa bits below the ones used to select a segment */
+#define ALT_T_BITS (23 - M3FC_ALTITUDE_TABLE_MANTISSA_BITS)
+
+/* The table in m3fc_altitude_table.h is generated by
+ * scripts/gen_altitude_table.py. Each row is a cubic in t over one segment,
+ * where a segment is selected by the float's exponent and top few mantissa
+ * bits and t in [0, 1) is the rest of the mantissa. This avoids any search
+ * over the atmosphere bands and any call to powf or logf, and the cubic's
+ * derivative gives dh/dp for free.
+ */
+float m3fc_altitude_from_pressure(float pressure, float* dhdp)
+{
+    union { float f; uint32_t u; } p = {.f = pressure};
+    union { float f; uint32_t u; } inv_w;
+    uint32_t idx;
+    const float* c;
+    float t;
+
+    /* Negative, zero, NaN and out of range pressures all wrap to an index
+     * past the end of the table.
+     */
+    idx = (p.u >> ALT_T_BITS)
+          - ((127 + M3FC_ALTITUDE_TABLE_MIN_EXP)
+             << M3FC_ALTITUDE_TABLE_MANTISSA_BITS);
+    if(idx >= M3FC_ALTITUDE_TABLE_SIZE) {
+        return M3FC_ALTITUDE_INVALID;
+    }
+
+    c = m3fc_altitude_table[idx];
+    t = (float)(p.u & ((1 << ALT_T_BITS) - 1)) * (1.0f / (1 << ALT_T_BITS));
+
+    if(dhdp != NULL) {
+        /* dt/dp is one over the segment width, 2^(mantissa bits - exponent),
+         * which we build directly as a float.
+         */
+        inv_w.u = (254 + M3FC_ALTITUDE_TABLE_MANTISSA_BITS - (p.u >> 23)) << 23;
+        *dhdp = (c[1] + t * (2.0f * c[2] + t * 3.0f * c[3])) * inv_w.f;
+    }
+
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
@@ -0,0 +1,20 @@
+/*
+ * Pressure to altitude conversion
+ * M3FC
+ * 2017 Adam Greig, Cambridge University Spaceflight
+ */
+
+#ifndef M3FC_ALTITUDE_H
+#define M3FC_ALTITUDE_H
+
+/* Returned for pressures outside the table, 1Pa to 131072Pa. */
+#define M3FC_ALTITUDE_INVALID (-9999.0f)
+
+/* Convert a pressure in Pa to an altitude in m using the
+ * US Standard Atmosphere 1976.
+ * If dhdp is not NULL, the gradient dh/dp in m/Pa is written to it.
+ * Returns M3FC_ALTITUDE_INVALID if the pressure is out of range.
+ */
+float m3fc_altitude_from_pressure(float pressure, float* dhdp);
+
+#endif
@@ -0,0 +1,291 @@
+/*
+    Generated by gen_altitude_table.py, do not edit.
+
+    US Standard Atmosphere 1976 altitude against pressure, as cubics in t
+    over 272 segments from 1 Pa to 131072 Pa.
+    Interpolation error before rounding to float: 3.71e-02 m.
+*/
+
+#ifndef M3FC_ALTITUDE_TABLE_H
+#define M3FC_ALTITUDE_TABLE_H
+
+#define M3FC_ALTITUDE_TABLE_MIN_EXP       (0)
+#define M3FC_ALTITUDE_TABLE_MANTISSA_BITS (4)
+#define M3FC_ALTITUDE_TABLE_SIZE          (272)
+
+static const float m3fc_altitude_table[M3FC_ALTITUDE_TABLE_SIZE][4] = {
+    {7.930263403e+04f, -3.623137661e+02f, 1.064146504e+01f, -3.942532060e-01f},
+    {7.895056748e+04f, -3.422135956e+02f, 9.461613674e+00f, -3.315565024e-01f},
+    {7.861748394e+04f, -3.242850378e+02f, 8.469135660e+00f, -2.815309149e-01f},
+    {7.830138651e+04f, -3.081913592e+02f, 7.626219853e+00f, -2.411232647e-01f},
+    {7.800058025e+04f, -2.936622893e+02f, 6.904151051e+00f, -2.081236046e-01f},
+    {7.771361398e+04f, -2.804783580e+02f, 6.280802181e+00f, -1.809052797e-01f},
+    {7.743923552e+04f, -2.684594695e+02f, 5.738898182e+00f, -1.582527462e-01f},
+    {7.717635670e+04f, -2.574564313e+02f, 5.264791524e+00f, -1.392451568e-01f},
+    {7.692402581e+04f, -2.473445838e+02f, 4.847583938e+00f, -1.231761749e-01f},
+    {7.668140564e+04f, -2.380189444e+02f, 4.478486784e+00f, -1.094978061e-01f},
+    {7.644775568e+04f, -2.293904643e+02f, 4.150348675e+00f, -9.778044100e-02f},
+    {7.622241779e+04f, -2.213831082e+02f, 3.857302167e+00f, -8.768402799e-02f},
+    {7.600480430e+04f, -2.139315560e+02f, 3.594496372e+00f, -7.893700343e-02f},
+    {7.579438830e+04f, -2.069793743e+02f, 3.357892416e+00f, -7.132070661e-02f},
+    {7.559069550e+04f, -2.004775515e+02f, 3.144105395e+00f, -6.465772264e-02f},
+    {7.539329739e+04f, -1.943833139e+02f, 2.950281119e+00f, -5.880307349e-02f},
+    {7.520180556e+04f, -3.773183218e+02f, 1.108216167e+01f, -4.105804746e-01f},
+    {7.483515882e+04f, -3.563857399e+02f, 9.853448937e+00f, -3.452873028e-01f},
+    {7.448828124e+04f, -3.377147039e+02f, 8.819869279e+00f, -2.931899980e-01f},
+    {7.415909321e+04f, -3.209545354e+02f, 7.942045669e+00f, -2.511089395e-01f},
+    {7.384582962e+04f, -3.058237708e+02f, 7.190073721e+00f, -2.167426594e-01f},
+    {7.354697918e+04f, -2.920938514e+02f, 6.540910008e+00f, -1.883971378e-01f},
+    {7.326123784e+04f, -2.795772228e+02f, 5.976564056e+00f, -1.648064916e-01f},
+    {7.298747237e+04f, -2.681185141e+02f, 5.482823145e+00f, -1.450117379e-01f},
+    {7.272469167e+04f, -2.575879031e+02f, 5.048337678e+00f, -1.282772888e-01f},
+    {7.247202383e+04f, -2.478760596e+02f, 4.663955046e+00f, -1.140324556e-01f},
+    {7.222869769e+04f, -2.388902469e+02f, 4.322227704e+00f, -1.018298375e-01f},
+    {7.199402784e+04f, -2.305512810e+02f, 4.017045216e+00f, -9.131530011e-02f},
+    {7.176740229e+04f, -2.227911364e+02f, 3.743355803e+00f, -8.220603373e-02f},
+    {7.154827230e+04f, -2.155510429e+02f, 3.496953331e+00f, -7.427432200e-02f},
+    {7.133614394e+04f, -2.087799592e+02f, 3.274312715e+00f, -6.733540283e-02f},
+    {7.113057096e+04f, -2.024333400e+02f, 3.096369957e+00f, -9.397943548e-02f},
+    {7.093114001e+04f, -3.930450768e+02f, 1.125730150e+01f, -4.123160972e-01f},
+    {7.054893992e+04f, -3.717674221e+02f, 1.002335458e+01f, -3.472255856e-01f},
+    {7.018684862e+04f, -3.527623897e+02f, 8.983942528e+00f, -2.952201520e-01f},
+    {6.984277496e+04f, -3.356801651e+02f, 8.100017231e+00f, -2.531598985e-01f},
+    {6.951494165e+04f, -3.202396103e+02f, 7.341885319e+00f, -2.187691975e-01f},
+    {6.920182515e+04f, -3.062121473e+02f, 6.686637639e+00f, -1.903710149e-01f},
+    {6.890210927e+04f, -2.934099850e+02f, 6.116367517e+00f, -1.667107149e-01f},
+    {6.861464895e+04f, -2.816773821e+02f, 5.616912605e+00f, -1.468367902e-01f},
+    {6.833844164e+04f, -2.708840673e+02f, 5.176951450e+00f, -1.300186213e-01f},
+    {6.807260450e+04f, -2.609202203e+02f, 4.787344818e+00f, -1.156888046e-01f},
+    {6.781635594e+04f, -2.516925970e+02f, 4.440648766e+00f, -1.034020869e-01f},
+    {6.756900059e+04f, -2.431215058e+02f, 4.130750082e+00f, -9.280570763e-02f},
+    {6.732991703e+04f, -2.351384227e+02f, 3.852590128e+00f, -8.361770397e-02f},
+    {6.709854758e+04f, -2.276840956e+02f, 3.601953395e+00f, -7.561084696e-02f},
+    {6.687438982e+04f, -2.207070213e+02f, 3.375303984e+00f, -6.860061771e-02f},
+    {6.665698951e+04f, -2.141622152e+02f, 3.169657971e+00f, -6.243611256e-02f},
+    {6.644593451e+04f, -4.160204152e+02f, 1.191534387e+01f, -4.364179177e-01f},
+    {6.604139302e+04f, -3.934989813e+02f, 1.060926693e+01f, -3.675225587e-01f},
+    {6.565813579e+04f, -3.733830151e+02f, 9.509096340e+00f, -3.124771621e-01f},
+    {6.529394939e+04f, -3.553022539e+02f, 8.573501440e+00f, -2.679582886e-01f},
+    {6.494695268e+04f, -3.389591259e+02f, 7.771053142e+00f, -2.315572888e-01f},
+    {6.461553305e+04f, -3.241116914e+02f, 7.077503145e+00f, -2.014990986e-01f},
+    {6.429829736e+04f, -3.105611825e+02f, 6.473898045e+00f, -1.764557424e-01f},
+    {6.399403362e+04f, -2.981427536e+02f, 5.945247638e+00f, -1.554200931e-01f},
+    {6.370168070e+04f, -2.867185186e+02f, 5.479568678e+00f, -1.376188229e-01f},
+    {6.342030413e+04f, -2.761722377e+02f, 5.067187701e+00f, -1.224513609e-01f},
+    {6.314907663e+04f, -2.664052164e+02f, 4.700225630e+00f, -1.094464265e-01f},
+    {6.288726219e+04f, -2.573331044e+02f, 4.372211906e+00f, -9.823063897e-02f},
+    {6.263420307e+04f, -2.488833725e+02f, 4.077792190e+00f, -8.850555313e-02f},
+    {6.238930898e+04f, -2.409933048e+02f, 3.812504559e+00f, -8.003065758e-02f},
+    {6.215204815e+04f, -2.336083877e+02f, 3.572606420e+00f, -7.261064735e-02f},
+    {6.192193976e+04f, -2.266810068e+02f, 3.354939429e+00f, -6.608579778e-02f},
+    {6.169854761e+04f, -4.403387706e+02f, 1.261185191e+01f, -4.619286033e-01f},
+    {6.127035876e+04f, -4.165008526e+02f, 1.122942862e+01f, -3.890059856e-01f},
+    {6.086469833e+04f, -3.952090133e+02f, 1.006494787e+01f, -3.307429260e-01f},
+    {6.047922352e+04f, -3.760713463e+02f, 9.074663035e+00f, -2.836217143e-01f},
+    {6.011194321e+04f, -3.587728854e+02f, 8.225307849e+00f, -2.450929045e-01f},
+    {5.976115054e+04f, -3.430575484e+02f, 7.491216584e+00f, -2.132776712e-01f},
+    {5.942537093e+04f, -3.287149483e+02f, 6.852327918e+00f, -1.867704127e-01f},
+    {5.910332154e+04f, -3.155706037e+02f, 6.292775402e+00f, -1.645051306e-01f},
+    {5.879387921e+04f, -3.034785683e+02f, 5.799875311e+00f, -1.456632921e-01f},
+    {5.849605485e+04f, -2.923158075e+02f, 5.363388720e+00f, -1.296092204e-01f},
+    {5.820897283e+04f, -2.819778577e+02f, 4.974975985e+00f, -1.158440863e-01f},
+    {5.793185410e+04f, -2.723754380e+02f, 4.627788312e+00f, -1.039726831e-01f},
+    {5.766400248e+04f, -2.634317794e+02f, 4.316158376e+00f, -9.367912011e-02f},
+    {5.740479318e+04f, -2.550805000e+02f, 4.035363431e+00f, -8.470882698e-02f},
+    {5.715366333e+04f, -2.472638997e+02f, 3.781442115e+00f, -7.685508213e-02f},
+    {5.691010402e+04f, -2.399315807e+02f, 3.551051461e+00f, -6.994882436e-02f},
+    {5.667365354e+04f, -4.660786485e+02f, 1.334907414e+01f, -4.889305087e-01f},
+    {5.622043504e+04f, -4.408472917e+02f, 1.188584168e+01f, -4.117452202e-01f},
+    {5.579106184e+04f, -4.183108440e+02f, 1.065329154e+01f, -3.500764099e-01f},
+    {5.538305421e+04f, -3.980544902e+02f, 9.605119888e+00f, -3.002007411e-01f},
+    {5.499430464e+04f, -3.797448526e+02f, 8.706115885e+00f, -2.594197406e-01f},
+    {5.462300649e+04f, -3.631108801e+02f, 7.929113524e+00f, -2.257447570e-01f},
+    {5.426759897e+04f, -3.479298873e+02f, 7.252878802e+00f, -1.976880242e-01f},
+    {5.392672428e+04f, -3.340171938e+02f, 6.660617802e+00f, -1.741212313e-01f},
+    {5.359919358e+04f, -3.212183219e+02f, 6.138905376e+00f, -1.541779985e-01f},
+    {5.328395999e+04f, -3.094030451e+02f, 5.676904086e+00f, -1.371854907e-01f},
+    {5.298009666e+04f, -2.984607934e+02f, 5.265786795e+00f, -1.226157195e-01f},
+    {5.268677904e+04f, -2.882970670e+02f, 4.898304365e+00f, -1.100503768e-01f},
+    {5.240327022e+04f, -2.788306094e+02f, 4.568458189e+00f, -9.915510652e-02f},
+    {5.212890892e+04f, -2.699911583e+02f, 4.271249455e+00f, -8.966045742e-02f},
+    {5.186309935e+04f, -2.617176408e+02f, 4.002485241e+00f, -8.134762414e-02f},
+    {5.160530285e+04f, -2.539567132e+02f, 3.758627167e+00f, -7.403766304e-02f},
+    {5.135503072e+04f, -4.933231436e+02f, 1.376931371e+01f, -7.709176535e-02f},
+    {5.087539980e+04f, -4.660157915e+02f, 1.368471151e+01f, -4.932189443e-01f},
+    {5.042257550e+04f, -4.401260253e+02f, 1.220842363e+01f, -4.174398714e-01f},
+    {4.999424046e+04f, -4.169614977e+02f, 1.095867378e+01f, -3.564242226e-01f},
+    {4.958788121e+04f, -3.961134228e+02f, 9.891388769e+00f, -3.067445320e-01f},
+    {4.920135243e+04f, -3.772508788e+02f, 8.972712039e+00f, -2.658856196e-01f},
+    {4.883280838e+04f, -3.601031116e+02f, 8.176288595e+00f, -2.319733880e-01f},
+    {4.848064958e+04f, -3.444464546e+02f, 7.481355788e+00f, -2.035919896e-01f},
+    {4.814348089e+04f, -3.300945190e+02f, 6.871377743e+00f, -1.796582423e-01f},
+    {4.782007809e+04f, -3.168907382e+02f, 6.333053494e+00f, -1.593338909e-01f},
+    {4.750936107e+04f, -3.047026329e+02f, 5.855586375e+00f, -1.419633501e-01f},
+    {4.721037206e+04f, -2.934173502e+02f, 5.296433624e+00f, 3.793118061e-02f},
+    {4.692228908e+04f, -2.827106894e+02f, 5.458652598e+00f, -1.282436647e-01f},
+    {4.664490880e+04f, -2.721781152e+02f, 5.074285753e+00f, -1.153096676e-01f},
+    {4.637768966e+04f, -2.623754727e+02f, 4.728663233e+00f, -1.040484292e-01f},
+    {4.611993880e+04f, -2.532302915e+02f, 4.416777359e+00f, -9.419891405e-02f},
+    {4.587103109e+04f, -4.893586671e+02f, 1.651452758e+01f, -6.534827363e-01f},
+    {4.539753347e+04f, -4.582900602e+02f, 1.455928913e+01f, -5.450315675e-01f},
+    {4.495325766e+04f, -4.308065766e+02f, 1.292808870e+01f, -4.591934489e-01f},
+    {4.453491998e+04f, -4.063279796e+02f, 1.155346563e+01f, -3.903851541e-01f},
+    {4.413975508e+04f, -3.843922037e+02f, 1.038458795e+01f, -3.345963769e-01f},
+    {4.376541287e+04f, -3.646268170e+02f, 9.382575792e+00f, -2.888967057e-01f},
+    {4.340987973e+04f, -3.467283555e+02f, 8.517288095e+00f, -2.511114444e-01f},
+    {4.307141755e+04f, -3.304471136e+02f, 7.765072318e+00f, -2.196039541e-01f},
+    {4.274851591e+04f, -3.155757809e+02f, 7.107161253e+00f, -1.931267271e-01f},
+    {4.243985416e+04f, -3.019408386e+02f, 6.528512957e+00f, -1.707177251e-01f},
+    {4.214427112e+04f, -2.893959658e+02f, 6.016959300e+00f, -1.516270842e-01f},
+    {4.186074049e+04f, -2.778169285e+02f, 5.562572858e+00f, -1.352645408e-01f},
+    {4.158835087e+04f, -2.670975764e+02f, 5.157190491e+00f, -1.211612199e-01f},
+    {4.132628932e+04f, -2.571466790e+02f, 4.794050869e+00f, -1.089415219e-01f},
+    {4.107382775e+04f, -2.478854019e+02f, 4.467515861e+00f, -9.830220191e-02f},
+    {4.083031156e+04f, -2.392452768e+02f, 4.172854342e+00f, -8.899664064e-02f},
+    {4.059515014e+04f, -4.623331160e+02f, 1.560248854e+01f, -6.173931924e-01f},
+    {4.014780212e+04f, -4.329803185e+02f, 1.375523101e+01f, -5.149313987e-01f},
+    {3.972806210e+04f, -4.070146507e+02f, 1.221411601e+01f, -4.338338163e-01f},
+    {3.933282773e+04f, -3.838879201e+02f, 1.091540852e+01f, -3.688255606e-01f},
+    {3.895948640e+04f, -3.631635797e+02f, 9.811083831e+00f, -3.161178005e-01f},
+    {3.860581778e+04f, -3.444897655e+02f, 8.864409263e+00f, -2.729419608e-01f},
+    {3.826991948e+04f, -3.275797728e+02f, 8.046908351e+00f, -2.372434461e-01f},
+    {3.795014938e+04f, -3.121976865e+02f, 7.336234794e+00f, -2.074760032e-01f},
+    {3.764508045e+04f, -2.981476449e+02f, 6.714657834e+00f, -1.824610199e-01f},
+    {3.735346500e+04f, -2.852657123e+02f, 6.167966240e+00f, -1.612895880e-01f},
+    {3.707420597e+04f, -2.734136486e+02f, 5.684663886e+00f, -1.432532558e-01f},
+    {3.680633373e+04f, -2.624740806e+02f, 5.255371602e+00f, -1.277943578e-01f},
+    {3.654898722e+04f, -2.523467204e+02f, 4.872377071e+00f, -1.144699136e-01f},
+    {3.630139841e+04f, -2.429453760e+02f, 4.529292369e+00f, -1.029250663e-01f},
+    {3.606287940e+04f, -2.341955665e+02f, 4.220790736e+00f, -9.287331840e-02f},
+    {3.583281175e+04f, -2.260326050e+02f, 3.942402332e+00f, -8.408167048e-02f},
+    {3.561063747e+04f, -4.368000906e+02f, 1.474081820e+01f, -5.832967466e-01f},
+    {3.518799490e+04f, -4.090683445e+02f, 1.299557817e+01f, -4.864935559e-01f},
+    {3.479143564e+04f, -3.845366688e+02f, 1.153957352e+01f, -4.098747066e-01f},
+    {3.441802867e+04f, -3.626871459e+02f, 1.031258906e+01f, -3.484566273e-01f},
+    {3.406530566e+04f, -3.431073377e+02f, 9.269252317e+00f, -2.986597307e-01f},
+    {3.373116891e+04f, -3.254648122e+02f, 8.374859243e+00f, -2.578683402e-01f},
+    {3.341382109e+04f, -3.094886988e+02f, 7.602506018e+00f, -2.241413284e-01f},
+    {3.311171076e+04f, -2.949561107e+02f, 6.931080453e+00f, -1.960178362e-01f},
+    {3.282348971e+04f, -2.816820033e+02f, 6.343830993e+00f, -1.723843421e-01f},
+    {3.254797915e+04f, -2.695114943e+02f, 5.827331246e+00f, -1.523821336e-01f},
+    {3.228414261e+04f, -2.583139783e+02f, 5.370719974e+00f, -1.353418844e-01f},
+    {3.203106401e+04f, -2.479785640e+02f, 4.832181786e+00f, -1.650580095e-01f},
+    {3.178775257e+04f, -2.388093744e+02f, 4.386569057e+00f, -1.005383382e-01f},
+    {3.155322922e+04f, -2.303378513e+02f, 4.085231267e+00f, -9.056303272e-02f},
+    {3.132688604e+04f, -2.224390779e+02f, 3.813775911e+00f, -8.186228788e-02f},
+    {3.110817887e+04f, -2.150571129e+02f, 3.568387234e+00f, -7.423910373e-02f},
+    {3.089661591e+04f, -4.162861115e+02f, 1.336543682e+01f, -5.162672491e-01f},
+    {3.049317897e+04f, -3.911040396e+02f, 1.182063436e+01f, -4.319268235e-01f},
+    {3.011346364e+04f, -3.687585514e+02f, 1.052785239e+01f, -3.649699960e-01f},
+    {2.975486797e+04f, -3.487977566e+02f, 9.435225959e+00f, -3.111433815e-01f},
+    {2.941519429e+04f, -3.308607348e+02f, 8.503559447e+00f, -2.673830524e-01f},
+    {2.909256973e+04f, -3.146557651e+02f, 7.702789706e+00f, -2.314440116e-01f},
+    {2.878538532e+04f, -2.999445177e+02f, 7.009549012e+00f, -2.016558897e-01f},
+    {2.849224869e+04f, -2.865303874e+02f, 6.405453830e+00f, -1.767584832e-01f},
+    {2.821194700e+04f, -2.742497552e+02f, 5.875882594e+00f, -1.557889479e-01f},
+    {2.794341734e+04f, -2.629653568e+02f, 5.409089148e+00f, -1.380030903e-01f},
+    {2.768572307e+04f, -2.525611878e+02f, 4.995550545e+00f, -1.228195885e-01f},
+    {2.743803461e+04f, -2.429385455e+02f, 4.627481018e+00f, -1.097798966e-01f},
+    {2.719961377e+04f, -2.340129231e+02f, 4.298465460e+00f, -9.851904036e-02f},
+    {2.696980079e+04f, -2.257115493e+02f, 4.003179996e+00f, -8.874408750e-02f},
+    {2.674800367e+04f, -2.179714216e+02f, 3.737176781e+00f, -8.021809590e-02f},
+    {2.653368921e+04f, -2.107377223e+02f, 3.496716698e+00f, -7.274802214e-02f},
+    {2.632637546e+04f, -4.079250660e+02f, 1.309699398e+01f, -5.058980971e-01f},
+    {2.593104149e+04f, -3.832487723e+02f, 1.158321865e+01f, -4.232516364e-01f},
+    {2.555895268e+04f, -3.613520899e+02f, 1.031640202e+01f, -3.576396271e-01f},
+    {2.520755936e+04f, -3.417922048e+02f, 9.245720827e+00f, -3.048941123e-01f},
+    {2.487470798e+04f, -3.242154454e+02f, 8.332766701e+00f, -2.620127029e-01f},
+    {2.455856329e+04f, -3.083359501e+02f, 7.548080303e+00f, -2.267954926e-01f},
+    {2.425754862e+04f, -2.939201760e+02f, 6.868763247e+00f, -1.976056607e-01f},
+    {2.397029960e+04f, -2.807754665e+02f, 6.276801228e+00f, -1.732083149e-01f},
+    {2.369562773e+04f, -2.687414890e+02f, 5.757866353e+00f, -1.526599498e-01f},
+    {2.343249145e+04f, -2.576837361e+02f, 5.300448385e+00f, -1.352313185e-01f},
+    {2.317997293e+04f, -2.474885333e+02f, 4.895215644e+00f, -1.203527751e-01f},
+    {2.293725926e+04f, -2.380591604e+02f, 4.534538739e+00f, -1.075749834e-01f},
+    {2.270362706e+04f, -2.293128078e+02f, 4.212131410e+00f, -9.654029986e-02f},
+    {2.247842984e+04f, -2.211781659e+02f, 3.922776712e+00f, -8.696167551e-02f},
+    {2.226108749e+04f, -2.135934975e+02f, 3.662116132e+00f, -7.860692715e-02f},
+    {2.205107750e+04f, -2.065050860e+02f, 3.426485656e+00f, -7.128688887e-02f},
+    {2.184792762e+04f, -3.997319508e+02f, 1.283394277e+01f, -4.957372078e-01f},
+    {2.146053387e+04f, -3.755512768e+02f, 1.135057140e+01f, -4.147506893e-01f},
+    {2.109591842e+04f, -3.540943861e+02f, 1.010919859e+01f, -3.504564875e-01f},
+    {2.075158277e+04f, -3.349273584e+02f, 9.060021879e+00f, -2.987703587e-01f},
+    {2.042541666e+04f, -3.177036257e+02f, 8.165404302e+00f, -2.567502162e-01f},
+    {2.011562169e+04f, -3.021430677e+02f, 7.412278141e+00f, -3.123148029e-01f},
+    {1.982057859e+04f, -2.882554559e+02f, 6.544958153e+00f, -1.856901331e-01f},
+    {1.953868240e+04f, -2.757226100e+02f, 5.988678114e+00f, -1.629713820e-01f},
+    {1.926878550e+04f, -2.642341679e+02f, 5.500402690e+00f, -1.438128882e-01f},
+    {1.900990792e+04f, -2.536648012e+02f, 5.069484720e+00f, -1.275436448e-01f},
+    {1.876118506e+04f, -2.439084627e+02f, 4.687281686e+00f, -1.136388686e-01f},
+    {1.852185024e+04f, -2.348748159e+02f, 4.346719340e+00f, -1.016841329e-01f},
+    {1.829122046e+04f, -2.264864296e+02f, 4.041962261e+00f, -9.134921289e-02f},
+    {1.806868464e+04f, -2.186765527e+02f, 3.768162386e+00f, -8.236878278e-02f},
+    {1.785369388e+04f, -2.113873343e+02f, 3.521265147e+00f, -7.452800898e-02f},
+    {1.764575329e+04f, -2.045683880e+02f, 3.297858592e+00f, -6.765168567e-02f},
+    {1.744441510e+04f, -3.963512518e+02f, 1.236402803e+01f, -4.710921833e-01f},
+    {1.705995679e+04f, -3.730364723e+02f, 1.095434232e+01f, -3.948120609e-01f},
+    {1.669747985e+04f, -3.523122238e+02f, 9.772602918e+00f, -3.341524040e-01f},
+    {1.635460607e+04f, -3.337694752e+02f, 8.772202747e+00f, -2.853105776e-01f},
+    {1.602932349e+04f, -3.170810015e+02f, 7.917862098e+00f, -2.455429627e-01f},
+    {1.571991481e+04f, -3.019819062e+02f, 7.182479451e+00f, -2.128362072e-01f},
+    {1.542490255e+04f, -2.882554559e+02f, 6.544958153e+00f, -1.856901331e-01f},
+    {1.514300636e+04f, -2.757226100e+02f, 5.988678114e+00f, -1.629713820e-01f},
+    {1.487310945e+04f, -2.642341679e+02f, 5.500402690e+00f, -1.438128882e-01f},
+    {1.461423188e+04f, -2.536648012e+02f, 5.069484720e+00f, -1.275436448e-01f},
+    {1.436550902e+04f, -2.439084627e+02f, 4.687281686e+00f, -1.136388686e-01f},
+    {1.412617420e+04f, -2.348748159e+02f, 4.346719340e+00f, -1.016841329e-01f},
+    {1.389554442e+04f, -2.264864296e+02f, 4.041962261e+00f, -9.134921290e-02f},
+    {1.367300860e+04f, -2.186765527e+02f, 3.768162386e+00f, -8.236878278e-02f},
+    {1.345801784e+04f, -2.113873343e+02f, 3.521265147e+00f, -7.452800898e-02f},
+    {1.325007724e+04f, -2.045683880e+02f, 3.297858592e+00f, -6.765168567e-02f},
+    {1.304873906e+04f, -3.963512518e+02f, 1.236402803e+01f, -4.710921833e-01f},
+    {1.266428075e+04f, -3.730364723e+02f, 1.095434232e+01f, -3.948120609e-01f},
+    {1.230180380e+04f, -3.523122238e+02f, 9.772602918e+00f, -3.341524040e-01f},
+    {1.195893003e+04f, -3.337694752e+02f, 8.772202747e+00f, -2.853105776e-01f},
+    {1.163364745e+04f, -3.170810015e+02f, 7.917862098e+00f, -2.455429627e-01f},
+    {1.132423876e+04f, -3.019819062e+02f, 7.182479451e+00f, -2.128362072e-01f},
+    {1.102922650e+04f, -2.882554559e+02f, 5.762680289e+00f, -3.635400968e-01f},
+    {1.074637019e+04f, -2.778207156e+02f, 4.886799822e+00f, -1.208048717e-01f},
+    {1.047331547e+04f, -2.684095306e+02f, 4.524809197e+00f, -1.074524625e-01f},
+    {1.020932329e+04f, -2.596822695e+02f, 4.202800151e+00f, -9.602511649e-02f},
+    {9.953747797e+03f, -2.515647446e+02f, 3.915013212e+00f, -8.618526120e-02f},
+    {9.706011881e+03f, -2.439932740e+02f, 3.656697928e+00f, -7.766430349e-02f},
+    {9.465597640e+03f, -2.369128710e+02f, 3.423906897e+00f, -7.024667131e-02f},
+    {9.232038429e+03f, -2.302757972e+02f, 3.213337391e+00f, -6.375795003e-02f},
+    {9.004912212e+03f, -2.240403963e+02f, 3.022208378e+00f, -5.805596610e-02f},
+    {8.783835968e+03f, -2.181701474e+02f, 2.848164174e+00f, -5.302401732e-02f},
+    {8.568460960e+03f, -4.252657823e+02f, 1.074480701e+01f, -3.724829078e-01f},
+    {8.153567502e+03f, -4.048936170e+02f, 9.629904806e+00f, -3.156883902e-01f},
+    {7.757988102e+03f, -3.865808725e+02f, 8.684773094e+00f, -2.700283588e-01f},
+    {7.379821974e+03f, -3.700214114e+02f, 7.876178112e+00f, -2.328824368e-01f},
+    {7.017443858e+03f, -3.549677025e+02f, 7.178694697e+00f, -2.023402368e-01f},
+    {6.669452510e+03f, -3.412173338e+02f, 6.572594149e+00f, -1.769859679e-01f},
+    {6.334630784e+03f, -3.286031034e+02f, 6.042371731e+00f, -1.557547738e-01f},
+    {6.011914298e+03f, -3.169856243e+02f, 5.575701182e+00f, -1.378349617e-01f},
+    {5.700366540e+03f, -3.062477268e+02f, 5.162680058e+00f, -1.226002382e-01f},
+    {5.399158893e+03f, -2.962901674e+02f, 4.795276792e+00f, -1.095619577e-01f},
+    {5.107554440e+03f, -2.870282997e+02f, 4.466919987e+00f, -9.833495954e-02f},
+    {4.824894726e+03f, -2.783894646e+02f, 4.172189512e+00f, -8.861278641e-02f},
+    {4.550588838e+03f, -2.703109239e+02f, 3.906581491e+00f, -8.014947665e-02f},
+    {4.284104346e+03f, -2.627382094e+02f, 3.666327605e+00f, -7.274602814e-02f},
+    {4.024959718e+03f, -2.556237923e+02f, 3.448254777e+00f, -6.624022481e-02f},
+    {3.772717940e+03f, -2.489260034e+02f, 3.249675234e+00f, -6.049891275e-02f},
+    {3.526981113e+03f, -4.852162993e+02f, 1.225952266e+01f, -4.249925238e-01f},
+    {3.053599344e+03f, -4.619722316e+02f, 1.098745060e+01f, -3.601915762e-01f},
+    {2.602254372e+03f, -4.410779051e+02f, 9.909081889e+00f, -3.080947644e-01f},
+    {2.170777454e+03f, -4.221840256e+02f, 8.986497752e+00f, -2.657123118e-01f},
+    {1.757314213e+03f, -4.050081670e+02f, 8.190688788e+00f, -2.308645204e-01f},
+    {1.360265871e+03f, -3.893193830e+02f, 7.499145105e+00f, -2.019360126e-01f},
+    {9.782436967e+02f, -3.749269009e+02f, 6.894176237e+00f, -1.777118171e-01f},
+    {6.100332602e+02f, -3.616716838e+02f, 6.361718263e+00f, -1.572658154e-01f},
+    {2.545660288e+02f, -3.494200448e+02f, 5.890472774e+00f, -1.398834244e-01f},
+    {-8.910342656e+01f, -3.380587495e+02f, 5.471275979e+00f, -1.250071129e-01f},
+    {-4.218159072e+02f, -3.274912189e+02f, 5.096630097e+00f, -1.121974237e-01f},
+    {-7.443226934e+02f, -3.176345509e+02f, 4.760350913e+00f, -1.011046975e-01f},
+    {-1.057297998e+03f, -3.084171632e+02f, 4.457299630e+00f, -9.144829908e-02f},
+    {-1.361349310e+03f, -2.997769088e+02f, 4.183176702e+00f, -8.300117252e-02f},
+    {-1.657026043e+03f, -2.916595590e+02f, 3.934361737e+00f, -7.557823386e-02f},
+    {-1.944826819e+03f, -2.840175702e+02f, 3.707788062e+00f, -6.902755826e-02f},
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+ * Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+ * M3FC receive handlers, indexed by CAN ID for m3can_dispatch().
+ */
+
+#include "m3can.h"
+
+void m3fc_config_handle_load(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_save(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_accel_cal_x(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_accel_cal_y(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_accel_cal_z(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_crc(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_profile(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_pyros(uint8_t* data, uint8_t datalen);
+void m3fc_config_handle_set_radio_freq(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_arm(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_fire(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_psu_charger_status(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_pyro_arm(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_pyro_continuity(uint8_t* data, uint8_t datalen);
+void m3fc_mission_handle_pyro_supply(uint8_t* data, uint8_t datalen);
+void m3fc_mock_handle_accel(uint8_t* data, uint8_t datalen);
+void m3fc_mock_handle_baro(uint8_t* data, uint8_t datalen);
+void m3fc_mock_handle_enable(uint8_t* data, uint8_t datalen);
+
+static const struct m3can_handler m3fc_can_handlers[] = {
+    {CAN_MSG_ID_M3FC_SET_CFG_PROFILE, 8, 8, m3fc_config_handle_set_profile},
+    {CAN_MSG_ID_M3FC_SET_CFG_PYROS, 8, 8, m3fc_config_handle_set_pyros},
+    {CAN_MSG_ID_M3FC_LOAD_CFG, 0, 0, m3fc_config_handle_load},
+    {CAN_MSG_ID_M3FC_SAVE_CFG, 0, 0, m3fc_config_handle_save},
+    {CAN_MSG_ID_M3FC_MOCK_ENABLE, 0, 0, m3fc_mock_handle_enable},
+    {CAN_MSG_ID_M3FC_MOCK_ACCEL, 6, 6, m3fc_mock_handle_accel},
+    {CAN_MSG_ID_M3FC_MOCK_BARO, 8, 8, m3fc_mock_handle_baro},
+    {CAN_MSG_ID_M3FC_ARM, 0, 0, m3fc_mission_handle_arm},
+    {CAN_MSG_ID_M3FC_FIRE, 1, 1, m3fc_mission_handle_fire},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X, 8, 8, m3fc_config_handle_set_accel_cal_x},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y, 8, 8, m3fc_config_handle_set_accel_cal_y},
+    {CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z, 8, 8, m3fc_config_handle_set_accel_cal_z},
+    {CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ, 4, 4, m3fc_config_handle_set_radio_freq},
+    {CAN_MSG_ID_M3FC_SET_CFG_CRC, 4, 4, m3fc_config_handle_set_crc},
+    {CAN_MSG_ID_M3PYRO_ARM_STATUS, 1, 1, m3fc_mission_handle_pyro_arm},
+    {CAN_MSG_ID_M3PYRO_CONTINUITY, 4, 8, m3fc_mission_handle_pyro_continuity},
+    {CAN_MSG_ID_M3PYRO_SUPPLY_STATUS, 1, 2, m3fc_mission_handle_pyro_supply},
+    {CAN_MSG_ID_M3PSU_CHARGER_STATUS, 5, 5, m3fc_mission_handle_psu_charger_status},
+};
+
+static const uint8_t m3fc_can_index[M3CAN_DISPATCH_SLOTS] = {
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_PROFILE)] = 1,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_PYROS)] = 2,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_LOAD_CFG)] = 3,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SAVE_CFG)] = 4,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_MOCK_ENABLE)] = 5,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_MOCK_ACCEL)] = 6,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_MOCK_BARO)] = 7,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_ARM)] = 8,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_FIRE)] = 9,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X)] = 10,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y)] = 11,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z)] = 12,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ)] = 13,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3FC_SET_CFG_CRC)] = 14,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PYRO_ARM_STATUS)] = 15,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PYRO_CONTINUITY)] = 16,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PYRO_SUPPLY_STATUS)] = 17,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_CHARGER_STATUS)] = 18,
+};
+
+const struct m3can_dispatch_table m3fc_can_dispatch = {
+    m3fc_can_index, m3fc_can_handlers,
+};
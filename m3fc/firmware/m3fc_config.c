@@ -1,5 +1,8 @@
+#include <string.h>
+
 #include "m3fc_config.h"
 #include "m3can.h"
+#include "m3can_bulk.h"
 #include "m3fc_status.h"
 #include "m3flash.h"
 
@@ -14,52 +17,85 @@ static bool m3fc_config_check_accel_cal(void);
 static bool m3fc_config_check_radio_freq(void);
 static bool m3fc_config_check_crc(void);
 
+/* Whole config snapshots sent and received over bulk transfer */
+static uint8_t m3fc_config_bulk_tx_buf[sizeof(struct m3fc_config)];
+static uint8_t m3fc_config_bulk_rx_buf[sizeof(struct m3fc_config)];
+
+/* How often the reporter looks for changes, and how often it sends the CRC
+ * alone when nothing has changed.
+ */
+#define M3FC_CONFIG_POLL_MS     (1000)
+#define M3FC_CONFIG_DIGEST_MS   (5000)
+
+/* The config as last sent over CAN, and the one being compared with it */
+static struct m3fc_config m3fc_config_reported, m3fc_config_current;
+static bool m3fc_config_reported_valid;
+
+/* Signalled to send the whole config at once, for a remote frame */
+static BSEMAPHORE_DECL(m3fc_config_report_sem, true);
+static volatile bool m3fc_config_report_requested;
+
+static void m3fc_config_send(const struct m3fc_config* cfg)
+{
+    m3can_send_m3fc_cfg_profile(cfg->profile.m3fc_position,
+                                cfg->profile.accel_axis,
+                                cfg->profile.ignition_accel,
+                                cfg->profile.burnout_timeout,
+                                cfg->profile.apogee_timeout,
+                                cfg->profile.main_altitude,
+                                cfg->profile.main_timeout,
+                                cfg->profile.land_timeout);
+    m3can_send_m3fc_cfg_pyros((const uint8_t*)&cfg->pyros);
+    m3can_send_m3fc_cfg_accel_x(cfg->accel_cal.x_scale,
+                                cfg->accel_cal.x_offset);
+    m3can_send_m3fc_cfg_accel_y(cfg->accel_cal.y_scale,
+                                cfg->accel_cal.y_offset);
+    m3can_send_m3fc_cfg_accel_z(cfg->accel_cal.z_scale,
+                                cfg->accel_cal.z_offset);
+    m3can_send_m3fc_cfg_radio_freq(cfg->radio_freq);
+    m3can_send_m3fc_cfg_crc(cfg->crc);
+}
+
 static THD_WORKING_AREA(m3fc_config_reporter_thd_wa, 256);
 static THD_FUNCTION(m3fc_config_reporter_thd, arg) {
     (void)arg;
+    systime_t last_sent = chVTGetSystemTimeX();
 
     while(true) {
-        /* Send current config over CAN every 5s */
-        m3can_send_u8(CAN_MSG_ID_M3FC_CFG_PROFILE,
-                      m3fc_config.profile.m3fc_position,
-                      m3fc_config.profile.accel_axis,
-                      m3fc_config.profile.ignition_accel,
-                      m3fc_config.profile.burnout_timeout,
-                      m3fc_config.profile.apogee_timeout,
-                      m3fc_config.profile.main_altitude,
-                      m3fc_config.profile.main_timeout,
-                      m3fc_config.profile.land_timeout, 8);
-        m3can_send_u8(CAN_MSG_ID_M3FC_CFG_PYROS,
-                      m3fc_config.pyros.pyro1,
-                      m3fc_config.pyros.pyro2,
-                      m3fc_config.pyros.pyro3,
-                      m3fc_config.pyros.pyro4,
-                      m3fc_config.pyros.pyro5,
-                      m3fc_config.pyros.pyro6,
-                      m3fc_config.pyros.pyro7,
-                      m3fc_config.pyros.pyro8, 8);
-        m3can_send_f32(CAN_MSG_ID_M3FC_CFG_ACCEL_X,
-                       m3fc_config.accel_cal.x_scale,
-                       m3fc_config.accel_cal.x_offset, 2);
-        m3can_send_f32(CAN_MSG_ID_M3FC_CFG_ACCEL_Y,
-                       m3fc_config.accel_cal.y_scale,
-                       m3fc_config.accel_cal.y_offset, 2);
-        m3can_send_f32(CAN_MSG_ID_M3FC_CFG_ACCEL_Z,
-                       m3fc_config.accel_cal.z_scale,
-                       m3fc_config.accel_cal.z_offset, 2);
-        m3can_send_u32(CAN_MSG_ID_M3FC_CFG_RADIO_FREQ,
-                       m3fc_config.radio_freq, 0, 1);
-        m3can_send_u32(CAN_MSG_ID_M3FC_CFG_CRC,
-                       m3fc_config.crc, 0, 1);
-
-        /* Check the config. Sets an error inside the relevant config check
-         * functions, so no need to handle the error case here.
+        chSysLock();
+        memcpy(&m3fc_config_current, &m3fc_config, sizeof(m3fc_config));
+        chSysUnlock();
+
+        /* Send the whole config when it changes or is asked for, and
+         * otherwise just its CRC every 5s so receivers can tell it is
+         * unchanged.
          */
-        if(m3fc_config_check()) {
+        bool changed = !m3fc_config_reported_valid ||
+                       memcmp(&m3fc_config_current, &m3fc_config_reported,
+                              sizeof(m3fc_config)) != 0;
+        if(changed || m3fc_config_report_requested) {
+            m3fc_config_report_requested = false;
+            m3fc_config_send(&m3fc_config_current);
+            memcpy(&m3fc_config_reported, &m3fc_config_current,
+                   sizeof(m3fc_config));
+            m3fc_config_reported_valid = true;
+            last_sent = chVTGetSystemTimeX();
+        } else if(ST2MS(chVTTimeElapsedSinceX(last_sent)) >=
+                  M3FC_CONFIG_DIGEST_MS) {
+            m3can_send_m3fc_cfg_crc(m3fc_config_current.crc);
+            last_sent = chVTGetSystemTimeX();
+        }
+
+        /* Check the config when it changes. Sets an error inside the
+         * relevant config check functions, so no need to handle the error
+         * case here.
+         */
+        if(changed && m3fc_config_check()) {
             m3status_set_ok(M3FC_COMPONENT_CFG);
         }
 
-        chThdSleepMilliseconds(5000);
+        chBSemWaitTimeout(&m3fc_config_report_sem,
+                          MS2ST(M3FC_CONFIG_POLL_MS));
     }
 }
 
@@ -83,6 +119,36 @@ void m3fc_config_save() {
     }
 }
 
+static size_t m3fc_config_bulk_read(uint8_t port, uint8_t* buf, size_t size)
+{
+    (void)port;
+    (void)size;
+
+    chSysLock();
+    memcpy(buf, &m3fc_config, sizeof(m3fc_config));
+    chSysUnlock();
+
+    return sizeof(m3fc_config);
+}
+
+static void m3fc_config_bulk_write(uint8_t src, uint8_t port,
+                                   const uint8_t* data, size_t len)
+{
+    (void)src;
+    (void)port;
+
+    if(len != sizeof(m3fc_config)) {
+        m3status_set_error(M3FC_COMPONENT_CFG, M3FC_ERROR_CAN_BAD_COMMAND);
+        return;
+    }
+
+    chSysLock();
+    memcpy(&m3fc_config, data, sizeof(m3fc_config));
+    chSysUnlock();
+
+    m3fc_config_check();
+}
+
 void m3fc_config_init() {
     m3status_set_init(M3FC_COMPONENT_CFG);
 
@@ -90,6 +156,18 @@ void m3fc_config_init() {
         m3status_set_error(M3FC_COMPONENT_CFG, M3FC_ERROR_CFG_READ);
     }
 
+    /* The whole config can be read and written in one bulk transfer, as
+     * well as a field at a time with the CFG messages.
+     */
+    m3can_bulk_register_tx(M3CAN_BULK_PORT_M3FC_CONFIG,
+                           m3fc_config_bulk_tx_buf,
+                           sizeof(m3fc_config_bulk_tx_buf),
+                           m3fc_config_bulk_read);
+    m3can_bulk_register_rx(M3CAN_BULK_PORT_M3FC_CONFIG,
+                           m3fc_config_bulk_rx_buf,
+                           sizeof(m3fc_config_bulk_rx_buf),
+                           m3fc_config_bulk_write);
+
     chThdCreateStatic(m3fc_config_reporter_thd_wa,
                       sizeof(m3fc_config_reporter_thd_wa),
                       NORMALPRIO, m3fc_config_reporter_thd, NULL);
@@ -203,19 +281,9 @@ static bool m3fc_config_check_radio_freq(void)
 
 static bool m3fc_config_check_crc(void)
 {
-    uint32_t crc;
-    uint32_t *src = (uint32_t*)&m3fc_config;
-
     /* Subtract one so we don't compute over the stored checksum */
     size_t n = (sizeof(struct m3fc_config) / 4) - 1;
-
-    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
-    CRC->CR |= CRC_CR_RESET;
-    for(size_t i=0; i<n; i++) {
-        CRC->DR = src[i];
-    }
-    crc = CRC->DR;
-    RCC->AHB1ENR &= ~RCC_AHB1ENR_CRCEN;
+    uint32_t crc = m3flash_crc((uint32_t*)&m3fc_config, n);
 
     bool ok = crc == m3fc_config.crc;
 
@@ -323,6 +391,23 @@ void m3fc_config_handle_set_crc(uint8_t* data, uint8_t datalen) {
     m3fc_config.crc = u32data[0];
 }
 
+void m3fc_config_handle_rtr(uint16_t msg_id) {
+    switch(msg_id) {
+    case CAN_MSG_ID_M3FC_CFG_PROFILE:
+    case CAN_MSG_ID_M3FC_CFG_PYROS:
+    case CAN_MSG_ID_M3FC_CFG_ACCEL_X:
+    case CAN_MSG_ID_M3FC_CFG_ACCEL_Y:
+    case CAN_MSG_ID_M3FC_CFG_ACCEL_Z:
+    case CAN_MSG_ID_M3FC_CFG_RADIO_FREQ:
+    case CAN_MSG_ID_M3FC_CFG_CRC:
+        m3fc_config_report_requested = true;
+        chBSemSignal(&m3fc_config_report_sem);
+        break;
+    default:
+        break;
+    }
+}
+
 void m3fc_config_handle_load(uint8_t* data, uint8_t datalen) {
     (void)data;
     (void)datalen;
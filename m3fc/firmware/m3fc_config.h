@@ -98,5 +98,8 @@ void m3fc_config_handle_set_crc(uint8_t* data, uint8_t datalen);
 void m3fc_config_handle_load(uint8_t* data, uint8_t datalen);
 void m3fc_config_handle_save(uint8_t* data, uint8_t datalen);
 
+/* A remote frame for any of the CFG messages sends the whole config */
+void m3fc_config_handle_rtr(uint16_t msg_id);
+
 
 #endif
@@ -6,88 +6,101 @@
 #include "m3fc_config.h"
 #include "m3fc_state_estimation.h"
 #include "m3fc_ui.h"
+#include "ms5611.h"
+#include "adxl345.h"
 
 #define PYRO_SUPPLY_THRESHOLD       (40)
 #define PYRO_CONT_THRESHOLD         (100)
 
-volatile bool m3fc_mission_pyro_armed = false;
-volatile bool m3fc_mission_pyro_supply_good = false;
-volatile bool m3fc_mission_pyro_cont_ok = false;
-volatile bool m3fc_mission_psu_battleshort = false;
-
-static volatile bool m3fc_mission_armed = false;
-
-typedef enum {
-    STATE_INIT = 0, STATE_PAD, STATE_IGNITION, STATE_POWERED_ASCENT,
-    STATE_BURNOUT, STATE_FREE_ASCENT, STATE_APOGEE, STATE_DROGUE_DESCENT,
-    STATE_RELEASE_MAIN, STATE_MAIN_DESCENT, STATE_LAND, STATE_LANDED,
-    NUM_STATES
-} state_t;
-
-struct instance_data {
-    systime_t t_launch;
-    systime_t t_apogee;
-    systime_t t_land;
-    float h_ground;
-    state_estimate_t state;
-};
+/* The firmware's single mission controller, stepped by the mission thread
+ * and fed by the CAN handlers below.
+ */
+static struct m3fc_mission_controller mission;
 
-typedef struct instance_data instance_data_t;
+typedef struct m3fc_mission_controller mc_t;
 
-typedef state_t state_func_t(instance_data_t *data);
+typedef state_t state_func_t(mc_t *mc, systime_t now);
 
-static void m3fc_mission_send_state(state_t state, instance_data_t *data);
+static void m3fc_mission_send_state(state_t state);
 static uint8_t m3fc_mission_make_pyro_channel(int usage, uint8_t pyro);
 static void m3fc_mission_fire_pyro(int pyro_usage);
 static void m3fc_mission_fire_drogue_pyro(void);
 static void m3fc_mission_fire_main_pyro(void);
 static void m3fc_mission_fire_dart_pyro(void);
-static void m3fc_mission_check_pyros(void);
-static void m3fc_mission_check_psu(void);
+static void m3fc_mission_check_pyros(mc_t *mc);
+static void m3fc_mission_check_psu(mc_t *mc);
 static void m3fc_mission_enable_low_power_mode(void);
-
-state_t run_state(state_t cur_state, instance_data_t *data);
-static state_t do_state_init(instance_data_t *data);
-static state_t do_state_pad(instance_data_t *data);
-static state_t do_state_ignition(instance_data_t *data);
-static state_t do_state_powered_ascent(instance_data_t *data);
-static state_t do_state_burnout(instance_data_t *data);
-static state_t do_state_free_ascent(instance_data_t *data);
-static state_t do_state_apogee(instance_data_t *data);
-static state_t do_state_drogue_descent(instance_data_t *data);
-static state_t do_state_release_main(instance_data_t *data);
-static state_t do_state_main_descent(instance_data_t *data);
-static state_t do_state_land(instance_data_t *data);
-static state_t do_state_landed(instance_data_t *data);
-
-state_func_t* const state_table[NUM_STATES] = {
+static void m3fc_mission_apply(state_t cur_state);
+
+static state_t do_state_init(mc_t *mc, systime_t now);
+static state_t do_state_pad(mc_t *mc, systime_t now);
+static state_t do_state_ignition(mc_t *mc, systime_t now);
+static state_t do_state_powered_ascent(mc_t *mc, systime_t now);
+static state_t do_state_burnout(mc_t *mc, systime_t now);
+static state_t do_state_free_ascent(mc_t *mc, systime_t now);
+static state_t do_state_apogee(mc_t *mc, systime_t now);
+static state_t do_state_drogue_descent(mc_t *mc, systime_t now);
+static state_t do_state_release_main(mc_t *mc, systime_t now);
+static state_t do_state_main_descent(mc_t *mc, systime_t now);
+static state_t do_state_land(mc_t *mc, systime_t now);
+static state_t do_state_landed(mc_t *mc, systime_t now);
+
+static state_func_t* const state_table[NUM_STATES] = {
     do_state_init, do_state_pad, do_state_ignition, do_state_powered_ascent,
     do_state_burnout, do_state_free_ascent, do_state_apogee,
     do_state_drogue_descent, do_state_release_main, do_state_main_descent,
     do_state_land, do_state_landed
 };
 
-state_t run_state(state_t cur_state, instance_data_t *data) {
-    return state_table[cur_state](data);
-};
+void m3fc_mission_controller_init(mc_t *mc,
+                                  const struct m3fc_config* config)
+{
+    mc->state = STATE_INIT;
+    mc->t_launch = 0;
+    mc->t_apogee = 0;
+    mc->t_land = 0;
+    mc->h_ground = 0.0f;
+    mc->estimate.h = mc->estimate.v = mc->estimate.a = 0.0f;
+    mc->config = config;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
+    mc->beeper_mode = M3FC_UI_BEEPER_OFF;
+    mc->baro_osr = MS5611_OSR_4096;
+    mc->fire_usage = M3FC_CONFIG_PYRO_USAGE_NONE;
+    mc->low_power = false;
+}
+
+state_t m3fc_mission_controller_step(mc_t *mc, state_estimate_t estimate,
+                                     systime_t now)
+{
+    mc->estimate = estimate;
+    mc->fire_usage = M3FC_CONFIG_PYRO_USAGE_NONE;
+    mc->low_power = false;
+    mc->state = state_table[mc->state](mc, now);
+    return mc->state;
+}
 
-static state_t do_state_init(instance_data_t *data) {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+static state_t do_state_init(mc_t *mc, systime_t now) {
+    (void)now;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
-    data->h_ground = data->state.h;
+    /* On the ground we have time for the lowest noise barometer readings */
+    mc->baro_osr = MS5611_OSR_4096;
 
-    m3fc_mission_check_pyros();
-    m3fc_mission_check_psu();
+    mc->h_ground = mc->estimate.h;
 
-    if(m3fc_mission_pyro_supply_good) {
-        m3fc_ui_beeper_mode = M3FC_UI_BEEPER_FAST;
+    m3fc_mission_check_pyros(mc);
+    m3fc_mission_check_psu(mc);
+
+    if(mc->pyro_supply_good) {
+        mc->beeper_mode = M3FC_UI_BEEPER_FAST;
     } else {
-        m3fc_ui_beeper_mode = M3FC_UI_BEEPER_OFF;
+        mc->beeper_mode = M3FC_UI_BEEPER_OFF;
     }
 
     /* We only proceed to the pad state after receiving an ARM command. */
-    if(!m3fc_mission_armed) {
+    if(!mc->armed) {
         return STATE_INIT;
     } else {
         m3status_set_ok(M3FC_COMPONENT_MC);
@@ -95,15 +108,17 @@ static state_t do_state_init(instance_data_t *data) {
     }
 }
 
-static state_t do_state_pad(instance_data_t *data)
+static state_t do_state_pad(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = true;
+    (void)now;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = true;
+    mc->baro_osr = MS5611_OSR_4096;
 
-    m3fc_mission_check_pyros();
-    m3fc_mission_check_psu();
+    m3fc_mission_check_pyros(mc);
+    m3fc_mission_check_psu(mc);
 
-    m3fc_ui_beeper_mode = M3FC_UI_BEEPER_OFF;
+    mc->beeper_mode = M3FC_UI_BEEPER_OFF;
 
     /* Detect ignition when the acceleration exceeds the threshold.
      * Previously we also required altitude 10m above h_ground, but
@@ -112,7 +127,7 @@ static state_t do_state_pad(instance_data_t *data)
      * and revert back to pad if not, there's less harm in false positive
      * ignition detection, vs a lot of harm in a false negative.
      */
-    if(data->state.a > m3fc_config.profile.ignition_accel)
+    if(mc->estimate.a > mc->config->profile.ignition_accel)
     {
         return STATE_IGNITION;
     } else {
@@ -120,12 +135,15 @@ static state_t do_state_pad(instance_data_t *data)
     }
 }
 
-static state_t do_state_ignition(instance_data_t *data)
+static state_t do_state_ignition(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = false;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = false;
+    mc->dynamic_event_expected = false;
+
+    mc->t_launch = now;
 
-    data->t_launch = chVTGetSystemTimeX();
+    /* In flight we want barometer readings as fast as possible */
+    mc->baro_osr = MS5611_OSR_256;
 
     /* After ignition we proceed immediately to powered ascent
      * (the purpose of this state is to disable barometer and log the launch
@@ -134,18 +152,18 @@ static state_t do_state_ignition(instance_data_t *data)
     return STATE_POWERED_ASCENT;
 }
 
-static state_t do_state_powered_ascent(instance_data_t *data)
+static state_t do_state_powered_ascent(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = false;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = false;
+    mc->dynamic_event_expected = false;
 
     /* We detect burnout as either negative acceleration (we've started to slow
      * down due to drag) or configured timeout since launch.
      */
-    if(data->state.a < 0.0f) {
+    if(mc->estimate.a < 0.0f) {
         return STATE_BURNOUT;
-    } else if(ST2MS(chVTTimeElapsedSinceX(data->t_launch))
-              > m3fc_config.profile.burnout_timeout * 100)
+    } else if(ST2MS((systime_t)(now - mc->t_launch))
+              > mc->config->profile.burnout_timeout * 100)
     {
         return STATE_BURNOUT;
     } else {
@@ -153,19 +171,18 @@ static state_t do_state_powered_ascent(instance_data_t *data)
     }
 }
 
-static state_t do_state_burnout(instance_data_t *data)
+static state_t do_state_burnout(mc_t *mc, systime_t now)
 {
-    (void)data;
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
-    if(data->state.h > (data->h_ground + 20.0f) &&
-       ST2MS(chVTTimeElapsedSinceX(data->t_launch)) > 200)
+    if(mc->estimate.h > (mc->h_ground + 20.0f) &&
+       ST2MS((systime_t)(now - mc->t_launch)) > 200)
     {
         /* If we're at least 20m above launch altitude, and it's been at least
          * 200ms since we detected launch, consider it a successful burn.
          */
-        m3fc_mission_fire_dart_pyro();
+        mc->fire_usage = M3FC_CONFIG_PYRO_USAGE_DARTSEP;
         return STATE_FREE_ASCENT;
     } else {
         /* But if not, it was probably a false detection, so return to pad and
@@ -175,19 +192,19 @@ static state_t do_state_burnout(instance_data_t *data)
     }
 }
 
-static state_t do_state_free_ascent(instance_data_t *data)
+static state_t do_state_free_ascent(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
     /* We detect apogee as negative velocity (we've started to fall) or the
      * configured timeout since launch.
      * We hope that we're still mostly upright for accelerometer purposes...
      */
-    if(data->state.v < 0.0f) {
+    if(mc->estimate.v < 0.0f) {
         return STATE_APOGEE;
-    } else if(ST2MS(chVTTimeElapsedSinceX(data->t_launch))
-              > m3fc_config.profile.apogee_timeout * 1000)
+    } else if(ST2MS((systime_t)(now - mc->t_launch))
+              > mc->config->profile.apogee_timeout * 1000)
     {
         return STATE_APOGEE;
     } else {
@@ -195,30 +212,30 @@ static state_t do_state_free_ascent(instance_data_t *data)
     }
 }
 
-static state_t do_state_apogee(instance_data_t *data)
+static state_t do_state_apogee(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
-    data->t_apogee = chVTGetSystemTimeX();
-    m3fc_mission_fire_drogue_pyro();
+    mc->t_apogee = now;
+    mc->fire_usage = M3FC_CONFIG_PYRO_USAGE_DROGUE;
 
     /* After apogee we fire the drogue and immediately enter drogue descent. */
     return STATE_DROGUE_DESCENT;
 }
 
-static state_t do_state_drogue_descent(instance_data_t *data)
+static state_t do_state_drogue_descent(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
     /* We detect time to release the main based either on the configured
      * altitude above ground or on the configured timeout since apogee.
      */
-    if((data->state.h - data->h_ground) < m3fc_config.profile.main_altitude) {
+    if((mc->estimate.h - mc->h_ground) < mc->config->profile.main_altitude) {
         return STATE_RELEASE_MAIN;
-    } else if(ST2MS(chVTTimeElapsedSinceX(data->t_apogee))
-              > m3fc_config.profile.main_timeout * 1000)
+    } else if(ST2MS((systime_t)(now - mc->t_apogee))
+              > mc->config->profile.main_timeout * 1000)
     {
         return STATE_RELEASE_MAIN;
     } else {
@@ -226,87 +243,87 @@ static state_t do_state_drogue_descent(instance_data_t *data)
     }
 }
 
-static state_t do_state_release_main(instance_data_t *data)
+static state_t do_state_release_main(mc_t *mc, systime_t now)
 {
-    (void)data;
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
-    m3fc_mission_fire_main_pyro();
+    (void)now;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
+    mc->fire_usage = M3FC_CONFIG_PYRO_USAGE_MAIN;
 
     /* Start beeping again once we're coming down under parachute,
      * to make it easier to notice/find the rocket.
      * Performance of the accelerometer (affected by beeper) is
      * not important after main parachute is released.
      */
-    m3fc_ui_beeper_mode = M3FC_UI_BEEPER_FAST;
-    m3fc_ui_beeper_mode = M3FC_UI_BEEPER_OFF;
+    mc->beeper_mode = M3FC_UI_BEEPER_FAST;
+    mc->beeper_mode = M3FC_UI_BEEPER_OFF;
 
     /* At main release we fire the main and move directly into main descent. */
     return STATE_MAIN_DESCENT;
 }
 
-static state_t do_state_main_descent(instance_data_t *data)
+static state_t do_state_main_descent(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
     /* Landing is detected based on the configured timeout (probably) or on the
      * velocity being suitably small.
      */
-    if(ST2MS(chVTTimeElapsedSinceX(data->t_launch))
-       > m3fc_config.profile.land_timeout * 10000)
+    if(ST2MS((systime_t)(now - mc->t_launch))
+       > mc->config->profile.land_timeout * 10000)
     {
         return STATE_LAND;
-    } else if(fabsf(data->state.v) < 0.5f) {
+    } else if(fabsf(mc->estimate.v) < 0.5f) {
         return STATE_LAND;
     } else {
         return STATE_MAIN_DESCENT;
     }
 }
 
-static state_t do_state_land(instance_data_t *data)
+static state_t do_state_land(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
     /* Record landing time so we can later trigger events some time after
      * landing.
      */
-    data->t_land = chVTGetSystemTimeX();
+    mc->t_land = now;
+
+    mc->baro_osr = MS5611_OSR_4096;
 
     return STATE_LANDED;
 }
 
-static state_t do_state_landed(instance_data_t *data)
+static state_t do_state_landed(mc_t *mc, systime_t now)
 {
-    m3fc_state_estimation_trust_barometer = true;
-    m3fc_state_estimation_dynamic_event_expected = false;
+    mc->trust_barometer = true;
+    mc->dynamic_event_expected = false;
 
     /* After 5 minutes landed, tell the PSU to enter low-power mode, shutting
      * off m3fc and most other boards and cameras, only occasionally waking up
      * the radio to transmit our position.
      */
-    if (ST2S(chVTTimeElapsedSinceX(data->t_land)) > 300 ){
-        m3fc_mission_enable_low_power_mode();
+    if (ST2S((systime_t)(now - mc->t_land)) > 300 ){
+        mc->low_power = true;
     }
 
     /* Not much to do now. */
     return STATE_LANDED;
 }
 
-static void m3fc_mission_send_state(state_t state, instance_data_t *data) {
+static void m3fc_mission_send_state(state_t state) {
     uint8_t can_state = (uint8_t)state;
     uint32_t met;
 
-    if(data->t_launch == 0) {
+    if(mission.t_launch == 0) {
         met = 0;
     } else {
-        met = ST2MS(chVTTimeElapsedSinceX(data->t_launch));
+        met = ST2MS(chVTTimeElapsedSinceX(mission.t_launch));
     }
 
-    uint8_t buf[5] = {met, met>>8, met>>16, met>>24, can_state};
-
-    m3can_send(CAN_MSG_ID_M3FC_MISSION_STATE, false, buf, 5);
+    m3can_send_m3fc_mission_state(met, can_state);
 }
 
 static uint8_t m3fc_mission_make_pyro_channel(int usage, uint8_t pyro) {
@@ -327,18 +344,23 @@ static uint8_t m3fc_mission_make_pyro_channel(int usage, uint8_t pyro) {
     return channel;
 }
 
+void m3fc_mission_pyro_channels(const struct m3fc_config* config,
+                                uint8_t usage, uint8_t channels[8])
+{
+    channels[0] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro1);
+    channels[1] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro2);
+    channels[2] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro3);
+    channels[3] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro4);
+    channels[4] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro5);
+    channels[5] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro6);
+    channels[6] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro7);
+    channels[7] = m3fc_mission_make_pyro_channel(usage, config->pyros.pyro8);
+}
+
 static void m3fc_mission_fire_pyro(int usage) {
-    uint8_t channels[8] = {
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro1),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro2),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro3),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro4),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro5),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro6),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro7),
-        m3fc_mission_make_pyro_channel(usage, m3fc_config.pyros.pyro8),
-    };
-    m3can_send(CAN_MSG_ID_M3PYRO_FIRE_COMMAND, false, channels, 8);
+    uint8_t channels[8];
+    m3fc_mission_pyro_channels(&m3fc_config, usage, channels);
+    m3can_send_m3pyro_fire_command(channels);
 }
 
 static void m3fc_mission_fire_drogue_pyro() {
@@ -354,8 +376,34 @@ static void m3fc_mission_fire_dart_pyro() {
 }
 
 static void m3fc_mission_enable_low_power_mode() {
-    uint8_t data[1] = {1};
-    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER, false, data, 1);
+    m3can_send_m3psu_toggle_lowpower(1);
+}
+
+/* Act on the outputs of the step the mission thread just ran from
+ * `cur_state`.
+ */
+static void m3fc_mission_apply(state_t cur_state) {
+    m3fc_state_estimation_trust_barometer = mission.trust_barometer;
+    m3fc_state_estimation_dynamic_event_expected =
+        mission.dynamic_event_expected;
+    m3fc_ui_beeper_mode = mission.beeper_mode;
+    ms5611_set_osr(mission.baro_osr);
+
+    if(mission.fire_usage != M3FC_CONFIG_PYRO_USAGE_NONE) {
+        m3fc_mission_fire_pyro(mission.fire_usage);
+    }
+
+    if(mission.low_power) {
+        m3fc_mission_enable_low_power_mode();
+    }
+
+    if(cur_state == STATE_IGNITION) {
+        /* Keep full rate accelerometer data from around the launch */
+        adxl345_burst_trigger();
+    } else if(cur_state == STATE_LAND) {
+        /* With the bus quiet again, send the launch capture to be logged */
+        adxl345_burst_send();
+    }
 }
 
 static THD_WORKING_AREA(mission_thread_wa, 512);
@@ -364,22 +412,19 @@ static THD_FUNCTION(mission_thread, arg) {
     int can_counter = 0;
     state_t cur_state = STATE_INIT;
     state_t new_state;
-    instance_data_t data;
-    data.t_launch = 0;
-    data.t_apogee = 0;
-    data.t_land = 0;
-    data.h_ground = 0.0f;
 
     while(true) {
-        /* Run Kalman prediction step */
-        data.state = m3fc_state_estimation_get_state();
-
-        /* Run state machine current state function */
-        new_state = run_state(cur_state, &data);
+        /* Run state machine current state function on the latest state
+         * estimate, then act on what it decided.
+         */
+        new_state = m3fc_mission_controller_step(
+            &mission, m3fc_state_estimation_get_state(),
+            chVTGetSystemTimeX());
+        m3fc_mission_apply(cur_state);
 
         if(new_state != cur_state) {
             /* Log changes in state specifically */
-            m3fc_mission_send_state(new_state, &data);
+            m3fc_mission_send_state(new_state);
 
             /* Swap to the new state */
             cur_state = new_state;
@@ -387,7 +432,7 @@ static THD_FUNCTION(mission_thread, arg) {
 
         /* Send the state every second as well */
         if(can_counter++ >= 100) {
-            m3fc_mission_send_state(new_state, &data);
+            m3fc_mission_send_state(new_state);
             can_counter = 0;
         }
 
@@ -400,6 +445,7 @@ void m3fc_mission_init() {
     m3status_set_init(M3FC_COMPONENT_MC);
     m3status_set_init(M3FC_COMPONENT_MC_PYRO);
     m3status_set_init(M3FC_COMPONENT_MC_PSU);
+    m3fc_mission_controller_init(&mission, &m3fc_config);
     chThdCreateStatic(mission_thread_wa, sizeof(mission_thread_wa),
                       NORMALPRIO+5, mission_thread, NULL);
 }
@@ -411,42 +457,43 @@ void m3fc_mission_handle_psu_charger_status(uint8_t* data, uint8_t datalen) {
     }
 
     if(data[2] & (1<<5)) {
-        m3fc_mission_psu_battleshort = true;
+        mission.psu_battleshort = true;
     } else {
-        m3fc_mission_psu_battleshort = false;
+        mission.psu_battleshort = false;
     }
 }
 
-static void m3fc_mission_check_psu() {
-    if(!m3fc_mission_psu_battleshort) {
+static void m3fc_mission_check_psu(mc_t *mc) {
+    if(!mc->psu_battleshort) {
         m3status_set_error(M3FC_COMPONENT_MC_PSU, M3FC_ERROR_MC_PSU_BATTLESHORT);
     } else {
         m3status_set_ok(M3FC_COMPONENT_MC_PSU);
     }
 }
 
-static void m3fc_mission_check_pyros() {
-    if(!m3fc_mission_pyro_supply_good) {
+static void m3fc_mission_check_pyros(mc_t *mc) {
+    if(!mc->pyro_supply_good) {
         m3status_set_error(M3FC_COMPONENT_MC_PYRO, M3FC_ERROR_MC_PYRO_SUPPLY);
-    } else if(!m3fc_mission_pyro_armed) {
+    } else if(!mc->pyro_armed) {
         m3status_set_error(M3FC_COMPONENT_MC_PYRO, M3FC_ERROR_MC_PYRO_ARM);
-    } else if(!m3fc_mission_pyro_cont_ok) {
+    } else if(!mc->pyro_cont_ok) {
         m3status_set_error(M3FC_COMPONENT_MC_PYRO, M3FC_ERROR_MC_PYRO_CONT);
     } else {
         m3status_set_ok(M3FC_COMPONENT_MC_PYRO);
     }
 }
 
+/* r2 boards send the supply and bus voltages, r1 boards just the supply */
 void m3fc_mission_handle_pyro_supply(uint8_t* data, uint8_t datalen){
-    if(datalen != 1) {
+    if(datalen != 1 && datalen != 2) {
         m3status_set_error(M3FC_COMPONENT_MC_PYRO, M3FC_ERROR_CAN_BAD_COMMAND);
         return;
     }
 
     if(data[0] > PYRO_SUPPLY_THRESHOLD) {
-        m3fc_mission_pyro_supply_good = true;
+        mission.pyro_supply_good = true;
     } else {
-        m3fc_mission_pyro_supply_good = false;
+        mission.pyro_supply_good = false;
     }
 }
 
@@ -457,14 +504,15 @@ void m3fc_mission_handle_pyro_arm(uint8_t* data, uint8_t datalen){
     }
 
     if(data[0]) {
-        m3fc_mission_pyro_armed = true;
+        mission.pyro_armed = true;
     } else {
-        m3fc_mission_pyro_armed = false;
+        mission.pyro_armed = false;
     }
 }
 
+/* r2 boards send 8 channels, r1 boards 4 */
 void m3fc_mission_handle_pyro_continuity(uint8_t* data, uint8_t datalen){
-    if(datalen != 4) {
+    if(datalen != 4 && datalen != 8) {
         m3status_set_error(M3FC_COMPONENT_MC_PYRO, M3FC_ERROR_CAN_BAD_COMMAND);
         return;
     }
@@ -488,9 +536,9 @@ void m3fc_mission_handle_pyro_continuity(uint8_t* data, uint8_t datalen){
         (usage7 != M3FC_CONFIG_PYRO_USAGE_NONE && data[0] > PYRO_CONT_THRESHOLD) ||
         (usage8 != M3FC_CONFIG_PYRO_USAGE_NONE && data[0] > PYRO_CONT_THRESHOLD))
     {
-        m3fc_mission_pyro_cont_ok = false;
+        mission.pyro_cont_ok = false;
     } else {
-        m3fc_mission_pyro_cont_ok = true;
+        mission.pyro_cont_ok = true;
     }
 }
 
@@ -501,7 +549,7 @@ void m3fc_mission_handle_arm(uint8_t* data, uint8_t datalen) {
         return;
     }
 
-    m3fc_mission_armed = true;
+    mission.armed = true;
 }
 
 void m3fc_mission_handle_fire(uint8_t* data, uint8_t datalen)
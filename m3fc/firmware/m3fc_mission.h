@@ -1,6 +1,63 @@
 #ifndef MISSION_H
 #define MISSION_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include "ch.h"
+#include "m3fc_config.h"
+#include "m3fc_state_estimation.h"
+#include "m3fc_ui.h"
+#include "ms5611.h"
+
+typedef enum {
+    STATE_INIT = 0, STATE_PAD, STATE_IGNITION, STATE_POWERED_ASCENT,
+    STATE_BURNOUT, STATE_FREE_ASCENT, STATE_APOGEE, STATE_DROGUE_DESCENT,
+    STATE_RELEASE_MAIN, STATE_MAIN_DESCENT, STATE_LAND, STATE_LANDED,
+    NUM_STATES
+} state_t;
+
+/* One mission state machine. The firmware runs a single instance behind
+ * the m3fc_mission_* functions below; host tools can create as many as
+ * they like and drive them with the m3fc_mission_controller_* functions
+ * directly. An instance must only be stepped by one thread.
+ */
+struct m3fc_mission_controller {
+    state_t state;
+
+    /* Times of launch, apogee and landing, and the ground altitude */
+    systime_t t_launch;
+    systime_t t_apogee;
+    systime_t t_land;
+    float h_ground;
+
+    /* State estimate given to the latest step */
+    state_estimate_t estimate;
+
+    /* Flight profile and pyro configuration */
+    const struct m3fc_config* config;
+
+    /* Inputs: whether we've been sent the ARM command, and the latest
+     * reports from the pyro and power supply boards.
+     */
+    volatile bool armed;
+    volatile bool pyro_armed;
+    volatile bool pyro_supply_good;
+    volatile bool pyro_cont_ok;
+    volatile bool psu_battleshort;
+
+    /* Outputs for the caller to act on after each step: the state
+     * estimation flags, beeper mode and barometer oversampling to use,
+     * the pyro usage to fire now (M3FC_CONFIG_PYRO_USAGE_NONE for none),
+     * and whether to ask the PSU for low power mode.
+     */
+    bool trust_barometer;
+    bool dynamic_event_expected;
+    enum m3fc_ui_beeper_mode beeper_mode;
+    ms5611_osr_t baro_osr;
+    uint8_t fire_usage;
+    bool low_power;
+};
+
 void m3fc_mission_init(void);
 
 void m3fc_mission_handle_arm(uint8_t* data, uint8_t datalen);
@@ -10,4 +67,23 @@ void m3fc_mission_handle_pyro_continuity(uint8_t* data, uint8_t datalen);
 void m3fc_mission_handle_fire(uint8_t* data, uint8_t datalen);
 void m3fc_mission_handle_psu_charger_status(uint8_t* data, uint8_t datalen);
 
+/* Reset mission controller `mc` to the init state, using `config`.
+ * The inputs are left alone, so they may be set before this is called.
+ */
+void m3fc_mission_controller_init(struct m3fc_mission_controller* mc,
+                                  const struct m3fc_config* config);
+
+/* Run one step of `mc` with the latest state estimate at time `now`,
+ * and return the new state.
+ */
+state_t m3fc_mission_controller_step(struct m3fc_mission_controller* mc,
+                                     state_estimate_t estimate,
+                                     systime_t now);
+
+/* Fill `channels` with the M3Pyro fire command for every pyro `config`
+ * assigns to `usage`.
+ */
+void m3fc_mission_pyro_channels(const struct m3fc_config* config,
+                                uint8_t usage, uint8_t channels[8]);
+
 #endif
@@ -9,34 +9,52 @@
 #include "m3can.h"
 #include "m3fc_config.h"
 #include "m3fc_status.h"
+#include "m3fc_altitude.h"
+#include "m3prof.h"
 #include "m3fc_state_estimation.h"
 
-/* Kalman filter state and covariance storage.
- * See below for detailed description.
+/* The firmware's single estimator instance, driven by the
+ * m3fc_state_estimation_* functions. See below for a detailed description
+ * of the Kalman filter.
  */
-static float x[3]    = {0.0f, 0.0f, 0.0f};
-static float p[3][3] = {{250.0f, 0.0f, 0.0f},
-                        {  0.0f, 0.1f, 0.0f},
-                        {  0.0f, 0.0f, 0.1f}};
-
-/* Used to compute dt for each prediction step. */
-static systime_t t_clk;
-
-/* Lock to protect the global shared Kalman state */
-static binary_semaphore_t kalman_bsem;
-
-/* Constants from the US Standard Atmosphere 1976 */
-static const float Rs = 8.31432f;
-static const float g0 = 9.80665f;
-static const float M = 0.0289644f;
-static const float Lb[7] = {
-    -0.0065f, 0.0f, 0.001, 0.0028f, 0.0f, -0.0028f, -0.002f};
-static const float Pb[7] = {
-    101325.0f, 22632.10f, 5474.89f, 868.02f, 110.91f, 66.94f, 3.96f};
-static const float Tb[7] = {
-    288.15f, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65};
-static const float Hb[7] = {
-    0.0f, 11000.0f, 20000.0f, 32000.0f, 47000.0f, 51000.0f, 71000.0f};
+static struct m3fc_state_estimator estimator;
+
+/* Sensor samples waiting to be fused. Each sensor thread is the only
+ * producer for its own queue and the fusion thread is the only consumer,
+ * so pushing never blocks or takes a lock.
+ */
+#define SE_QUEUE_LEN (32)
+struct se_sample {
+    systime_t t;
+    float v[3];
+    float max;
+    float rms;
+};
+struct se_queue {
+    struct se_sample samples[SE_QUEUE_LEN];
+    uint32_t head;
+    uint32_t tail;
+};
+static struct se_queue accel_queue, baro_queue;
+
+/* The latest estimate, published by the fusion thread under a sequence lock
+ * so mission control can read it without blocking the sensor path.
+ * The fusion thread must run at a higher priority than any reader, or a
+ * reader could preempt it mid-write and spin forever.
+ */
+static struct {
+    uint32_t seq;
+    float dt;
+    state_estimate_t x;
+    float var[3];
+} snapshot;
+
+/* Signalled by sensor threads when they have queued a sample, and the
+ * time the fusion thread last ran a prediction step.
+ */
+static binary_semaphore_t fusion_bsem;
+static systime_t t_predict;
+#define SE_PREDICT_PERIOD MS2ST(10)
 
 /* Controlled externally to indicate whether the barometer should be used
  * (not during transonic regime) and whether a high-g dynamic event is expected
@@ -45,17 +63,17 @@ static const float Hb[7] = {
 volatile bool m3fc_state_estimation_trust_barometer;
 volatile bool m3fc_state_estimation_dynamic_event_expected;
 
-/* Functions to convert pressures to altitudes via the
- * US Standard Atmosphere
- */
-static float m3fc_state_estimation_pressure_to_altitude(float pressure);
-static float m3fc_state_estimation_p2a_nonzero_lapse(float p, int b);
-static float m3fc_state_estimation_p2a_zero_lapse(float p, int b);
-
 /* Internal accelerometer update function, might be used by multiple
- * accelerometers. Called from state_estimation_new_accel.
+ * accelerometers. Called from state_estimator_update_accels.
  */
-static void m3fc_state_estimation_update_accel(float accel, float r);
+static void m3fc_state_estimator_update_accel(struct m3fc_state_estimator* se,
+                                              float accel, float r);
+
+static void m3fc_state_estimation_push(struct se_queue* q,
+                                       const struct se_sample* sample);
+static struct se_sample* m3fc_state_estimation_peek(struct se_queue* q);
+static void m3fc_state_estimation_pop(struct se_queue* q);
+static void m3fc_state_estimation_publish(float dt);
 
 
 /*
@@ -138,26 +156,26 @@ static void m3fc_state_estimation_update_accel(float accel, float r);
  *
  * It's just not quite awful enough to write general purpose matrix routines.
  */
-state_estimate_t m3fc_state_estimation_get_state()
+state_estimate_t m3fc_state_estimator_predict(struct m3fc_state_estimator* se,
+                                              systime_t now)
 {
     float q, dt, dt2, dt3, dt4, dt5, dt6, dt2_2;
+    float* x = se->x;
+    float (*p)[3] = se->p;
     state_estimate_t x_out;
 
     /* Set the process noise variance according to whether we expect
      * something to change soon. These numbers are more or less guesses.
      */
-    if(m3fc_state_estimation_dynamic_event_expected) {
+    if(se->dynamic_event_expected) {
         q = 2000.0f;
     } else {
         q = 500.0f;
     }
 
-    /* Acquire lock */
-    chBSemWait(&kalman_bsem);
-
     /* Find elapsed time */
-    dt = (float)(ST2US(chVTTimeElapsedSinceX(t_clk))) / 1e6f;
-    t_clk = chVTGetSystemTimeX();
+    dt = (float)(ST2US((systime_t)(now - se->t_clk))) / 1e6f;
+    se->t_clk = now;
 
     dt2 = dt * dt;
     dt3 = dt * dt2;
@@ -215,41 +233,223 @@ state_estimate_t m3fc_state_estimation_get_state()
     x_out.v = x[1];
     x_out.a = x[2];
 
-    /* Release lock */
-    chBSemSignal(&kalman_bsem);
+    return x_out;
+}
 
-    /* Transmit the newly predicted state and variances over CAN */
-    m3can_send_f32(CAN_MSG_ID_M3FC_SE_T_H, dt, x[0], 2);
-    m3can_send_f32(CAN_MSG_ID_M3FC_SE_V_A, x[1], x[2], 2);
-    m3can_send_f32(CAN_MSG_ID_M3FC_SE_VAR_H, p[0][0], 0.0f, 1);
-    m3can_send_f32(CAN_MSG_ID_M3FC_SE_VAR_V_A, p[1][1], p[2][2], 2);
+/*
+ * Read the latest published estimate and send it over CAN.
+ * Never blocks: if the fusion thread publishes while we are copying, we
+ * simply copy again.
+ */
+state_estimate_t m3fc_state_estimation_get_state()
+{
+    uint32_t seq;
+    float dt, var[3];
+    state_estimate_t x_out;
+
+    M3PROF_START(M3PROF_M3FC_SE_GET_STATE);
+
+    do {
+        seq = __atomic_load_n(&snapshot.seq, __ATOMIC_ACQUIRE);
+        dt = snapshot.dt;
+        x_out = snapshot.x;
+        var[0] = snapshot.var[0];
+        var[1] = snapshot.var[1];
+        var[2] = snapshot.var[2];
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while((seq & 1) ||
+            seq != __atomic_load_n(&snapshot.seq, __ATOMIC_RELAXED));
+
+    /* Transmit the latest state and variances over CAN */
+    m3can_send_m3fc_se_t_h(dt, x_out.h);
+    m3can_send_m3fc_se_v_a(x_out.v, x_out.a);
+    m3can_send_m3fc_se_var_h(var[0]);
+    m3can_send_m3fc_se_var_v_a(var[1], var[2]);
 
     m3status_set_ok(M3FC_COMPONENT_SE);
 
+    M3PROF_STOP(M3PROF_M3FC_SE_GET_STATE);
+
     return x_out;
 }
 
 /*
- * Initialises the state estimation's shared variables.
+ * Fuse every queued sensor sample, oldest first, and run the prediction
+ * step every SE_PREDICT_PERIOD. Publishes a new snapshot if anything
+ * changed.
+ */
+void m3fc_state_estimation_fuse()
+{
+    struct se_sample *a, *b;
+    systime_t now = chVTGetSystemTimeX();
+    float dt = snapshot.dt;
+    bool changed = false;
+
+    M3PROF_START(M3PROF_M3FC_SE_FUSE);
+
+    if(chVTTimeElapsedSinceX(t_predict) >= SE_PREDICT_PERIOD) {
+        estimator.dynamic_event_expected =
+            m3fc_state_estimation_dynamic_event_expected;
+        dt = (float)(ST2US(chVTTimeElapsedSinceX(estimator.t_clk))) / 1e6f;
+        m3fc_state_estimator_predict(&estimator, now);
+        t_predict = now;
+        changed = true;
+    }
+
+    while(true) {
+        a = m3fc_state_estimation_peek(&accel_queue);
+        b = m3fc_state_estimation_peek(&baro_queue);
+
+        if(a != NULL && (b == NULL || (int32_t)(a->t - b->t) <= 0)) {
+            estimator.accel_axis = m3fc_config.profile.accel_axis;
+            if(!m3fc_state_estimator_update_accels(&estimator, a->v,
+                                                   a->max, a->rms)) {
+                m3status_set_error(M3FC_COMPONENT_ACCEL,
+                                   M3FC_ERROR_ACCEL_AXIS);
+            }
+            m3fc_state_estimation_pop(&accel_queue);
+        } else if(b != NULL) {
+            estimator.trust_barometer = m3fc_state_estimation_trust_barometer;
+            if(!m3fc_state_estimator_update_pressure(&estimator, b->v[0],
+                                                     b->rms)) {
+                m3status_set_error(M3FC_COMPONENT_SE, M3FC_ERROR_SE_PRESSURE);
+            }
+            m3fc_state_estimation_pop(&baro_queue);
+        } else {
+            break;
+        }
+
+        changed = true;
+    }
+
+    if(changed) {
+        m3fc_state_estimation_publish(dt);
+    }
+
+    M3PROF_STOP(M3PROF_M3FC_SE_FUSE);
+}
+
+static THD_WORKING_AREA(m3fc_state_estimation_thd_wa, 512);
+static THD_FUNCTION(m3fc_state_estimation_thd, arg) {
+    (void)arg;
+    chRegSetThreadName("fusion");
+
+    while(true) {
+        chBSemWaitTimeout(&fusion_bsem, SE_PREDICT_PERIOD);
+        m3fc_state_estimation_fuse();
+    }
+}
+
+/*
+ * Initialises the state estimation's shared variables and starts the
+ * fusion thread.
  */
 void m3fc_state_estimation_init()
 {
     m3status_set_init(M3FC_COMPONENT_SE);
     m3fc_state_estimation_trust_barometer = true;
     m3fc_state_estimation_dynamic_event_expected = false;
-    t_clk = chVTGetSystemTime();
-    chBSemObjectInit(&kalman_bsem, false);
+    m3fc_state_estimator_init(&estimator, chVTGetSystemTime());
+    t_predict = estimator.t_clk;
+    accel_queue.head = accel_queue.tail = 0;
+    baro_queue.head = baro_queue.tail = 0;
+    m3fc_state_estimation_publish(0.0f);
+    chBSemObjectInit(&fusion_bsem, true);
+
+    /* Above mission control, the only snapshot reader. */
+    chThdCreateStatic(m3fc_state_estimation_thd_wa,
+                      sizeof(m3fc_state_estimation_thd_wa),
+                      NORMALPRIO+6, m3fc_state_estimation_thd, NULL);
+}
+
+/* Queue a sample for the fusion thread. Only ever called from the one
+ * producer thread for `q`. If the queue is full the sample is dropped.
+ */
+static void m3fc_state_estimation_push(struct se_queue* q,
+                                       const struct se_sample* sample)
+{
+    uint32_t head = q->head;
+    uint32_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+
+    if(head - tail == SE_QUEUE_LEN) {
+        m3status_set_error(M3FC_COMPONENT_SE, M3FC_ERROR_SE_QUEUE);
+        return;
+    }
+
+    q->samples[head % SE_QUEUE_LEN] = *sample;
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    chBSemSignal(&fusion_bsem);
+}
+
+/* Oldest sample in `q`, or NULL if empty. Fusion thread only. */
+static struct se_sample* m3fc_state_estimation_peek(struct se_queue* q)
+{
+    uint32_t tail = q->tail;
+    if(__atomic_load_n(&q->head, __ATOMIC_ACQUIRE) == tail) {
+        return NULL;
+    }
+    return &q->samples[tail % SE_QUEUE_LEN];
+}
+
+/* Release the sample returned by peek back to the producer. */
+static void m3fc_state_estimation_pop(struct se_queue* q)
+{
+    __atomic_store_n(&q->tail, q->tail + 1, __ATOMIC_RELEASE);
+}
+
+/* Copy the estimator state into the snapshot. Fusion thread only. */
+static void m3fc_state_estimation_publish(float dt)
+{
+    uint32_t seq = snapshot.seq;
+
+    __atomic_store_n(&snapshot.seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    snapshot.dt = dt;
+    snapshot.x.h = estimator.x[0];
+    snapshot.x.v = estimator.x[1];
+    snapshot.x.a = estimator.x[2];
+    snapshot.var[0] = estimator.p[0][0];
+    snapshot.var[1] = estimator.p[1][1];
+    snapshot.var[2] = estimator.p[2][2];
+
+    __atomic_store_n(&snapshot.seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/*
+ * Reset an estimator to a zero state with a large altitude variance,
+ * so the first few barometer readings pull it to the launch altitude.
+ */
+void m3fc_state_estimator_init(struct m3fc_state_estimator* se,
+                               systime_t now)
+{
+    int i, j;
+
+    for(i=0; i<3; i++) {
+        se->x[i] = 0.0f;
+        for(j=0; j<3; j++) {
+            se->p[i][j] = 0.0f;
+        }
+    }
+    se->p[0][0] = 250.0f;
+    se->p[1][1] = 0.1f;
+    se->p[2][2] = 0.1f;
+
+    se->t_clk = now;
+    se->trust_barometer = true;
+    se->dynamic_event_expected = false;
+    se->accel_axis = M3FC_CONFIG_ACCEL_AXIS_Z;
 }
 
 /* We run a Kalman update step with a new pressure reading.
  * The pressure is converted to an altitude (since that's what's in our state
- * and what is useful to reason about) using the US standard atmosphere via the
- * `state_estimation_pressure_to_altitude` function. We also use this function
- * to estimate the current sensor noise in altitude terms.
+ * and what is useful to reason about) using the US standard atmosphere via
+ * `m3fc_altitude_from_pressure`, which also gives the gradient dh/dp that we
+ * use to estimate the current sensor noise in altitude terms.
  *
  * We thus derive R, the sensor noise variance, as the altitude error band at
  * the current altitude, squared:
- * R = (alt(pressure-error) - alt(pressure+error))².
+ * R = (alt(pressure-error) - alt(pressure+error))² ≈ (2 error dh/dp)².
  *
  * Then the Kalman update is run, with:
  * z = [altitude]
@@ -271,33 +471,31 @@ void m3fc_state_estimation_init()
  *           [P10 - K1 P00    P11 - K1 P01    P12 - K1 P02]
  *           [P20 - K2 P00    P21 - K2 P01    P22 - K2 P02]
  */
-void m3fc_state_estimation_new_pressure(float pressure, float rms)
+bool m3fc_state_estimator_update_pressure(struct m3fc_state_estimator* se,
+                                          float pressure, float rms)
 {
     float y, r, s_inv, k[3];
-    float h, hp, hm;
+    float h, dhdp;
+    float* x = se->x;
+    float (*p)[3] = se->p;
 
     /* Discard data when mission control believes we are transonic. */
-    if(!m3fc_state_estimation_trust_barometer)
-        return;
+    if(!se->trust_barometer)
+        return true;
 
     /* Convert pressure reading into an altitude.
-     * Run the same conversion for pressure ± sensor resolution to get an idea
+     * Scale the sensor resolution by the local gradient to get an idea
      * of the current noise variance in altitude terms for the filter.
      */
-    h = m3fc_state_estimation_pressure_to_altitude(pressure);
-    hp = m3fc_state_estimation_pressure_to_altitude(pressure + rms);
-    hm = m3fc_state_estimation_pressure_to_altitude(pressure - rms);
-    r = (hm - hp) * (hm - hp);
-
-    /* If there was an error (couldn't find suitable altitude band) for this
-     * pressure, just don't use it. It's probably wrong. */
-    if(h == -9999.0f || hp == -9999.0f || hm == -9999.0f) {
-        m3status_set_error(M3FC_COMPONENT_SE, M3FC_ERROR_SE_PRESSURE);
-        return;
+    h = m3fc_altitude_from_pressure(pressure, &dhdp);
+
+    /* If the pressure is outside the table, just don't use it.
+     * It's probably wrong. */
+    if(h == M3FC_ALTITUDE_INVALID) {
+        return false;
     }
 
-    /* Acquire lock */
-    chBSemWait(&kalman_bsem);
+    r = (2.0f * rms * dhdp) * (2.0f * rms * dhdp);
 
     /* Measurement residual */
     y = h - x[0];
@@ -326,66 +524,15 @@ void m3fc_state_estimation_new_pressure(float pressure, float rms)
     p[2][1] -= k[2] * p[0][1];
     p[2][2] -= k[2] * p[0][2];
 
-    /* Release lock */
-    chBSemSignal(&kalman_bsem);
-}
-
-static float m3fc_state_estimation_pressure_to_altitude(float pressure)
-{
-    int b;
-    /* If the pressure is below the model's ground level, we can
-     * extrapolate into the ground instead.
-     */
-    if(pressure > Pb[0]) {
-        return m3fc_state_estimation_p2a_nonzero_lapse(pressure, 0);
-    }
-
-    /* For each level of the US Standard Atmosphere 1976, check if the pressure
-     * is inside that level, and use the appropriate conversion based on lapse
-     * rate at that level.
-     */
-    for(b = 0; b < 6; b++) {
-        if(pressure <= Pb[b] && pressure > Pb[b+1]) {
-            if(Lb[b] == 0.0f) {
-                return m3fc_state_estimation_p2a_zero_lapse(pressure, b);
-            } else {
-                return m3fc_state_estimation_p2a_nonzero_lapse(pressure, b);
-            }
-        }
-    }
-
-    /* If no levels matched, something is wrong, returning -9999f will cause
-     * this pressure value to be ignored.
-     */
-    return -9999.0f;
+    return true;
 }
 
-/*
- * Convert a pressure and an atmospheric level b into an altitude.
- * Rearranges the standard equation for non-zero-lapse regions,
- * P = Pb (Tb / (Tb + Lb(h - hb)))^(M g0 / R* Lb)
- */
-static float m3fc_state_estimation_p2a_nonzero_lapse(float pressure, int b)
-{
-    const float lb = Lb[b];
-    const float hb = Hb[b];
-    const float pb = Pb[b];
-    const float tb = Tb[b];
-
-    return hb + tb/lb * (powf(pressure/pb, (-Rs*lb)/(g0*M)) - 1.0f);
-}
-
-/* Convert a pressure and an atmospheric level b into an altitude.
- * Reverses the standard equation for zero-lapse regions,
- * P = Pb exp( -g0 M (h-hb) / R* Tb)
- */
-static float m3fc_state_estimation_p2a_zero_lapse(float pressure, int b)
+void m3fc_state_estimation_new_pressure(float pressure, float rms)
 {
-    const float hb = Hb[b];
-    const float pb = Pb[b];
-    const float tb = Tb[b];
-
-    return hb + (Rs * tb)/(g0 * M) * (logf(pressure / pb));
+    struct se_sample sample = {
+        .t = chVTGetSystemTimeX(), .v = {pressure, 0.0f, 0.0f}, .rms = rms,
+    };
+    m3fc_state_estimation_push(&baro_queue, &sample);
 }
 
 /* Update the state estimate with a new accelerometer reading.
@@ -395,25 +542,27 @@ static float m3fc_state_estimation_p2a_zero_lapse(float pressure, int b)
  * close to 1G, we'll assume we're just not upright any more and return 0
  * acceleration with a larger variance.
  */
-void m3fc_state_estimation_new_accels(float accels[3], float max, float rms)
+bool m3fc_state_estimator_update_accels(struct m3fc_state_estimator* se,
+                                        const float accels[3],
+                                        float max, float rms)
 {
     float accel;
 
     /* Get "up" acceleration from configuration. */
-    if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_X) {
+    if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_X) {
         accel = accels[0];
-    } else if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_NX) {
+    } else if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_NX) {
         accel = -accels[0];
-    } else if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_Y) {
+    } else if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_Y) {
         accel = accels[1];
-    } else if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_NY) {
+    } else if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_NY) {
         accel = -accels[1];
-    } else if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_Z) {
+    } else if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_Z) {
         accel = accels[2];
-    } else if(m3fc_config.profile.accel_axis == M3FC_CONFIG_ACCEL_AXIS_NZ) {
+    } else if(se->accel_axis == M3FC_CONFIG_ACCEL_AXIS_NZ) {
         accel = -accels[2];
     } else {
-        m3status_set_error(M3FC_COMPONENT_ACCEL, M3FC_ERROR_ACCEL_AXIS);
+        return false;
     }
 
     float overall_accel = sqrtf(accels[0] * accels[0] +
@@ -426,13 +575,23 @@ void m3fc_state_estimation_new_accels(float accels[3], float max, float rms)
         rms = 9.80665f;
     } else if(fabsf(accel) > max) {
         /* Do not use for state estimation if reading is above sensor max. */
-        return;
+        return true;
     } else {
         /* Subtract 1G from the up acceleration to remove effect of gravity */
         accel -= 9.80665f;
     }
 
-    m3fc_state_estimation_update_accel(accel, rms*rms);
+    m3fc_state_estimator_update_accel(se, accel, rms*rms);
+    return true;
+}
+
+void m3fc_state_estimation_new_accels(float accels[3], float max, float rms)
+{
+    struct se_sample sample = {
+        .t = chVTGetSystemTimeX(), .v = {accels[0], accels[1], accels[2]},
+        .max = max, .rms = rms,
+    };
+    m3fc_state_estimation_push(&accel_queue, &sample);
 }
 
 
@@ -459,12 +618,12 @@ void m3fc_state_estimation_new_accels(float accels[3], float max, float rms)
  *           [P10 - K1 P20    P11 - K1 P21    P12 - K1 P22]
  *           [P20 - K2 P20    P21 - K2 P21    P22 - K2 P22]
  */
-static void m3fc_state_estimation_update_accel(float a, float r)
+static void m3fc_state_estimator_update_accel(struct m3fc_state_estimator* se,
+                                              float a, float r)
 {
     float y, s_inv, k[3];
-
-    /* Acquire lock */
-    chBSemWait(&kalman_bsem);
+    float* x = se->x;
+    float (*p)[3] = se->p;
 
     /* Measurement residual */
     y = a - x[2];
@@ -492,8 +651,5 @@ static void m3fc_state_estimation_update_accel(float a, float r)
     p[2][0] -= k[2] * p[2][0];
     p[2][1] -= k[2] * p[2][1];
     p[2][2] -= k[2] * p[2][2];
-
-    /* Release lock */
-    chBSemSignal(&kalman_bsem);
 }
 
@@ -8,9 +8,33 @@
 #define M3FC_STATE_ESTIMATION_H
 
 #include <stdint.h>
+#include <stdbool.h>
+#include "ch.h"
 
 typedef struct { float h; float v; float a; } state_estimate_t;
 
+/* One Kalman filter instance. The firmware runs a single instance behind
+ * the m3fc_state_estimation_* functions below; host tools can create as
+ * many as they like and drive them with the m3fc_state_estimator_*
+ * functions directly. An instance must only be used by one thread.
+ */
+struct m3fc_state_estimator {
+    /* State [h v a]' and its covariance */
+    float x[3];
+    float p[3][3];
+
+    /* Time of the last prediction step, to compute dt */
+    systime_t t_clk;
+
+    /* Whether to use barometer readings, whether to use the higher process
+     * noise for an expected dynamic event, and which accelerometer axis
+     * is up (M3FC_CONFIG_ACCEL_AXIS_*). See the globals below.
+     */
+    bool trust_barometer;
+    bool dynamic_event_expected;
+    uint8_t accel_axis;
+};
+
 /* Used to signal that the barometer is not trustworthy due to
  * transonic regime. Set by the mission control thread and read by
  * the barometer thread when it goes to update the state estimate.
@@ -24,18 +48,53 @@ extern volatile bool m3fc_state_estimation_trust_barometer;
  */
 extern volatile bool m3fc_state_estimation_dynamic_event_expected;
 
-/* Update with a new pressure reading (in Pascals) and associated RMS noise */
+/* Queue a new pressure reading (in Pascals) and associated RMS noise.
+ * Never blocks; the fusion thread applies it shortly afterwards.
+ */
 void m3fc_state_estimation_new_pressure(float pressure, float rms);
 
-/* Update with new accelerometer readings (in m/s/s on x, y, z) and
- * associated maximum value and RMS noise */
+/* Queue new accelerometer readings (in m/s/s on x, y, z) and
+ * associated maximum value and RMS noise. Never blocks. */
 void m3fc_state_estimation_new_accels(float accels[3], float max, float rms);
 
-/* Compute and return the latest state estimate */
+/* Return the latest state estimate published by the fusion thread.
+ * Never blocks. Must be called from a thread below the fusion thread's
+ * priority. */
 state_estimate_t m3fc_state_estimation_get_state(void);
 
-/* Initialise state estimation. Must be called before
- * update or prediction steps above are called. */
+/* Apply all queued samples and run the prediction step if it is due,
+ * then publish a new state estimate. Run by the fusion thread; host
+ * harnesses without threads call it directly. */
+void m3fc_state_estimation_fuse(void);
+
+/* Initialise state estimation and start the fusion thread. Must be called
+ * before any samples are queued. */
 void m3fc_state_estimation_init(void);
 
+/* Reset estimator `se` to its initial state, with `now` as the time of the
+ * last prediction.
+ */
+void m3fc_state_estimator_init(struct m3fc_state_estimator* se,
+                               systime_t now);
+
+/* Run the prediction step of `se` up to time `now` and return the new
+ * state estimate.
+ */
+state_estimate_t m3fc_state_estimator_predict(struct m3fc_state_estimator* se,
+                                              systime_t now);
+
+/* Update `se` with a pressure reading in Pa and its RMS noise.
+ * Returns false if the pressure was outside the atmosphere model.
+ */
+bool m3fc_state_estimator_update_pressure(struct m3fc_state_estimator* se,
+                                          float pressure, float rms);
+
+/* Update `se` with accelerometer readings in m/s/s on x, y, z and the
+ * associated maximum value and RMS noise.
+ * Returns false if the configured up axis is invalid.
+ */
+bool m3fc_state_estimator_update_accels(struct m3fc_state_estimator* se,
+                                        const float accels[3],
+                                        float max, float rms);
+
 #endif
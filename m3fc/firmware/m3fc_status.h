@@ -34,6 +34,7 @@
 #define M3FC_ERROR_CFG_CHK_ACCEL_CAL  (18)
 #define M3FC_ERROR_CFG_CHK_RADIO_FREQ (19)
 #define M3FC_ERROR_CFG_CHK_CRC        (20)
+#define M3FC_ERROR_SE_QUEUE           (22)
 
 
 #endif
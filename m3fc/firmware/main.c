@@ -2,6 +2,11 @@
 #include "hal.h"
 
 #include "m3can.h"
+#include "m3prof.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
+#include "m3can_timesync.h"
+#include "m3can_bulk.h"
 #include "m3fc_ui.h"
 #include "m3fc_config.h"
 #include "m3fc_status.h"
@@ -50,11 +55,21 @@ int main(void) {
     halInit();
     chSysInit();
 
-    uint16_t listen_to_ids[] = { CAN_ID_M3FC, CAN_ID_M3PSU, CAN_ID_M3PYRO };
-    m3can_init(CAN_ID_M3FC, listen_to_ids, 3);
+    static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3FC;
+    m3can_init(CAN_ID_M3FC, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+    m3prof_init();
+    m3monitor_init();
+    m3can_stats_init();
+
+    /* M3FC keeps the time for every other board */
+    m3can_timesync_init_master();
 
     m3fc_ui_init();
     m3fc_config_init();
+
+    /* Serve config snapshots registered by m3fc_config_init */
+    m3can_bulk_init();
+
     ms5611_init(&SPID1, GPIOC, GPIOC_BARO_CS);
     adxl345_init(&SPID2, GPIOA, GPIOA_ACCEL_CS);
 
@@ -4,6 +4,7 @@
 #include "m3fc_status.h"
 #include "m3fc_state_estimation.h"
 #include "m3fc_mock.h"
+#include "m3prof.h"
 #include "ms5611.h"
 
 #define MS5611_CMD_RESET                0x1E
@@ -20,18 +21,40 @@
 #define MS5611_CMD_ADC_READ             0x00
 #define MS5611_CMD_PROM_READ            0xA0
 
+/* Pressure samples between temperature conversions. Temperature changes
+ * slowly compared to pressure, so we reuse the last D2 reading and spend
+ * the time converting pressure instead.
+ */
+#define MS5611_TEMPERATURE_INTERVAL     (16)
+
+/* Minimum time between baro CAN frames. Only the estimator needs every
+ * sample, so the bus sees about the rate of the old paired D1 and D2
+ * conversions at OSR256 rather than one frame for each sample.
+ */
+#define MS5611_CAN_PERIOD_US            (1400)
+
 typedef struct {
     uint16_t c1, c2, c3, c4, c5, c6;
 } MS5611CalData;
 
+/* Maximum conversion times in microseconds for each OSR, from the datasheet */
+static const uint16_t ms5611_conversion_us[] = {600, 1170, 2280, 4540, 9040};
+
+static const float ms5611_pressure_rms[] = MS5611_PRESSURE_RMS;
+
 static SPIDriver* ms5611_spid;
+static virtual_timer_t ms5611_vt;
+static binary_semaphore_t ms5611_thd_sem;
+static volatile ms5611_osr_t ms5611_osr = MS5611_OSR_256;
 
 static void ms5611_reset(void);
 static void ms5611_read_u16(uint8_t adr, uint16_t* c);
-static void ms5611_read_s24(uint8_t adr, int32_t* d);
+static void ms5611_read_adc(int32_t* d);
+static void ms5611_start_conversion(uint8_t cmd, ms5611_osr_t osr);
+static void ms5611_conversion_done(void* arg);
 static void ms5611_read_cal(MS5611CalData* cal_data);
-static void ms5611_read(MS5611CalData* cal_data,
-                        int32_t* temperature, int32_t* pressure);
+static void ms5611_compensate(MS5611CalData* cal_data, int32_t d1, int32_t d2,
+                              int32_t* temperature, int32_t* pressure);
 
 static SPIConfig spi_cfg = {
     .end_cb = NULL,
@@ -66,27 +89,49 @@ static void ms5611_read_u16(uint8_t adr, uint16_t* c)
 }
 
 /*
- * Reads an int24 from the MS5611 address `adr`, stores it to `d`.
+ * Starts a D1 or D2 conversion with command `cmd` at oversampling `osr`,
+ * and arms a timer to wake the thread when it will have finished.
+ * Chip select and the bus are released while the conversion runs.
  */
-static void ms5611_read_s24(uint8_t adr, int32_t* d)
+static void ms5611_start_conversion(uint8_t cmd, ms5611_osr_t osr)
 {
-    uint8_t adc_adr = MS5611_CMD_ADC_READ, rx[3];
+    cmd += 2 * osr;
 
+    spiAcquireBus(ms5611_spid);
     spiSelect(ms5611_spid);
-    spiSend(ms5611_spid, 1, (void*)&adr);
-
-    /*
-     * Wait for conversion to complete. There doesn't appear to be any way
-     * to do this without timing it, unfortunately.
-     */
-    chThdSleepMicroseconds(600);
+    spiSend(ms5611_spid, 1, (void*)&cmd);
     spiUnselect(ms5611_spid);
+    spiReleaseBus(ms5611_spid);
+
+    chVTSet(&ms5611_vt, US2ST(ms5611_conversion_us[osr]),
+            ms5611_conversion_done, NULL);
+}
+
+/*
+ * Timer callback when a conversion should be complete.
+ */
+static void ms5611_conversion_done(void* arg)
+{
+    (void)arg;
+    chSysLockFromISR();
+    chBSemSignalI(&ms5611_thd_sem);
+    chSysUnlockFromISR();
+}
+
+/*
+ * Reads the 24 bit result of the last conversion, stores it to `d`.
+ * The MS5611 returns 0 if the conversion has not finished.
+ */
+static void ms5611_read_adc(int32_t* d)
+{
+    uint8_t adr = MS5611_CMD_ADC_READ, rx[3];
 
-    /* Read ADC result */
+    spiAcquireBus(ms5611_spid);
     spiSelect(ms5611_spid);
-    spiSend(ms5611_spid, 1, (void*)&adc_adr);
+    spiSend(ms5611_spid, 1, (void*)&adr);
     spiReceive(ms5611_spid, 3, (void*)rx);
     spiUnselect(ms5611_spid);
+    spiReleaseBus(ms5611_spid);
 
     *d = rx[0] << 16 | rx[1] << 8 | rx[2];
 }
@@ -108,22 +153,20 @@ static void ms5611_read_cal(MS5611CalData* cal_data)
 }
 
 /*
- * Read and compensate a temperature and pressure from the MS5611.
+ * Compensate raw readings into a temperature and pressure.
  *
  * `cal_data` is previously read calibration data.
+ * `d1` and `d2` are the raw pressure and temperature conversions.
  * `temperature` and `pressure` are written to.
  *
  * `temperature` is in centidegrees Celcius,
  * `pressure` is in Pascals.
  */
-static void ms5611_read(MS5611CalData* cal_data,
-                        int32_t* temperature, int32_t* pressure)
+static void ms5611_compensate(MS5611CalData* cal_data, int32_t d1, int32_t d2,
+                              int32_t* temperature, int32_t* pressure)
 {
-    int32_t d1, d2;
     int64_t off, sens, dt;
     int64_t t2 = 0, sens2 = 0, off2 = 0;
-    ms5611_read_s24(MS5611_CMD_CONVERT_D1_OSR256, &d1);
-    ms5611_read_s24(MS5611_CMD_CONVERT_D2_OSR256, &d2);
 
     /* Compute temperature */
     dt = (int64_t)d2 - ((int64_t)cal_data->c5 << 8);
@@ -153,8 +196,11 @@ static void ms5611_read(MS5611CalData* cal_data,
 
 /*
  * MS5611 main thread.
- * Resets the MS5611, reads cal data, then reads a pressure and temperature
- * in a loop.
+ * Resets the MS5611 and reads cal data, then runs a conversion state
+ * machine: each time the conversion timer fires we read the result and
+ * immediately start the next conversion, then process the reading while
+ * the MS5611 is busy. A temperature (D2) conversion is run every
+ * MS5611_TEMPERATURE_INTERVAL pressure (D1) conversions.
  */
 static THD_WORKING_AREA(ms5611_thd_wa, 256);
 static THD_FUNCTION(ms5611_thd, arg) {
@@ -162,12 +208,68 @@ static THD_FUNCTION(ms5611_thd, arg) {
 
     MS5611CalData cal_data;
     int32_t temperature, pressure;
+    int32_t adc, d1 = 0, d2 = 0;
+    bool converting_d2, was_d2, have_d2 = false;
+    int samples_since_d2 = 0;
+    ms5611_osr_t osr, d1_osr = MS5611_OSR_256;
+    systime_t last_can = chVTGetSystemTimeX();
+    msg_t wait_result;
+
     chRegSetThreadName("MS5611");
+    chBSemObjectInit(&ms5611_thd_sem, true);
+    chVTObjectInit(&ms5611_vt);
     spiStart(ms5611_spid, &spi_cfg);
     ms5611_reset();
     ms5611_read_cal(&cal_data);
+
+    converting_d2 = true;
+    osr = ms5611_osr;
+    ms5611_start_conversion(MS5611_CMD_CONVERT_D2_OSR256, osr);
+
     while (true) {
-        ms5611_read(&cal_data, &temperature, &pressure);
+        wait_result = chBSemWaitTimeout(&ms5611_thd_sem, MS2ST(100));
+        if(wait_result == MSG_TIMEOUT) {
+            /* Should never happen, but restart with a temperature
+             * conversion if it does. */
+            converting_d2 = true;
+            osr = ms5611_osr;
+            ms5611_start_conversion(MS5611_CMD_CONVERT_D2_OSR256, osr);
+            continue;
+        }
+
+        M3PROF_START(M3PROF_M3FC_MS5611_SAMPLE);
+
+        /* Collect the finished conversion and start the next one */
+        ms5611_read_adc(&adc);
+        if(converting_d2) {
+            if(adc != 0) {
+                d2 = adc;
+                have_d2 = true;
+                samples_since_d2 = 0;
+            }
+        } else {
+            d1 = adc;
+            d1_osr = osr;
+            samples_since_d2++;
+        }
+
+        was_d2 = converting_d2;
+        converting_d2 = !have_d2 ||
+                        samples_since_d2 >= MS5611_TEMPERATURE_INTERVAL;
+        osr = ms5611_osr;
+        if(converting_d2) {
+            ms5611_start_conversion(MS5611_CMD_CONVERT_D2_OSR256, osr);
+        } else {
+            ms5611_start_conversion(MS5611_CMD_CONVERT_D1_OSR256, osr);
+        }
+
+        /* Only a fresh, valid pressure conversion gives a new sample */
+        if(was_d2 || d1 == 0) {
+            M3PROF_STOP(M3PROF_M3FC_MS5611_SAMPLE);
+            continue;
+        }
+
+        ms5611_compensate(&cal_data, d1, d2, &temperature, &pressure);
 
         /* If we're doing hardware-in-the-loop mocking, discard the just-read
          * value and use the latest mock value instead.
@@ -176,14 +278,26 @@ static THD_FUNCTION(ms5611_thd, arg) {
             m3fc_mock_get_baro(&pressure, &temperature);
         }
 
-        /* Submit new reading if it's within range.
-         * Error band is +-2.5mbar = 250Pa */
+        /* Submit new reading if it's within range, with the error band for
+         * the OSR it was converted at. */
         if(pressure > 1000 && pressure < 120000) {
-            m3fc_state_estimation_new_pressure((float)pressure, 250.0f);
+            m3fc_state_estimation_new_pressure((float)pressure,
+                                               ms5611_pressure_rms[d1_osr]);
         }
 
-        m3can_send_i32(CAN_MSG_ID_M3FC_BARO, temperature, pressure, 2);
+        if(chVTTimeElapsedSinceX(last_can) >= US2ST(MS5611_CAN_PERIOD_US)) {
+            last_can = chVTGetSystemTimeX();
+            m3can_send_m3fc_baro(temperature, pressure);
+        }
         m3status_set_ok(M3FC_COMPONENT_BARO);
+
+        M3PROF_STOP(M3PROF_M3FC_MS5611_SAMPLE);
+    }
+}
+
+void ms5611_set_osr(ms5611_osr_t osr) {
+    if(osr <= MS5611_OSR_4096) {
+        ms5611_osr = osr;
     }
 }
 
@@ -5,9 +5,35 @@
 #ifndef MS5611_H
 #define MS5611_H
 
+#include "hal.h"
+
+/* Oversampling ratio for pressure and temperature conversions.
+ * Higher ratios have lower noise but take longer to convert: from 0.6ms and
+ * 0.065mbar RMS at OSR256 up to 9.04ms and 0.012mbar RMS at OSR4096.
+ */
+typedef enum {
+    MS5611_OSR_256 = 0,
+    MS5611_OSR_512,
+    MS5611_OSR_1024,
+    MS5611_OSR_2048,
+    MS5611_OSR_4096,
+} ms5611_osr_t;
+
+/* Pressure RMS error in Pa given to state estimation at each OSR. The
+ * 2.5mbar used at OSR256 allows for more than just sensor noise, and is
+ * scaled down by the datasheet noise figures at higher OSRs.
+ */
+#define MS5611_PRESSURE_RMS {250.0f, 162.0f, 104.0f, 69.0f, 46.0f}
+
 /*
  * Initialise the MS5611 and start a thread that will collect samples from it.
  */
 void ms5611_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad);
 
+/*
+ * Select the oversampling ratio used from the next conversion onwards.
+ * Safe to call from any thread.
+ */
+void ms5611_set_osr(ms5611_osr_t osr);
+
 #endif
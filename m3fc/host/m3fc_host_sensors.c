@@ -0,0 +1,207 @@
+/*
+ * Host stand-ins for the ADXL345 and MS5611 drivers
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * There is no SPI bus on the host, so these replace adxl345.c and ms5611.c
+ * with threads that deliver samples at the same rates and through the same
+ * calls: batches of 16 accelerometer samples every 5ms, one CAN frame per 4
+ * samples, and barometer samples as fast as the selected OSR allows with a
+ * temperature conversion every 16 and a CAN frame at most every 1.4ms.
+ * Samples are the HIL mock values once
+ * mocking is enabled over CAN, and otherwise a board sitting on the pad.
+ */
+
+#include <math.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "m3can.h"
+#include "m3fc_config.h"
+#include "m3fc_mock.h"
+#include "m3fc_status.h"
+#include "m3fc_state_estimation.h"
+#include "ms5611.h"
+#include "adxl345.h"
+
+#define HOST_ACCEL_BATCH            (16)
+#define HOST_ACCEL_BATCH_MS         (5)
+#define HOST_ACCEL_CAN_DECIMATION   (4)
+#define HOST_ACCEL_SAMPLE_US        (312)       /* 3200Hz */
+#define HOST_BARO_TEMPERATURE_INTERVAL (16)
+#define HOST_BARO_CAN_PERIOD_US     (1400)
+
+#define HOST_PAD_PRESSURE           (101325)
+#define HOST_PAD_TEMPERATURE        (2000)
+
+/* Datasheet maximum conversion times, as in ms5611.c */
+static const uint16_t host_ms5611_conversion_us[] = {
+    600, 1170, 2280, 4540, 9040};
+static volatile ms5611_osr_t host_ms5611_osr = MS5611_OSR_256;
+static const float host_ms5611_pressure_rms[] = MS5611_PRESSURE_RMS;
+
+/* Raw reading of `g` gravities on an axis with `scale` g/LSB and `offset` */
+static int16_t host_accel_raw(float g, float scale, float offset)
+{
+    if(scale == 0.0f) {
+        return 0;
+    }
+    return (int16_t)lrintf(offset + g / scale);
+}
+
+/* One accelerometer sample, resting on the pad with 1g along the
+ * configured up axis, unless mocked.
+ */
+static void host_accel_sample(int16_t accels[3])
+{
+    float g[3] = {0.0f, 0.0f, 0.0f};
+    uint8_t axis = m3fc_config.profile.accel_axis;
+
+    if(m3fc_mock_get_enabled()) {
+        m3fc_mock_get_accel(accels);
+        return;
+    }
+
+    if(axis >= 1 && axis <= 6) {
+        g[(axis - 1) / 2] = (axis % 2) ? 1.0f : -1.0f;
+    }
+    accels[0] = host_accel_raw(g[0], m3fc_config.accel_cal.x_scale,
+                               m3fc_config.accel_cal.x_offset);
+    accels[1] = host_accel_raw(g[1], m3fc_config.accel_cal.y_scale,
+                               m3fc_config.accel_cal.y_offset);
+    accels[2] = host_accel_raw(g[2], m3fc_config.accel_cal.z_scale,
+                               m3fc_config.accel_cal.z_offset);
+}
+
+static THD_WORKING_AREA(host_accel_thd_wa, 512);
+static THD_FUNCTION(host_accel_thd, arg)
+{
+    (void)arg;
+    const float g = 9.80665f;
+    int32_t sums[3], can_sums[3] = {0, 0, 0};
+    int16_t sample[3], accels[3];
+    float faccels[3];
+    uint8_t can_n = 0;
+    systime_t t = chVTGetSystemTimeX();
+
+    chRegSetThreadName("ADXL345");
+    m3status_set_ok(M3FC_COMPONENT_ACCEL);
+
+    while(true) {
+        t += MS2ST(HOST_ACCEL_BATCH_MS);
+        chThdSleepUntil(t);
+
+        sums[0] = sums[1] = sums[2] = 0;
+        for(int i=0; i<HOST_ACCEL_BATCH; i++) {
+            host_accel_sample(sample);
+            for(int j=0; j<3; j++) {
+                sums[j] += sample[j];
+                can_sums[j] += sample[j];
+            }
+            if(++can_n == HOST_ACCEL_CAN_DECIMATION) {
+                for(int j=0; j<3; j++) {
+                    accels[j] = can_sums[j] / HOST_ACCEL_CAN_DECIMATION;
+                    can_sums[j] = 0;
+                }
+                can_n = 0;
+                /* Stamped with the middle of its samples, as in adxl345.c,
+                 * counting back from when the batch was due. M3FC is the
+                 * time master so its system time is common time.
+                 */
+                m3can_send_m3fc_accel(accels[0], accels[1], accels[2],
+                    (uint16_t)(t - US2ST((2 * (HOST_ACCEL_BATCH - i) + 1) *
+                                         HOST_ACCEL_SAMPLE_US / 2)));
+            }
+        }
+
+        for(int j=0; j<3; j++) {
+            accels[j] = sums[j] / HOST_ACCEL_BATCH;
+        }
+        faccels[0] = ((float)accels[0] - m3fc_config.accel_cal.x_offset)
+                     * m3fc_config.accel_cal.x_scale * g;
+        faccels[1] = ((float)accels[1] - m3fc_config.accel_cal.y_offset)
+                     * m3fc_config.accel_cal.y_scale * g;
+        faccels[2] = ((float)accels[2] - m3fc_config.accel_cal.z_offset)
+                     * m3fc_config.accel_cal.z_scale * g;
+        m3fc_state_estimation_new_accels(faccels, 156.96f,
+                                         0.2385f / sqrtf(HOST_ACCEL_BATCH));
+    }
+}
+
+static THD_WORKING_AREA(host_baro_thd_wa, 512);
+static THD_FUNCTION(host_baro_thd, arg)
+{
+    (void)arg;
+    int32_t pressure, temperature;
+    int samples_since_d2 = 0;
+    ms5611_osr_t osr;
+    systime_t last_can = chVTGetSystemTimeX();
+
+    chRegSetThreadName("MS5611");
+    m3status_set_ok(M3FC_COMPONENT_BARO);
+
+    while(true) {
+        /* Each conversion plus a tick of thread and SPI latency */
+        osr = host_ms5611_osr;
+        chThdSleep(US2ST(host_ms5611_conversion_us[osr]) + 1);
+
+        if(++samples_since_d2 >= HOST_BARO_TEMPERATURE_INTERVAL) {
+            samples_since_d2 = 0;
+            continue;
+        }
+
+        if(m3fc_mock_get_enabled()) {
+            m3fc_mock_get_baro(&pressure, &temperature);
+        } else {
+            pressure = HOST_PAD_PRESSURE;
+            temperature = HOST_PAD_TEMPERATURE;
+        }
+
+        if(pressure > 1000 && pressure < 120000) {
+            m3fc_state_estimation_new_pressure((float)pressure,
+                                               host_ms5611_pressure_rms[osr]);
+        }
+        if(chVTTimeElapsedSinceX(last_can) >= US2ST(HOST_BARO_CAN_PERIOD_US)) {
+            last_can = chVTGetSystemTimeX();
+            m3can_send_m3fc_baro(temperature, pressure);
+        }
+    }
+}
+
+void adxl345_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad)
+{
+    (void)spid;
+    (void)ssport;
+    (void)sspad;
+
+    m3status_set_init(M3FC_COMPONENT_ACCEL);
+    chThdCreateStatic(host_accel_thd_wa, sizeof(host_accel_thd_wa),
+                      NORMALPRIO, host_accel_thd, NULL);
+}
+
+/* Host samples are all the same, so there is no launch to capture */
+void adxl345_burst_trigger(void)
+{
+}
+
+void adxl345_burst_send(void)
+{
+}
+
+void ms5611_set_osr(ms5611_osr_t osr)
+{
+    if(osr <= MS5611_OSR_4096) {
+        host_ms5611_osr = osr;
+    }
+}
+
+void ms5611_init(SPIDriver* spid, ioportid_t ssport, uint16_t sspad)
+{
+    (void)spid;
+    (void)ssport;
+    (void)sspad;
+
+    m3status_set_init(M3FC_COMPONENT_BARO);
+    chThdCreateStatic(host_baro_thd_wa, sizeof(host_baro_thd_wa),
+                      NORMALPRIO, host_baro_thd, NULL);
+}
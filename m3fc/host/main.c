@@ -0,0 +1,45 @@
+/*
+ * M3FC firmware as a Linux process on a virtual CAN bus
+ * See shared/m3host/README.md
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "m3can.h"
+#include "m3can_timesync.h"
+#include "m3can_bulk.h"
+#include "m3host.h"
+#include "m3fc_ui.h"
+#include "m3fc_config.h"
+#include "m3fc_status.h"
+#include "m3fc_mission.h"
+#include "m3fc_state_estimation.h"
+#include "ms5611.h"
+#include "adxl345.h"
+
+int main(void) {
+    m3host_init("m3fc");
+
+    halInit();
+    chSysInit();
+
+    static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3FC;
+    m3can_init(CAN_ID_M3FC, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+    m3can_timesync_init_master();
+
+    m3fc_ui_init();
+    m3fc_config_init();
+    m3can_bulk_init();
+    ms5611_init(NULL, GPIOC, GPIOC_BARO_CS);
+    adxl345_init(NULL, GPIOA, GPIOA_ACCEL_CS);
+
+    m3fc_state_estimation_init();
+    m3fc_mission_init();
+
+    while(!m3host_should_stop()) {
+        chThdSleepMilliseconds(100);
+    }
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Pressure to altitude table test and benchmark
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Checks m3fc_altitude_from_pressure against a double precision US Standard
+ * Atmosphere 1976 at every float pressure from 1Pa to 120000Pa, so the error
+ * bound holds for all inputs in range rather than just at sampled points.
+ * Then times it against the previous band search + powf/logf conversion,
+ * which was run three times per barometer sample to get R.
+ *
+ * Exits non-zero if the altitude or gradient error bounds are exceeded.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "m3fc_altitude.h"
+
+#define P_MIN       (1.0f)
+#define P_MAX       (120000.0f)
+
+/* Altitude error bound, and gradient error bound relative to |dh/dp|. */
+#define MAX_ALT_ERROR   (0.1)
+#define MAX_GRAD_ERROR  (1e-3)
+
+#define BENCH_SAMPLES   (1 << 20)
+
+static const double Rs = 8.31432;
+static const double g0 = 9.80665;
+static const double M = 0.0289644;
+static const double Lb[7] = {
+    -0.0065, 0.0, 0.001, 0.0028, 0.0, -0.0028, -0.002};
+static const double Tb[7] = {
+    288.15, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65};
+static const double Hb[7] = {
+    0.0, 11000.0, 20000.0, 32000.0, 47000.0, 51000.0, 71000.0};
+static double Pb[7];
+
+/* Carry the band base pressures up from sea level, as the generator does */
+static void ref_init(void)
+{
+    Pb[0] = 101325.0;
+    for(int b=0; b<6; b++) {
+        double dh = Hb[b+1] - Hb[b];
+        if(Lb[b] == 0.0) {
+            Pb[b+1] = Pb[b] * exp(-g0 * M * dh / (Rs * Tb[b]));
+        } else {
+            Pb[b+1] = Pb[b] * pow(Tb[b] / (Tb[b] + Lb[b] * dh),
+                                  g0 * M / (Rs * Lb[b]));
+        }
+    }
+}
+
+static double ref_altitude(double p, double* dhdp)
+{
+    int b = 0;
+    for(int i=6; i>0; i--) {
+        if(p <= Pb[i]) {
+            b = i;
+            break;
+        }
+    }
+
+    if(Lb[b] == 0.0) {
+        double k = Rs * Tb[b] / (g0 * M);
+        *dhdp = -k / p;
+        return Hb[b] - k * log(p / Pb[b]);
+    } else {
+        double e = -Rs * Lb[b] / (g0 * M);
+        double r = pow(p / Pb[b], e);
+        *dhdp = Tb[b] / Lb[b] * e * r / p;
+        return Hb[b] + Tb[b] / Lb[b] * (r - 1.0);
+    }
+}
+
+/* The conversion previously in m3fc_state_estimation.c, kept for timing,
+ * with the sign of the zero lapse rate case corrected.
+ */
+static const float old_Rs = 8.31432f;
+static const float old_g0 = 9.80665f;
+static const float old_M = 0.0289644f;
+static const float old_Lb[7] = {
+    -0.0065f, 0.0f, 0.001, 0.0028f, 0.0f, -0.0028f, -0.002f};
+static const float old_Pb[7] = {
+    101325.0f, 22632.10f, 5474.89f, 868.02f, 110.91f, 66.94f, 3.96f};
+static const float old_Tb[7] = {
+    288.15f, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65};
+static const float old_Hb[7] = {
+    0.0f, 11000.0f, 20000.0f, 32000.0f, 47000.0f, 51000.0f, 71000.0f};
+
+static float old_p2a_nonzero_lapse(float pressure, int b)
+{
+    return old_Hb[b] + old_Tb[b]/old_Lb[b] *
+        (powf(pressure/old_Pb[b], (-old_Rs*old_Lb[b])/(old_g0*old_M)) - 1.0f);
+}
+
+static float old_p2a_zero_lapse(float pressure, int b)
+{
+    return old_Hb[b] - (old_Rs * old_Tb[b])/(old_g0 * old_M) *
+        (logf(pressure / old_Pb[b]));
+}
+
+static float old_pressure_to_altitude(float pressure)
+{
+    if(pressure > old_Pb[0]) {
+        return old_p2a_nonzero_lapse(pressure, 0);
+    }
+    for(int b = 0; b < 6; b++) {
+        if(pressure <= old_Pb[b] && pressure > old_Pb[b+1]) {
+            if(old_Lb[b] == 0.0f) {
+                return old_p2a_zero_lapse(pressure, b);
+            } else {
+                return old_p2a_nonzero_lapse(pressure, b);
+            }
+        }
+    }
+    return -9999.0f;
+}
+
+static bool check_range(void)
+{
+    union { float f; uint32_t u; } p = {.f = P_MIN};
+    union { float f; uint32_t u; } end = {.f = P_MAX};
+    double max_err = 0.0, max_grad_err = 0.0;
+    float p_err = 0.0f, p_grad_err = 0.0f;
+    uint32_t n = 0;
+    bool ok = true;
+
+    for(; p.u <= end.u; p.u++, n++) {
+        double ref_dhdp, ref_h = ref_altitude(p.f, &ref_dhdp);
+        float dhdp, h = m3fc_altitude_from_pressure(p.f, &dhdp);
+
+        double err = fabs(h - ref_h);
+        double grad_err = fabs(dhdp - ref_dhdp) / fabs(ref_dhdp);
+        if(err > max_err) {
+            max_err = err;
+            p_err = p.f;
+        }
+        if(grad_err > max_grad_err) {
+            max_grad_err = grad_err;
+            p_grad_err = p.f;
+        }
+    }
+
+    printf("Checked %u pressures from %.0fPa to %.0fPa:\n", n, P_MIN, P_MAX);
+    printf("  max altitude error %.4fm at %.4fPa (limit %.4fm)\n",
+           max_err, p_err, MAX_ALT_ERROR);
+    printf("  max gradient error %.2e at %.4fPa (limit %.2e)\n",
+           max_grad_err, p_grad_err, MAX_GRAD_ERROR);
+
+    if(max_err > MAX_ALT_ERROR || max_grad_err > MAX_GRAD_ERROR) {
+        ok = false;
+    }
+    return ok;
+}
+
+static bool check_invalid(void)
+{
+    const float bad[] = {0.0f, -0.0f, -101325.0f, 0.5f, 131072.0f, 1e9f,
+                         INFINITY, NAN};
+    bool ok = true;
+
+    for(size_t i=0; i<sizeof(bad)/sizeof(bad[0]); i++) {
+        float dhdp;
+        if(m3fc_altitude_from_pressure(bad[i], &dhdp)
+           != M3FC_ALTITUDE_INVALID)
+        {
+            printf("  %g Pa not rejected\n", bad[i]);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Time the per-sample work of each path: three conversions before, one
+ * conversion with gradient now.
+ */
+static void bench(void)
+{
+    float* p = malloc(BENCH_SAMPLES * sizeof(float));
+    volatile float sink = 0.0f;
+    double t0, t_old, t_new;
+    uint64_t c0, c_old, c_new;
+
+    srand(1);
+    for(int i=0; i<BENCH_SAMPLES; i++) {
+        /* Flight-like pressures, ground to 30km */
+        p[i] = 1200.0f + 100000.0f * (float)rand() / RAND_MAX;
+    }
+
+    t0 = now_s();
+    c0 = cycles();
+    for(int i=0; i<BENCH_SAMPLES; i++) {
+        float h = old_pressure_to_altitude(p[i]);
+        float hp = old_pressure_to_altitude(p[i] + 2.0f);
+        float hm = old_pressure_to_altitude(p[i] - 2.0f);
+        sink += h + (hm - hp) * (hm - hp);
+    }
+    c_old = cycles() - c0;
+    t_old = now_s() - t0;
+
+    t0 = now_s();
+    c0 = cycles();
+    for(int i=0; i<BENCH_SAMPLES; i++) {
+        float dhdp, h = m3fc_altitude_from_pressure(p[i], &dhdp);
+        sink += h + (4.0f * dhdp) * (4.0f * dhdp);
+    }
+    c_new = cycles() - c0;
+    t_new = now_s() - t0;
+
+    printf("Per barometer sample, %d samples:\n", BENCH_SAMPLES);
+    printf("  band search + powf/logf x3  %7.1fns  %7.1f cycles\n",
+           t_old * 1e9 / BENCH_SAMPLES, (double)c_old / BENCH_SAMPLES);
+    printf("  table with gradient         %7.1fns  %7.1f cycles\n",
+           t_new * 1e9 / BENCH_SAMPLES, (double)c_new / BENCH_SAMPLES);
+    printf("  speedup %.1fx\n", t_old / t_new);
+
+    (void)sink;
+    free(p);
+}
+
+int main(int argc, char* argv[])
+{
+    bool ok = true;
+
+    ref_init();
+
+    ok &= check_range();
+    ok &= check_invalid();
+    if(argc < 2 || strcmp(argv[1], "-q") != 0) {
+        bench();
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
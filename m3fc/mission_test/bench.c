@@ -0,0 +1,329 @@
+/*
+ * Host benchmarks for the estimation and mission hot paths
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Micro-benchmarks time single operations on the flight code (pressure
+ * conversion, each Kalman step, the sample queues and fusion, reading the
+ * published state and the mission state dispatcher) in ns/op. The macro
+ * benchmark runs a whole simulated flight and reports how many sensor
+ * samples per second the flight code gets through.
+ *
+ * Results are printed as a table, and optionally written as JSON (-j) or
+ * CSV (-c) for comparing against a previous run. Host timings do not
+ * translate directly to the M4F, but are a regression baseline for
+ * changes to these paths.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "m3fc_altitude.h"
+#include "m3fc_state_estimation.h"
+#include "m3fc_mission.h"
+
+#define BENCH_ITERATIONS    (1 << 20)
+#define BENCH_REPEATS       (5)
+#define BENCH_MAX_RESULTS   (16)
+
+struct bench_result {
+    const char* name;
+    double ns_per_op;
+    long iterations;
+};
+
+static struct bench_result results[BENCH_MAX_RESULTS];
+static int n_results;
+
+static volatile float sink;
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Flight-like inputs, generated once so the RNG isn't timed */
+static float pressures[1024];
+static float accels[1024][3];
+
+static void bench_inputs(void)
+{
+    srand(1);
+    for(int i=0; i<1024; i++) {
+        pressures[i] = 20000.0f + 80000.0f * (float)rand() / RAND_MAX;
+        accels[i][0] = 0.2f * (float)rand() / RAND_MAX;
+        accels[i][1] = -0.3f * (float)rand() / RAND_MAX;
+        accels[i][2] = 9.0f + 80.0f * (float)rand() / RAND_MAX;
+    }
+}
+
+static void bench_altitude(long n)
+{
+    float acc = 0.0f, dhdp;
+    for(long i=0; i<n; i++) {
+        acc += m3fc_altitude_from_pressure(pressures[i & 1023], &dhdp);
+    }
+    sink = acc;
+}
+
+/* Each Kalman step is run on a private estimator, reset periodically so
+ * the covariance stays in a realistic range.
+ */
+static void bench_predict(long n)
+{
+    struct m3fc_state_estimator se;
+    systime_t t = 0;
+    m3fc_state_estimator_init(&se, t);
+    for(long i=0; i<n; i++) {
+        if((i & 1023) == 0) {
+            m3fc_state_estimator_init(&se, t);
+        }
+        t += 10;
+        sink = m3fc_state_estimator_predict(&se, t).h;
+    }
+}
+
+static void bench_update_pressure(long n)
+{
+    struct m3fc_state_estimator se;
+    m3fc_state_estimator_init(&se, 0);
+    for(long i=0; i<n; i++) {
+        m3fc_state_estimator_update_pressure(&se, pressures[i & 1023], 250.0f);
+    }
+    sink = se.x[0];
+}
+
+static void bench_update_accels(long n)
+{
+    struct m3fc_state_estimator se;
+    m3fc_state_estimator_init(&se, 0);
+    se.accel_axis = M3FC_CONFIG_ACCEL_AXIS_Z;
+    for(long i=0; i<n; i++) {
+        m3fc_state_estimator_update_accels(&se, accels[i & 1023], 156.96f,
+                                           0.0596f);
+    }
+    sink = se.x[2];
+}
+
+/* One accelerometer batch through the sensor queue and the fusion step,
+ * with a barometer sample every fourth batch and a prediction every 10ms,
+ * roughly as in flight.
+ */
+static void bench_queue_fuse(long n)
+{
+    current_time = 0;
+    m3fc_state_estimation_init();
+    for(long i=0; i<n; i++) {
+        current_time += 50;
+        m3fc_state_estimation_new_accels(accels[i & 1023], 156.96f, 0.0596f);
+        if((i & 3) == 0) {
+            m3fc_state_estimation_new_pressure(pressures[i & 1023], 250.0f);
+        }
+        m3fc_state_estimation_fuse();
+    }
+}
+
+static void bench_get_state(long n)
+{
+    float acc = 0.0f;
+    for(long i=0; i<n; i++) {
+        acc += m3fc_state_estimation_get_state().h;
+    }
+    sink = acc;
+}
+
+/* Each state is stepped on a private mission controller with the default
+ * flight profile, put back into that state before every step.
+ */
+static void bench_run_state_pad(long n)
+{
+    struct sim_params params;
+    struct m3fc_mission_controller mc;
+    state_estimate_t x = {0.0f, 0.0f, 0.0f};
+    int state = 0;
+    sim_default_params(&params);
+    m3fc_mission_controller_init(&mc, &params.config);
+    for(long i=0; i<n; i++) {
+        mc.state = STATE_PAD;
+        x.a = accels[i & 1023][0];
+        state += m3fc_mission_controller_step(&mc, x, 0);
+    }
+    sink = (float)state;
+}
+
+static void bench_run_state_ascent(long n)
+{
+    struct sim_params params;
+    struct m3fc_mission_controller mc;
+    state_estimate_t x = {1000.0f, 100.0f, -9.8f};
+    int state = 0;
+    sim_default_params(&params);
+    m3fc_mission_controller_init(&mc, &params.config);
+    for(long i=0; i<n; i++) {
+        mc.state = STATE_FREE_ASCENT;
+        state += m3fc_mission_controller_step(&mc, x, 0);
+    }
+    sink = (float)state;
+}
+
+static void run_micro(const char* name, void (*fn)(long), long n)
+{
+    double best = 1e30;
+    for(int r=0; r<BENCH_REPEATS; r++) {
+        double t0 = now_s();
+        fn(n);
+        double t = now_s() - t0;
+        if(t < best) {
+            best = t;
+        }
+    }
+
+    results[n_results].name = name;
+    results[n_results].ns_per_op = best * 1e9 / n;
+    results[n_results].iterations = n;
+    printf("  %-26s %10.1f ns/op\n", name, results[n_results].ns_per_op);
+    n_results++;
+}
+
+struct bench_flight {
+    double wall_s;
+    double flight_s;
+    uint64_t samples;
+    double samples_per_s;
+    double realtime_factor;
+};
+
+/* Time a whole default simulated flight. The simulator's own physics and
+ * sensor models are included, so this is a lower bound on the flight
+ * code's throughput.
+ */
+static void run_macro(struct bench_flight* b)
+{
+    struct sim_params params;
+    struct sim_result result;
+    double best = 1e30;
+
+    sim_default_params(&params);
+    for(int r=0; r<BENCH_REPEATS; r++) {
+        double t0 = now_s();
+        sim_run(&params, &result, false);
+        double t = now_s() - t0;
+        if(t < best) {
+            best = t;
+        }
+    }
+
+    b->wall_s = best;
+    b->flight_s = result.t_state[SIM_NUM_STATES-1];
+    b->samples = (uint64_t)result.n_accel + result.n_baro;
+    b->samples_per_s = b->samples / best;
+    b->realtime_factor = b->flight_s / best;
+
+    printf("  simulated flight: %.1fs of flight, %lu samples in %.3fs\n",
+           b->flight_s, (unsigned long)b->samples, b->wall_s);
+    printf("  %.0f samples/s, %.0fx real time\n", b->samples_per_s,
+           b->realtime_factor);
+}
+
+static void write_json(const char* path, const struct bench_flight* b)
+{
+    FILE* f = fopen(path, "w");
+    if(f == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(f, "{\n  \"micro\": [\n");
+    for(int i=0; i<n_results; i++) {
+        fprintf(f, "    {\"name\": \"%s\", \"ns_per_op\": %.2f, "
+                   "\"iterations\": %ld}%s\n",
+                results[i].name, results[i].ns_per_op, results[i].iterations,
+                i == n_results - 1 ? "" : ",");
+    }
+    fprintf(f, "  ],\n  \"flight\": {\"wall_s\": %.4f, \"flight_s\": %.3f, "
+               "\"samples\": %lu, \"samples_per_s\": %.0f, "
+               "\"realtime_factor\": %.1f}\n}\n",
+            b->wall_s, b->flight_s, (unsigned long)b->samples,
+            b->samples_per_s, b->realtime_factor);
+    fclose(f);
+}
+
+static void write_csv(const char* path, const struct bench_flight* b)
+{
+    FILE* f = fopen(path, "w");
+    if(f == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(f, "name,value,unit\n");
+    for(int i=0; i<n_results; i++) {
+        fprintf(f, "%s,%.2f,ns/op\n", results[i].name, results[i].ns_per_op);
+    }
+    fprintf(f, "flight,%.0f,samples/s\n", b->samples_per_s);
+    fclose(f);
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-n iterations] [-j results.json] [-c results.csv]\n",
+           name);
+}
+
+int main(int argc, char* argv[])
+{
+    struct bench_flight flight;
+    const char* json_path = NULL;
+    const char* csv_path = NULL;
+    long n = BENCH_ITERATIONS;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:j:c:h")) != -1) {
+        switch(opt) {
+        case 'n':
+            n = strtol(optarg, NULL, 0);
+            break;
+        case 'j':
+            json_path = optarg;
+            break;
+        case 'c':
+            csv_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(n < 1024) {
+        n = 1024;
+    }
+
+    bench_inputs();
+
+    printf("Micro-benchmarks (best of %d runs of %ld):\n", BENCH_REPEATS, n);
+    run_micro("altitude_from_pressure", bench_altitude, n);
+    run_micro("estimator_predict", bench_predict, n);
+    run_micro("estimator_update_pressure", bench_update_pressure, n);
+    run_micro("estimator_update_accels", bench_update_accels, n);
+    run_micro("queue_and_fuse", bench_queue_fuse, n);
+    run_micro("get_state", bench_get_state, n);
+    run_micro("run_state_pad", bench_run_state_pad, n);
+    run_micro("run_state_free_ascent", bench_run_state_ascent, n);
+
+    printf("Macro-benchmark (best of %d):\n", BENCH_REPEATS);
+    run_macro(&flight);
+
+    if(json_path != NULL) {
+        write_json(json_path, &flight);
+    }
+    if(csv_path != NULL) {
+        write_csv(csv_path, &flight);
+    }
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+/*
+ * Monte Carlo campaign runner
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Runs many simulated flights with randomised mission profile, sensor noise,
+ * bias and dropout, spread over worker threads on every core, and reports
+ * the distribution of detection latencies and the false trigger rate.
+ *
+ * Each flight has its own estimator and mission controller, so the workers
+ * share nothing but the run parameters, and write each result straight into
+ * its slot in one array.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "sim.h"
+
+/* Mission state numbers, see m3fc_mission.h */
+#define SIM_STATE_IGNITION          (2)
+#define SIM_STATE_BURNOUT           (4)
+#define SIM_STATE_APOGEE            (6)
+#define SIM_STATE_RELEASE_MAIN      (8)
+#define SIM_STATE_LANDED            (11)
+
+/* A profile field to randomise, inclusive range in config units */
+struct campaign_range {
+    const char* name;
+    size_t offset;
+    int min, max;
+};
+
+#define PROFILE_FIELD(f) #f, offsetof(struct m3fc_config, profile.f)
+static struct campaign_range campaign_ranges[] = {
+    {PROFILE_FIELD(ignition_accel),  25, 25},
+    {PROFILE_FIELD(burnout_timeout), 75, 75},
+    {PROFILE_FIELD(apogee_timeout),  35, 35},
+    {PROFILE_FIELD(main_altitude),   30, 30},
+    {PROFILE_FIELD(main_timeout),   255, 255},
+    {PROFILE_FIELD(land_timeout),    60, 60},
+};
+#define NUM_RANGES (sizeof(campaign_ranges) / sizeof(campaign_ranges[0]))
+
+/* Spread of the non-profile variations */
+struct campaign_spread {
+    float noise_min, noise_max;     /* scale on nominal sensor noise */
+    float accel_bias;               /* RMS, LSB */
+    float baro_bias;                /* RMS, Pa */
+    float dropout_max;              /* uniform in [0, dropout_max] */
+    float mass;                     /* RMS fraction of dry mass */
+};
+
+/* One run's inputs and outputs */
+struct campaign_record {
+    uint32_t run;
+    uint8_t profile[NUM_RANGES];
+    float accel_noise, baro_noise;
+    float accel_bias, baro_bias;
+    float dropout;
+    float dry_mass;
+    struct sim_result result;
+};
+
+/* Summary statistics for one detection event */
+struct campaign_event {
+    const char* name;
+    int state;
+    size_t n;
+    size_t missed;
+    float* latency;
+};
+
+static uint32_t campaign_rand(uint32_t* s)
+{
+    *s ^= *s << 13; *s ^= *s >> 17; *s ^= *s << 5;
+    return *s;
+}
+
+static float campaign_uniform(uint32_t* s)
+{
+    return (campaign_rand(s) >> 8) / 16777216.0f;
+}
+
+static float campaign_gaussian(uint32_t* s)
+{
+    /* Irwin-Hall approximation is plenty for picking run parameters */
+    float sum = 0.0f;
+    for(int i=0; i<12; i++) {
+        sum += campaign_uniform(s);
+    }
+    return sum - 6.0f;
+}
+
+/* Draw the parameters for run `run` from `base`. Each run's draw depends
+ * only on the campaign seed and its run number, so results don't depend on
+ * the number of workers.
+ */
+static void campaign_draw(const struct sim_params* base,
+                          const struct campaign_spread* spread,
+                          uint32_t seed, uint32_t run,
+                          struct sim_params* params,
+                          struct campaign_record* rec)
+{
+    uint32_t s = (seed * 2654435761u) ^ (run * 40503u + 1);
+    if(s == 0) {
+        s = 1;
+    }
+    for(int i=0; i<8; i++) {
+        campaign_rand(&s);
+    }
+
+    *params = *base;
+    params->seed = campaign_rand(&s) | 1;
+
+    for(size_t i=0; i<NUM_RANGES; i++) {
+        const struct campaign_range* r = &campaign_ranges[i];
+        uint8_t* field = (uint8_t*)&params->config + r->offset;
+        *field = (uint8_t)(r->min + campaign_rand(&s) % (r->max - r->min + 1));
+        rec->profile[i] = *field;
+    }
+
+    float noise = spread->noise_min + campaign_uniform(&s) *
+                  (spread->noise_max - spread->noise_min);
+    params->accel_noise *= noise;
+    params->baro_noise *= noise;
+    params->accel_bias = spread->accel_bias * campaign_gaussian(&s);
+    params->baro_bias = spread->baro_bias * campaign_gaussian(&s);
+    params->dropout = spread->dropout_max * campaign_uniform(&s);
+    params->dry_mass *= 1.0f + spread->mass * campaign_gaussian(&s);
+
+    rec->run = run;
+    rec->accel_noise = params->accel_noise;
+    rec->baro_noise = params->baro_noise;
+    rec->accel_bias = params->accel_bias;
+    rec->baro_bias = params->baro_bias;
+    rec->dropout = params->dropout;
+    rec->dry_mass = params->dry_mass;
+}
+
+/* One worker thread's share of the campaign: every `stride`th run from
+ * `first`, written into `recs`.
+ */
+struct campaign_worker {
+    pthread_t thread;
+    const struct sim_params* base;
+    const struct campaign_spread* spread;
+    uint32_t seed, first, stride, runs;
+    struct campaign_record* recs;
+};
+
+static void* campaign_worker(void* arg)
+{
+    struct campaign_worker* w = arg;
+    struct sim_params params;
+
+    for(uint32_t run=w->first; run<w->runs; run+=w->stride) {
+        struct campaign_record* rec = &w->recs[run];
+        memset(rec, 0, sizeof(*rec));
+        campaign_draw(w->base, w->spread, w->seed, run, &params, rec);
+        sim_run(&params, &rec->result, false);
+    }
+
+    return NULL;
+}
+
+static bool campaign_parse_range(const char* arg)
+{
+    char name[32];
+    int min, max;
+
+    if(sscanf(arg, "%31[a-z_]=%d:%d", name, &min, &max) != 3) {
+        if(sscanf(arg, "%31[a-z_]=%d", name, &min) != 2) {
+            return false;
+        }
+        max = min;
+    }
+
+    if(min < 0 || max > 255 || min > max) {
+        return false;
+    }
+
+    for(size_t i=0; i<NUM_RANGES; i++) {
+        if(strcmp(campaign_ranges[i].name, name) == 0) {
+            campaign_ranges[i].min = min;
+            campaign_ranges[i].max = max;
+            return true;
+        }
+    }
+    return false;
+}
+
+static int campaign_cmp_float(const void* a, const void* b)
+{
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static float campaign_percentile(const float* sorted, size_t n, float pc)
+{
+    size_t i = (size_t)(pc / 100.0f * (n - 1) + 0.5f);
+    return sorted[i];
+}
+
+static void campaign_print_event(struct campaign_event* e, size_t runs)
+{
+    float mean = 0.0f;
+
+    if(e->n == 0) {
+        printf("  %-9s  never detected (%zu missed)\n", e->name, e->missed);
+        return;
+    }
+
+    qsort(e->latency, e->n, sizeof(float), campaign_cmp_float);
+    for(size_t i=0; i<e->n; i++) {
+        mean += e->latency[i];
+    }
+    mean /= e->n;
+
+    printf("  %-9s %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f %7.3f   %5.1f%%\n",
+           e->name, e->latency[0],
+           campaign_percentile(e->latency, e->n, 5.0f),
+           campaign_percentile(e->latency, e->n, 50.0f),
+           mean,
+           campaign_percentile(e->latency, e->n, 95.0f),
+           campaign_percentile(e->latency, e->n, 99.0f),
+           e->latency[e->n - 1],
+           100.0f * e->missed / runs);
+}
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [options]\n"
+           "  -n runs        number of flights (default 1000)\n"
+           "  -j jobs        worker threads (default one per core)\n"
+           "  -s seed        campaign seed (default 1)\n"
+           "  -e motor.eng   thrust curve\n"
+           "  -p name=lo:hi  randomise a profile field uniformly in [lo, hi]\n"
+           "                 (ignition_accel, burnout_timeout, apogee_timeout,\n"
+           "                 main_altitude, main_timeout, land_timeout)\n"
+           "  -N lo:hi       sensor noise scale range (default 0.5:2)\n"
+           "  -b accel:baro  RMS sensor bias in LSB and Pa (default 5:100)\n"
+           "  -d max         maximum sample dropout fraction (default 0.05)\n"
+           "  -o file.csv    write per-run parameters and results\n",
+           name);
+}
+
+int main(int argc, char* argv[])
+{
+    struct sim_params base;
+    struct campaign_spread spread = {
+        .noise_min = 0.5f, .noise_max = 2.0f,
+        .accel_bias = 5.0f, .baro_bias = 100.0f,
+        .dropout_max = 0.05f, .mass = 0.05f,
+    };
+    uint32_t runs = 1000;
+    uint32_t seed = 1;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    const char* csv_path = NULL;
+    int opt;
+
+    sim_default_params(&base);
+
+    while((opt = getopt(argc, argv, "n:j:s:e:p:N:b:d:o:h")) != -1) {
+        switch(opt) {
+        case 'n':
+            runs = strtoul(optarg, NULL, 0);
+            break;
+        case 'j':
+            jobs = strtol(optarg, NULL, 0);
+            break;
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            if(!sim_load_eng(&base, optarg)) {
+                printf("Could not read thrust curve from %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'p':
+            if(!campaign_parse_range(optarg)) {
+                printf("Bad profile range '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        case 'N':
+            if(sscanf(optarg, "%f:%f", &spread.noise_min,
+                      &spread.noise_max) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'b':
+            if(sscanf(optarg, "%f:%f", &spread.accel_bias,
+                      &spread.baro_bias) != 2) {
+                usage(argv[0]);
+                return 1;
+            }
+            break;
+        case 'd':
+            spread.dropout_max = strtof(optarg, NULL);
+            break;
+        case 'o':
+            csv_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(jobs < 1) {
+        jobs = 1;
+    }
+    if(runs == 0) {
+        return 0;
+    }
+
+    if((uint32_t)jobs > runs) {
+        jobs = runs;
+    }
+
+    struct campaign_record* recs = calloc(runs, sizeof(*recs));
+    struct campaign_worker* workers = calloc(jobs, sizeof(*workers));
+    if(recs == NULL || workers == NULL) {
+        perror("calloc");
+        return 1;
+    }
+
+    for(long j=0; j<jobs; j++) {
+        struct campaign_worker* w = &workers[j];
+        w->base = &base;
+        w->spread = &spread;
+        w->seed = seed;
+        w->first = j;
+        w->stride = jobs;
+        w->runs = runs;
+        w->recs = recs;
+        int err = pthread_create(&w->thread, NULL, campaign_worker, w);
+        if(err != 0) {
+            printf("Could not start worker thread: %s\n", strerror(err));
+            return 1;
+        }
+    }
+    for(long j=0; j<jobs; j++) {
+        pthread_join(workers[j].thread, NULL);
+    }
+    free(workers);
+
+    /* Latency of each detection against the matching true event */
+    struct campaign_event events[] = {
+        {"ignition", SIM_STATE_IGNITION,     0, 0, NULL},
+        {"burnout",  SIM_STATE_BURNOUT,      0, 0, NULL},
+        {"apogee",   SIM_STATE_APOGEE,       0, 0, NULL},
+        {"main",     SIM_STATE_RELEASE_MAIN, 0, 0, NULL},
+        {"landed",   SIM_STATE_LANDED,       0, 0, NULL},
+    };
+    const size_t num_events = sizeof(events) / sizeof(events[0]);
+    uint32_t false_ignition = 0, early_apogee = 0, early_landing = 0;
+    uint32_t any_false = 0;
+
+    for(size_t e=0; e<num_events; e++) {
+        events[e].latency = calloc(runs, sizeof(float));
+    }
+
+    for(uint32_t i=0; i<runs; i++) {
+        const struct sim_result* r = &recs[i].result;
+        float truth[] = {r->t_liftoff, r->t_burnout, r->t_apogee,
+                         r->t_main, r->t_landing};
+        bool is_false = false;
+
+        for(size_t e=0; e<num_events; e++) {
+            float t = r->t_state[events[e].state];
+            if(t < 0.0f || truth[e] < 0.0f) {
+                events[e].missed++;
+            } else {
+                events[e].latency[events[e].n++] = t - truth[e];
+            }
+        }
+
+        if(r->false_ignitions > 0 ||
+           (r->t_state[SIM_STATE_IGNITION] >= 0.0f &&
+            r->t_state[SIM_STATE_IGNITION] < r->t_liftoff))
+        {
+            false_ignition++;
+            is_false = true;
+        }
+        if(r->t_state[SIM_STATE_APOGEE] >= 0.0f &&
+           r->t_state[SIM_STATE_APOGEE] < r->t_burnout)
+        {
+            early_apogee++;
+            is_false = true;
+        }
+        if(r->t_state[SIM_STATE_LANDED] >= 0.0f &&
+           r->t_state[SIM_STATE_LANDED] < r->t_landing)
+        {
+            early_landing++;
+            is_false = true;
+        }
+        any_false += is_false;
+    }
+
+    printf("%u flights, %ld workers, seed %u\n", runs, jobs, seed);
+    for(size_t i=0; i<NUM_RANGES; i++) {
+        printf("  %-16s %3d..%3d\n", campaign_ranges[i].name,
+               campaign_ranges[i].min, campaign_ranges[i].max);
+    }
+    printf("\nDetection latency (s):\n");
+    printf("  %-9s %7s %7s %7s %7s %7s %7s %7s   %6s\n", "event", "min",
+           "p5", "p50", "mean", "p95", "p99", "max", "missed");
+    for(size_t e=0; e<num_events; e++) {
+        campaign_print_event(&events[e], runs);
+    }
+    printf("\nFalse triggers:\n");
+    printf("  ignition on pad          %5u  (%5.2f%%)\n", false_ignition,
+           100.0f * false_ignition / runs);
+    printf("  apogee before burnout    %5u  (%5.2f%%)\n", early_apogee,
+           100.0f * early_apogee / runs);
+    printf("  landed before touchdown  %5u  (%5.2f%%)\n", early_landing,
+           100.0f * early_landing / runs);
+    printf("  any                      %5u  (%5.2f%%)\n", any_false,
+           100.0f * any_false / runs);
+
+    if(csv_path != NULL) {
+        FILE* csv = fopen(csv_path, "w");
+        if(csv == NULL) {
+            perror(csv_path);
+            return 1;
+        }
+        fprintf(csv, "run");
+        for(size_t i=0; i<NUM_RANGES; i++) {
+            fprintf(csv, ",%s", campaign_ranges[i].name);
+        }
+        fprintf(csv, ",accel_noise,baro_noise,accel_bias,baro_bias,dropout,"
+                     "dry_mass,h_apogee,h_main,false_ignitions");
+        for(size_t e=0; e<num_events; e++) {
+            fprintf(csv, ",t_true_%s,t_detect_%s", events[e].name,
+                    events[e].name);
+        }
+        fprintf(csv, "\n");
+        for(uint32_t i=0; i<runs; i++) {
+            const struct campaign_record* c = &recs[i];
+            const struct sim_result* r = &c->result;
+            float truth[] = {r->t_liftoff, r->t_burnout, r->t_apogee,
+                             r->t_main, r->t_landing};
+            fprintf(csv, "%u", c->run);
+            for(size_t j=0; j<NUM_RANGES; j++) {
+                fprintf(csv, ",%u", c->profile[j]);
+            }
+            fprintf(csv, ",%.3f,%.3f,%.3f,%.3f,%.4f,%.3f,%.2f,%.2f,%d",
+                    c->accel_noise, c->baro_noise, c->accel_bias,
+                    c->baro_bias, c->dropout, c->dry_mass, r->h_apogee,
+                    r->h_main, r->false_ignitions);
+            for(size_t e=0; e<num_events; e++) {
+                fprintf(csv, ",%.4f,%.4f", truth[e],
+                        r->t_state[events[e].state]);
+            }
+            fprintf(csv, "\n");
+        }
+        fclose(csv);
+    }
+
+    for(size_t e=0; e<num_events; e++) {
+        free(events[e].latency);
+    }
+    free(recs);
+
+    return 0;
+}
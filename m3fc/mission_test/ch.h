@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 typedef uint32_t systime_t;
 extern uint32_t current_time;
@@ -15,12 +16,15 @@ extern uint32_t current_time;
 #define chVTTimeElapsedSinceX(x)    (current_time - x)
 
 #define chThdSleepMilliseconds(x)
-#define chThdCreateStatic(a, b, c, d, e) ((void)a)
+#define chThdCreateStatic(a, b, c, d, e) ((void)a, (void)d)
+#define chRegSetThreadName(x)
+#define NORMALPRIO                  (128)
 
 #define THD_WORKING_AREA(x, y)      uint8_t x[y]
 #define THD_FUNCTION(name, arg)     void name(void* arg)
 
 typedef bool binary_semaphore_t;
 #define chBSemWait(x)
+#define chBSemWaitTimeout(x, y)
 #define chBSemSignal(x)
 #define chBSemObjectInit(x, y)      ((void)x)
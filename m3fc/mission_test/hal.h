@@ -0,0 +1,8 @@
+#pragma once
+
+#include <stdint.h>
+
+typedef struct SPIDriver SPIDriver;
+typedef void* ioportid_t;
+typedef struct EXTDriver EXTDriver;
+typedef uint32_t expchannel_t;
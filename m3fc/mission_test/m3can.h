@@ -1,16 +1,15 @@
 #pragma once
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define m3can_init(x)
-#define m3can_send(a, b, c, d) ((void)c)
 
-#define CAN_ID_M3FC      (1)
-#define CAN_ID_M3RADIO   (4)
-#define CAN_MSG_ID(x)    (x<<5)
-#define CAN_MSG_ID_M3FC_MISSION_STATE       (CAN_ID_M3FC | CAN_MSG_ID(32))
-#define CAN_MSG_ID_M3FC_ACCEL               (CAN_ID_M3FC | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3FC_BARO                (CAN_ID_M3FC | CAN_MSG_ID(49))
-#define CAN_MSG_ID_M3FC_SE_T_H              (CAN_ID_M3FC | CAN_MSG_ID(50))
-#define CAN_MSG_ID_M3FC_SE_V_A              (CAN_ID_M3FC | CAN_MSG_ID(51))
-#define CAN_MSG_ID_M3FC_SE_VAR_H            (CAN_ID_M3FC | CAN_MSG_ID(52))
-#define CAN_MSG_ID_M3FC_SE_VAR_V_A          (CAN_ID_M3FC | CAN_MSG_ID(53))
-#define CAN_MSG_ID_M3RADIO_GPS_ALT          (CAN_ID_M3RADIO | CAN_MSG_ID(49))
+/* Each host harness provides its own m3can_send, so the simulator can watch
+ * for pyro fire commands while the replay tool just discards everything.
+ */
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen);
+#define m3can_own_id (1)
+
+/* Message IDs and packers, generated from shared/m3can/messages.yaml */
+#include "m3can_msgs.h"
@@ -1,9 +1,13 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-#include "../firmware/m3fc_mission.c"
-#include "../firmware/m3fc_state_estimation.c"
+#include "m3can.h"
+#include "m3fc_config.h"
+#include "m3fc_mission.h"
+#include "m3fc_state_estimation.h"
+#include "logreader.h"
 
 uint32_t current_time = 0;
 struct m3fc_config m3fc_config = {
@@ -20,6 +24,30 @@ struct m3fc_config m3fc_config = {
 };
 enum m3fc_ui_beeper_mode m3fc_ui_beeper_mode = M3FC_UI_BEEPER_SLOW;
 
+/* Outgoing CAN traffic is ignored when replaying logs. */
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)msg_id;
+    (void)can_rtr;
+    (void)data;
+    (void)datalen;
+}
+
+/* The replayed log already has its barometer samples. */
+void ms5611_set_osr(ms5611_osr_t osr)
+{
+    (void)osr;
+}
+
+/* Nor are there raw accelerometer samples to capture. */
+void adxl345_burst_trigger(void)
+{
+}
+
+void adxl345_burst_send(void)
+{
+}
+
 const char* state_names[] = {
     "init", "pad", "ignition", "powered ascent", "burnout",
     "free ascent", "apogee", "drogue descent", "release main",
@@ -44,33 +72,59 @@ struct log_packet {
 
 int main(int argc, char* argv[])
 {
-    (void)mission_thread;
+    if(argc < 2 || argc > 4) {
+        printf("Usage: %s <log file> [start s [end s]]\n", argv[0]);
+        return 1;
+    }
 
-    if(argc != 2) {
-        printf("Usage: %s <log file>\n", argv[0]);
+    static struct logreader logfile;
+    struct logformat_frame frame;
+    if(logreader_open(&logfile, argv[1]) != 0) {
+        perror(argv[1]);
         return 1;
     }
 
-    FILE* logfile = fopen(argv[1], "rb");
+    /* Replay just the launch window, read straight from the log's index */
+    if(argc > 2) {
+        uint32_t start = (uint32_t)(atof(argv[2]) * 10000.0 + 0.5);
+        uint32_t end = argc > 3 ? (uint32_t)(atof(argv[3]) * 10000.0 + 0.5)
+                                : UINT32_MAX;
+        logreader_select(&logfile, start, end, NULL);
+    }
     FILE* outfile = fopen("out.bin", "wb");
     struct log_packet packet;
 
     state_t cur_state = STATE_PAD;
     state_t new_state;
-    instance_data_t data = {0};
-    data.h_ground = -54.0f;
+    state_estimate_t x;
+    struct m3fc_mission_controller mc;
+    struct m3fc_state_estimator se;
+    m3fc_mission_controller_init(&mc, &m3fc_config);
+    mc.state = STATE_PAD;
+    mc.h_ground = -54.0f;
     systime_t last_mission_time = 0;
 
-    while(fread(&packet, sizeof(struct log_packet), 1, logfile)) {
+    while(logreader_next(&logfile, &frame)) {
+        packet.sid = frame.sid;
+        packet.rtr = frame.rtr;
+        packet.dlc = frame.len;
+        memcpy(packet.u8, frame.data, 8);
+        packet.ts = frame.timestamp;
+
         /* set the global fake time */
         current_time = packet.ts;
 
         /* first time around, initialise timestamps */
         if(last_mission_time == 0) {
             last_mission_time = current_time;
-            m3fc_state_estimation_init();
+            m3fc_state_estimator_init(&se, current_time);
         }
 
+        /* mission control sets the estimator flags as it changes state */
+        se.trust_barometer = mc.trust_barometer;
+        se.dynamic_event_expected = mc.dynamic_event_expected;
+        se.accel_axis = m3fc_config.profile.accel_axis;
+
         if(packet.sid == CAN_MSG_ID_M3FC_ACCEL) {
             /* convert accels to m/s/s floats and run SE */
             const float g = 9.80665f;
@@ -79,11 +133,12 @@ int main(int argc, char* argv[])
                 (float)packet.i16[1] * 0.0039 * g,
                 ((float)packet.i16[2]) * 0.00405 * g,
             };
-            m3fc_state_estimation_new_accels(faccels, 156.96f, 10.01f);
+            m3fc_state_estimator_update_accels(&se, faccels, 156.96f, 10.01f);
             fwrite(&packet, sizeof(struct log_packet), 1, outfile);
         } else if(packet.sid == CAN_MSG_ID_M3FC_BARO) {
             /* run SE on new pressure */
-            m3fc_state_estimation_new_pressure((float)packet.i32[1], 250.0f);
+            m3fc_state_estimator_update_pressure(&se, (float)packet.i32[1],
+                                                 250.0f);
             fwrite(&packet, sizeof(struct log_packet), 1, outfile);
         } else if(packet.sid == CAN_MSG_ID_M3RADIO_GPS_ALT) {
             fwrite(&packet, sizeof(struct log_packet), 1, outfile);
@@ -91,13 +146,13 @@ int main(int argc, char* argv[])
 
         if(current_time - last_mission_time > 100) {
             /* Run the mission state machine every 10ms */
-            data.state = m3fc_state_estimation_get_state();
-            new_state = run_state(cur_state, &data);
+            x = m3fc_state_estimator_predict(&se, current_time);
+            new_state = m3fc_mission_controller_step(&mc, x, current_time);
             if(new_state != cur_state) {
                 printf("State change, old=%s new=%s\n",
                        state_names[cur_state], state_names[new_state]);
-                printf("t=%d h=%f v=%f a=%f\n", current_time, data.state.h,
-                       data.state.v, data.state.a);
+                printf("t=%d h=%f v=%f a=%f\n", current_time, x.h, x.v,
+                       x.a);
                 printf("\n");
 
                 cur_state = new_state;
@@ -112,22 +167,22 @@ int main(int argc, char* argv[])
 
             struct log_packet se_t_h = {
                 .sid = CAN_MSG_ID_M3FC_SE_T_H, .rtr = 0, .dlc = 8,
-                .f32 = {0, data.state.h},
+                .f32 = {0, x.h},
                 .ts  = current_time,
             };
             struct log_packet se_v_a = {
                 .sid = CAN_MSG_ID_M3FC_SE_V_A, .rtr = 0, .dlc = 8,
-                .f32 = {data.state.v, data.state.a},
+                .f32 = {x.v, x.a},
                 .ts  = current_time,
             };
             struct log_packet se_var_h = {
                 .sid = CAN_MSG_ID_M3FC_SE_VAR_H, .rtr = 0, .dlc = 8,
-                .f32 = {p[0][0]},
+                .f32 = {se.p[0][0]},
                 .ts = current_time,
             };
             struct log_packet se_var_v_a = {
                 .sid = CAN_MSG_ID_M3FC_SE_VAR_V_A, .rtr = 0, .dlc = 8,
-                .f32 = {p[1][1], p[2][2]},
+                .f32 = {se.p[1][1], se.p[2][2]},
                 .ts = current_time,
             };
             struct log_packet mc_state = {
@@ -145,7 +200,7 @@ int main(int argc, char* argv[])
         }
     }
 
-    fclose(logfile);
+    logreader_close(&logfile);
     fclose(outfile);
 
     return 0;
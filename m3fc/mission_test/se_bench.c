@@ -0,0 +1,246 @@
+/*
+ * State estimation jitter benchmark
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Runs the sensor producers, the fusion thread and a mission control reader
+ * as host threads, and measures how long the accelerometer thread spends
+ * handing a sample to state estimation and how late it wakes for its next
+ * sample. Compares the queue + seqlock path against the previous design,
+ * where every sensor update and prediction took the same lock.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "m3fc_config.h"
+#include "m3fc_state_estimation.h"
+
+uint32_t current_time = 0;
+struct m3fc_config m3fc_config = {
+    .profile = {.accel_axis = M3FC_CONFIG_ACCEL_AXIS_Z},
+};
+
+/* The SE frames are discarded, their cost is emulated below instead. */
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)msg_id;
+    (void)can_rtr;
+    (void)data;
+    (void)datalen;
+}
+
+#define ACCEL_PERIOD_NS     (125000)
+#define BARO_PERIOD_NS      (1400000)
+#define MISSION_PERIOD_NS   (1000000)
+
+/* Emulated time for each of the four SE CAN frames the mission thread sends
+ * after reading the state, when the transmit mailboxes are full.
+ */
+#define CAN_SEND_NS         (130000)
+
+enum bench_mode { MODE_LOCKED, MODE_LOCKFREE };
+
+static enum bench_mode mode;
+static volatile bool running;
+static struct m3fc_state_estimator locked_se;
+static pthread_mutex_t locked_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int num_samples;
+static int64_t* submit_ns;
+static int64_t* wake_ns;
+static int64_t* read_ns;
+static int num_reads;
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void sleep_until(int64_t t)
+{
+    struct timespec ts = {.tv_sec = t / 1000000000, .tv_nsec = t % 1000000000};
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+static void busy_wait(int64_t ns)
+{
+    int64_t end = now_ns() + ns;
+    while(now_ns() < end);
+}
+
+static void set_time(void)
+{
+    __atomic_store_n(&current_time, (uint32_t)(now_ns() / 100000),
+                     __ATOMIC_RELAXED);
+}
+
+static void* accel_thread(void* arg)
+{
+    (void)arg;
+    float accels[3] = {0.1f, -0.2f, 9.9f};
+    int64_t deadline = now_ns();
+
+    for(int i=0; i<num_samples; i++) {
+        deadline += ACCEL_PERIOD_NS;
+        sleep_until(deadline);
+
+        int64_t t0 = now_ns();
+        set_time();
+        if(mode == MODE_LOCKFREE) {
+            m3fc_state_estimation_new_accels(accels, 156.96f, 0.1186f);
+        } else {
+            pthread_mutex_lock(&locked_mutex);
+            m3fc_state_estimator_update_accels(&locked_se, accels,
+                                               156.96f, 0.1186f);
+            pthread_mutex_unlock(&locked_mutex);
+        }
+        int64_t t1 = now_ns();
+
+        wake_ns[i] = t0 - deadline;
+        submit_ns[i] = t1 - t0;
+    }
+
+    return NULL;
+}
+
+static void* baro_thread(void* arg)
+{
+    (void)arg;
+    int64_t deadline = now_ns();
+
+    while(running) {
+        deadline += BARO_PERIOD_NS;
+        sleep_until(deadline);
+        set_time();
+        if(mode == MODE_LOCKFREE) {
+            m3fc_state_estimation_new_pressure(101000.0f, 250.0f);
+        } else {
+            pthread_mutex_lock(&locked_mutex);
+            m3fc_state_estimator_update_pressure(&locked_se, 101000.0f,
+                                                 250.0f);
+            pthread_mutex_unlock(&locked_mutex);
+        }
+    }
+
+    return NULL;
+}
+
+static void* fusion_thread(void* arg)
+{
+    (void)arg;
+    while(running) {
+        set_time();
+        m3fc_state_estimation_fuse();
+        usleep(50);
+    }
+    return NULL;
+}
+
+static void* mission_thread(void* arg)
+{
+    (void)arg;
+    int64_t deadline = now_ns();
+    int max_reads = (int)((int64_t)num_samples * ACCEL_PERIOD_NS
+                          / MISSION_PERIOD_NS) + 16;
+
+    while(running && num_reads < max_reads) {
+        deadline += MISSION_PERIOD_NS;
+        sleep_until(deadline);
+
+        int64_t t0 = now_ns();
+        set_time();
+        if(mode == MODE_LOCKFREE) {
+            m3fc_state_estimation_get_state();
+        } else {
+            /* As before: prediction under the lock, then the CAN frames */
+            pthread_mutex_lock(&locked_mutex);
+            m3fc_state_estimator_predict(&locked_se, current_time);
+            pthread_mutex_unlock(&locked_mutex);
+        }
+        read_ns[num_reads++] = now_ns() - t0;
+
+        busy_wait(4 * CAN_SEND_NS);
+    }
+
+    return NULL;
+}
+
+static int cmp_i64(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char* name, int64_t* v, int n)
+{
+    qsort(v, n, sizeof(int64_t), cmp_i64);
+    printf("  %-18s %8.2f %8.2f %8.2f %8.2f %9.2f\n", name,
+           v[n/2] / 1000.0, v[n*90/100] / 1000.0, v[n*99/100] / 1000.0,
+           v[n*999/1000] / 1000.0, v[n-1] / 1000.0);
+}
+
+static void run(enum bench_mode m)
+{
+    pthread_t accel, baro, fusion, mission;
+
+    mode = m;
+    running = true;
+    num_reads = 0;
+    set_time();
+    m3fc_state_estimation_init();
+    m3fc_state_estimator_init(&locked_se, current_time);
+
+    pthread_create(&baro, NULL, baro_thread, NULL);
+    pthread_create(&mission, NULL, mission_thread, NULL);
+    if(m == MODE_LOCKFREE) {
+        pthread_create(&fusion, NULL, fusion_thread, NULL);
+    }
+    pthread_create(&accel, NULL, accel_thread, NULL);
+
+    pthread_join(accel, NULL);
+    running = false;
+    pthread_join(baro, NULL);
+    pthread_join(mission, NULL);
+    if(m == MODE_LOCKFREE) {
+        pthread_join(fusion, NULL);
+    }
+
+    printf("%s (%d accel samples, %d reads), us:\n",
+           m == MODE_LOCKFREE ? "queue + seqlock" : "shared lock",
+           num_samples, num_reads);
+    printf("  %-18s %8s %8s %8s %8s %9s\n", "", "p50", "p90", "p99",
+           "p99.9", "max");
+    report("accel submit", submit_ns, num_samples);
+    report("accel wake late", wake_ns, num_samples);
+    report("mission read", read_ns, num_reads);
+}
+
+int main(int argc, char* argv[])
+{
+    num_samples = argc > 1 ? atoi(argv[1]) : 20000;
+    if(num_samples < 1000) {
+        num_samples = 1000;
+    }
+
+    submit_ns = calloc(num_samples, sizeof(int64_t));
+    wake_ns = calloc(num_samples, sizeof(int64_t));
+    read_ns = calloc(num_samples, sizeof(int64_t));
+
+    run(MODE_LOCKED);
+    printf("\n");
+    run(MODE_LOCKFREE);
+
+    free(submit_ns);
+    free(wake_ns);
+    free(read_ns);
+    return 0;
+}
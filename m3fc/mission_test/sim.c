@@ -0,0 +1,656 @@
+/*
+ * Software-in-the-loop flight simulator
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Models a 1-D trajectory (thrust curve, drag, parachutes), synthesises
+ * ADXL345 and MS5611 samples at their real rates and feeds them through the
+ * flight state estimation and mission control code on a simulated clock.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "m3can.h"
+#include "m3fc_mission.h"
+#include "m3fc_state_estimation.h"
+#include "sim.h"
+
+_Static_assert(SIM_NUM_STATES == NUM_STATES, "SIM_NUM_STATES out of date");
+
+/* Only the firmware's single instance wrappers use these. Each simulated
+ * flight has its own estimator and mission controller, so many flights can
+ * run at once on different threads.
+ */
+uint32_t current_time = 0;
+struct m3fc_config m3fc_config;
+enum m3fc_ui_beeper_mode m3fc_ui_beeper_mode = M3FC_UI_BEEPER_SLOW;
+
+const char* sim_state_names[SIM_NUM_STATES] = {
+    "init", "pad", "ignition", "powered ascent", "burnout",
+    "free ascent", "apogee", "drogue descent", "release main",
+    "main descent", "land", "landed"
+};
+
+/* US Standard Atmosphere 1976, in double precision for the truth model */
+static const double sim_Rs = 8.31432;
+static const double sim_g0 = 9.80665;
+static const double sim_M = 0.0289644;
+static const double sim_Lb[7] = {
+    -0.0065, 0.0, 0.001, 0.0028, 0.0, -0.0028, -0.002};
+static const double sim_Pb[7] = {
+    101325.0, 22632.10, 5474.89, 868.02, 110.91, 66.94, 3.96};
+static const double sim_Tb[7] = {
+    288.15, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65};
+static const double sim_Hb[7] = {
+    0.0, 11000.0, 20000.0, 32000.0, 47000.0, 51000.0, 71000.0};
+
+/* Truth state of the simulated vehicle */
+struct sim_flight {
+    const struct sim_params* params;
+    struct sim_result* result;
+
+    double h, v;
+    double specific_force;
+    double impulse, total_impulse;
+    bool on_ground;
+    bool drogue_fired, main_fired;
+    double t_drogue_open, t_main_open;
+    double t_now;
+
+    /* Accelerometer samples waiting in the simulated FIFO */
+    int32_t fifo_sums[3];
+    int fifo_n;
+    bool fifo_saturated;
+
+    /* Barometer pressure conversions since the last temperature one, and
+     * the oversampling last selected by mission control.
+     */
+    int baro_since_d2;
+    ms5611_osr_t baro_osr;
+
+    /* Samples taken at the current time, waiting to be fused */
+    bool accel_ready, baro_ready;
+    float accel[3], accel_rms;
+    float pressure, pressure_rms;
+
+    /* The flight code under test, and when the estimator last predicted */
+    struct m3fc_state_estimator se;
+    struct m3fc_mission_controller mc;
+    systime_t t_predict;
+
+    uint32_t rng;
+};
+
+/* The fusion thread runs a prediction step at least this often */
+#define SIM_PREDICT_PERIOD MS2ST(10)
+
+/* Datasheet barometer conversion time and RMS noise (relative to OSR256)
+ * at each OSR.
+ */
+static const uint16_t sim_baro_conversion_us[] = {600, 1170, 2280, 4540, 9040};
+static const float sim_baro_noise_scale[] = {
+    1.0f, 0.042f/0.065f, 0.027f/0.065f, 0.018f/0.065f, 0.012f/0.065f};
+static const float sim_baro_rms[] = MS5611_PRESSURE_RMS;
+
+static double sim_pressure_at(double altitude);
+static double sim_thrust_at(const struct sim_params* params, double t);
+static double sim_total_impulse(const struct sim_params* params);
+static void sim_physics_step(struct sim_flight* f, double dt);
+static void sim_sample_accel(struct sim_flight* f);
+static uint64_t sim_sample_baro(struct sim_flight* f);
+static void sim_fuse(struct sim_flight* f, systime_t now);
+static void sim_fire(struct sim_flight* f, uint8_t usage);
+static float sim_gaussian(uint32_t* rng);
+static float sim_uniform(uint32_t* rng);
+
+void sim_default_params(struct sim_params* params)
+{
+    /* A 4kg-propellant L-class motor with a roughly progressive curve. */
+    static const float thrust[][2] = {
+        {0.00f,    0.0f}, {0.05f, 1900.0f}, {0.20f, 1700.0f},
+        {1.00f, 1750.0f}, {2.00f, 1800.0f}, {3.00f, 1650.0f},
+        {3.40f,  900.0f}, {3.70f,  200.0f}, {3.90f,    0.0f},
+    };
+
+    memset(params, 0, sizeof(*params));
+
+    params->dry_mass = 14.0f;
+    params->prop_mass = 3.0f;
+    params->cd = 0.45f;
+    params->diameter = 0.102f;
+    params->drogue_cda = 0.35f;
+    params->main_cda = 4.0f;
+
+    params->thrust_points = sizeof(thrust) / sizeof(thrust[0]);
+    for(int i=0; i<params->thrust_points; i++) {
+        params->thrust_t[i] = thrust[i][0];
+        params->thrust_f[i] = thrust[i][1];
+    }
+
+    params->ground_altitude = 0.0f;
+    params->t_arm = 1.0f;
+    params->t_ignition = 10.0f;
+    params->t_max = 900.0f;
+    params->deploy_delay = 0.5f;
+
+    /* ADXL345: 6.2LSB RMS at 3200Hz (see adxl345.c).
+     * MS5611: 0.065mbar resolution at OSR256.
+     */
+    params->accel_noise = 6.2f;
+    params->baro_noise = 6.5f;
+    params->seed = 1;
+
+    params->config.profile.m3fc_position = M3FC_CONFIG_POSITION_CORE;
+    params->config.profile.accel_axis = M3FC_CONFIG_ACCEL_AXIS_Z;
+    params->config.profile.ignition_accel = 25;
+    params->config.profile.burnout_timeout = 75;
+    params->config.profile.apogee_timeout = 35;
+    params->config.profile.main_altitude = 30;
+    params->config.profile.main_timeout = 255;
+    params->config.profile.land_timeout = 60;
+
+    params->config.pyros.pyro6 = M3FC_CONFIG_PYRO_USAGE_DROGUE |
+                                 M3FC_CONFIG_PYRO_CURRENT_3A |
+                                 M3FC_CONFIG_PYRO_TYPE_METRON;
+    params->config.pyros.pyro7 = M3FC_CONFIG_PYRO_USAGE_MAIN |
+                                 M3FC_CONFIG_PYRO_CURRENT_1A |
+                                 M3FC_CONFIG_PYRO_TYPE_METRON;
+
+    params->config.accel_cal.x_scale = 0.0039f;
+    params->config.accel_cal.y_scale = 0.0039f;
+    params->config.accel_cal.z_scale = 0.0039f;
+    params->config.radio_freq = 869600000;
+}
+
+bool sim_load_eng(struct sim_params* params, const char* path)
+{
+    char line[256];
+    bool header = true;
+    FILE* f = fopen(path, "r");
+
+    if(f == NULL) {
+        return false;
+    }
+
+    params->thrust_points = 0;
+    while(fgets(line, sizeof(line), f) != NULL) {
+        float t, thrust;
+
+        /* Skip comments and blank lines */
+        if(line[0] == ';' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+
+        /* The first non-comment line describes the motor. The propellant
+         * mass is the fifth field, in kg.
+         */
+        if(header) {
+            char name[64];
+            float dia, len, prop, total;
+            if(sscanf(line, "%63s %f %f %*s %f %f", name, &dia, &len,
+                      &prop, &total) == 5)
+            {
+                params->prop_mass = prop;
+            }
+            header = false;
+            continue;
+        }
+
+        if(sscanf(line, "%f %f", &t, &thrust) != 2) {
+            continue;
+        }
+
+        if(params->thrust_points == SIM_MAX_THRUST_POINTS) {
+            break;
+        }
+
+        params->thrust_t[params->thrust_points] = t;
+        params->thrust_f[params->thrust_points] = thrust;
+        params->thrust_points++;
+    }
+
+    fclose(f);
+    return params->thrust_points > 0;
+}
+
+/* Only the firmware wrappers send CAN frames; pyro fire commands from a
+ * simulated flight are read straight from its mission controller.
+ */
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)msg_id;
+    (void)can_rtr;
+    (void)data;
+    (void)datalen;
+}
+
+void sim_run(const struct sim_params* params, struct sim_result* result,
+             bool verbose)
+{
+    struct sim_flight flight;
+    uint64_t t_us = 0;
+    uint64_t t_end_us = (uint64_t)(params->t_max * 1e6f);
+    uint64_t next_phys = 0, next_accel = 0, next_baro = 0;
+    uint64_t n_accel_samples = 0;
+    uint64_t next_mission = SIM_MISSION_PERIOD_US;
+    uint64_t t_arm_us = (uint64_t)(params->t_arm * 1e6f);
+    struct m3fc_mission_controller* mc = &flight.mc;
+    state_t cur_state = STATE_INIT;
+    state_t new_state;
+    systime_t now;
+
+    memset(&flight, 0, sizeof(flight));
+    flight.params = params;
+    flight.result = result;
+    flight.on_ground = true;
+    flight.specific_force = sim_g0;
+    flight.total_impulse = sim_total_impulse(params);
+    flight.t_drogue_open = flight.t_main_open = INFINITY;
+    flight.rng = params->seed ? params->seed : 1;
+    flight.baro_since_d2 = SIM_BARO_TEMPERATURE_INTERVAL;
+    flight.baro_osr = MS5611_OSR_256;
+
+    memset(result, 0, sizeof(*result));
+    result->t_liftoff = result->t_burnout = result->t_apogee = -1.0f;
+    result->t_main = result->t_landing = result->h_main = -1.0f;
+    for(int i=0; i<SIM_NUM_STATES; i++) {
+        result->t_state[i] = -1.0f;
+    }
+    result->t_state[STATE_INIT] = 0.0f;
+
+    /* The pyro and power boards report that all is well from power on */
+    m3fc_state_estimator_init(&flight.se, 0);
+    m3fc_mission_controller_init(mc, &params->config);
+    mc->pyro_armed = true;
+    mc->pyro_supply_good = true;
+    mc->pyro_cont_ok = true;
+    mc->psu_battleshort = true;
+
+    while(t_us < t_end_us) {
+        /* Advance to whichever event comes next */
+        t_us = next_phys;
+        if(next_accel < t_us)   t_us = next_accel;
+        if(next_baro < t_us)    t_us = next_baro;
+        if(next_mission < t_us) t_us = next_mission;
+        now = (systime_t)(t_us / 100);
+        flight.t_now = (double)t_us / 1e6;
+
+        if(t_us == next_phys) {
+            sim_physics_step(&flight, SIM_PHYSICS_PERIOD_US / 1e6);
+            next_phys += SIM_PHYSICS_PERIOD_US;
+        }
+
+        if(t_us == next_accel) {
+            sim_sample_accel(&flight);
+            n_accel_samples++;
+            next_accel = n_accel_samples * 1000000 / SIM_ACCEL_ODR_HZ;
+        }
+
+        if(t_us == next_baro) {
+            next_baro += sim_sample_baro(&flight);
+        }
+
+        /* The fusion thread runs whenever a sample is queued and at least
+         * every 10ms, above mission control's priority.
+         */
+        sim_fuse(&flight, now);
+
+        if(t_us == next_mission) {
+            next_mission += SIM_MISSION_PERIOD_US;
+
+            if(t_us >= t_arm_us) {
+                mc->armed = true;
+            }
+
+            state_estimate_t x = {
+                flight.se.x[0], flight.se.x[1], flight.se.x[2]};
+            new_state = m3fc_mission_controller_step(mc, x, now);
+
+            /* Act on the step as the mission thread would */
+            flight.baro_osr = mc->baro_osr;
+            if(mc->fire_usage != M3FC_CONFIG_PYRO_USAGE_NONE) {
+                sim_fire(&flight, mc->fire_usage);
+            }
+
+            if(new_state != cur_state) {
+                if(result->t_state[new_state] < 0.0f) {
+                    result->t_state[new_state] = (float)flight.t_now;
+                }
+                if(new_state == STATE_PAD && cur_state != STATE_INIT) {
+                    result->false_ignitions++;
+                }
+                if(verbose) {
+                    printf("t=%8.3f  %-14s -> %-14s  h=%8.1f v=%7.1f a=%6.1f"
+                           "  (true h=%8.1f v=%7.1f)\n",
+                           flight.t_now, sim_state_names[cur_state],
+                           sim_state_names[new_state], x.h, x.v, x.a,
+                           flight.h, flight.v);
+                }
+                cur_state = new_state;
+            }
+
+            /* Stop once both the mission and the vehicle are on the ground */
+            if(cur_state == STATE_LANDED && result->t_landing >= 0.0f) {
+                break;
+            }
+        }
+    }
+}
+
+/* Apply the samples taken at time `now` to the flight's estimator, as
+ * m3fc_state_estimation_fuse does for the firmware: predict first if it is
+ * due, then the accelerometer, then the barometer, each with the flags
+ * mission control last set.
+ */
+static void sim_fuse(struct sim_flight* f, systime_t now)
+{
+    if((systime_t)(now - f->t_predict) >= SIM_PREDICT_PERIOD) {
+        f->se.dynamic_event_expected = f->mc.dynamic_event_expected;
+        m3fc_state_estimator_predict(&f->se, now);
+        f->t_predict = now;
+    }
+
+    if(f->accel_ready) {
+        f->se.accel_axis = f->params->config.profile.accel_axis;
+        m3fc_state_estimator_update_accels(&f->se, f->accel, 156.96f,
+                                           f->accel_rms);
+        f->accel_ready = false;
+    }
+
+    if(f->baro_ready) {
+        f->se.trust_barometer = f->mc.trust_barometer;
+        m3fc_state_estimator_update_pressure(&f->se, f->pressure,
+                                             f->pressure_rms);
+        f->baro_ready = false;
+    }
+}
+
+/* Mission control fired the pyros for `usage`: open the corresponding
+ * parachute after a short delay.
+ */
+static void sim_fire(struct sim_flight* f, uint8_t usage)
+{
+    uint8_t channels[8];
+    bool any = false;
+
+    /* Nothing happens unless some pyro is configured for this usage */
+    m3fc_mission_pyro_channels(&f->params->config, usage, channels);
+    for(int i=0; i<8; i++) {
+        any |= channels[i] != 0;
+    }
+    if(!any) {
+        return;
+    }
+
+    if(usage == M3FC_CONFIG_PYRO_USAGE_DROGUE && !f->drogue_fired) {
+        f->drogue_fired = true;
+        f->t_drogue_open = f->t_now + f->params->deploy_delay;
+    } else if(usage == M3FC_CONFIG_PYRO_USAGE_MAIN && !f->main_fired) {
+        f->main_fired = true;
+        f->t_main_open = f->t_now + f->params->deploy_delay;
+        f->result->h_main = f->h;
+    }
+}
+
+/* Pressure in Pa at `altitude` metres above sea level. */
+static double sim_pressure_at(double altitude)
+{
+    int b = 0;
+    while(b < 6 && altitude >= sim_Hb[b+1]) {
+        b++;
+    }
+
+    if(sim_Lb[b] == 0.0) {
+        return sim_Pb[b] * exp(-sim_g0 * sim_M * (altitude - sim_Hb[b])
+                               / (sim_Rs * sim_Tb[b]));
+    } else {
+        return sim_Pb[b] * pow(sim_Tb[b] /
+                               (sim_Tb[b] + sim_Lb[b]*(altitude - sim_Hb[b])),
+                               sim_g0 * sim_M / (sim_Rs * sim_Lb[b]));
+    }
+}
+
+/* Thrust in N at `t` seconds after ignition, linearly interpolated. */
+static double sim_thrust_at(const struct sim_params* params, double t)
+{
+    double t0 = 0.0, f0 = 0.0;
+
+    if(t < 0.0) {
+        return 0.0;
+    }
+
+    for(int i=0; i<params->thrust_points; i++) {
+        double t1 = params->thrust_t[i], f1 = params->thrust_f[i];
+        if(t <= t1) {
+            if(t1 == t0) {
+                return f1;
+            }
+            return f0 + (f1 - f0) * (t - t0) / (t1 - t0);
+        }
+        t0 = t1;
+        f0 = f1;
+    }
+
+    return 0.0;
+}
+
+static double sim_total_impulse(const struct sim_params* params)
+{
+    double t0 = 0.0, f0 = 0.0, total = 0.0;
+    for(int i=0; i<params->thrust_points; i++) {
+        total += 0.5 * (f0 + params->thrust_f[i]) * (params->thrust_t[i] - t0);
+        t0 = params->thrust_t[i];
+        f0 = params->thrust_f[i];
+    }
+    return total;
+}
+
+/* Integrate the vehicle's vertical motion over `dt` seconds with a
+ * semi-implicit Euler step.
+ */
+static void sim_physics_step(struct sim_flight* f, double dt)
+{
+    const struct sim_params* params = f->params;
+    struct sim_result* result = f->result;
+    double t = f->t_now;
+    double t_burn = t - params->t_ignition;
+    double thrust = sim_thrust_at(params, t_burn);
+    double mass, rho, cda, drag, a;
+
+    mass = params->dry_mass;
+    if(f->total_impulse > 0.0) {
+        mass += params->prop_mass * (1.0 - f->impulse / f->total_impulse);
+    }
+    f->impulse += thrust * dt;
+
+    if(result->t_burnout < 0.0f && params->thrust_points > 0 &&
+       t_burn >= params->thrust_t[params->thrust_points - 1])
+    {
+        result->t_burnout = (float)t;
+    }
+
+    /* Exponential atmosphere is plenty for drag purposes */
+    rho = 1.225 * exp(-(params->ground_altitude + f->h) / 8500.0);
+
+    cda = params->cd * M_PI * params->diameter * params->diameter / 4.0;
+    if(t >= f->t_drogue_open) {
+        cda += params->drogue_cda;
+    }
+    if(t >= f->t_main_open) {
+        cda += params->main_cda;
+    }
+
+    drag = -0.5 * rho * f->v * fabs(f->v) * cda;
+
+    if(f->on_ground) {
+        /* Sitting on the pad (or the ground after landing) until the motor
+         * can lift us off it.
+         */
+        if(result->t_landing < 0.0f && thrust > mass * sim_g0) {
+            f->on_ground = false;
+            result->t_liftoff = (float)t;
+        } else {
+            f->specific_force = sim_g0;
+            return;
+        }
+    }
+
+    f->specific_force = (thrust + drag) / mass;
+    a = f->specific_force - sim_g0;
+
+    double v_prev = f->v;
+    f->v += a * dt;
+    f->h += f->v * dt;
+
+    if(result->t_apogee < 0.0f && v_prev > 0.0 && f->v <= 0.0) {
+        result->t_apogee = (float)t;
+        result->h_apogee = (float)f->h;
+    }
+
+    if(result->t_apogee >= 0.0f && result->t_main < 0.0f &&
+       f->h < params->config.profile.main_altitude)
+    {
+        result->t_main = (float)t;
+    }
+
+    if(f->h <= 0.0 && f->v < 0.0) {
+        f->h = 0.0;
+        f->v = 0.0;
+        f->on_ground = true;
+        f->specific_force = sim_g0;
+        result->t_landing = (float)t;
+    }
+}
+
+/* Generate one ADXL345 sample along the configured up axis, quantised and
+ * clipped like the real part in full resolution ±16g mode, and add it to the
+ * FIFO. At the watermark, submit the batch average as adxl345_thd does,
+ * unless any sample in it was clipped.
+ */
+static void sim_sample_accel(struct sim_flight* f)
+{
+    const struct m3fc_config* cfg = &f->params->config;
+    const float g = 9.80665f;
+    float up = (float)(f->specific_force / sim_g0) / cfg->accel_cal.z_scale;
+
+    for(int i=0; i<3; i++) {
+        float lsb = (i == 2 ? up : 0.0f) + f->params->accel_bias +
+                    f->params->accel_noise * sim_gaussian(&f->rng);
+        lsb = roundf(lsb);
+        if(lsb >= 4095.0f || lsb <= -4096.0f) {
+            lsb = lsb > 0.0f ? 4095.0f : -4096.0f;
+            f->fifo_saturated = true;
+        }
+        f->fifo_sums[i] += (int32_t)lsb;
+    }
+
+    if(++f->fifo_n < SIM_ACCEL_WATERMARK) {
+        return;
+    }
+
+    int n = f->fifo_n;
+    int16_t accels[3] = {
+        f->fifo_sums[0] / n, f->fifo_sums[1] / n, f->fifo_sums[2] / n,
+    };
+    bool saturated = f->fifo_saturated;
+    f->fifo_sums[0] = f->fifo_sums[1] = f->fifo_sums[2] = 0;
+    f->fifo_n = 0;
+    f->fifo_saturated = false;
+
+    if(sim_uniform(&f->rng) < f->params->dropout || saturated) {
+        return;
+    }
+
+    f->accel[0] = ((float)accels[0] - cfg->accel_cal.x_offset)
+                  * cfg->accel_cal.x_scale * g;
+    f->accel[1] = ((float)accels[1] - cfg->accel_cal.y_offset)
+                  * cfg->accel_cal.y_scale * g;
+    f->accel[2] = ((float)accels[2] - cfg->accel_cal.z_offset)
+                  * cfg->accel_cal.z_scale * g;
+    f->accel_rms = 0.2385f / sqrtf((float)n);
+    f->accel_ready = true;
+    f->result->n_accel++;
+}
+
+/* Complete one MS5611 conversion. Pressure conversions are submitted as
+ * ms5611_thd does; every so often a temperature conversion takes a slot
+ * instead. Returns the time in microseconds until the next conversion
+ * completes, at the currently selected OSR.
+ */
+static uint64_t sim_sample_baro(struct sim_flight* f)
+{
+    uint64_t conversion = (sim_baro_conversion_us[f->baro_osr] + 99) / 100;
+    conversion = (conversion + 1) * 100;
+
+    if(f->baro_since_d2 >= SIM_BARO_TEMPERATURE_INTERVAL) {
+        f->baro_since_d2 = 0;
+        return conversion;
+    }
+    f->baro_since_d2++;
+
+    double altitude = f->params->ground_altitude + f->h;
+    float noise = f->params->baro_noise * sim_baro_noise_scale[f->baro_osr]
+                  * sim_gaussian(&f->rng);
+    int32_t pressure = (int32_t)lround(sim_pressure_at(altitude) + noise +
+                                       f->params->baro_bias);
+
+    if(sim_uniform(&f->rng) < f->params->dropout) {
+        return conversion;
+    }
+
+    if(pressure > 1000 && pressure < 120000) {
+        f->pressure = (float)pressure;
+        f->pressure_rms = sim_baro_rms[f->baro_osr];
+        f->baro_ready = true;
+        f->result->n_baro++;
+    }
+
+    return conversion;
+}
+
+/* Each flight reads the barometer OSR from its own mission controller, and
+ * has no use for a full rate capture after the flight.
+ */
+void ms5611_set_osr(ms5611_osr_t osr)
+{
+    (void)osr;
+}
+
+void adxl345_burst_trigger(void)
+{
+}
+
+void adxl345_burst_send(void)
+{
+}
+
+/* Standard normal deviate from a xorshift32 generator via Box-Muller.
+ * Kept local rather than using rand() so each flight is reproducible
+ * from its seed alone.
+ */
+static float sim_gaussian(uint32_t* rng)
+{
+    float u1, u2;
+    uint32_t s = *rng;
+
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    u1 = ((s >> 8) + 1.0f) / 16777217.0f;
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    u2 = (s >> 8) / 16777216.0f;
+
+    *rng = s;
+    return sqrtf(-2.0f * logf(u1)) * cosf(2.0f * (float)M_PI * u2);
+}
+
+/* Uniform deviate in [0, 1) from the same generator. */
+static float sim_uniform(uint32_t* rng)
+{
+    uint32_t s = *rng;
+    s ^= s << 13; s ^= s >> 17; s ^= s << 5;
+    *rng = s;
+    return (s >> 8) / 16777216.0f;
+}
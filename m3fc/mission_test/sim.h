@@ -0,0 +1,132 @@
+/*
+ * Software-in-the-loop flight simulator
+ * M3FC
+ * Cambridge University Spaceflight
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "m3fc_config.h"
+
+/* Must match NUM_STATES in m3fc_mission.h, checked in sim.c */
+#define SIM_NUM_STATES          (12)
+
+#define SIM_MAX_THRUST_POINTS   (64)
+
+/* The ADXL345 samples at 3200Hz into its FIFO and the driver submits the
+ * average of each batch of 16 samples to state estimation.
+ */
+#define SIM_ACCEL_ODR_HZ        (3200)
+#define SIM_ACCEL_WATERMARK     (16)
+
+/* The MS5611 converts pressure back to back, with a temperature conversion
+ * every 16 pressure conversions. Each conversion takes the datasheet
+ * maximum for the OSR mission control has selected, rounded up to a
+ * system tick, plus a tick of thread and SPI latency.
+ */
+#define SIM_BARO_TEMPERATURE_INTERVAL (16)
+
+/* Sample periods in microseconds */
+#define SIM_MISSION_PERIOD_US   (10000)
+#define SIM_PHYSICS_PERIOD_US   (1000)
+
+struct sim_params {
+    /* Airframe: masses in kg, diameter in m, parachute Cd*A in m² */
+    float dry_mass;
+    float prop_mass;
+    float cd;
+    float diameter;
+    float drogue_cda;
+    float main_cda;
+
+    /* Thrust curve, time since ignition in s against thrust in N */
+    int thrust_points;
+    float thrust_t[SIM_MAX_THRUST_POINTS];
+    float thrust_f[SIM_MAX_THRUST_POINTS];
+
+    /* Launch site altitude above sea level in m */
+    float ground_altitude;
+
+    /* Times in s since power on of the ARM command, motor ignition,
+     * and the point at which we give up on the flight.
+     */
+    float t_arm;
+    float t_ignition;
+    float t_max;
+
+    /* Time in s between a pyro fire command and the parachute opening */
+    float deploy_delay;
+
+    /* Sensor noise: accelerometer in LSB RMS, barometer in Pa RMS at OSR256
+     * (scaled down by the datasheet figures at higher OSRs)
+     */
+    float accel_noise;
+    float baro_noise;
+
+    /* Constant sensor bias: accelerometer in LSB, barometer in Pa */
+    float accel_bias;
+    float baro_bias;
+
+    /* Probability that any one sensor sample is lost */
+    float dropout;
+
+    /* PRNG seed for sensor noise */
+    uint32_t seed;
+
+    /* Flight computer configuration under test */
+    struct m3fc_config config;
+};
+
+struct sim_result {
+    /* True events, in s since power on, or -1 if they never happened.
+     * t_main is when the vehicle descends through the configured main
+     * deployment altitude.
+     */
+    float t_liftoff;
+    float t_burnout;
+    float t_apogee;
+    float t_main;
+    float t_landing;
+    float h_apogee;
+
+    /* First time each mission state was entered, or -1 if never */
+    float t_state[SIM_NUM_STATES];
+
+    /* Altitude above ground when the main fire command was sent */
+    float h_main;
+
+    /* Number of times the mission went back to pad after ignition */
+    int false_ignitions;
+
+    /* Number of accelerometer batches and barometer samples fed to
+     * state estimation */
+    uint32_t n_accel;
+    uint32_t n_baro;
+};
+
+/* Mission state names, indexed by state number */
+extern const char* sim_state_names[SIM_NUM_STATES];
+
+/* Fill `params` with a nominal single-stage flight and the core
+ * configuration from m3fc/config/core.yaml.
+ */
+void sim_default_params(struct sim_params* params);
+
+/* Load a thrust curve in RASP .eng format into `params`.
+ * Returns false if the file can't be read or has no data points.
+ */
+bool sim_load_eng(struct sim_params* params, const char* path);
+
+/* Simulate a whole flight, feeding synthetic sensor data through the real
+ * state estimation and mission control code.
+ * If `verbose` is set, each state change is printed as it happens.
+ * Flights share no state, so any number may run at once on different
+ * threads.
+ */
+void sim_run(const struct sim_params* params, struct sim_result* result,
+             bool verbose);
+
+#endif
@@ -0,0 +1,116 @@
+/*
+ * Software-in-the-loop flight simulator command line
+ * M3FC
+ * Cambridge University Spaceflight
+ *
+ * Runs one simulated flight against the flight code and reports detection
+ * latencies for each phase. Exits non-zero if the mission did not complete
+ * a nominal sequence, so it can be used as a pre-flight check of a config.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+/* Mission state numbers used in the summary, see m3fc_mission.c */
+#define SIM_STATE_IGNITION          (2)
+#define SIM_STATE_BURNOUT           (4)
+#define SIM_STATE_APOGEE            (6)
+#define SIM_STATE_RELEASE_MAIN      (8)
+#define SIM_STATE_LANDED            (11)
+
+static void usage(const char* name)
+{
+    printf("Usage: %s [-e motor.eng] [-s seed] [-m dry mass kg] [-q]\n", name);
+}
+
+static void print_latency(const char* name, float t_true, float t_detect)
+{
+    if(t_detect < 0.0f) {
+        printf("  %-10s true t=%8.3fs  NOT DETECTED\n", name, t_true);
+    } else if(t_true < 0.0f) {
+        printf("  %-10s detected t=%8.3fs  (no true event)\n", name, t_detect);
+    } else {
+        printf("  %-10s true t=%8.3fs  detected t=%8.3fs  latency %+7.3fs\n",
+               name, t_true, t_detect, t_detect - t_true);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    struct sim_params params;
+    struct sim_result result;
+    bool verbose = true;
+    bool ok = true;
+    int opt;
+
+    sim_default_params(&params);
+
+    while((opt = getopt(argc, argv, "e:s:m:qh")) != -1) {
+        switch(opt) {
+        case 'e':
+            if(!sim_load_eng(&params, optarg)) {
+                printf("Could not read thrust curve from %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 's':
+            params.seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            params.dry_mass = strtof(optarg, NULL);
+            break;
+        case 'q':
+            verbose = false;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    sim_run(&params, &result, verbose);
+
+    printf("\nFlight summary (seed %u):\n", params.seed);
+    printf("  apogee %.1fm at t=%.3fs, main fired at %.1fm\n",
+           result.h_apogee, result.t_apogee, result.h_main);
+    print_latency("ignition", result.t_liftoff,
+                  result.t_state[SIM_STATE_IGNITION]);
+    print_latency("burnout", result.t_burnout,
+                  result.t_state[SIM_STATE_BURNOUT]);
+    print_latency("apogee", result.t_apogee,
+                  result.t_state[SIM_STATE_APOGEE]);
+    print_latency("main", result.t_main,
+                  result.t_state[SIM_STATE_RELEASE_MAIN]);
+    print_latency("landed", result.t_landing,
+                  result.t_state[SIM_STATE_LANDED]);
+    printf("  %u accel and %u baro samples, %d false ignitions\n",
+           result.n_accel, result.n_baro, result.false_ignitions);
+
+    if(result.false_ignitions > 0) {
+        ok = false;
+    }
+    for(int i=SIM_STATE_IGNITION; i<SIM_NUM_STATES; i++) {
+        if(result.t_state[i] < 0.0f) {
+            printf("  state %s never reached\n", sim_state_names[i]);
+            ok = false;
+        }
+    }
+    if(result.t_state[SIM_STATE_LANDED] >= 0.0f &&
+       result.t_state[SIM_STATE_LANDED] < result.t_landing)
+    {
+        printf("  warning: landing detected before touchdown\n");
+    }
+    if(result.t_state[SIM_STATE_APOGEE] >= 0.0f &&
+       result.t_state[SIM_STATE_APOGEE] < result.t_burnout)
+    {
+        printf("  apogee detected before motor burnout\n");
+        ok = false;
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
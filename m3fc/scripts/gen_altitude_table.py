@@ -0,0 +1,145 @@
+"""
+Generate m3fc_altitude_table.h, the pressure to altitude lookup table used by
+m3fc_altitude.c.
+
+The table is indexed directly by the bits of an IEEE754 single: the exponent
+and the top MANTISSA_BITS of the mantissa select a segment, and the remaining
+mantissa bits give the position t in [0, 1) across it. Each segment stores the
+coefficients of a cubic in t, the Hermite interpolant of the exact US Standard
+Atmosphere 1976 altitude and its derivative at both ends of the segment.
+
+Usage: python3 gen_altitude_table.py [output.h]
+"""
+
+import sys
+import math
+
+# Constants from the US Standard Atmosphere 1976
+Rs = 8.31432
+g0 = 9.80665
+M = 0.0289644
+Lb = [-0.0065, 0.0, 0.001, 0.0028, 0.0, -0.0028, -0.002]
+Tb = [288.15, 216.65, 216.65, 228.65, 270.65, 270.65, 214.65]
+Hb = [0.0, 11000.0, 20000.0, 32000.0, 47000.0, 51000.0, 71000.0]
+
+
+def base_pressures():
+    """Pressure at the base of each band, carried up from sea level.
+    The rounded values usually tabulated leave steps of up to 5m in
+    altitude at the band edges."""
+    pb = [101325.0]
+    for b in range(6):
+        dh = Hb[b + 1] - Hb[b]
+        if Lb[b] == 0.0:
+            p = pb[b] * math.exp(-g0 * M * dh / (Rs * Tb[b]))
+        else:
+            p = pb[b] * (Tb[b] / (Tb[b] + Lb[b] * dh)) ** (g0 * M / (Rs * Lb[b]))
+        pb.append(p)
+    return pb
+
+
+Pb = base_pressures()
+
+# Table covers [2^MIN_EXP, 2^(MAX_EXP+1)) Pa, i.e. 1 Pa to 131072 Pa.
+MIN_EXP = 0
+MAX_EXP = 16
+MANTISSA_BITS = 4
+
+
+def band(p):
+    """Atmosphere band for pressure p. Pressures above Pb[0] extrapolate the
+    first band into the ground, and pressures below Pb[6] continue the last
+    band, which the standard defines up to 84852m (0.37Pa)."""
+    for b in range(6, 0, -1):
+        if p <= Pb[b]:
+            return b
+    return 0
+
+
+def altitude(p):
+    """Altitude in m and its derivative dh/dp in m/Pa at pressure p."""
+    b = band(p)
+    if Lb[b] == 0.0:
+        k = Rs * Tb[b] / (g0 * M)
+        return Hb[b] - k * math.log(p / Pb[b]), -k / p
+    e = (-Rs * Lb[b]) / (g0 * M)
+    r = (p / Pb[b]) ** e
+    return Hb[b] + Tb[b] / Lb[b] * (r - 1.0), Tb[b] / Lb[b] * e * r / p
+
+
+def segment(p0, p1):
+    """Cubic h(t) = c0 + c1 t + c2 t^2 + c3 t^3 over t in [0, 1)."""
+    w = p1 - p0
+    h0, d0 = altitude(p0)
+    h1, d1 = altitude(p1)
+    d0 *= w
+    d1 *= w
+    return (h0, d0,
+            3.0 * (h1 - h0) - 2.0 * d0 - d1,
+            2.0 * (h0 - h1) + d0 + d1)
+
+
+def segments():
+    segs = []
+    for exp in range(MIN_EXP, MAX_EXP + 1):
+        n = 1 << MANTISSA_BITS
+        for m in range(n):
+            p0 = math.ldexp(1.0 + m / n, exp)
+            p1 = math.ldexp(1.0 + (m + 1) / n, exp)
+            segs.append(segment(p0, p1))
+    return segs
+
+
+def max_error(segs, steps=64):
+    """Largest difference between the cubics and the exact altitude."""
+    worst = 0.0
+    n = 1 << MANTISSA_BITS
+    for i, c in enumerate(segs):
+        exp = MIN_EXP + i // n
+        m = i % n
+        p0 = math.ldexp(1.0 + m / n, exp)
+        w = math.ldexp(1.0 / n, exp)
+        for s in range(steps):
+            t = s / steps
+            h = c[0] + t * (c[1] + t * (c[2] + t * c[3]))
+            worst = max(worst, abs(h - altitude(p0 + t * w)[0]))
+    return worst
+
+
+def main():
+    out = sys.argv[1] if len(sys.argv) > 1 else "m3fc_altitude_table.h"
+    segs = segments()
+    err = max_error(segs)
+
+    with open(out, "w") as f:
+        f.write("/*\n")
+        f.write("    Generated by gen_altitude_table.py, do not edit.\n\n")
+        f.write("    US Standard Atmosphere 1976 altitude against pressure,"
+                " as cubics in t\n")
+        f.write("    over {} segments from {} Pa to {} Pa.\n"
+                .format(len(segs), 2**MIN_EXP, 2**(MAX_EXP + 1)))
+        f.write("    Interpolation error before rounding to float:"
+                " {:.2e} m.\n".format(err))
+        f.write("*/\n\n")
+        f.write("#ifndef M3FC_ALTITUDE_TABLE_H\n")
+        f.write("#define M3FC_ALTITUDE_TABLE_H\n\n")
+        f.write("#define M3FC_ALTITUDE_TABLE_MIN_EXP       ({})\n"
+                .format(MIN_EXP))
+        f.write("#define M3FC_ALTITUDE_TABLE_MANTISSA_BITS ({})\n"
+                .format(MANTISSA_BITS))
+        f.write("#define M3FC_ALTITUDE_TABLE_SIZE          ({})\n\n"
+                .format(len(segs)))
+        f.write("static const float m3fc_altitude_table"
+                "[M3FC_ALTITUDE_TABLE_SIZE][4] = {\n")
+        for c in segs:
+            f.write("    {{{}}},\n".format(
+                ", ".join("{:.9e}f".format(x) for x in c)))
+        f.write("};\n\n")
+        f.write("#endif\n")
+
+    print("Wrote {} segments to {}, max interpolation error {:.2e} m"
+          .format(len(segs), out, err))
+
+
+if __name__ == "__main__":
+    main()
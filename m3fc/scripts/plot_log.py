@@ -1,18 +1,25 @@
+import os
 import sys
 import math
 import struct
 import numpy as np
 import matplotlib.pyplot as plt
 
-SID_M3FC_MISSION_STATE = (32 << 5) | 1
-SID_M3FC_ACCEL = (48 << 5) | 1
-SID_M3FC_BARO = (49 << 5) | 1
-SID_M3FC_SE_T_H = (50 << 5) | 1
-SID_M3FC_SE_V_A = (51 << 5) | 1
-SID_M3FC_SE_VAR_H = (52 << 5) | 1
-SID_M3FC_SE_VAR_V_A = (53 << 5) | 1
-SID_M3PYRO_SUPPLY = (49 << 5) | 3
-SID_M3RADIO_GPS_ALT = (49 << 5) | 4
+# CAN IDs generated from shared/m3can/messages.yaml
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "..", "..", "gcs", "m3gcs"))
+from m3can_msgs import (                                        # noqa: E402
+    CAN_MSG_ID_M3FC_MISSION_STATE as SID_M3FC_MISSION_STATE,
+    CAN_MSG_ID_M3FC_ACCEL as SID_M3FC_ACCEL,
+    CAN_MSG_ID_M3FC_BARO as SID_M3FC_BARO,
+    CAN_MSG_ID_M3FC_SE_T_H as SID_M3FC_SE_T_H,
+    CAN_MSG_ID_M3FC_SE_V_A as SID_M3FC_SE_V_A,
+    CAN_MSG_ID_M3FC_SE_VAR_H as SID_M3FC_SE_VAR_H,
+    CAN_MSG_ID_M3FC_SE_VAR_V_A as SID_M3FC_SE_VAR_V_A,
+    CAN_MSG_ID_M3PYRO_SUPPLY_STATUS as SID_M3PYRO_SUPPLY,
+    CAN_MSG_ID_M3RADIO_GPS_ALT as SID_M3RADIO_GPS_ALT,
+)
+from logformat import read_frames                               # noqa: E402
 
 accel_times = []
 accel_vals = []
@@ -79,60 +86,70 @@ def p2a_nzl(p, b):
     return hb + tb/lb * (math.pow(p/pb, (-Rs*lb)/(g0*M)) - 1)
 
 
+if len(sys.argv) not in (2, 4):
+    print("Usage: {} <logfile.bin> [start s end s]".format(sys.argv[0]))
+    sys.exit(1)
+
+# Only the frames plotted, and with a start and end only that window of
+# the flight, which logs with an index read just the blocks of
+start = end = None
+if len(sys.argv) == 4:
+    start = round(float(sys.argv[2]) * 1e4)
+    end = round(float(sys.argv[3]) * 1e4)
+ids = {SID_M3FC_MISSION_STATE, SID_M3FC_ACCEL, SID_M3FC_BARO,
+       SID_M3FC_SE_V_A, SID_M3FC_SE_T_H, SID_M3FC_SE_VAR_H,
+       SID_M3FC_SE_VAR_V_A, SID_M3PYRO_SUPPLY, SID_M3RADIO_GPS_ALT}
+
 prev_state = 0
-with open(sys.argv[1], "rb") as f:
-    packet = f.read(16)
-    while packet:
-        sid, rtr, dlc, data, ts = struct.unpack("<HBB8sI", packet)
-        ts /= 1e4
-        if sid == SID_M3FC_MISSION_STATE:
-            _, state = struct.unpack("<IB", data[:5])
-            if state != prev_state:
-                state_times.append(ts)
-                state_vals.append(state)
-                prev_state = state
-        elif sid == SID_M3FC_ACCEL:
-            _, _, z = struct.unpack("<hhh", data[:6])
-            accel_times.append(ts)
-            if ts < 385:
-                accel_vals.append(z*3.9e-3*9.81 - 9.81)
-            else:
-                accel_vals.append(z*3.9e-3*9.81 + 9.81)
-        elif sid == SID_M3FC_BARO:
-            _, pressure = struct.unpack("<ii", data)
-            pressure_times.append(ts)
-            pressure_vals.append(pressure)
-            baro_alt_times.append(ts)
-            baro_alt_vals.append(p2a(pressure))
-        elif sid == SID_M3FC_SE_V_A:
-            se_v, se_a = struct.unpack("<ff", data)
-            se_a_times.append(ts)
-            se_a_vals.append(se_a)
-            se_v_times.append(ts)
-            se_v_vals.append(se_v)
-        elif sid == SID_M3FC_SE_T_H:
-            _, se_h = struct.unpack("<ff", data)
-            se_h_times.append(ts)
-            se_h_vals.append(se_h)
-        elif sid == SID_M3FC_SE_VAR_H:
-            se_var_h = struct.unpack("<f", data[:4])
-            se_var_h_times.append(ts)
-            se_var_h_vals.append(se_h)
-        elif sid == SID_M3FC_SE_VAR_V_A:
-            se_var_v, se_var_a = struct.unpack("<ff", data)
-            se_var_v_times.append(ts)
-            se_var_v_vals.append(se_var_v)
-            se_var_a_times.append(ts)
-            se_var_a_vals.append(se_var_a)
-        elif sid == SID_M3PYRO_SUPPLY:
-            supply = struct.unpack("<B", data[:1])
-            supply_times.append(ts)
-            supply_vals.append(supply)
-        elif sid == SID_M3RADIO_GPS_ALT:
-            _, gps_alt = struct.unpack("<ii", data)
-            gps_alt_times.append(ts)
-            gps_alt_vals.append(gps_alt/1e3)
-        packet = f.read(16)
+for sid, rtr, dlc, data, ts in read_frames(sys.argv[1], start, end, ids):
+    ts /= 1e4
+    if sid == SID_M3FC_MISSION_STATE:
+        _, state = struct.unpack("<IB", data[:5])
+        if state != prev_state:
+            state_times.append(ts)
+            state_vals.append(state)
+            prev_state = state
+    elif sid == SID_M3FC_ACCEL:
+        _, _, z = struct.unpack("<hhh", data[:6])
+        accel_times.append(ts)
+        if ts < 385:
+            accel_vals.append(z*3.9e-3*9.81 - 9.81)
+        else:
+            accel_vals.append(z*3.9e-3*9.81 + 9.81)
+    elif sid == SID_M3FC_BARO:
+        _, pressure = struct.unpack("<ii", data)
+        pressure_times.append(ts)
+        pressure_vals.append(pressure)
+        baro_alt_times.append(ts)
+        baro_alt_vals.append(p2a(pressure))
+    elif sid == SID_M3FC_SE_V_A:
+        se_v, se_a = struct.unpack("<ff", data)
+        se_a_times.append(ts)
+        se_a_vals.append(se_a)
+        se_v_times.append(ts)
+        se_v_vals.append(se_v)
+    elif sid == SID_M3FC_SE_T_H:
+        _, se_h = struct.unpack("<ff", data)
+        se_h_times.append(ts)
+        se_h_vals.append(se_h)
+    elif sid == SID_M3FC_SE_VAR_H:
+        se_var_h = struct.unpack("<f", data[:4])
+        se_var_h_times.append(ts)
+        se_var_h_vals.append(se_h)
+    elif sid == SID_M3FC_SE_VAR_V_A:
+        se_var_v, se_var_a = struct.unpack("<ff", data)
+        se_var_v_times.append(ts)
+        se_var_v_vals.append(se_var_v)
+        se_var_a_times.append(ts)
+        se_var_a_vals.append(se_var_a)
+    elif sid == SID_M3PYRO_SUPPLY:
+        supply = struct.unpack("<B", data[:1])
+        supply_times.append(ts)
+        supply_vals.append(supply)
+    elif sid == SID_M3RADIO_GPS_ALT:
+        _, gps_alt = struct.unpack("<ii", data)
+        gps_alt_times.append(ts)
+        gps_alt_vals.append(gps_alt/1e3)
 
 n_accels = len(accel_vals)
 t_accels = accel_times[-1] - accel_times[0]
@@ -0,0 +1,32 @@
+/*
+ * Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+ * M3PSU receive handlers, indexed by CAN ID for m3can_dispatch().
+ */
+
+#include "m3can.h"
+
+void m3psu_can_handle_toggle_battleshort(uint8_t* data, uint8_t datalen);
+void m3psu_can_handle_toggle_channel(uint8_t* data, uint8_t datalen);
+void m3psu_can_handle_toggle_charger(uint8_t* data, uint8_t datalen);
+void m3psu_can_handle_toggle_lowpower(uint8_t* data, uint8_t datalen);
+void m3psu_can_handle_toggle_pyros(uint8_t* data, uint8_t datalen);
+
+static const struct m3can_handler m3psu_can_handlers[] = {
+    {CAN_MSG_ID_M3PSU_TOGGLE_PYROS, 1, 1, m3psu_can_handle_toggle_pyros},
+    {CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL, 2, 2, m3psu_can_handle_toggle_channel},
+    {CAN_MSG_ID_M3PSU_TOGGLE_CHARGER, 1, 1, m3psu_can_handle_toggle_charger},
+    {CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER, 1, 1, m3psu_can_handle_toggle_lowpower},
+    {CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT, 1, 1, m3psu_can_handle_toggle_battleshort},
+};
+
+static const uint8_t m3psu_can_index[M3CAN_DISPATCH_SLOTS] = {
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_TOGGLE_PYROS)] = 1,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL)] = 2,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_TOGGLE_CHARGER)] = 3,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER)] = 4,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT)] = 5,
+};
+
+const struct m3can_dispatch_table m3psu_can_dispatch = {
+    m3psu_can_index, m3psu_can_handlers,
+};
@@ -26,21 +26,84 @@
 #define M3STATUS_PYRO_MON_ERROR_INIT  (1)
 #define M3STATUS_PYRO_MON_ERROR_COMMS (2)
 
+/* Components and error codes shared by all boards, see
+ * shared/m3status/m3status.h.
+ */
+#define M3STATUS_COMPONENT_CAN              (255)
+
+#define M3STATUS_ERROR_CAN_TX_OVERFLOW      (255)
+#define M3STATUS_ERROR_CAN_TX_DROPPED       (254)
+#define M3STATUS_ERROR_CAN_BAD_LENGTH       (253)
+
+/* Number of shared components, counting down from 255 */
+#define M3STATUS_NUM_SHARED         (1)
+
+/* Highest board specific component number. Each board sets its own in its
+ * Makefile, so status is only stored for the components it has. Others
+ * are ignored.
+ */
+#ifndef M3STATUS_MAX_COMPONENT
+#define M3STATUS_MAX_COMPONENT      (15)
+#endif
+
+/* Component states packed into each batch status frame, 2 bits each */
+#define M3STATUS_BATCH_COMPONENTS   (24)
+#define M3STATUS_BATCH_UNUSED       (3)
+
+#if M3STATUS_MAX_COMPONENT >= 256 - M3STATUS_BATCH_COMPONENTS
+#error "M3STATUS_MAX_COMPONENT overlaps the shared components"
+#endif
+
+/* How often m3can sends the status digest. A status packet whose only
+ * change is its detail bytes is sent at most once in each period.
+ */
+#define M3STATUS_DIGEST_PERIOD_MS   (1000)
+
 /* Call to update status, with optional error code.
  * Call initialising() for each component to start including that component ID
  * and to send an initialising status message for it.
  * Call ok() on components once they finish initialising successfully.
  * Call error() on components whenever an error occurs, with an optional error
  * code to give more details.
- * On each call, if that component's status has changed or if it has been too
- * long since we last transmitted this component's status, a new CAN status
- * packet is sent out with this update and the overall status summary.
+ * A CAN status packet with this update and the overall status summary is
+ * sent when the component's state or error code changes. Repeated calls
+ * with the same status send nothing more; the periodic digest shows the
+ * board is still alive, and a remote frame for our status ID replays every
+ * component's latest status.
  */
 void m3status_set_init(uint8_t component);
 void m3status_set_ok(uint8_t component);
 void m3status_set_error(uint8_t component, uint8_t errorcode);
 
-/* Get the current board's overall status */
+/* As m3status_set_error(), but with up to 4 bytes of extra detail (such as
+ * an error count) appended to the status packet.
+ */
+void m3status_set_error_data(uint8_t component, uint8_t errorcode,
+                             const uint8_t* data, uint8_t datalen);
+
+/* Send the status digest: the overall status, how many components have
+ * reported, how many are initialising and in error, and a count of
+ * changes so receivers can tell when they have missed a status packet.
+ * Any detail held back since the last digest is sent first.
+ * Called by m3can every M3STATUS_DIGEST_PERIOD_MS.
+ */
+void m3status_send_digest(void);
+
+/* Send the state of every component in batch status frames. Each covers
+ * M3STATUS_BATCH_COMPONENTS components from the one in its `first` byte,
+ * two bits each, with M3STATUS_BATCH_UNUSED for those not reporting.
+ */
+void m3status_send_batch(void);
+
+/* Answer a remote frame for our status (a batch, then a status packet for
+ * each component in error with its error code and detail) or digest.
+ * Called by m3can for every remote frame received.
+ */
+void m3status_handle_rtr(uint16_t msg_id);
+
+/* Get the current board's overall status, from running counts of
+ * components in each state.
+ */
 uint8_t m3status_get(void);
 
 /* Get an individual component's current status */
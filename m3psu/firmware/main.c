@@ -25,6 +25,8 @@
 #include "lowpower.h"
 #include "smbus.h"
 #include "m3can.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
 
 static THD_WORKING_AREA(waPowerManager, 1024);
 static THD_WORKING_AREA(waChargeController, 1024);
@@ -32,58 +34,65 @@ static THD_WORKING_AREA(waChargeController, 1024);
 static THD_WORKING_AREA(waPowerCheck, 512);
 static THD_WORKING_AREA(waAwakeTime, 128);
 
-void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen){
-  (void)rtr;
+/* Generated from shared/m3can/messages.yaml into m3psu_can_handlers.c */
+extern const struct m3can_dispatch_table m3psu_can_dispatch;
 
-  if(msg_id == CAN_MSG_ID_M3PSU_TOGGLE_PYROS){
-    if(datalen >= 1){
-      if(data[0] == 0){
-        PowerManager_disable_pyros();
-      }else if(data[0] == 1){
-        PowerManager_enable_pyros();
-      }
-    }
-  }else if(msg_id == CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL){
-    if(datalen >= 2){
-      if(data[0] == 1){
-        PowerManager_switch_on(data[1]);
-      }else if(data[0] == 0){
-        if(data[1] == POWER_CHANNEL_3V3_RADIO ||
-            data[1] == POWER_CHANNEL_5V_RADIO ||
-            data[1] == POWER_CHANNEL_5V_CAN){
-          // Ignore turning off the radio or CAN!
-        }else{
-          PowerManager_switch_off(data[1]);
-        }
-      }
-    }
-  }else if(msg_id == CAN_MSG_ID_M3PSU_TOGGLE_CHARGER){
-    if(datalen >= 1){
-      if(data[0] == 1){
-        ChargeController_enable_charger();
-      }else if(data[0] == 0){
-        ChargeController_disable_charger();
-      }
-    }
-  }else if(msg_id == CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER){
-    if(datalen >= 1){
-      if(data[0] == 1){
-        lowpower_enable();
-      }else if(data[0] == 0){
-        lowpower_disable();
-      }
-    }
-  }else if(msg_id == CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT){
-    if(datalen >= 1){
-      if(data[0] == 1){
-        ChargeController_enable_battleshort();
-      }else if(data[0] == 0){
-        ChargeController_disable_battleshort();
-      }
+void m3psu_can_handle_toggle_pyros(uint8_t *data, uint8_t datalen){
+  (void)datalen;
+  if(data[0] == 0){
+    PowerManager_disable_pyros();
+  }else if(data[0] == 1){
+    PowerManager_enable_pyros();
+  }
+}
+
+void m3psu_can_handle_toggle_channel(uint8_t *data, uint8_t datalen){
+  (void)datalen;
+  if(data[0] == 1){
+    PowerManager_switch_on(data[1]);
+  }else if(data[0] == 0){
+    if(data[1] == POWER_CHANNEL_3V3_RADIO ||
+        data[1] == POWER_CHANNEL_5V_RADIO ||
+        data[1] == POWER_CHANNEL_5V_CAN){
+      // Ignore turning off the radio or CAN!
+    }else{
+      PowerManager_switch_off(data[1]);
     }
   }
 }
 
+void m3psu_can_handle_toggle_charger(uint8_t *data, uint8_t datalen){
+  (void)datalen;
+  if(data[0] == 1){
+    ChargeController_enable_charger();
+  }else if(data[0] == 0){
+    ChargeController_disable_charger();
+  }
+}
+
+void m3psu_can_handle_toggle_lowpower(uint8_t *data, uint8_t datalen){
+  (void)datalen;
+  if(data[0] == 1){
+    lowpower_enable();
+  }else if(data[0] == 0){
+    lowpower_disable();
+  }
+}
+
+void m3psu_can_handle_toggle_battleshort(uint8_t *data, uint8_t datalen){
+  (void)datalen;
+  if(data[0] == 1){
+    ChargeController_enable_battleshort();
+  }else if(data[0] == 0){
+    ChargeController_disable_battleshort();
+  }
+}
+
+void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen){
+  (void)rtr;
+  m3can_dispatch(&m3psu_can_dispatch, msg_id, data, datalen);
+}
+
 THD_FUNCTION(awake_time_thread, arg){
   (void)arg;
   while(true){
@@ -117,8 +126,10 @@ int main(void) {
 
   smbus_init(&I2C_DRIVER);
 
-  uint16_t listen_to_ids[] = { CAN_ID_M3PSU };
-  m3can_init(CAN_ID_M3PSU, listen_to_ids, 1);
+  static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3PSU;
+  m3can_init(CAN_ID_M3PSU, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+  m3monitor_init();
+  m3can_stats_init();
 
   PowerManager_init();
   ChargeController_init();
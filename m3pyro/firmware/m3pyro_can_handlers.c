@@ -0,0 +1,23 @@
+/*
+ * Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+ * M3PYRO receive handlers, indexed by CAN ID for m3can_dispatch().
+ */
+
+#include "m3can.h"
+
+void m3pyro_can_handle_arm(uint8_t* data, uint8_t datalen);
+void m3pyro_can_handle_fire(uint8_t* data, uint8_t datalen);
+
+static const struct m3can_handler m3pyro_can_handlers[] = {
+    {CAN_MSG_ID_M3PYRO_FIRE_COMMAND, 1, 8, m3pyro_can_handle_fire},
+    {CAN_MSG_ID_M3PYRO_ARM_COMMAND, 1, 1, m3pyro_can_handle_arm},
+};
+
+static const uint8_t m3pyro_can_index[M3CAN_DISPATCH_SLOTS] = {
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PYRO_FIRE_COMMAND)] = 1,
+    [M3CAN_DISPATCH_SLOT(CAN_MSG_ID_M3PYRO_ARM_COMMAND)] = 2,
+};
+
+const struct m3can_dispatch_table m3pyro_can_dispatch = {
+    m3pyro_can_index, m3pyro_can_handlers,
+};
@@ -2,6 +2,8 @@
 #include "hal.h"
 
 #include "m3can.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
 #include "m3pyro_continuity.h"
 #include "m3pyro_arming.h"
 #include "m3pyro_firing.h"
@@ -19,8 +21,10 @@ int main(void) {
     halInit();
     chSysInit();
 
-    uint16_t filter_ids[] = { CAN_ID_M3PYRO };
-    m3can_init(CAN_ID_M3PYRO, filter_ids, 1);
+    static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3PYRO;
+    m3can_init(CAN_ID_M3PYRO, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+    m3monitor_init();
+    m3can_stats_init();
 
     palClearLine(LINE_FIRE1);
     palClearLine(LINE_FIRE2);
@@ -39,21 +43,26 @@ int main(void) {
     }
 }
 
-void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
-    (void)msg_id;
-    (void)rtr;
-    (void)data;
+/* Generated from shared/m3can/messages.yaml into m3pyro_can_handlers.c */
+extern const struct m3can_dispatch_table m3pyro_can_dispatch;
+
+void m3pyro_can_handle_arm(uint8_t *data, uint8_t datalen) {
     (void)datalen;
 
-    if((msg_id & 0x1F) != CAN_ID_M3PYRO) {
-        return;
-    }
+    uint8_t armed = data[0];
+    m3pyro_arming_set(armed);
+}
 
-    if(msg_id == CAN_MSG_ID_M3PYRO_ARM_COMMAND) {
-        uint8_t armed = data[0];
-        m3pyro_arming_set(armed);
-    } else if(msg_id == CAN_MSG_ID_M3PYRO_FIRE_COMMAND) {
-        uint8_t ch1 = data[0], ch2 = data[1], ch3 = data[2], ch4 = data[3];
-        m3pyro_firing_fire(ch1, ch2, ch3, ch4);
+void m3pyro_can_handle_fire(uint8_t *data, uint8_t datalen) {
+    /* This board has four channels; any not sent are left off */
+    uint8_t ch[4] = {0, 0, 0, 0};
+    for(uint8_t i=0; i<4 && i<datalen; i++) {
+        ch[i] = data[i];
     }
+    m3pyro_firing_fire(ch[0], ch[1], ch[2], ch[3]);
+}
+
+void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
+    (void)rtr;
+    m3can_dispatch(&m3pyro_can_dispatch, msg_id, data, datalen);
 }
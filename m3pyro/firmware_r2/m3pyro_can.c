@@ -0,0 +1,32 @@
+#include "m3can.h"
+#include "m3pyro_status.h"
+#include "m3pyro_firing.h"
+
+/* Generated from shared/m3can/messages.yaml into m3pyro_can_handlers.c */
+extern const struct m3can_dispatch_table m3pyro_can_dispatch;
+
+void m3pyro_can_handle_arm(uint8_t *data, uint8_t datalen) {
+    (void)datalen;
+
+    /* Handle arming/disarming command */
+    uint8_t armed = data[0];
+    if(armed) {
+        m3pyro_arm();
+    } else {
+        m3pyro_disarm();
+    }
+}
+
+void m3pyro_can_handle_fire(uint8_t *data, uint8_t datalen) {
+    /* Handle fire command, where channels past datalen are left alone */
+    for(uint8_t ch=1; ch<=datalen; ch++) {
+        if(data[ch - 1] != 0) {
+            m3pyro_firing_enqueue(ch, data[ch - 1]);
+        }
+    }
+}
+
+void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
+    (void)rtr;
+    m3can_dispatch(&m3pyro_can_dispatch, msg_id, data, datalen);
+}
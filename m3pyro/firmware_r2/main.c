@@ -2,6 +2,8 @@
 #include "hal.h"
 
 #include "m3can.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
 #include "m3pyro_status.h"
 #include "m3pyro_hal.h"
 #include "m3pyro_selftest.h"
@@ -34,8 +36,10 @@ int main(void) {
     halInit();
     chSysInit();
 
-    uint16_t filter_ids[] = { CAN_ID_M3PYRO };
-    m3can_init(CAN_ID_M3PYRO, filter_ids, 1);
+    static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3PYRO;
+    m3can_init(CAN_ID_M3PYRO, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+    m3monitor_init();
+    m3can_stats_init();
 
     m3pyro_status_init();
     m3pyro_hal_init();
@@ -67,59 +71,3 @@ int main(void) {
         chThdSleepMilliseconds(100);
     }
 }
-
-void m3can_recv(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
-    (void)msg_id;
-    (void)rtr;
-
-    /* Only respond to CAN messages addressed to M3Pyro */
-    if((msg_id & 0x1F) != CAN_ID_M3PYRO) {
-        return;
-    }
-
-    if(msg_id == CAN_MSG_ID_M3PYRO_ARM_COMMAND) {
-        /* Handle arming/disarming command */
-        uint8_t armed = data[0];
-        if(armed) {
-            m3pyro_arm();
-        } else {
-            m3pyro_disarm();
-        }
-    } else if(msg_id == CAN_MSG_ID_M3PYRO_FIRE_COMMAND) {
-        /* Handle fire command */
-        uint8_t ch1 = data[0], ch2 = data[1], ch3 = data[2], ch4 = data[3];
-        uint8_t ch5 = data[4], ch6 = data[5], ch7 = data[6], ch8 = data[7];
-
-        if(datalen >= 1 && ch1 != 0) {
-            m3pyro_firing_enqueue(1, ch1);
-        }
-
-        if(datalen >= 2 && ch2 != 0) {
-            m3pyro_firing_enqueue(2, ch2);
-        }
-
-        if(datalen >= 3 && ch3 != 0) {
-            m3pyro_firing_enqueue(3, ch3);
-        }
-
-        if(datalen >= 4 && ch4 != 0) {
-            m3pyro_firing_enqueue(4, ch4);
-        }
-
-        if(datalen >= 5 && ch5 != 0) {
-            m3pyro_firing_enqueue(5, ch5);
-        }
-
-        if(datalen >= 6 && ch6 != 0) {
-            m3pyro_firing_enqueue(6, ch6);
-        }
-
-        if(datalen >= 7 && ch7 != 0) {
-            m3pyro_firing_enqueue(7, ch7);
-        }
-
-        if(datalen >= 8 && ch8 != 0) {
-            m3pyro_firing_enqueue(8, ch8);
-        }
-    }
-}
@@ -0,0 +1,163 @@
+/*
+ * Host model of the M3Pyro r2 bus and channel hardware
+ * M3PYRO
+ * Cambridge University Spaceflight
+ *
+ * Implements m3pyro_hal.h on the host GPIO table in place of m3pyro_hal.c.
+ * The bus sits at the supply voltage with either constant current supply
+ * on, at the continuity voltage with continuity enabled, and discharges
+ * through whichever channel is asserted into a 2 ohm e-match load, so the
+ * self test passes and continuity reads every channel as connected.
+ *
+ * Channel changes are traced as source "pyro" when a supply is on, i.e.
+ * when firing, and as "pyro_cont" for continuity measurements.
+ */
+
+#include <math.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "m3host.h"
+#include "m3pyro_hal.h"
+#include "m3pyro_status.h"
+
+/* Voltages in 0.1V */
+#define HOST_SUPPLY_V           (74)
+#define HOST_BUS_SUPPLY_V       (70)
+#define HOST_BUS_CONT_V         (26)
+
+/* Continuity ADC reading with the bus charged */
+#define HOST_CONT_CHARGED       (3200)
+
+/* Resistance of each channel's load, and the continuity circuit's
+ * capacitance and series resistance as used in m3pyro_continuity.c
+ */
+#define HOST_LOAD_OHMS          (2.0f)
+#define HOST_CONT_CAPACITANCE   (22e-6f)
+#define HOST_CONT_SERIES_OHMS   (300.0f)
+
+typedef enum {
+    HOST_CONT_HIZ,
+    HOST_CONT_HIGH,
+    HOST_CONT_GND,
+} host_cont_t;
+
+static const ioline_t host_ch_lines[8] = {
+    LINE_CH1, LINE_CH2, LINE_CH3, LINE_CH4,
+    LINE_CH5, LINE_CH6, LINE_CH7, LINE_CH8,
+};
+
+static volatile host_cont_t host_cont = HOST_CONT_HIZ;
+static volatile adcsample_t host_cont_reading;
+static volatile uint8_t host_channel;
+static volatile systime_t host_channel_t;
+
+static bool host_supply_on(void)
+{
+    return palReadLine(LINE_1A_EN) || palReadLine(LINE_3A_EN);
+}
+
+void m3pyro_hal_init(void)
+{
+    m3status_set_init(M3PYRO_COMPONENT_HAL);
+    palClearLine(LINE_1A_EN);
+    palClearLine(LINE_3A_EN);
+    palClearLine(LINE_CONT_EN);
+    m3pyro_deassert_ch();
+    m3status_set_ok(M3PYRO_COMPONENT_HAL);
+}
+
+uint8_t m3pyro_read_bus(void)
+{
+    if(host_supply_on()) {
+        return HOST_BUS_SUPPLY_V;
+    } else if(host_cont == HOST_CONT_HIGH) {
+        return HOST_BUS_CONT_V;
+    }
+    return 0;
+}
+
+uint8_t m3pyro_read_supply(void)
+{
+    return HOST_SUPPLY_V;
+}
+
+adcsample_t m3pyro_read_cont(void)
+{
+    return host_cont_reading;
+}
+
+void m3pyro_cont_enable(void)
+{
+    host_cont = HOST_CONT_HIGH;
+    host_cont_reading = HOST_CONT_CHARGED;
+    palSetLine(LINE_CONT_EN);
+}
+
+void m3pyro_cont_disable(void)
+{
+    host_cont = HOST_CONT_HIZ;
+}
+
+void m3pyro_cont_gnd(void)
+{
+    host_cont = HOST_CONT_GND;
+    host_cont_reading = 0;
+    palClearLine(LINE_CONT_EN);
+}
+
+void m3pyro_deassert_ch(void)
+{
+    if(host_channel != 0) {
+        /* The charged bus discharged through the load while connected */
+        float t = (float)ST2US(chVTTimeElapsedSinceX(host_channel_t)) / 1e6f;
+        float tau = HOST_CONT_CAPACITANCE *
+                    (HOST_LOAD_OHMS + HOST_CONT_SERIES_OHMS);
+        host_cont_reading = (adcsample_t)((float)host_cont_reading *
+                                          expf(-t / tau));
+
+        m3host_trace(host_supply_on() ? "pyro" : "pyro_cont",
+                     "ch%u off", host_channel);
+        host_channel = 0;
+    }
+
+    for(int i=0; i<8; i++) {
+        palClearLine(host_ch_lines[i]);
+    }
+}
+
+void m3pyro_assert_ch(uint8_t channel)
+{
+    m3pyro_deassert_ch();
+
+    if(channel < 1 || channel > 8) {
+        m3status_set_error(M3PYRO_COMPONENT_HAL, M3PYRO_ERROR_BADCH);
+        return;
+    }
+
+    host_channel = channel;
+    host_channel_t = chVTGetSystemTimeX();
+    palSetLine(host_ch_lines[channel - 1]);
+    m3host_trace(host_supply_on() ? "pyro" : "pyro_cont",
+                 "ch%u on", channel);
+}
+
+void m3pyro_1a_enable(void)
+{
+    palSetLine(LINE_1A_EN);
+}
+
+void m3pyro_1a_disable(void)
+{
+    palClearLine(LINE_1A_EN);
+}
+
+void m3pyro_3a_enable(void)
+{
+    palSetLine(LINE_3A_EN);
+}
+
+void m3pyro_3a_disable(void)
+{
+    palClearLine(LINE_3A_EN);
+}
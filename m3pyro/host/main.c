@@ -0,0 +1,57 @@
+/*
+ * M3Pyro r2 firmware as a Linux process on a virtual CAN bus
+ * See shared/m3host/README.md
+ */
+
+#include "ch.h"
+#include "hal.h"
+
+#include "m3can.h"
+#include "m3host.h"
+#include "m3pyro_status.h"
+#include "m3pyro_hal.h"
+#include "m3pyro_selftest.h"
+#include "m3pyro_continuity.h"
+#include "m3pyro_firing.h"
+
+static THD_WORKING_AREA(monitor_thd_wa, 128);
+static THD_FUNCTION(monitor_thd, arg) {
+    (void)arg;
+    chRegSetThreadName("monitor");
+    uint8_t readings[2];
+    while(true) {
+        readings[0] = m3pyro_read_supply();
+        readings[1] = m3pyro_read_bus();
+        m3can_send(CAN_MSG_ID_M3PYRO_SUPPLY_STATUS, false, readings, 2);
+        chThdSleepMilliseconds(500);
+    }
+}
+
+int main(void) {
+    m3host_init("m3pyro");
+
+    halInit();
+    chSysInit();
+
+    static const uint16_t rx_ids[] = M3CAN_RX_IDS_M3PYRO;
+    m3can_init(CAN_ID_M3PYRO, rx_ids, sizeof(rx_ids)/sizeof(rx_ids[0]));
+
+    m3pyro_status_init();
+    m3pyro_hal_init();
+
+    m3pyro_disarm();
+    m3pyro_selftest();
+
+    chThdCreateStatic(monitor_thd_wa, sizeof(monitor_thd_wa),
+                      LOWPRIO, monitor_thd, NULL);
+    m3pyro_continuity_init();
+    m3pyro_firing_init();
+
+    while(!m3host_should_stop()) {
+        chThdSleepMilliseconds(100);
+    }
+
+    /* Make safe on the way out, as a disarm would */
+    m3pyro_disarm();
+    return 0;
+}
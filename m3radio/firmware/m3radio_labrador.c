@@ -3,6 +3,7 @@
 #include "labrador.h"
 #include "si446x.h"
 #include "m3can.h"
+#include "m3can_bulk.h"
 #include "m3radio_status.h"
 #include "m3radio_labrador.h"
 #include "m3radio_router.h"
@@ -58,10 +59,31 @@ struct labrador_radio_config labradcfg;
  */
 struct labrador_stats labstats;
 
+/* Si446x configuration as (group, property, value) triples, dumped once
+ * after initialisation. Sent to M3DL for logging and to anyone who asks.
+ */
+#define M3RADIO_SI446X_MAX_PARAMS (384)
+static uint8_t si446x_params[3 * M3RADIO_SI446X_MAX_PARAMS];
+static size_t si446x_params_len;
+
 /* Callback for the configuration dumping utility in the Si446x driver */
 static void si446x_cfg_cb(uint8_t g, uint8_t p, uint8_t v)
 {
-    m3can_send_u8(CAN_MSG_ID_M3RADIO_SI4460_CFG, g, p, v, 0, 0, 0, 0, 0, 3);
+    if(si446x_params_len + 3 <= sizeof(si446x_params)) {
+        si446x_params[si446x_params_len++] = g;
+        si446x_params[si446x_params_len++] = p;
+        si446x_params[si446x_params_len++] = v;
+    }
+}
+
+/* The dump doesn't change, so it's already in the bulk TX buffer */
+static size_t si446x_params_bulk_read(uint8_t port, uint8_t* buf,
+                                      size_t size)
+{
+    (void)port;
+    (void)buf;
+    (void)size;
+    return si446x_params_len;
 }
 
 THD_WORKING_AREA(m3radio_labrador_rx_thd_wa, 1024);
@@ -147,8 +169,15 @@ void m3radio_labrador_init()
         chThdSleepMilliseconds(1000);
     }
 
-    /* Dump the Si446x configuration to CAN for logging */
+    /* Dump the Si446x configuration to CAN for logging, as one bulk
+     * transfer rather than a frame per property.
+     */
+    si446x_params_len = 0;
     si446x_dump_params(si446x_cfg_cb);
+    m3can_bulk_register_tx(M3CAN_BULK_PORT_SI446X_PARAMS, si446x_params,
+                           sizeof(si446x_params), si446x_params_bulk_read);
+    m3can_bulk_send(CAN_ID_M3DL, M3CAN_BULK_PORT_SI446X_PARAMS,
+                    si446x_params, si446x_params_len);
 
     /* Start RX thread */
     chThdCreateStatic(
@@ -1,6 +1,7 @@
 #include <string.h>
 #include "ch.h"
 #include "m3can.h"
+#include "m3prof.h"
 #include "m3radio_status.h"
 #include "m3radio_router_slots.h"
 #include "m3radio_router.h"
@@ -102,6 +103,8 @@ void m3radio_router_fillbuf(uint8_t* buf, size_t len)
     uint8_t n_frames = 0;
     struct pool_frame *frame;
 
+    M3PROF_START(M3PROF_M3RADIO_FILLBUF);
+
     /* Check how many messages are in the mailbox for transmission */
     chSysLock();
     messages_remaining = chMBGetUsedCountI(&mailbox);
@@ -151,6 +154,8 @@ void m3radio_router_fillbuf(uint8_t* buf, size_t len)
      */
     buf[0] = (uint8_t)n_frames;
     buf[1] = (uint8_t)messages_remaining;
+
+    M3PROF_STOP(M3PROF_M3RADIO_FILLBUF);
 }
 
 void m3radio_router_init() {
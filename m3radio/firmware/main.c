@@ -1,6 +1,10 @@
 #include "ch.h"
 #include "hal.h"
 #include "m3can.h"
+#include "m3prof.h"
+#include "m3monitor.h"
+#include "m3can_stats.h"
+#include "m3can_bulk.h"
 #include "m3radio_status.h"
 #include "m3radio_gps_ant.h"
 #include "m3radio_labrador.h"
@@ -66,6 +70,12 @@ int main(void) {
      * We listen to all subsystems so don't set any filters.
      */
     m3can_init(CAN_ID_M3RADIO, NULL, 0);
+    m3prof_init();
+    m3monitor_init();
+    m3can_stats_init();
+
+    /* Answer requests for the Si446x configuration once it's dumped */
+    m3can_bulk_init();
 
     /* We'll enable CAN loopback so we can send our own messages over
      * the radio */
@@ -0,0 +1,68 @@
+/*
+ * M3Radio firmware as a Linux process on a virtual CAN bus
+ * See shared/m3host/README.md
+ *
+ * Runs the CAN router unmodified. There is no Labrador radio, so in place
+ * of its transmit loop a thread fills one radio packet a second from the
+ * router and appends it to downlink.bin in the working directory.
+ */
+
+#include <stdio.h>
+
+#include "ch.h"
+#include "hal.h"
+
+#include "m3can.h"
+#include "m3host.h"
+#include "m3radio_status.h"
+#include "m3radio_router.h"
+
+#define HOST_DOWNLINK_LEN       (128)
+#define HOST_DOWNLINK_PERIOD_MS (1000)
+
+static THD_WORKING_AREA(host_downlink_thd_wa, 512);
+static THD_FUNCTION(host_downlink_thd, arg) {
+    (void)arg;
+    uint8_t buf[HOST_DOWNLINK_LEN];
+    chRegSetThreadName("downlink");
+
+    FILE* f = fopen("downlink.bin", "wb");
+    if(f == NULL) {
+        m3status_set_error(M3RADIO_COMPONENT_LABRADOR,
+                           M3RADIO_ERROR_LABRADOR_TX);
+        return;
+    }
+
+    while(true) {
+        chThdSleepMilliseconds(HOST_DOWNLINK_PERIOD_MS);
+        m3radio_router_fillbuf(buf, sizeof(buf));
+        fwrite(buf, 1, sizeof(buf), f);
+        fflush(f);
+        m3host_trace("downlink", "%u bytes", (unsigned)sizeof(buf));
+    }
+}
+
+int main(void) {
+    m3host_init("m3radio");
+
+    halInit();
+    chSysInit();
+
+    m3radio_status_init();
+
+    /* Listen to all subsystems and route our own messages too */
+    m3can_init(CAN_ID_M3RADIO, NULL, 0);
+    m3can_set_loopback(true);
+
+    m3radio_router_init();
+
+    m3status_set_init(M3RADIO_COMPONENT_LABRADOR);
+    chThdCreateStatic(host_downlink_thd_wa, sizeof(host_downlink_thd_wa),
+                      NORMALPRIO, host_downlink_thd, NULL);
+    m3status_set_ok(M3RADIO_COMPONENT_LABRADOR);
+
+    while(!m3host_should_stop()) {
+        chThdSleepMilliseconds(100);
+    }
+    return 0;
+}
@@ -0,0 +1,602 @@
+"""
+Generate the CAN message code for every board and the ground station from
+messages.yaml, so IDs and payload layouts are only written down once.
+
+Writes:
+    shared/m3can/m3can_msgs.h
+        CAN_ID_* and CAN_MSG_ID_* definitions, the M3CAN_RX_IDS_<BOARD>
+        list of IDs each board receives, a packed struct for each
+        payload with a compile-time size check, and static inline
+        m3can_send_<board>_<message>() packers.
+    <board>/firmware/<board>_can_handlers.c
+        For each board that handles messages, its handlers with the payload
+        lengths each accepts, and the sparse ID-indexed table m3can_dispatch()
+        looks them up in.
+    m3radio/firmware/m3radio_router_slots.c
+        Default radio downlink mode of every message.
+    m3dl/firmware/logformat_schema.c
+        Payload length of every message and the field widths of those marked
+        log_delta, for the datalogger's log format, with an ID-indexed table.
+    gcs/m3gcs/m3can_msgs.py
+        The same IDs, and a decoder for each payload built on a precompiled
+        struct.Struct.
+
+Usage: python3 gen_messages.py
+"""
+
+import os
+import struct
+import yaml
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.join(HERE, "..", "..")
+
+# Boards with more than one firmware revision get a handler table in each
+FIRMWARE_DIRS = {
+    "m3pyro": ["firmware", "firmware_r2"],
+}
+
+GENERATED = "Generated by shared/m3can/gen_messages.py from messages.yaml, " \
+            "do not edit."
+
+# Width codes of integer fields in a delta coded log record, see
+# m3dl/firmware/logformat.h
+LOG_FIELD_WIDTHS = {"u8": 1, "i8": 1, "u16": 2, "i16": 2, "u32": 3, "i32": 3}
+LOG_MAX_DELTA = 16
+
+# type: (C type, struct format character)
+TYPES = {
+    "u8": ("uint8_t", "B"),
+    "i8": ("int8_t", "b"),
+    "u16": ("uint16_t", "H"),
+    "i16": ("int16_t", "h"),
+    "u32": ("uint32_t", "I"),
+    "i32": ("int32_t", "i"),
+    "f32": ("float", "f"),
+    "char": ("char", "s"),
+}
+
+
+class Field:
+    def __init__(self, spec):
+        self.name = spec[0]
+        self.scale = spec[2] if len(spec) > 2 else 1
+        self.unit = spec[3] if len(spec) > 3 else ""
+        t = spec[1]
+        if "[" in t:
+            self.type, n = t.rstrip("]").split("[")
+            self.count = int(n)
+        else:
+            self.type, self.count = t, None
+        if self.type not in TYPES:
+            raise ValueError("Unknown type {} for field {}"
+                             .format(t, self.name))
+        self.ctype, self.fmt_char = TYPES[self.type]
+
+    @property
+    def fmt(self):
+        if self.count is None:
+            return self.fmt_char
+        return "{}{}".format(self.count, self.fmt_char)
+
+    @property
+    def values(self):
+        """Number of values struct.unpack produces for this field"""
+        if self.count is None or self.type == "char":
+            return 1
+        return self.count
+
+    @property
+    def cdecl(self):
+        if self.count is None:
+            return "{} {}".format(self.ctype, self.name)
+        return "{} {}[{}]".format(self.ctype, self.name, self.count)
+
+
+class Message:
+    def __init__(self, board, name, spec, common=False):
+        self.board = board
+        self.name = name
+        self.msg_id = spec["id"]
+        self.common = common
+        self.fields = [Field(f) for f in spec.get("fields", [])]
+        self.radio = spec.get("radio")
+        self.handlers = spec.get("handlers", {})
+        self.receivers = set(self.handlers) | set(spec.get("receivers", []))
+        self.rtr = spec.get("rtr", False)
+        self.fmt = "<" + "".join(f.fmt for f in self.fields)
+        self.size = struct.calcsize(self.fmt)
+        self.min_length = spec.get("min_length", self.size)
+        self.log_delta = spec.get("log_delta", False)
+        if not 0 <= self.msg_id < 64:
+            raise ValueError("{}: message ID out of range".format(self.cname))
+        if self.size > 8:
+            raise ValueError("{}: payload is {} bytes".format(self.cname,
+                                                             self.size))
+        if not 0 <= self.min_length <= self.size:
+            raise ValueError("{}: bad min_length".format(self.cname))
+        if self.log_delta and (not self.fields or any(
+                f.type not in LOG_FIELD_WIDTHS for f in self.fields)):
+            raise ValueError("{}: log_delta needs integer fields".format(
+                self.cname))
+
+    @property
+    def log_fields(self):
+        """Delta coded field width codes, two bits each from the first"""
+        if not self.log_delta:
+            return 0
+        codes = []
+        for f in self.fields:
+            codes += [LOG_FIELD_WIDTHS[f.type]] * (f.count or 1)
+        return sum(c << (2 * i) for i, c in enumerate(codes))
+
+    @property
+    def prefix(self):
+        return self.name if self.common else self.board + "_" + self.name
+
+    @property
+    def cname(self):
+        return "CAN_MSG_ID_" + self.prefix.upper()
+
+    @property
+    def struct_name(self):
+        return "m3can_msg_" + self.prefix
+
+
+def load():
+    with open(os.path.join(HERE, "messages.yaml")) as f:
+        schema = yaml.safe_load(f)
+
+    boards = schema["boards"]
+    for board, bid in boards.items():
+        # m3can_dispatch indexes by the low three bits of the board ID
+        if not 0 < bid < 8:
+            raise ValueError("{}: board ID out of range".format(board))
+    common = [Message(None, name, spec, common=True)
+              for name, spec in schema["common"].items()]
+    messages = []
+    common_radio = {}
+    for board, msgs in schema["messages"].items():
+        if board not in boards:
+            raise ValueError("Unknown board {}".format(board))
+        common_radio[board] = msgs.get("common_radio", {})
+        for name, spec in msgs.items():
+            if name == "common_radio":
+                continue
+            messages.append(Message(board, name, spec))
+
+    for m in common:
+        for rx in m.receivers:
+            if rx not in boards:
+                raise ValueError("{}: unknown board {}".format(m.cname, rx))
+
+    seen = {}
+    for m in messages:
+        sid = boards[m.board] | (m.msg_id << 5)
+        if sid in seen:
+            raise ValueError("{} and {} share ID {}".format(
+                m.cname, seen[sid].cname, sid))
+        seen[sid] = m
+        for rx in m.receivers:
+            if rx not in boards:
+                raise ValueError("{}: unknown board {}".format(m.cname, rx))
+
+    return boards, common, messages, common_radio
+
+
+def can_id(boards, m):
+    return boards[m.board] | (m.msg_id << 5)
+
+
+def write_c_header(boards, common, messages):
+    lines = [
+        "/*",
+        " * " + GENERATED,
+        " * Included by m3can.h.",
+        " */",
+        "",
+        "#ifndef M3CAN_MSGS_H",
+        "#define M3CAN_MSGS_H",
+        "",
+        "#include <stdint.h>",
+        "#include <stdbool.h>",
+        "#include <string.h>",
+        "",
+    ]
+    for board, bid in boards.items():
+        lines.append("#define CAN_ID_{:<8} ({})".format(board.upper(), bid))
+    lines += ["", "#define CAN_MSG_ID(x)    (x<<5)", ""]
+
+    lines.append("/* Sent by every board, OR with the board's ID */")
+    for m in common:
+        lines.append("#define {:<36} CAN_MSG_ID({})".format(m.cname, m.msg_id))
+
+    board = None
+    for m in messages:
+        if m.board != board:
+            board = m.board
+            lines += ["", "/* {} */".format(board.upper())]
+        lines.append("#define {:<36} (CAN_ID_{} | CAN_MSG_ID({}))".format(
+            m.cname, board.upper(), m.msg_id))
+
+    lines += c_rx_ids(boards, common, messages)
+
+    lines += [
+        "",
+        "",
+        "/* Payloads and packers. The structs match the little-endian wire",
+        " * layout, so handlers may also cast received data to them.",
+        " */",
+    ]
+    for m in common + messages:
+        lines += c_packer(m)
+
+    lines += ["", "#endif /* M3CAN_MSGS_H */", ""]
+    return "\n".join(lines)
+
+
+def c_rx_ids(boards, common, messages):
+    lines = [
+        "",
+        "/* CAN IDs each board receives, to pass to m3can_init(). Messages the",
+        " * board sends in reply to a remote frame are marked M3CAN_FILTER_RTR,",
+        " * and common messages are received from every other board. Remote",
+        " * frames for the board's own common rtr messages are answered by m3can.",
+        " */",
+    ]
+    for board in boards:
+        ids = []
+        for m in sorted(messages, key=lambda m: can_id(boards, m)):
+            if board in m.receivers:
+                ids.append(m.cname)
+            elif m.board == board and m.rtr:
+                ids.append("{} | M3CAN_FILTER_RTR".format(m.cname))
+        for m in common:
+            if board in m.receivers:
+                ids += ["CAN_ID_{} | {}".format(other.upper(), m.cname)
+                        for other in boards if other != board]
+        # Boards with nothing to filter for receive everything already
+        if not ids:
+            continue
+        for m in common:
+            if m.rtr:
+                ids.append("CAN_ID_{} | {} | M3CAN_FILTER_RTR".format(
+                    board.upper(), m.cname))
+        lines.append("#define M3CAN_RX_IDS_{} {{ \\".format(board.upper()))
+        lines += ["    {}, \\".format(i) for i in ids]
+        lines.append("}")
+    return lines
+
+
+def c_packer(m):
+    if m.common:
+        send_id = "m3can_own_id | " + m.cname
+    else:
+        send_id = m.cname
+    fn = "m3can_send_" + m.prefix
+    lines = [""]
+
+    if not m.fields:
+        lines += [
+            "static inline void {}(void)".format(fn),
+            "{",
+            "    m3can_send({}, false, NULL, 0);".format(send_id),
+            "}",
+        ]
+        return lines
+
+    lines.append("struct {} {{".format(m.struct_name))
+    for f in m.fields:
+        decl = "    {};".format(f.cdecl)
+        if f.unit or f.scale != 1:
+            unit = f.unit
+            if f.scale != 1:
+                unit = "{:g} {}".format(f.scale, unit).strip()
+            decl = "{:<36}/* {} */".format(decl, unit)
+        lines.append(decl)
+    lines += [
+        "} __attribute__((packed));",
+        "_Static_assert(sizeof(struct {}) == {},".format(m.struct_name,
+                                                          m.size),
+        "               \"{} payload size\");".format(m.prefix),
+        "",
+    ]
+
+    params = []
+    for f in m.fields:
+        if f.count is None:
+            params.append("{} {}".format(f.ctype, f.name))
+        else:
+            params.append("const {} {}[{}]".format(f.ctype, f.name, f.count))
+    sig = "static inline void {}(".format(fn)
+    lines += wrap_params(sig, params, ")")
+    lines += ["{", "    struct {} msg;".format(m.struct_name)]
+    for f in m.fields:
+        if f.count is None:
+            lines.append("    msg.{0} = {0};".format(f.name))
+        else:
+            lines.append("    memcpy(msg.{0}, {0}, sizeof(msg.{0}));"
+                         .format(f.name))
+    lines += [
+        "    m3can_send({}, false,".format(send_id),
+        "               (uint8_t*)&msg, sizeof(msg));",
+        "}",
+    ]
+    return lines
+
+
+def wrap_params(start, params, end, width=79):
+    lines = []
+    line = start
+    indent = " " * len(start)
+    for i, p in enumerate(params):
+        p += ", " if i < len(params) - 1 else end
+        if len(line) + len(p.rstrip()) > width and line.strip() != \
+                start.strip():
+            lines.append(line.rstrip())
+            line = indent
+        line += p
+    lines.append(line)
+    return lines
+
+
+def write_handlers(boards, messages, board):
+    handled = sorted(((can_id(boards, m), m) for m in messages
+                      if board in m.handlers), key=lambda x: x[0])
+    lines = [
+        "/*",
+        " * " + GENERATED,
+        " * {} receive handlers, indexed by CAN ID for m3can_dispatch()."
+        .format(board.upper()),
+        " */",
+        "",
+        "#include \"m3can.h\"",
+        "",
+    ]
+    for fn in sorted(set(m.handlers[board] for _, m in handled)):
+        lines.append("void {}(uint8_t* data, uint8_t datalen);".format(fn))
+    lines += [
+        "",
+        "static const struct m3can_handler {}_can_handlers[] = {{"
+        .format(board),
+    ]
+    for _, m in handled:
+        lines.append("    {{{}, {}, {}, {}}},".format(
+            m.cname, m.min_length, m.size, m.handlers[board]))
+    lines += [
+        "};",
+        "",
+        "static const uint8_t {}_can_index[M3CAN_DISPATCH_SLOTS] = {{"
+        .format(board),
+    ]
+    for i, (_, m) in enumerate(handled):
+        lines.append("    [M3CAN_DISPATCH_SLOT({})] = {},".format(
+            m.cname, i + 1))
+    lines += [
+        "};",
+        "",
+        "const struct m3can_dispatch_table {0}_can_dispatch = {{".format(board),
+        "    {0}_can_index, {0}_can_handlers,".format(board),
+        "};",
+        "",
+    ]
+    return "\n".join(lines)
+
+
+def write_router_slots(boards, messages, common_radio):
+    lines = [
+        "/*",
+        " * " + GENERATED,
+        " * Set each message's `radio` entry there to change these.",
+        " */",
+        "",
+        "#include \"m3radio_router_slots.h\"",
+        "",
+        "struct m3radio_slot m3radio_slots[2048] = {",
+        "    /* Unless otherwise specified, default is to never transmit. */",
+        "    {.mode=M3RADIO_ROUTER_MODE_NEVER, .skip_count=0},",
+    ]
+
+    def slot(sid, radio):
+        if radio == "always":
+            mode = ".mode = M3RADIO_ROUTER_MODE_ALWAYS"
+        elif radio == "never":
+            mode = ".mode = M3RADIO_ROUTER_MODE_NEVER"
+        elif isinstance(radio, int) and 0 < radio < 65536:
+            mode = ".mode = M3RADIO_ROUTER_MODE_TIMED, .period = {}".format(
+                radio)
+        else:
+            raise ValueError("Bad radio setting {!r}".format(radio))
+        return "    {:<42} = {{ {} }},".format("[" + sid + "]", mode)
+
+    for board in common_radio:
+        lines += ["", "", "    /* {} Packets */".format(board.upper())]
+        for name, radio in common_radio[board].items():
+            sid = "CAN_ID_{} | CAN_MSG_ID_{}".format(board.upper(),
+                                                     name.upper())
+            lines.append(slot(sid, radio))
+        for m in messages:
+            if m.board == board and m.radio is not None:
+                lines.append(slot(m.cname, m.radio))
+
+    lines += ["};", ""]
+    return "\n".join(lines)
+
+
+def write_log_schema(boards, common, messages):
+    entries = []
+    for board, bid in boards.items():
+        for m in common:
+            entries.append((bid | (m.msg_id << 5), "CAN_ID_{} | {}".format(
+                board.upper(), m.cname), m))
+    for m in messages:
+        entries.append((can_id(boards, m), m.cname, m))
+    entries.sort(key=lambda x: x[0])
+    if len(entries) > 255:
+        raise ValueError("{} log schema entries, index is u8".format(
+            len(entries)))
+
+    lines = [
+        "/*",
+        " * " + GENERATED,
+        " * Every message's payload length for the datalogger's log format,",
+        " * with the field widths of those marked log_delta.",
+        " */",
+        "",
+        "#include \"m3can.h\"",
+        "#include \"logformat.h\"",
+        "",
+        "const struct logformat_schema_entry logformat_schema[] = {",
+    ]
+    delta = 0
+    for _, name, m in entries:
+        if m.log_delta:
+            delta += 1
+        lines.append("    {{{}, {}, {}, 0x{:04X}}},".format(
+            name, m.size, delta if m.log_delta else 0, m.log_fields))
+    if delta > LOG_MAX_DELTA:
+        raise ValueError("{} log_delta messages, at most {}".format(
+            delta, LOG_MAX_DELTA))
+    lines += [
+        "};",
+        "",
+        "const uint16_t logformat_schema_len = {};".format(len(entries)),
+        "",
+        "const uint8_t logformat_schema_index[2048] = {",
+    ]
+    for i, (_, name, _) in enumerate(entries):
+        lines.append("    [{}] = {},".format(name, i + 1))
+    lines += ["};", ""]
+    return "\n".join(lines)
+
+
+def write_python(boards, common, messages):
+    lines = [
+        '"""',
+        GENERATED,
+        "",
+        "MESSAGES maps each CAN ID to a Message, whose decode() returns the",
+        "scaled payload fields as a dict, and whose struct can be used",
+        "directly to unpack the raw values in bulk.",
+        '"""',
+        "",
+        "import struct",
+        "",
+        "",
+        "def msg_id(x):",
+        "    return x << 5",
+        "",
+        "",
+    ]
+    for board, bid in boards.items():
+        lines.append("CAN_ID_{} = {}".format(board.upper(), bid))
+    lines.append("")
+    for m in common:
+        lines.append("CAN_MSG_ID_{} = msg_id({})".format(m.prefix.upper(),
+                                                         m.msg_id))
+    for board in boards:
+        for m in common:
+            lines.append("CAN_MSG_ID_{}_{} = CAN_ID_{} | CAN_MSG_ID_{}".format(
+                board.upper(), m.name.upper(), board.upper(),
+                m.name.upper()))
+    for m in messages:
+        lines.append("{} = CAN_ID_{} | msg_id({})".format(
+            m.cname, m.board.upper(), m.msg_id))
+
+    lines += [
+        "",
+        "",
+        "class Message:",
+        "    def __init__(self, board, name, fmt, fields):",
+        "        self.board = board",
+        "        self.name = name",
+        "        self.struct = struct.Struct(fmt)",
+        "        self.size = self.struct.size",
+        "        # (name, first value, number of values or None, scale, unit)",
+        "        self.fields = fields",
+        "",
+        "    def decode(self, data):",
+        "        \"\"\"Scaled fields of `data` by name, or None if it is too",
+        "        short. Arrays decode to lists and text to str.\"\"\"",
+        "        if len(data) < self.size:",
+        "            return None",
+        "        raw = self.struct.unpack_from(bytes(data))",
+        "        out = {}",
+        "        for name, i, n, scale, _ in self.fields:",
+        "            if n is None:",
+        "                v = raw[i]",
+        "                out[name] = v if scale == 1 else v * scale",
+        "            elif n == 0:",
+        "                out[name] = raw[i].split(b\"\\0\", 1)[0].decode(",
+        "                    \"ascii\", \"replace\")",
+        "            else:",
+        "                vs = raw[i:i+n]",
+        "                out[name] = list(vs) if scale == 1 else [",
+        "                    v * scale for v in vs]",
+        "        return out",
+        "",
+        "",
+        "def decode(sid, data):",
+        "    \"\"\"Decode a frame with CAN ID `sid`, returning the message and a",
+        "    dict of its fields, or None if it isn't known.\"\"\"",
+        "    msg = MESSAGES.get(sid)",
+        "    if msg is None:",
+        "        return None",
+        "    return msg, msg.decode(data)",
+        "",
+        "",
+        "MESSAGES = {",
+    ]
+
+    def py_message(sid, board, m):
+        fields = []
+        i = 0
+        for f in m.fields:
+            if f.type == "char":
+                n = 0
+            else:
+                n = f.count
+            fields.append("({!r}, {}, {}, {!r}, {!r})".format(
+                f.name, i, n, f.scale, f.unit))
+            i += f.values
+        out = ["    {}: Message({!r}, {!r}, {!r}, [".format(
+            sid, board, m.name, m.fmt)]
+        out += ["        {},".format(f) for f in fields]
+        out.append("    ]),")
+        return out
+
+    for board in boards:
+        for m in common:
+            sid = "CAN_MSG_ID_{}_{}".format(board.upper(), m.name.upper())
+            lines += py_message(sid, board, m)
+    for m in messages:
+        lines += py_message(m.cname, m.board, m)
+    lines += ["}", ""]
+    return "\n".join(lines)
+
+
+def write(path, text):
+    path = os.path.normpath(os.path.join(ROOT, path))
+    with open(path, "w") as f:
+        f.write(text)
+    print("Wrote {}".format(os.path.relpath(path, ROOT)))
+
+
+def main():
+    boards, common, messages, common_radio = load()
+    write("shared/m3can/m3can_msgs.h",
+          write_c_header(boards, common, messages))
+    rx_boards = sorted(set(b for m in messages for b in m.handlers))
+    for board in rx_boards:
+        for firmware in FIRMWARE_DIRS.get(board, ["firmware"]):
+            write("{0}/{1}/{0}_can_handlers.c".format(board, firmware),
+                  write_handlers(boards, messages, board))
+    write("m3radio/firmware/m3radio_router_slots.c",
+          write_router_slots(boards, messages, common_radio))
+    write("m3dl/firmware/logformat_schema.c",
+          write_log_schema(boards, common, messages))
+    write("gcs/m3gcs/m3can_msgs.py", write_python(boards, common, messages))
+
+
+if __name__ == "__main__":
+    main()
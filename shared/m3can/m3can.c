@@ -8,6 +8,11 @@
 #include "ch.h"
 #include "hal.h"
 #include "m3can.h"
+#include "m3can_filter.h"
+#include "m3can_stats.h"
+#include "m3can_timesync.h"
+#include "m3can_bulk.h"
+#include "m3status.h"
 
 #ifndef FIRMWARE_VERSION
 #error "Please check your Makefile sets FIRMWARE_VERSION"
@@ -18,13 +23,39 @@ uint8_t m3can_own_id = 0;
 static volatile bool m3can_loopback_enabled;
 static void m3can_send_git_version(void);
 
+#define M3CAN_EVT_TXEMPTY   EVENT_MASK(0)
+#define M3CAN_EVT_QUEUED    EVENT_MASK(1)
+
+/* A queued frame drops once it has waited this long for a free mailbox,
+ * so a disconnected or bus-off transceiver can't hold up the queue.
+ */
+#define M3CAN_TX_TIMEOUT_MS (100)
+
+/* Frames waiting for a mailbox, see m3can_send */
+struct m3can_tx_entry {
+    uint32_t seq;
+    CANTxFrame frame;
+};
+
+static struct m3can_tx_entry m3can_tx_heap[M3CAN_TX_QUEUE_LEN];
+static size_t m3can_tx_count;
+static uint32_t m3can_tx_seq;
+static uint32_t m3can_tx_overflows;
+static uint32_t m3can_tx_dropped;
+static thread_t* m3can_tx_tp;
+
 
 static const CANConfig cancfg = {
     .mcr =
         /* Automatic Bus Off Management enabled,
-         * Automatic Wake Up Management enabled.
+         * Automatic Wake Up Management enabled,
+         * Transmit FIFO Priority: mailboxes are sent in the order they were
+         * loaded rather than by ID, so frames with the same ID in different
+         * mailboxes can't swap. The TX heap already loads them most
+         * important first, so a frame can only wait behind the at most
+         * three already in the mailboxes.
          */
-        CAN_MCR_ABOM | CAN_MCR_AWUM,
+        CAN_MCR_ABOM | CAN_MCR_AWUM | CAN_MCR_TXFP,
     .btr =
         /* CAN is on APB1 at 42MHz, we want 1Mbit/s.
          * 1/Baud = (BRP+1)/(APB1) * (3+TS1+TS2)
@@ -35,55 +66,148 @@ static const CANConfig cancfg = {
 };
 
 
-static void m3can_filter_messages(uint16_t *allowed_ids, uint8_t numids) {
-    // clear all filters
-    canSTM32SetFilters(27, 0, NULL);
-    // Layout of bits in register (we're in 16-bit mode; see manual p. 1092):
-    // STDID       RTR IDE EXID
-    // A9876543210 0   0   17,16,15
-    // mask: last 5 bits match RTR, IDE, EXID -- ignore those
-    const uint32_t mask = 0x1f << (5+16);  // match last 5 bits of STDID, shift to mask position
-    const uint32_t numfilters = numids/2 + (numids % 2);
-    chDbgAssert(numfilters <= 27, "Too many filters passed in");
-
-    CANFilter filters[27] = { 0 };
-    for (uint8_t i = 0; i < numids; i += 2) {
-        uint8_t n = i / 2;  // CANFilter number -- 2 filters per CANFilter
-        filters[n].filter       = n;    // filter number to be programmed
-        filters[n].mode         = 0;    // mask mode
-        filters[n].scale        = 0;    // 16-bit mode enough to filter STDID
-        filters[n].assignment   = 0;    // must be zero
-        // registers: 16 LSB are ID, 16 MSG are mask
-        // each register is one filter
-        filters[n].register1 = (allowed_ids[i] << 5) | mask;
-        if (i == numids-1) {
-            // odd number of IDs passed in
-            filters[n].register2 = filters[n].register1;
-        } else {
-            filters[n].register2 = (allowed_ids[i+1] << 5) | mask;
+/*
+ * Program the acceptance filters to pass only the `n` CAN IDs in `ids`,
+ * as planned by m3can_filter_plan. Must be called before canStart.
+ */
+static void m3can_filter_messages(const uint16_t* ids, size_t n) {
+    struct m3can_filter_bank banks[M3CAN_FILTER_BANKS];
+    CANFilter filters[M3CAN_FILTER_BANKS];
+    size_t num_banks;
+
+    m3can_filter_plan(ids, n, banks, M3CAN_FILTER_BANKS, &num_banks);
+
+    for(size_t i=0; i<num_banks; i++) {
+        filters[i].filter       = i;
+        filters[i].mode         = banks[i].mode;
+        filters[i].scale        = banks[i].scale;
+        filters[i].assignment   = 0;
+        filters[i].register1    = banks[i].register1;
+        filters[i].register2    = banks[i].register2;
+    }
+    canSTM32SetFilters(M3CAN_FILTER_BANKS, num_banks, filters);
+}
+
+
+/* True if heap entry `a` should be transmitted before `b` */
+static bool m3can_tx_before(const struct m3can_tx_entry* a,
+                            const struct m3can_tx_entry* b)
+{
+    if(a->frame.SID != b->frame.SID) {
+        return a->frame.SID < b->frame.SID;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static void m3can_tx_sift_up(size_t i) {
+    struct m3can_tx_entry entry = m3can_tx_heap[i];
+    while(i > 0) {
+        size_t parent = (i - 1) / 2;
+        if(!m3can_tx_before(&entry, &m3can_tx_heap[parent])) {
+            break;
+        }
+        m3can_tx_heap[i] = m3can_tx_heap[parent];
+        i = parent;
+    }
+    m3can_tx_heap[i] = entry;
+}
+
+static void m3can_tx_sift_down(size_t i) {
+    struct m3can_tx_entry entry = m3can_tx_heap[i];
+    while(true) {
+        size_t child = 2 * i + 1;
+        if(child >= m3can_tx_count) {
+            break;
+        }
+        if(child + 1 < m3can_tx_count &&
+           m3can_tx_before(&m3can_tx_heap[child + 1], &m3can_tx_heap[child])) {
+            child++;
+        }
+        if(!m3can_tx_before(&m3can_tx_heap[child], &entry)) {
+            break;
+        }
+        m3can_tx_heap[i] = m3can_tx_heap[child];
+        i = child;
+    }
+    m3can_tx_heap[i] = entry;
+}
+
+/* Add `entry` to the TX heap. Call with the system locked.
+ * If the heap is full, the least important frame out of `entry` and those
+ * already queued is discarded and counted as an overflow.
+ */
+static void m3can_tx_push(const struct m3can_tx_entry* entry) {
+    if(m3can_tx_count < M3CAN_TX_QUEUE_LEN) {
+        m3can_tx_heap[m3can_tx_count] = *entry;
+        m3can_tx_sift_up(m3can_tx_count++);
+        return;
+    }
+
+    /* The least important frame is one of the leaves */
+    size_t worst = m3can_tx_count / 2;
+    for(size_t i = worst + 1; i < m3can_tx_count; i++) {
+        if(m3can_tx_before(&m3can_tx_heap[worst], &m3can_tx_heap[i])) {
+            worst = i;
+        }
+    }
+
+    m3can_tx_overflows++;
+    if(m3can_tx_before(entry, &m3can_tx_heap[worst])) {
+        m3can_tx_heap[worst] = *entry;
+        m3can_tx_sift_up(worst);
+    }
+}
+
+/* Remove the most important frame from the TX heap into `frame`.
+ * Returns false if the heap is empty.
+ */
+static bool m3can_tx_pop(CANTxFrame* frame) {
+    bool popped = false;
+
+    chSysLock();
+    if(m3can_tx_count > 0) {
+        *frame = m3can_tx_heap[0].frame;
+        m3can_tx_heap[0] = m3can_tx_heap[--m3can_tx_count];
+        if(m3can_tx_count > 0) {
+            m3can_tx_sift_down(0);
         }
+        popped = true;
     }
-    canSTM32SetFilters(27, numfilters, filters);
+    chSysUnlock();
+
+    return popped;
 }
 
 
+/* Queue a frame for transmission by the TX thread, without blocking.
+ * Frames are kept in a binary min-heap ordered by CAN ID, and by the order
+ * they were queued for equal IDs, so the TX thread always loads the most
+ * important pending frame into the next free mailbox.
+ */
 void m3can_send(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
-    static CANTxFrame txmsg;
+    struct m3can_tx_entry entry;
 
     chDbgAssert(datalen <= 8, "CAN packet >8 bytes");
 
     if(rtr == false) {
-        txmsg.RTR = CAN_RTR_DATA;
+        entry.frame.RTR = CAN_RTR_DATA;
     } else {
-        txmsg.RTR = CAN_RTR_REMOTE;
+        entry.frame.RTR = CAN_RTR_REMOTE;
     }
-    txmsg.IDE = CAN_IDE_STD;
-    txmsg.DLC = datalen;
-    txmsg.SID = msg_id;
-
-    memcpy(&txmsg.data8, data, datalen);
-
-    canTransmit(&CAND1, CAN_ANY_MAILBOX, &txmsg, MS2ST(100));
+    entry.frame.IDE = CAN_IDE_STD;
+    entry.frame.DLC = datalen;
+    entry.frame.SID = msg_id;
+
+    memcpy(&entry.frame.data8, data, datalen);
+
+    chSysLock();
+    entry.seq = m3can_tx_seq++;
+    m3can_tx_push(&entry);
+    if(m3can_tx_tp != NULL) {
+        chEvtSignalI(m3can_tx_tp, M3CAN_EVT_QUEUED);
+        chSchRescheduleS();
+    }
+    chSysUnlock();
 
     if(m3can_loopback_enabled) {
         m3can_recv(msg_id, rtr, data, datalen);
@@ -91,54 +215,85 @@ void m3can_send(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen) {
 }
 
 
-void m3can_send_u8(uint16_t msg_id, uint8_t d0, uint8_t d1, uint8_t d2,
-                 uint8_t d3, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
-                 size_t n)
-{
-    uint8_t buf[8] = {d0, d1, d2, d3, d4, d5, d6, d7};
-    m3can_send(msg_id, false, buf, n);
+void m3can_get_tx_stats(uint32_t* overflows, uint32_t* dropped) {
+    chSysLock();
+    *overflows = m3can_tx_overflows;
+    *dropped = m3can_tx_dropped;
+    chSysUnlock();
 }
 
-void m3can_send_u16(uint16_t msg_id, uint16_t d0, uint16_t d1, uint16_t d2,
-                  uint16_t d3, size_t n)
-{
-    uint8_t buf[8] = {d0, d0>>8, d1, d1>>8, d2, d2>>8, d3, d3>>8};
-    m3can_send(msg_id, false, buf, n<<1);
-}
 
-void m3can_send_u32(uint16_t msg_id, uint32_t d0, uint32_t d1, size_t n)
-{
-    uint8_t buf[8] = {d0, d0>>8, d0>>16, d0>>24, d1, d1>>8, d1>>16, d1>>24};
-    m3can_send(msg_id, false, buf, n<<2);
-}
+/*
+ * CAN TX thread.
+ * Woken by new frames being queued and by the driver's mailbox-empty
+ * interrupt, and loads frames from the TX heap into free mailboxes until
+ * either runs out. Queue overflows and dropped frames are reported as a
+ * CAN component error through m3status, with the running counts.
+ */
+static THD_WORKING_AREA(can_tx_wa, 512);
+static THD_FUNCTION(can_tx_thd, arg) {
+    (void)arg;
 
-void m3can_send_i8(int16_t msg_id, int8_t d0, int8_t d1, int8_t d2,
-                 int8_t d3, int8_t d4, int8_t d5, int8_t d6, int8_t d7,
-                 size_t n)
-{
-    uint8_t buf[8] = {d0, d1, d2, d3, d4, d5, d6, d7};
-    m3can_send(msg_id, false, buf, n);
-}
+    event_listener_t el;
+    CANTxFrame txmsg;
+    bool have_frame = false;
+    systime_t time_blocked = 0;
+    uint32_t overflows, dropped, last_overflows = 0, last_dropped = 0;
+    systime_t time_last_error = 0;
 
-void m3can_send_i16(int16_t msg_id, int16_t d0, int16_t d1, int16_t d2,
-                  int16_t d3, size_t n)
-{
-    uint8_t buf[8] = {d0, d0>>8, d1, d1>>8, d2, d2>>8, d3, d3>>8};
-    m3can_send(msg_id, false, buf, n<<1);
-}
+    chRegSetThreadName("CAN TX");
+    chEvtRegisterMask(&CAND1.txempty_event, &el, M3CAN_EVT_TXEMPTY);
 
-void m3can_send_i32(int16_t msg_id, int32_t d0, int32_t d1, size_t n)
-{
-    uint8_t buf[8] = {d0, d0>>8, d0>>16, d0>>24, d1, d1>>8, d1>>16, d1>>24};
-    m3can_send(msg_id, false, buf, n<<2);
-}
+    while(true) {
+        chEvtWaitAnyTimeout(ALL_EVENTS, MS2ST(M3CAN_TX_TIMEOUT_MS));
+
+        /* Fill free mailboxes. A frame that doesn't fit is kept here
+         * until the next mailbox-empty interrupt. */
+        while(have_frame || m3can_tx_pop(&txmsg)) {
+            if(canTransmit(&CAND1, CAN_ANY_MAILBOX, &txmsg,
+                           TIME_IMMEDIATE) != MSG_OK) {
+                if(!have_frame) {
+                    have_frame = true;
+                    time_blocked = chVTGetSystemTimeX();
+                    m3can_stats_count_tx_blocked();
+                }
+                break;
+            }
+            have_frame = false;
+            m3can_stats_count(txmsg.SID, txmsg.RTR, txmsg.DLC, txmsg.data8,
+                              true);
+            m3can_timesync_frame(txmsg.SID, txmsg.data8, txmsg.DLC, true);
+        }
 
-void m3can_send_f32(uint16_t msg_id, float d0, float d1, size_t n)
-{
-    float buf[2] = {d0, d1};
-    m3can_send(msg_id, false, (uint8_t*)buf, n<<2);
-}
+        if(have_frame && ST2MS(chVTTimeElapsedSinceX(time_blocked)) >
+                         M3CAN_TX_TIMEOUT_MS) {
+            have_frame = false;
+            chSysLock();
+            m3can_tx_dropped++;
+            chSysUnlock();
+        }
 
+        /* Report the CAN component as in error while frames are being
+         * lost, and OK once none have been lost for a second. */
+        m3can_get_tx_stats(&overflows, &dropped);
+        if(overflows != last_overflows || dropped != last_dropped) {
+            uint8_t counts[4] = {overflows, overflows >> 8,
+                                 dropped, dropped >> 8};
+            m3status_set_error_data(M3STATUS_COMPONENT_CAN,
+                                    dropped != last_dropped ?
+                                        M3STATUS_ERROR_CAN_TX_DROPPED :
+                                        M3STATUS_ERROR_CAN_TX_OVERFLOW,
+                                    counts, 4);
+            last_overflows = overflows;
+            last_dropped = dropped;
+            time_last_error = chVTGetSystemTimeX();
+        } else if(m3status_get_component(M3STATUS_COMPONENT_CAN) ==
+                      M3STATUS_ERROR &&
+                  ST2MS(chVTTimeElapsedSinceX(time_last_error)) > 1000) {
+            m3status_set_ok(M3STATUS_COMPONENT_CAN);
+        }
+    }
+}
 
 static THD_WORKING_AREA(can_rx_wa, 512);
 static THD_FUNCTION(can_rx_thd, arg) {
@@ -146,21 +301,36 @@ static THD_FUNCTION(can_rx_thd, arg) {
 
     event_listener_t el;
     CANRxFrame rxmsg;
-    systime_t time_last_id = 0;
+    systime_t time_last_id = 0, time_last_digest = 0;
 
     chEvtRegister(&CAND1.rxfull_event, &el, 0);
 
     while(true) {
-        if(chEvtWaitAnyTimeout(ALL_EVENTS, MS2ST(100)) == 0) {
-            continue;
-        }
+        /* Wakes at least every 100ms so the periodic sends below happen
+         * on a quiet bus too */
+        chEvtWaitAnyTimeout(ALL_EVENTS, MS2ST(100));
 
         /* Handle all pending frames */
         while(canReceive(&CAND1, CAN_ANY_MAILBOX, &rxmsg,
                          TIME_IMMEDIATE) == MSG_OK) {
+            m3can_stats_count(rxmsg.SID, rxmsg.RTR, rxmsg.DLC, rxmsg.data8,
+                              false);
+            m3can_timesync_frame(rxmsg.SID, rxmsg.data8, rxmsg.DLC, false);
+            if(!rxmsg.RTR) {
+                m3can_bulk_frame(rxmsg.SID, rxmsg.data8, rxmsg.DLC);
+            } else {
+                m3status_handle_rtr(rxmsg.SID);
+            }
             m3can_recv(rxmsg.SID, rxmsg.RTR, rxmsg.data8, rxmsg.DLC);
         }
 
+        /* Send our status digest every second */
+        if(ST2MS(chVTTimeElapsedSinceX(time_last_digest)) >=
+           M3STATUS_DIGEST_PERIOD_MS) {
+            m3status_send_digest();
+            time_last_digest = chVTGetSystemTimeX();
+        }
+
         /* Send our git ID every 5 seconds */
         if(ST2MS(chVTTimeElapsedSinceX(time_last_id)) > 5000) {
             m3can_send_git_version();
@@ -174,13 +344,15 @@ void m3can_set_loopback(bool enabled) {
 }
 
 
-void m3can_init(uint8_t board_id, uint16_t* filter_ids, size_t num_filter_ids)
+void m3can_init(uint8_t board_id, const uint16_t* rx_ids, size_t num_rx_ids)
 {
     m3can_own_id = board_id;
-    if(filter_ids != NULL) {
-        m3can_filter_messages(filter_ids, num_filter_ids);
+    if(rx_ids != NULL && num_rx_ids > 0) {
+        m3can_filter_messages(rx_ids, num_rx_ids);
     }
     canStart(&CAND1, &cancfg);
+    m3can_tx_tp = chThdCreateStatic(can_tx_wa, sizeof(can_tx_wa),
+                                    NORMALPRIO+7, can_tx_thd, NULL);
     m3can_send_git_version();
     chThdCreateStatic(can_rx_wa, sizeof(can_rx_wa), NORMALPRIO,
                       can_rx_thd, NULL);
@@ -3,121 +3,72 @@
 
 #include "ch.h"
 #include "hal.h"
+#include "m3can_filter.h"
 
-#define CAN_ID_M3FC      (1)
-#define CAN_ID_M3PSU     (2)
-#define CAN_ID_M3PYRO    (3)
-#define CAN_ID_M3RADIO   (4)
-#define CAN_ID_M3IMU     (5)
-#define CAN_ID_M3DL      (6)
-#define CAN_ID_GROUND    (7)
-
-#define CAN_MSG_ID(x)    (x<<5)
-
-#define CAN_MSG_ID_VERSION                  CAN_MSG_ID(63)
-#define CAN_MSG_ID_STATUS                   CAN_MSG_ID(0)
+/* Number of frames m3can_send can queue while waiting for a free mailbox */
+#ifndef M3CAN_TX_QUEUE_LEN
+#define M3CAN_TX_QUEUE_LEN (64)
+#endif
 
 extern uint8_t m3can_own_id;
 
-// Fill out known CAN message IDs here, so all boards can know about them
-/* M3RADIO */
-#define CAN_MSG_ID_M3RADIO_GPS_LATLNG       (CAN_ID_M3RADIO | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3RADIO_GPS_ALT          (CAN_ID_M3RADIO | CAN_MSG_ID(49))
-#define CAN_MSG_ID_M3RADIO_GPS_TIME         (CAN_ID_M3RADIO | CAN_MSG_ID(50))
-#define CAN_MSG_ID_M3RADIO_GPS_STATUS       (CAN_ID_M3RADIO | CAN_MSG_ID(51))
-#define CAN_MSG_ID_M3RADIO_SI4460_CFG       (CAN_ID_M3RADIO | CAN_MSG_ID(52))
-#define CAN_MSG_ID_M3RADIO_PACKET_COUNT     (CAN_ID_M3RADIO | CAN_MSG_ID(53))
-#define CAN_MSG_ID_M3RADIO_PACKET_STATS     (CAN_ID_M3RADIO | CAN_MSG_ID(54))
-#define CAN_MSG_ID_M3RADIO_PING             (CAN_ID_M3RADIO | CAN_MSG_ID(55))
-#define CAN_MSG_ID_M3RADIO_SET_FREQ         (CAN_ID_M3RADIO | CAN_MSG_ID(56))
-
-
-/* M3PSU */
-#define CAN_MSG_ID_M3PSU_TOGGLE_PYROS           (CAN_ID_M3PSU | CAN_MSG_ID(16))
-#define CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL         (CAN_ID_M3PSU | CAN_MSG_ID(17))
-#define CAN_MSG_ID_M3PSU_TOGGLE_CHARGER         (CAN_ID_M3PSU | CAN_MSG_ID(18))
-#define CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER        (CAN_ID_M3PSU | CAN_MSG_ID(19))
-#define CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT     (CAN_ID_M3PSU | CAN_MSG_ID(20))
-#define CAN_MSG_ID_M3PSU_PYRO_STATUS            (CAN_ID_M3PSU | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12      (CAN_ID_M3PSU | CAN_MSG_ID(49))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34      (CAN_ID_M3PSU | CAN_MSG_ID(50))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56      (CAN_ID_M3PSU | CAN_MSG_ID(51))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78      (CAN_ID_M3PSU | CAN_MSG_ID(52))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910     (CAN_ID_M3PSU | CAN_MSG_ID(53))
-#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112    (CAN_ID_M3PSU | CAN_MSG_ID(54))
-#define CAN_MSG_ID_M3PSU_CHARGER_STATUS         (CAN_ID_M3PSU | CAN_MSG_ID(55))
-#define CAN_MSG_ID_M3PSU_BATT_VOLTAGES          (CAN_ID_M3PSU | CAN_MSG_ID(56))
-#define CAN_MSG_ID_M3PSU_CAPACITY               (CAN_ID_M3PSU | CAN_MSG_ID(57))
-#define CAN_MSG_ID_M3PSU_AWAKE_TIME             (CAN_ID_M3PSU | CAN_MSG_ID(58))
-
-
-/* M3FC */
-#define CAN_MSG_ID_M3FC_MISSION_STATE       (CAN_ID_M3FC | CAN_MSG_ID(32))
-#define CAN_MSG_ID_M3FC_ACCEL               (CAN_ID_M3FC | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3FC_BARO                (CAN_ID_M3FC | CAN_MSG_ID(49))
-#define CAN_MSG_ID_M3FC_SE_T_H              (CAN_ID_M3FC | CAN_MSG_ID(50))
-#define CAN_MSG_ID_M3FC_SE_V_A              (CAN_ID_M3FC | CAN_MSG_ID(51))
-#define CAN_MSG_ID_M3FC_SE_VAR_H            (CAN_ID_M3FC | CAN_MSG_ID(52))
-#define CAN_MSG_ID_M3FC_SE_VAR_V_A          (CAN_ID_M3FC | CAN_MSG_ID(53))
-#define CAN_MSG_ID_M3FC_CFG_PROFILE         (CAN_ID_M3FC | CAN_MSG_ID(54))
-#define CAN_MSG_ID_M3FC_CFG_PYROS           (CAN_ID_M3FC | CAN_MSG_ID(55))
-#define CAN_MSG_ID_M3FC_CFG_ACCEL_X         (CAN_ID_M3FC | CAN_MSG_ID(56))
-#define CAN_MSG_ID_M3FC_CFG_ACCEL_Y         (CAN_ID_M3FC | CAN_MSG_ID(57))
-#define CAN_MSG_ID_M3FC_CFG_ACCEL_Z         (CAN_ID_M3FC | CAN_MSG_ID(58))
-#define CAN_MSG_ID_M3FC_CFG_RADIO_FREQ      (CAN_ID_M3FC | CAN_MSG_ID(59))
-#define CAN_MSG_ID_M3FC_CFG_CRC             (CAN_ID_M3FC | CAN_MSG_ID(60))
-#define CAN_MSG_ID_M3FC_SET_CFG_PROFILE     (CAN_ID_M3FC | CAN_MSG_ID(1))
-#define CAN_MSG_ID_M3FC_SET_CFG_PYROS       (CAN_ID_M3FC | CAN_MSG_ID(2))
-#define CAN_MSG_ID_M3FC_LOAD_CFG            (CAN_ID_M3FC | CAN_MSG_ID(3))
-#define CAN_MSG_ID_M3FC_SAVE_CFG            (CAN_ID_M3FC | CAN_MSG_ID(4))
-#define CAN_MSG_ID_M3FC_MOCK_ENABLE         (CAN_ID_M3FC | CAN_MSG_ID(5))
-#define CAN_MSG_ID_M3FC_MOCK_ACCEL          (CAN_ID_M3FC | CAN_MSG_ID(6))
-#define CAN_MSG_ID_M3FC_MOCK_BARO           (CAN_ID_M3FC | CAN_MSG_ID(7))
-#define CAN_MSG_ID_M3FC_ARM                 (CAN_ID_M3FC | CAN_MSG_ID(8))
-#define CAN_MSG_ID_M3FC_FIRE                (CAN_ID_M3FC | CAN_MSG_ID(9))
-#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X     (CAN_ID_M3FC | CAN_MSG_ID(10))
-#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y     (CAN_ID_M3FC | CAN_MSG_ID(11))
-#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z     (CAN_ID_M3FC | CAN_MSG_ID(12))
-#define CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ  (CAN_ID_M3FC | CAN_MSG_ID(13))
-#define CAN_MSG_ID_M3FC_SET_CFG_CRC         (CAN_ID_M3FC | CAN_MSG_ID(14))
-
-
-/* M3DL */
-#define CAN_MSG_ID_M3DL_FREE_SPACE          (CAN_ID_M3DL | CAN_MSG_ID(32))
-#define CAN_MSG_ID_M3DL_RATE                (CAN_ID_M3DL | CAN_MSG_ID(33))
-#define CAN_MSG_ID_M3DL_TEMP_1_2            (CAN_ID_M3DL | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3DL_TEMP_3_4            (CAN_ID_M3DL | CAN_MSG_ID(49))
-#define CAN_MSG_ID_M3DL_TEMP_5_6            (CAN_ID_M3DL | CAN_MSG_ID(50))
-#define CAN_MSG_ID_M3DL_TEMP_7_8            (CAN_ID_M3DL | CAN_MSG_ID(51))
-#define CAN_MSG_ID_M3DL_TEMP_9              (CAN_ID_M3DL | CAN_MSG_ID(52))
-#define CAN_MSG_ID_M3DL_PRESSURE            (CAN_ID_M3DL | CAN_MSG_ID(53))
-
-
-/* M3IMU */
-
-
-/* M3PYRO */
-#define CAN_MSG_ID_M3PYRO_FIRE_COMMAND      (CAN_ID_M3PYRO | CAN_MSG_ID(1))
-#define CAN_MSG_ID_M3PYRO_ARM_COMMAND       (CAN_ID_M3PYRO | CAN_MSG_ID(2))
-#define CAN_MSG_ID_M3PYRO_FIRE_STATUS       (CAN_ID_M3PYRO | CAN_MSG_ID(16))
-#define CAN_MSG_ID_M3PYRO_ARM_STATUS        (CAN_ID_M3PYRO | CAN_MSG_ID(17))
-#define CAN_MSG_ID_M3PYRO_CONTINUITY        (CAN_ID_M3PYRO | CAN_MSG_ID(48))
-#define CAN_MSG_ID_M3PYRO_SUPPLY_STATUS     (CAN_ID_M3PYRO | CAN_MSG_ID(49))
-
-
-
 /* Define this function somewhere else and implement it */
 void m3can_recv(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen);
 
+/* Receive dispatch, generated from messages.yaml into <board>_can_handlers.c.
+ *
+ * A frame's slot in the index is its message ID and the low three bits of
+ * its board ID, so one 512 byte index covers every board. Each slot holds
+ * one more than the position of the frame's handler in the handler table,
+ * or 0 if it has none. Looking up any frame is an index read and a compare,
+ * the same on every board however many messages it handles.
+ */
+#define M3CAN_DISPATCH_SLOTS        (64 * 8)
+#define M3CAN_DISPATCH_SLOT(id)     ((((id) >> 5) << 3) | ((id) & 0x07))
+
+struct m3can_handler {
+    uint16_t msg_id;
+    /* Accepted payload lengths, from the message's fields */
+    uint8_t min_len;
+    uint8_t max_len;
+    void (*handler)(uint8_t* data, uint8_t datalen);
+};
+
+struct m3can_dispatch_table {
+    const uint8_t* index;
+    const struct m3can_handler* handlers;
+};
+
+typedef enum {
+    M3CAN_DISPATCH_OK = 0,
+    M3CAN_DISPATCH_NO_HANDLER,
+    /* Reported through m3status as M3STATUS_ERROR_CAN_BAD_LENGTH */
+    M3CAN_DISPATCH_BAD_LENGTH,
+} m3can_dispatch_result_t;
+
+/* Call the handler for `msg_id` from `table`, if it has one and `datalen`
+ * is a valid length for it.
+ */
+m3can_dispatch_result_t m3can_dispatch(const struct m3can_dispatch_table* table,
+                                       uint16_t msg_id, uint8_t* data,
+                                       uint8_t datalen);
+
 /* Call m3can_init early during startup, setting your board ID from the list
- * above.
- * filter_ids is an array of allowed board IDs to listen to,
- * num_filter_ids is the length of that array.
+ * in m3can_msgs.h.
+ * rx_ids is an array of the CAN IDs this board receives, normally the
+ * generated M3CAN_RX_IDS_<BOARD> list, and num_rx_ids its length. Only these
+ * frames are let through the hardware filters, see m3can_filter.h. Pass NULL
+ * to receive everything.
  */
-void m3can_init(uint8_t board_id, uint16_t *filter_ids, size_t num_filter_ids);
+void m3can_init(uint8_t board_id, const uint16_t *rx_ids, size_t num_rx_ids);
 
 /* Call m3can_send to transmit a packet.
- * msg_id should be from the list above
+ * The packet is queued and sent by the CAN TX thread, so this never blocks
+ * waiting for the bus. Queued packets are sent lowest CAN ID first, and in
+ * order for the same ID; once in the CAN peripheral's three mailboxes they
+ * go out in the order they were loaded. If the queue is full, the least
+ * important packet is discarded and counted as an overflow.
+ * msg_id should be from m3can_msgs.h
  * can_rtr is the "remote transmission request", set to indicate you're asking
  *         for data rather than sending it
  * data[] and datalen are the data (and number of bytes of it) to send.
@@ -142,6 +93,12 @@ void m3can_send_i16(int16_t msg_id, int16_t d0, int16_t d1, int16_t d2,
 void m3can_send_i32(int16_t msg_id, int32_t d0, int32_t d1, size_t n);
 void m3can_send_f32(uint16_t msg_id, float d0, float d1, size_t n);
 
+/* Read the number of packets lost to a full TX queue (`overflows`) and
+ * discarded after waiting too long for the bus (`dropped`) since startup.
+ * Both are also reported as M3STATUS_COMPONENT_CAN errors through m3status.
+ */
+void m3can_get_tx_stats(uint32_t* overflows, uint32_t* dropped);
+
 /* Enable processing all sent messages (via m3can_send) as though they were
  * also received (in m3can_recv).
  * Useful for boards like datalogger and radio which want to receive their own
@@ -149,5 +106,10 @@ void m3can_send_f32(uint16_t msg_id, float d0, float d1, size_t n);
  */
 void m3can_set_loopback(bool enabled);
 
+/* Message IDs, payload structs and m3can_send_<board>_<message>() packers,
+ * generated from messages.yaml by gen_messages.py.
+ */
+#include "m3can_msgs.h"
+
 #endif /* _M3CAN_H */
 
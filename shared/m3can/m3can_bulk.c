@@ -0,0 +1,445 @@
+/*
+ * Segmented bulk transfer over CAN
+ * Cambridge University Spaceflight
+ *
+ * See m3can_bulk.h for the protocol.
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "m3can.h"
+#include "m3can_bulk.h"
+
+/* Longest blob a first frame can describe */
+#define M3CAN_BULK_MAX_LEN  (0xFFFF)
+
+/* Data bytes in each frame type */
+#define M3CAN_BULK_SF_DATA  (6)
+#define M3CAN_BULK_FF_DATA  (4)
+#define M3CAN_BULK_CF_DATA  (7)
+
+/* A port we receive on, and the transfer into it in progress, if any.
+ * Only touched by the CAN RX thread once registered.
+ */
+struct m3can_bulk_rx {
+    uint8_t port;
+    uint8_t* buf;
+    size_t size;
+    m3can_bulk_rx_cb cb;
+
+    bool active;
+    uint8_t src;
+    uint8_t sn;
+    uint8_t window;
+    uint16_t len;
+    uint16_t got;
+    systime_t last;
+};
+
+/* A port we answer requests for */
+struct m3can_bulk_tx {
+    uint8_t port;
+    uint8_t* buf;
+    size_t size;
+    m3can_bulk_tx_cb cb;
+};
+
+static struct m3can_bulk_rx m3can_bulk_rx_ports[M3CAN_BULK_MAX_PORTS];
+static size_t m3can_bulk_num_rx;
+static struct m3can_bulk_tx m3can_bulk_tx_ports[M3CAN_BULK_MAX_PORTS];
+static size_t m3can_bulk_num_tx;
+
+/* Held for the duration of each m3can_bulk_send */
+static BSEMAPHORE_DECL(m3can_bulk_tx_lock, false);
+
+/* The receiver of the blob being sent, and its last flow control frame,
+ * signalled through m3can_bulk_fc_sem. Protected by the system lock.
+ */
+static BSEMAPHORE_DECL(m3can_bulk_fc_sem, true);
+static uint8_t m3can_bulk_tx_dest;
+static uint8_t m3can_bulk_fc_status;
+static uint8_t m3can_bulk_fc_bs;
+static uint8_t m3can_bulk_fc_stmin;
+
+/* Requests waiting for the bulk thread, as (board << 8) | port */
+static msg_t m3can_bulk_requests_buf[4];
+static MAILBOX_DECL(m3can_bulk_requests, m3can_bulk_requests_buf,
+                    sizeof(m3can_bulk_requests_buf)/sizeof(msg_t));
+
+
+static void m3can_bulk_send_fc(uint8_t board, uint8_t status, uint8_t bs,
+                               uint8_t stmin)
+{
+    uint8_t frame[4] = {M3CAN_BULK_FC | status, board, bs, stmin};
+    m3can_send(m3can_own_id | CAN_MSG_ID_BULK_FLOW, false, frame,
+               sizeof(frame));
+}
+
+static struct m3can_bulk_rx* m3can_bulk_find_rx(uint8_t port)
+{
+    for(size_t i=0; i<m3can_bulk_num_rx; i++) {
+        if(m3can_bulk_rx_ports[i].port == port) {
+            return &m3can_bulk_rx_ports[i];
+        }
+    }
+    return NULL;
+}
+
+static struct m3can_bulk_tx* m3can_bulk_find_tx(uint8_t port)
+{
+    for(size_t i=0; i<m3can_bulk_num_tx; i++) {
+        if(m3can_bulk_tx_ports[i].port == port) {
+            return &m3can_bulk_tx_ports[i];
+        }
+    }
+    return NULL;
+}
+
+/* Each board sends one blob at a time, so a single or first frame from
+ * `src` to anyone means it has given up on any blob it was sending us.
+ */
+static void m3can_bulk_cancel_from(uint8_t src)
+{
+    for(size_t i=0; i<m3can_bulk_num_rx; i++) {
+        if(m3can_bulk_rx_ports[i].active &&
+           m3can_bulk_rx_ports[i].src == src) {
+            m3can_bulk_rx_ports[i].active = false;
+        }
+    }
+}
+
+static void m3can_bulk_rx_single(uint8_t src, const uint8_t* data,
+                                 uint8_t dlc)
+{
+    struct m3can_bulk_rx* rx = m3can_bulk_find_rx(data[1]);
+    size_t len = dlc - 2;
+
+    if(rx == NULL || len == 0 || (rx->buf != NULL && len > rx->size)) {
+        return;
+    }
+
+    if(rx->buf != NULL) {
+        memcpy(rx->buf, &data[2], len);
+    }
+    if(rx->cb != NULL) {
+        rx->cb(src, rx->port, rx->buf, len);
+    }
+}
+
+static void m3can_bulk_rx_first(uint8_t src, const uint8_t* data,
+                                uint8_t dlc)
+{
+    struct m3can_bulk_rx* rx = m3can_bulk_find_rx(data[1]);
+    uint16_t len = data[2] | (data[3] << 8);
+
+    if(dlc != 8) {
+        return;
+    }
+
+    if(rx == NULL) {
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_ABORT, M3CAN_BULK_ABORT_PORT, 0);
+        return;
+    }
+
+    if(len <= M3CAN_BULK_SF_DATA || (rx->buf != NULL && len > rx->size)) {
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_ABORT,
+                           M3CAN_BULK_ABORT_LENGTH, 0);
+        return;
+    }
+
+    /* A sender which has gone quiet loses the port to a new one */
+    if(rx->active &&
+       ST2MS(chVTTimeElapsedSinceX(rx->last)) < M3CAN_BULK_TIMEOUT_MS) {
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_ABORT, M3CAN_BULK_ABORT_BUSY, 0);
+        return;
+    }
+
+    rx->active = true;
+    rx->src = src;
+    rx->sn = 1;
+    rx->window = M3CAN_BULK_BLOCK_SIZE;
+    rx->len = len;
+    rx->got = M3CAN_BULK_FF_DATA;
+    rx->last = chVTGetSystemTimeX();
+    if(rx->buf != NULL) {
+        memcpy(rx->buf, &data[4], M3CAN_BULK_FF_DATA);
+    }
+
+    m3can_bulk_send_fc(src, M3CAN_BULK_FC_CTS, M3CAN_BULK_BLOCK_SIZE,
+                       M3CAN_BULK_STMIN_MS);
+}
+
+static void m3can_bulk_rx_consecutive(uint8_t src, const uint8_t* data,
+                                      uint8_t dlc)
+{
+    struct m3can_bulk_rx* rx = NULL;
+    size_t n;
+
+    for(size_t i=0; i<m3can_bulk_num_rx; i++) {
+        if(m3can_bulk_rx_ports[i].active &&
+           m3can_bulk_rx_ports[i].src == src) {
+            rx = &m3can_bulk_rx_ports[i];
+            break;
+        }
+    }
+
+    if(rx == NULL) {
+        return;
+    }
+
+    n = rx->len - rx->got;
+    if(n > M3CAN_BULK_CF_DATA) {
+        n = M3CAN_BULK_CF_DATA;
+    }
+
+    if((data[0] & 0x0F) != (rx->sn & 0x0F) || dlc < n + 1) {
+        rx->active = false;
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_ABORT,
+                           M3CAN_BULK_ABORT_SEQUENCE, 0);
+        return;
+    }
+
+    if(rx->buf != NULL) {
+        memcpy(&rx->buf[rx->got], &data[1], n);
+    }
+    rx->got += n;
+    rx->sn++;
+    rx->last = chVTGetSystemTimeX();
+
+    if(rx->got == rx->len) {
+        rx->active = false;
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_DONE, 0, 0);
+        if(rx->cb != NULL) {
+            rx->cb(src, rx->port, rx->buf, rx->len);
+        }
+    } else if(--rx->window == 0) {
+        rx->window = M3CAN_BULK_BLOCK_SIZE;
+        m3can_bulk_send_fc(src, M3CAN_BULK_FC_CTS, M3CAN_BULK_BLOCK_SIZE,
+                           M3CAN_BULK_STMIN_MS);
+    }
+}
+
+void m3can_bulk_frame(uint16_t sid, const uint8_t* data, uint8_t dlc)
+{
+    uint16_t msg = sid & ~0x1F;
+    uint8_t src = sid & 0x1F;
+
+    if(dlc < 1 || src == m3can_own_id) {
+        return;
+    }
+
+    if(msg == CAN_MSG_ID_BULK_DATA) {
+        uint8_t type = data[0] & 0xF0;
+        uint8_t dest = data[0] & 0x0F;
+
+        if(type == M3CAN_BULK_CF) {
+            m3can_bulk_rx_consecutive(src, data, dlc);
+        } else if(type == M3CAN_BULK_SF || type == M3CAN_BULK_FF) {
+            m3can_bulk_cancel_from(src);
+            if(dest != m3can_own_id || dlc < 2) {
+                return;
+            }
+            if(type == M3CAN_BULK_SF) {
+                m3can_bulk_rx_single(src, data, dlc);
+            } else {
+                m3can_bulk_rx_first(src, data, dlc);
+            }
+        }
+    } else if(msg == CAN_MSG_ID_BULK_FLOW) {
+        uint8_t type = data[0] & 0xF0;
+
+        if(dlc < 3 || data[1] != m3can_own_id) {
+            return;
+        }
+
+        if(type == M3CAN_BULK_FC && dlc == 4) {
+            chSysLock();
+            if(src == m3can_bulk_tx_dest) {
+                m3can_bulk_fc_status = data[0] & 0x0F;
+                m3can_bulk_fc_bs = data[2];
+                m3can_bulk_fc_stmin = data[3];
+                chBSemSignalI(&m3can_bulk_fc_sem);
+                chSchRescheduleS();
+            }
+            chSysUnlock();
+        } else if(type == M3CAN_BULK_RQ) {
+            if(m3can_bulk_find_tx(data[2]) != NULL) {
+                /* Requests beyond what the mailbox holds are dropped */
+                chMBPost(&m3can_bulk_requests, (src << 8) | data[2],
+                         TIME_IMMEDIATE);
+            }
+        }
+    }
+}
+
+/* Send the consecutive frames after the first, in the windows the
+ * receiver asks for, until it reports the blob done or aborts.
+ */
+static m3can_bulk_result_t m3can_bulk_send_segmented(const uint8_t* data,
+                                                     size_t len)
+{
+    size_t pos = M3CAN_BULK_FF_DATA;
+    uint8_t sn = 1;
+    uint8_t frame[8];
+
+    while(true) {
+        uint8_t status, bs, stmin;
+
+        if(chBSemWaitTimeout(&m3can_bulk_fc_sem,
+                             MS2ST(M3CAN_BULK_TIMEOUT_MS)) != MSG_OK) {
+            return M3CAN_BULK_TIMEOUT;
+        }
+
+        chSysLock();
+        status = m3can_bulk_fc_status;
+        bs = m3can_bulk_fc_bs;
+        stmin = m3can_bulk_fc_stmin;
+        chSysUnlock();
+
+        if(status == M3CAN_BULK_FC_DONE) {
+            return pos == len ? M3CAN_BULK_OK : M3CAN_BULK_ABORTED;
+        } else if(status != M3CAN_BULK_FC_CTS) {
+            return M3CAN_BULK_ABORTED;
+        }
+
+        /* STmin is in milliseconds up to 127, as ISO-TP */
+        if(stmin > 127) {
+            stmin = 127;
+        }
+
+        for(uint8_t i=0; pos < len && (bs == 0 || i < bs); i++) {
+            size_t n = len - pos;
+            if(n > M3CAN_BULK_CF_DATA) {
+                n = M3CAN_BULK_CF_DATA;
+            }
+
+            frame[0] = M3CAN_BULK_CF | (sn++ & 0x0F);
+            memcpy(&frame[1], &data[pos], n);
+            m3can_send(m3can_own_id | CAN_MSG_ID_BULK_DATA, false, frame,
+                       n + 1);
+            pos += n;
+
+            if(stmin > 0 && pos < len) {
+                chThdSleepMilliseconds(stmin);
+            }
+        }
+    }
+}
+
+m3can_bulk_result_t m3can_bulk_send(uint8_t dest, uint8_t port,
+                                    const uint8_t* data, size_t len)
+{
+    m3can_bulk_result_t rv;
+    uint8_t frame[8];
+
+    if(len == 0 || len > M3CAN_BULK_MAX_LEN) {
+        return M3CAN_BULK_INVALID;
+    }
+
+    chBSemWait(&m3can_bulk_tx_lock);
+
+    frame[0] = (len <= M3CAN_BULK_SF_DATA ? M3CAN_BULK_SF : M3CAN_BULK_FF) |
+               (dest & 0x0F);
+    frame[1] = port;
+
+    if(len <= M3CAN_BULK_SF_DATA) {
+        memcpy(&frame[2], data, len);
+        m3can_send(m3can_own_id | CAN_MSG_ID_BULK_DATA, false, frame,
+                   len + 2);
+        rv = M3CAN_BULK_OK;
+    } else {
+        frame[2] = len & 0xFF;
+        frame[3] = len >> 8;
+        memcpy(&frame[4], data, M3CAN_BULK_FF_DATA);
+
+        chSysLock();
+        m3can_bulk_tx_dest = dest;
+        chSysUnlock();
+        chBSemReset(&m3can_bulk_fc_sem, true);
+
+        m3can_send(m3can_own_id | CAN_MSG_ID_BULK_DATA, false, frame, 8);
+        rv = m3can_bulk_send_segmented(data, len);
+
+        chSysLock();
+        m3can_bulk_tx_dest = 0;
+        chSysUnlock();
+    }
+
+    chBSemSignal(&m3can_bulk_tx_lock);
+
+    return rv;
+}
+
+void m3can_bulk_request(uint8_t dest, uint8_t port)
+{
+    uint8_t frame[3] = {M3CAN_BULK_RQ, dest, port};
+    m3can_send(m3can_own_id | CAN_MSG_ID_BULK_FLOW, false, frame,
+               sizeof(frame));
+}
+
+void m3can_bulk_register_rx(uint8_t port, uint8_t* buf, size_t size,
+                            m3can_bulk_rx_cb cb)
+{
+    chDbgAssert(m3can_bulk_num_rx < M3CAN_BULK_MAX_PORTS,
+                "too many bulk RX ports");
+
+    struct m3can_bulk_rx* rx = &m3can_bulk_rx_ports[m3can_bulk_num_rx];
+    rx->port = port;
+    rx->buf = buf;
+    rx->size = buf != NULL ? size : M3CAN_BULK_MAX_LEN;
+    rx->cb = cb;
+    rx->active = false;
+
+    chSysLock();
+    m3can_bulk_num_rx++;
+    chSysUnlock();
+}
+
+void m3can_bulk_register_tx(uint8_t port, uint8_t* buf, size_t size,
+                            m3can_bulk_tx_cb cb)
+{
+    chDbgAssert(m3can_bulk_num_tx < M3CAN_BULK_MAX_PORTS,
+                "too many bulk TX ports");
+
+    struct m3can_bulk_tx* tx = &m3can_bulk_tx_ports[m3can_bulk_num_tx];
+    tx->port = port;
+    tx->buf = buf;
+    tx->size = size;
+    tx->cb = cb;
+
+    chSysLock();
+    m3can_bulk_num_tx++;
+    chSysUnlock();
+}
+
+static THD_WORKING_AREA(m3can_bulk_thd_wa, 384);
+static THD_FUNCTION(m3can_bulk_thd, arg) {
+    (void)arg;
+
+    msg_t request;
+
+    chRegSetThreadName("bulk");
+
+    while(true) {
+        if(chMBFetch(&m3can_bulk_requests, &request,
+                     TIME_INFINITE) != MSG_OK) {
+            continue;
+        }
+
+        uint8_t board = (request >> 8) & 0xFF;
+        struct m3can_bulk_tx* tx = m3can_bulk_find_tx(request & 0xFF);
+        if(tx == NULL) {
+            continue;
+        }
+
+        size_t len = tx->cb(tx->port, tx->buf, tx->size);
+        m3can_bulk_send(board, tx->port, tx->buf, len);
+    }
+}
+
+void m3can_bulk_init(void)
+{
+    chThdCreateStatic(m3can_bulk_thd_wa, sizeof(m3can_bulk_thd_wa),
+                      LOWPRIO, m3can_bulk_thd, NULL);
+}
@@ -0,0 +1,137 @@
+#ifndef _M3CAN_BULK_H
+#define _M3CAN_BULK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "ch.h"
+
+/* Segmented transfer of blobs up to 64kB between boards, after ISO 15765-2
+ * (ISO-TP).
+ *
+ * Data goes in CAN_MSG_ID_BULK_DATA frames sent with the sender's board ID,
+ * and the receiver paces it with CAN_MSG_ID_BULK_FLOW frames sent with its
+ * own. The first byte of each frame is a type in the high nibble:
+ *
+ *  SF  0x0D PORT data[0-6]                 whole blob of up to 6 bytes
+ *  FF  0x1D PORT LEN_LO LEN_HI data[4]     first frame of a longer blob
+ *  CF  0x2N data[1-7]                      consecutive frame, N = 1, 2, ...
+ *                                          mod 16
+ *  FC  0x3S BOARD BS STMIN                 flow control to BOARD
+ *  RQ  0x40 BOARD PORT                     ask BOARD to send PORT
+ *
+ * where D is the destination board ID and PORT says what the blob is, from
+ * the list below. After a first frame the sender waits for a flow control
+ * frame with status CTS, then sends BS consecutive frames at least STMIN
+ * milliseconds apart before waiting for the next one (BS 0 means the rest
+ * of the blob). So the receiver sets the window and the sender never has
+ * more than one window queued, which keeps bulk traffic from crowding out
+ * other frames in the TX queue or on the bus. Once the last consecutive
+ * frame arrives the receiver sends status DONE, or ABORT at any point with
+ * a reason in BS. Consecutive frames carry no destination, so each board
+ * sends one blob at a time.
+ *
+ * Single frames are not acknowledged, and neither side retransmits: a lost
+ * frame aborts the transfer, which the caller may retry.
+ *
+ * Received blobs are reassembled in the RX thread, and requests are served
+ * by a thread started with m3can_bulk_init(). Every board which sends or
+ * receives blobs needs CAN_MSG_ID_BULK_DATA and CAN_MSG_ID_BULK_FLOW from
+ * the boards it talks to in its receive filters, which messages.yaml lists
+ * under the common messages' receivers.
+ */
+
+/* What a blob contains */
+#define M3CAN_BULK_PORT_M3FC_CONFIG         (1)
+#define M3CAN_BULK_PORT_SI446X_PARAMS       (2)
+#define M3CAN_BULK_PORT_M3FC_ACCEL_BURST    (3)
+
+/* Frame types */
+#define M3CAN_BULK_SF       (0x00)
+#define M3CAN_BULK_FF       (0x10)
+#define M3CAN_BULK_CF       (0x20)
+#define M3CAN_BULK_FC       (0x30)
+#define M3CAN_BULK_RQ       (0x40)
+
+/* Flow control status */
+#define M3CAN_BULK_FC_CTS   (0)
+#define M3CAN_BULK_FC_DONE  (1)
+#define M3CAN_BULK_FC_ABORT (2)
+
+/* Abort reasons, sent in the BS byte of an ABORT */
+#define M3CAN_BULK_ABORT_PORT       (1)
+#define M3CAN_BULK_ABORT_LENGTH     (2)
+#define M3CAN_BULK_ABORT_BUSY       (3)
+#define M3CAN_BULK_ABORT_SEQUENCE   (4)
+
+/* Window and frame spacing a receiver asks for */
+#ifndef M3CAN_BULK_BLOCK_SIZE
+#define M3CAN_BULK_BLOCK_SIZE       (8)
+#endif
+#ifndef M3CAN_BULK_STMIN_MS
+#define M3CAN_BULK_STMIN_MS         (1)
+#endif
+
+/* Either side gives up after this long without hearing from the other */
+#define M3CAN_BULK_TIMEOUT_MS       (1000)
+
+/* Ports this board may register to send or receive */
+#define M3CAN_BULK_MAX_PORTS        (4)
+
+typedef enum {
+    M3CAN_BULK_OK = 0,
+    /* Nothing heard from the receiver for M3CAN_BULK_TIMEOUT_MS */
+    M3CAN_BULK_TIMEOUT,
+    /* The receiver refused or abandoned the blob */
+    M3CAN_BULK_ABORTED,
+    /* The blob is empty or too long */
+    M3CAN_BULK_INVALID,
+} m3can_bulk_result_t;
+
+/* Called from the CAN RX thread with a complete blob from board `src`.
+ * `data` is the buffer given to m3can_bulk_register_rx, or NULL if that
+ * was NULL.
+ */
+typedef void (*m3can_bulk_rx_cb)(uint8_t src, uint8_t port,
+                                 const uint8_t* data, size_t len);
+
+/* Called from the bulk thread to fill `buf`, of `size` bytes, with the blob
+ * for `port`. Returns its length.
+ */
+typedef size_t (*m3can_bulk_tx_cb)(uint8_t port, uint8_t* buf, size_t size);
+
+/* Accept blobs of up to `size` bytes for `port` into `buf`, calling `cb`
+ * with each. A NULL `buf` accepts blobs of any length without storing
+ * them, for boards like the datalogger which only need the frames to flow.
+ */
+void m3can_bulk_register_rx(uint8_t port, uint8_t* buf, size_t size,
+                            m3can_bulk_rx_cb cb);
+
+/* Answer requests for `port` with whatever `cb` writes into `buf`, of
+ * `size` bytes.
+ */
+void m3can_bulk_register_tx(uint8_t port, uint8_t* buf, size_t size,
+                            m3can_bulk_tx_cb cb);
+
+/* Send the `len` byte blob `data` to board `dest` as `port`, waiting until
+ * the receiver confirms it. May be called from any thread but the CAN RX
+ * thread; concurrent calls are sent one after another.
+ */
+m3can_bulk_result_t m3can_bulk_send(uint8_t dest, uint8_t port,
+                                    const uint8_t* data, size_t len);
+
+/* Ask board `dest` to send us `port`. The blob arrives through the
+ * callback registered for it here.
+ */
+void m3can_bulk_request(uint8_t dest, uint8_t port);
+
+/* Handle a bulk frame from the bus. Called by m3can. */
+void m3can_bulk_frame(uint16_t sid, const uint8_t* data, uint8_t dlc);
+
+/* Start the thread which answers requests. Call after m3can_init() and
+ * registering ports, on boards which register any for sending.
+ */
+void m3can_bulk_init(void);
+
+#endif /* _M3CAN_BULK_H */
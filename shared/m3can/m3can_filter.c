@@ -0,0 +1,463 @@
+/*
+ * CAN acceptance filter planner
+ * M3 shared
+ * Cambridge University Spaceflight
+ *
+ * Each board passes m3can_init the exact CAN IDs it wants to receive, and
+ * this packs them into the STM32's filter banks so frames for other boards
+ * are dropped in hardware instead of costing an RX interrupt and a
+ * m3can_recv call each.
+ *
+ * The IDs are first grouped into "cubes": sets of IDs that differ only in a
+ * few don't-care bits, such as a run of aligned message IDs or the same
+ * message from several boards. Each ID is grown greedily one bit at a time
+ * while every ID in the cube is still wanted, then each cube is shrunk back
+ * to the IDs no other cube covers. Cubes of four or more IDs go
+ * in 16 bit mask filters (two per bank), single IDs in 16 bit list filters
+ * (four per bank), and pairs go whichever way fills the last banks best.
+ * 32 bit filters only add extended ID bits, which M3 doesn't use, so they
+ * are only used for the accept-everything fallback.
+ */
+
+#include "m3can_filter.h"
+
+#define M3CAN_FILTER_SID_MASK       (0x7FF)
+#define M3CAN_FILTER_BOARD_MASK     (0x1F)
+#define M3CAN_FILTER_MSG_MASK       (0x7E0)
+
+/* 16 bit filter fields: STDID[10:0] RTR IDE EXID[17:15] */
+#define M3CAN_FILTER_F16_RTR        (0x0010)
+#define M3CAN_FILTER_F16_IDE        (0x0008)
+#define M3CAN_FILTER_F16_EXACT      (0xFFF8)
+
+/* IDs that differ from `id` only in the `dontcare` bits. With `rtr` set,
+ * remote frames are accepted as well as data frames.
+ */
+struct m3can_filter_cube {
+    uint16_t id;
+    uint16_t dontcare;
+    bool rtr;
+};
+
+/* Requested IDs sorted by SID, with M3CAN_FILTER_RTR flags */
+static uint16_t m3can_filter_ids[M3CAN_FILTER_MAX_IDS];
+static size_t m3can_filter_num_ids;
+
+static struct m3can_filter_cube m3can_filter_cubes[M3CAN_FILTER_MAX_IDS];
+static size_t m3can_filter_num_cubes;
+
+static int m3can_filter_find(uint16_t sid)
+{
+    size_t lo = 0, hi = m3can_filter_num_ids;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint16_t mid_sid = m3can_filter_ids[mid] & M3CAN_FILTER_SID_MASK;
+        if(mid_sid < sid) {
+            lo = mid + 1;
+        } else if(mid_sid > sid) {
+            hi = mid;
+        } else {
+            return (int)mid;
+        }
+    }
+    return -1;
+}
+
+/* True if frames with `sid` (and remote frames, if `rtr`) must pass,
+ * either because they were asked for or because their board is widened.
+ */
+static bool m3can_filter_wanted(uint16_t sid, bool rtr, uint32_t widened)
+{
+    if(widened & (1UL << (sid & M3CAN_FILTER_BOARD_MASK))) {
+        return true;
+    }
+    int i = m3can_filter_find(sid);
+    return i >= 0 && (!rtr || (m3can_filter_ids[i] & M3CAN_FILTER_RTR));
+}
+
+static bool m3can_filter_cube_wanted(uint16_t id, uint16_t dontcare, bool rtr,
+                                     uint32_t widened)
+{
+    uint32_t s = 0;
+
+    /* Visit every subset of the don't-care bits */
+    while(true) {
+        if(!m3can_filter_wanted(id | s, rtr, widened)) {
+            return false;
+        }
+        if(s == dontcare) {
+            return true;
+        }
+        s = (s - dontcare) & dontcare;
+    }
+}
+
+/* True if a cube other than `skip` passes `sid` (and its remote frames) */
+static bool m3can_filter_covered(uint16_t sid, bool rtr, size_t skip)
+{
+    for(size_t i=0; i<m3can_filter_num_cubes; i++) {
+        const struct m3can_filter_cube* c = &m3can_filter_cubes[i];
+        if(i == skip) {
+            continue;
+        }
+        if(((sid ^ c->id) & ~c->dontcare & M3CAN_FILTER_SID_MASK) == 0 &&
+           (c->rtr || !rtr)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void m3can_filter_build_cubes(uint32_t widened)
+{
+    m3can_filter_num_cubes = 0;
+
+    /* Widened boards accept every message and remote frame */
+    for(uint16_t board=0; board<=M3CAN_FILTER_BOARD_MASK; board++) {
+        if(widened & (1UL << board)) {
+            struct m3can_filter_cube* c =
+                &m3can_filter_cubes[m3can_filter_num_cubes++];
+            c->id = board;
+            c->dontcare = M3CAN_FILTER_MSG_MASK;
+            c->rtr = true;
+        }
+    }
+
+    for(size_t i=0; i<m3can_filter_num_ids; i++) {
+        uint16_t sid = m3can_filter_ids[i] & M3CAN_FILTER_SID_MASK;
+        bool rtr = (m3can_filter_ids[i] & M3CAN_FILTER_RTR) != 0;
+        uint16_t dontcare = 0;
+
+        if(m3can_filter_covered(sid, rtr, SIZE_MAX)) {
+            continue;
+        }
+
+        for(int bit=0; bit<11; bit++) {
+            uint16_t grown = dontcare | (1 << bit);
+            if(m3can_filter_cube_wanted(sid & ~grown, grown, rtr, widened)) {
+                dontcare = grown;
+            }
+        }
+
+        struct m3can_filter_cube* c =
+            &m3can_filter_cubes[m3can_filter_num_cubes++];
+        c->id = sid & ~dontcare;
+        c->dontcare = dontcare;
+        c->rtr = rtr;
+    }
+}
+
+/*
+ * Growing each cube as far as it goes leaves them overlapping, so shrink
+ * each to just cover the IDs no other cube does, and drop any left empty.
+ * Smaller cubes can then go in list filters where that packs better.
+ */
+static void m3can_filter_reduce_cubes(void)
+{
+    size_t i = 0;
+    while(i < m3can_filter_num_cubes) {
+        struct m3can_filter_cube* c = &m3can_filter_cubes[i];
+        uint16_t first = 0, dontcare = 0;
+        bool any = false;
+        uint32_t s = 0;
+
+        while(true) {
+            uint16_t sid = c->id | s;
+            if(!m3can_filter_covered(sid, c->rtr, i)) {
+                if(!any) {
+                    first = sid;
+                    any = true;
+                }
+                dontcare |= sid ^ first;
+            }
+            if(s == c->dontcare) {
+                break;
+            }
+            s = (s - c->dontcare) & c->dontcare;
+        }
+
+        if(any) {
+            c->id = first & ~dontcare;
+            c->dontcare = dontcare;
+            i++;
+        } else {
+            m3can_filter_cubes[i] =
+                m3can_filter_cubes[--m3can_filter_num_cubes];
+        }
+    }
+}
+
+/* Number of list filter entries needed to hold cube `c` */
+static size_t m3can_filter_cube_entries(const struct m3can_filter_cube* c)
+{
+    return (1UL << __builtin_popcount(c->dontcare)) * (c->rtr ? 2 : 1);
+}
+
+static size_t m3can_filter_count_banks(size_t mask_slots, size_t entries)
+{
+    /* An odd mask slot out can hold one list entry as an exact match */
+    size_t spare = mask_slots & 1;
+    size_t listed = entries > spare ? entries - spare : 0;
+    return (mask_slots + 1) / 2 + (listed + 3) / 4;
+}
+
+/*
+ * Decide how many of the two-entry cubes to list rather than mask, to use
+ * the fewest banks. Sets `listed_pairs` and returns the number of banks.
+ */
+static size_t m3can_filter_layout(size_t* listed_pairs)
+{
+    size_t masks = 0, pairs = 0, singles = 0;
+
+    for(size_t i=0; i<m3can_filter_num_cubes; i++) {
+        size_t e = m3can_filter_cube_entries(&m3can_filter_cubes[i]);
+        if(e == 1) {
+            singles++;
+        } else if(e == 2) {
+            pairs++;
+        } else {
+            masks++;
+        }
+    }
+
+    size_t best = SIZE_MAX;
+    for(size_t k=0; k<=pairs; k++) {
+        size_t n = m3can_filter_count_banks(masks + pairs - k,
+                                            singles + 2 * k);
+        if(n < best) {
+            best = n;
+            *listed_pairs = k;
+        }
+    }
+    return best;
+}
+
+static uint16_t m3can_filter_mask16(const struct m3can_filter_cube* c)
+{
+    uint16_t mask = ((~c->dontcare & M3CAN_FILTER_SID_MASK) << 5)
+                    | M3CAN_FILTER_F16_IDE;
+    if(!c->rtr) {
+        mask |= M3CAN_FILTER_F16_RTR;
+    }
+    return mask;
+}
+
+static void m3can_filter_set_half(struct m3can_filter_bank* bank, int half,
+                                  uint16_t field)
+{
+    uint32_t* reg = half < 2 ? &bank->register1 : &bank->register2;
+    if(half & 1) {
+        *reg = (*reg & 0x0000FFFF) | ((uint32_t)field << 16);
+    } else {
+        *reg = (*reg & 0xFFFF0000) | field;
+    }
+}
+
+/* Writes mask slots, then list entries, into banks */
+struct m3can_filter_writer {
+    struct m3can_filter_bank* banks;
+    size_t mask_banks;
+    size_t mask_slot;
+    size_t list_slot;
+};
+
+static void m3can_filter_put_mask(struct m3can_filter_writer* w,
+                                  uint16_t id, uint16_t mask)
+{
+    struct m3can_filter_bank* bank = &w->banks[w->mask_slot / 2];
+    bank->mode = M3CAN_FILTER_MODE_MASK;
+    bank->scale = M3CAN_FILTER_SCALE_16;
+    m3can_filter_set_half(bank, 2 * (w->mask_slot & 1), id);
+    m3can_filter_set_half(bank, 2 * (w->mask_slot & 1) + 1, mask);
+    w->mask_slot++;
+}
+
+static void m3can_filter_put_entry(struct m3can_filter_writer* w,
+                                   uint16_t field)
+{
+    /* Use up the spare slot in the last mask bank first */
+    if(w->mask_slot & 1) {
+        m3can_filter_put_mask(w, field, M3CAN_FILTER_F16_EXACT);
+        return;
+    }
+
+    struct m3can_filter_bank* bank =
+        &w->banks[w->mask_banks + w->list_slot / 4];
+    bank->mode = M3CAN_FILTER_MODE_LIST;
+    bank->scale = M3CAN_FILTER_SCALE_16;
+    m3can_filter_set_half(bank, w->list_slot & 3, field);
+    w->list_slot++;
+}
+
+static void m3can_filter_put_cube_entries(struct m3can_filter_writer* w,
+                                          const struct m3can_filter_cube* c)
+{
+    uint32_t s = 0;
+    while(true) {
+        uint16_t field = (uint16_t)((c->id | s) << 5);
+        m3can_filter_put_entry(w, field);
+        if(c->rtr) {
+            m3can_filter_put_entry(w, field | M3CAN_FILTER_F16_RTR);
+        }
+        if(s == c->dontcare) {
+            break;
+        }
+        s = (s - c->dontcare) & c->dontcare;
+    }
+}
+
+static size_t m3can_filter_write(struct m3can_filter_bank* banks,
+                                 size_t listed_pairs)
+{
+    struct m3can_filter_writer w = {.banks = banks};
+    size_t mask_slots = 0, pairs = 0;
+
+    /* Work out which cubes are masked, to know where list banks start */
+    for(size_t i=0; i<m3can_filter_num_cubes; i++) {
+        size_t e = m3can_filter_cube_entries(&m3can_filter_cubes[i]);
+        if(e > 2 || (e == 2 && pairs++ >= listed_pairs)) {
+            mask_slots++;
+        }
+    }
+    w.mask_banks = (mask_slots + 1) / 2;
+
+    pairs = 0;
+    for(size_t i=0; i<m3can_filter_num_cubes; i++) {
+        const struct m3can_filter_cube* c = &m3can_filter_cubes[i];
+        size_t e = m3can_filter_cube_entries(c);
+        if(e > 2 || (e == 2 && pairs++ >= listed_pairs)) {
+            m3can_filter_put_mask(&w, c->id << 5, m3can_filter_mask16(c));
+        }
+    }
+
+    pairs = 0;
+    for(size_t i=0; i<m3can_filter_num_cubes; i++) {
+        const struct m3can_filter_cube* c = &m3can_filter_cubes[i];
+        size_t e = m3can_filter_cube_entries(c);
+        if(e == 1 || (e == 2 && pairs++ < listed_pairs)) {
+            m3can_filter_put_cube_entries(&w, c);
+        }
+    }
+
+    /* Fill unused halves by repeating a filter already in the bank */
+    if(w.mask_slot & 1) {
+        banks[w.mask_slot / 2].register2 = banks[w.mask_slot / 2].register1;
+    }
+    if(w.list_slot & 3) {
+        struct m3can_filter_bank* bank = &banks[w.mask_banks + w.list_slot/4];
+        uint16_t last = bank->register1 & 0xFFFF;
+        for(int half=w.list_slot & 3; half<4; half++) {
+            m3can_filter_set_half(bank, half, last);
+        }
+    }
+
+    return w.mask_banks + (w.list_slot + 3) / 4;
+}
+
+/* Non-widened board with the most requested IDs, or -1 if none are left */
+static int m3can_filter_busiest_board(uint32_t widened)
+{
+    size_t counts[M3CAN_FILTER_BOARD_MASK + 1] = {0};
+    size_t most = 0;
+    int busiest = -1;
+
+    for(size_t i=0; i<m3can_filter_num_ids; i++) {
+        counts[m3can_filter_ids[i] & M3CAN_FILTER_BOARD_MASK]++;
+    }
+    for(int board=0; board<=M3CAN_FILTER_BOARD_MASK; board++) {
+        if(!(widened & (1UL << board)) && counts[board] > most) {
+            most = counts[board];
+            busiest = board;
+        }
+    }
+    return busiest;
+}
+
+m3can_filter_result_t m3can_filter_plan(const uint16_t* ids, size_t n,
+                                        struct m3can_filter_bank* banks,
+                                        size_t max_banks, size_t* num_banks)
+{
+    uint32_t widened = 0;
+
+    if(n <= M3CAN_FILTER_MAX_IDS) {
+        /* Insertion sort by SID, merging duplicates */
+        m3can_filter_num_ids = 0;
+        for(size_t i=0; i<n; i++) {
+            uint16_t id = ids[i] & (M3CAN_FILTER_SID_MASK | M3CAN_FILTER_RTR);
+            uint16_t sid = id & M3CAN_FILTER_SID_MASK;
+            int dup = m3can_filter_find(sid);
+            if(dup >= 0) {
+                m3can_filter_ids[dup] |= id;
+                continue;
+            }
+            size_t j = m3can_filter_num_ids++;
+            while(j > 0 &&
+                  (m3can_filter_ids[j-1] & M3CAN_FILTER_SID_MASK) > sid) {
+                m3can_filter_ids[j] = m3can_filter_ids[j-1];
+                j--;
+            }
+            m3can_filter_ids[j] = id;
+        }
+
+        while(true) {
+            size_t listed_pairs = 0;
+            m3can_filter_build_cubes(widened);
+            m3can_filter_reduce_cubes();
+            if(m3can_filter_layout(&listed_pairs) <= max_banks) {
+                *num_banks = m3can_filter_write(banks, listed_pairs);
+                return widened ? M3CAN_FILTER_WIDENED : M3CAN_FILTER_EXACT;
+            }
+
+            int board = m3can_filter_busiest_board(widened);
+            if(board < 0) {
+                break;
+            }
+            widened |= 1UL << board;
+        }
+    }
+
+    /* Nothing fits, so accept everything with one 32 bit mask of zero */
+    *num_banks = 0;
+    if(max_banks > 0) {
+        banks[0].mode = M3CAN_FILTER_MODE_MASK;
+        banks[0].scale = M3CAN_FILTER_SCALE_32;
+        banks[0].register1 = 0;
+        banks[0].register2 = 0;
+        *num_banks = 1;
+    }
+    return M3CAN_FILTER_ALL;
+}
+
+bool m3can_filter_match(const struct m3can_filter_bank* banks, size_t n,
+                        uint16_t sid, bool rtr)
+{
+    uint16_t f16 = (sid << 5) | (rtr ? M3CAN_FILTER_F16_RTR : 0);
+    uint32_t f32 = ((uint32_t)sid << 21) | (rtr ? 0x2 : 0);
+
+    for(size_t i=0; i<n; i++) {
+        const struct m3can_filter_bank* b = &banks[i];
+        if(b->scale == M3CAN_FILTER_SCALE_16) {
+            uint16_t h[4] = {
+                b->register1 & 0xFFFF, b->register1 >> 16,
+                b->register2 & 0xFFFF, b->register2 >> 16,
+            };
+            if(b->mode == M3CAN_FILTER_MODE_MASK) {
+                if(((f16 ^ h[0]) & h[1]) == 0 || ((f16 ^ h[2]) & h[3]) == 0) {
+                    return true;
+                }
+            } else if(f16 == h[0] || f16 == h[1] || f16 == h[2] ||
+                      f16 == h[3]) {
+                return true;
+            }
+        } else {
+            if(b->mode == M3CAN_FILTER_MODE_MASK) {
+                if(((f32 ^ b->register1) & b->register2) == 0) {
+                    return true;
+                }
+            } else if(f32 == b->register1 || f32 == b->register2) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,77 @@
+#ifndef _M3CAN_FILTER_H
+#define _M3CAN_FILTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Filter banks available to CAN1. The STM32F4 has 28 banks shared with
+ * CAN2, and ChibiOS always leaves at least the last one to CAN2.
+ */
+#define M3CAN_FILTER_BANKS          (27)
+
+/* Most IDs m3can_filter_plan will pack exactly. Longer lists accept
+ * everything.
+ */
+#ifndef M3CAN_FILTER_MAX_IDS
+#define M3CAN_FILTER_MAX_IDS        (64)
+#endif
+
+/* OR into an ID passed to m3can_filter_plan to also accept remote frames
+ * (RTR) for it, rather than just data frames.
+ */
+#define M3CAN_FILTER_RTR            (0x8000)
+
+/* Bank modes and scales, as the STM32 FM1R and FS1R bits */
+#define M3CAN_FILTER_MODE_MASK      (0)
+#define M3CAN_FILTER_MODE_LIST      (1)
+#define M3CAN_FILTER_SCALE_16       (0)
+#define M3CAN_FILTER_SCALE_32       (1)
+
+/* One filter bank, with the FR1 and FR2 register contents.
+ *
+ * At 16 bit scale each register holds two 16 bit fields, laid out as
+ * STDID[10:0] RTR IDE EXID[17:15]. In mask mode each register is one
+ * filter, with the ID in the low half and the mask in the high half; in
+ * list mode each half is one exact ID, so a bank holds two ID/mask pairs
+ * or four IDs.
+ * At 32 bit scale each register is STDID[10:0] EXID[17:0] IDE RTR 0, and a
+ * bank holds one ID/mask pair or two IDs.
+ */
+struct m3can_filter_bank {
+    uint8_t mode;
+    uint8_t scale;
+    uint32_t register1;
+    uint32_t register2;
+};
+
+typedef enum {
+    /* Exactly the requested frames are accepted */
+    M3CAN_FILTER_EXACT = 0,
+    /* Some boards' IDs were widened to accept all that board's frames */
+    M3CAN_FILTER_WIDENED,
+    /* Everything is accepted */
+    M3CAN_FILTER_ALL,
+} m3can_filter_result_t;
+
+/* Plan acceptance filters for the `n` 11 bit CAN IDs in `ids`, writing up
+ * to `max_banks` banks to `banks` and the number used to `num_banks`.
+ *
+ * Groups of IDs differing only in some bits, such as every message from a
+ * board, are packed into mask filters and the remaining IDs into list
+ * filters, using as few banks as possible. If that needs more than
+ * `max_banks`, the boards with the most IDs are widened to accept all their
+ * frames one at a time until it fits, and if nothing fits a single bank
+ * accepting everything is used.
+ */
+m3can_filter_result_t m3can_filter_plan(const uint16_t* ids, size_t n,
+                                        struct m3can_filter_bank* banks,
+                                        size_t max_banks, size_t* num_banks);
+
+/* True if a standard frame with `sid` and `rtr` passes any of the `n`
+ * banks in `banks`, as the STM32 filter hardware would decide.
+ */
+bool m3can_filter_match(const struct m3can_filter_bank* banks, size_t n,
+                        uint16_t sid, bool rtr);
+
+#endif /* _M3CAN_FILTER_H */
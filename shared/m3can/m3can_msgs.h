@@ -0,0 +1,1569 @@
+/*
+ * Generated by shared/m3can/gen_messages.py from messages.yaml, do not edit.
+ * Included by m3can.h.
+ */
+
+#ifndef M3CAN_MSGS_H
+#define M3CAN_MSGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define CAN_ID_M3FC     (1)
+#define CAN_ID_M3PSU    (2)
+#define CAN_ID_M3PYRO   (3)
+#define CAN_ID_M3RADIO  (4)
+#define CAN_ID_M3IMU    (5)
+#define CAN_ID_M3DL     (6)
+#define CAN_ID_GROUND   (7)
+
+#define CAN_MSG_ID(x)    (x<<5)
+
+/* Sent by every board, OR with the board's ID */
+#define CAN_MSG_ID_STATUS                    CAN_MSG_ID(0)
+#define CAN_MSG_ID_STATUS_DIGEST             CAN_MSG_ID(40)
+#define CAN_MSG_ID_STATUS_BATCH              CAN_MSG_ID(41)
+#define CAN_MSG_ID_BULK_DATA                 CAN_MSG_ID(45)
+#define CAN_MSG_ID_BULK_FLOW                 CAN_MSG_ID(46)
+#define CAN_MSG_ID_CAN_STATS                 CAN_MSG_ID(47)
+#define CAN_MSG_ID_THREAD_STATS              CAN_MSG_ID(61)
+#define CAN_MSG_ID_PROFILE                   CAN_MSG_ID(62)
+#define CAN_MSG_ID_VERSION                   CAN_MSG_ID(63)
+
+/* M3RADIO */
+#define CAN_MSG_ID_M3RADIO_GPS_LATLNG        (CAN_ID_M3RADIO | CAN_MSG_ID(48))
+#define CAN_MSG_ID_M3RADIO_GPS_ALT           (CAN_ID_M3RADIO | CAN_MSG_ID(49))
+#define CAN_MSG_ID_M3RADIO_GPS_TIME          (CAN_ID_M3RADIO | CAN_MSG_ID(50))
+#define CAN_MSG_ID_M3RADIO_GPS_STATUS        (CAN_ID_M3RADIO | CAN_MSG_ID(51))
+#define CAN_MSG_ID_M3RADIO_PACKET_COUNT      (CAN_ID_M3RADIO | CAN_MSG_ID(53))
+#define CAN_MSG_ID_M3RADIO_PACKET_STATS      (CAN_ID_M3RADIO | CAN_MSG_ID(54))
+#define CAN_MSG_ID_M3RADIO_PING              (CAN_ID_M3RADIO | CAN_MSG_ID(55))
+#define CAN_MSG_ID_M3RADIO_SET_FREQ          (CAN_ID_M3RADIO | CAN_MSG_ID(56))
+
+/* M3PSU */
+#define CAN_MSG_ID_M3PSU_TOGGLE_PYROS        (CAN_ID_M3PSU | CAN_MSG_ID(16))
+#define CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL      (CAN_ID_M3PSU | CAN_MSG_ID(17))
+#define CAN_MSG_ID_M3PSU_TOGGLE_CHARGER      (CAN_ID_M3PSU | CAN_MSG_ID(18))
+#define CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER     (CAN_ID_M3PSU | CAN_MSG_ID(19))
+#define CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT  (CAN_ID_M3PSU | CAN_MSG_ID(20))
+#define CAN_MSG_ID_M3PSU_PYRO_STATUS         (CAN_ID_M3PSU | CAN_MSG_ID(48))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12   (CAN_ID_M3PSU | CAN_MSG_ID(49))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34   (CAN_ID_M3PSU | CAN_MSG_ID(50))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56   (CAN_ID_M3PSU | CAN_MSG_ID(51))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78   (CAN_ID_M3PSU | CAN_MSG_ID(52))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910  (CAN_ID_M3PSU | CAN_MSG_ID(53))
+#define CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112 (CAN_ID_M3PSU | CAN_MSG_ID(54))
+#define CAN_MSG_ID_M3PSU_CHARGER_STATUS      (CAN_ID_M3PSU | CAN_MSG_ID(55))
+#define CAN_MSG_ID_M3PSU_BATT_VOLTAGES       (CAN_ID_M3PSU | CAN_MSG_ID(56))
+#define CAN_MSG_ID_M3PSU_CAPACITY            (CAN_ID_M3PSU | CAN_MSG_ID(57))
+#define CAN_MSG_ID_M3PSU_AWAKE_TIME          (CAN_ID_M3PSU | CAN_MSG_ID(58))
+
+/* M3FC */
+#define CAN_MSG_ID_M3FC_SET_CFG_PROFILE      (CAN_ID_M3FC | CAN_MSG_ID(1))
+#define CAN_MSG_ID_M3FC_SET_CFG_PYROS        (CAN_ID_M3FC | CAN_MSG_ID(2))
+#define CAN_MSG_ID_M3FC_LOAD_CFG             (CAN_ID_M3FC | CAN_MSG_ID(3))
+#define CAN_MSG_ID_M3FC_SAVE_CFG             (CAN_ID_M3FC | CAN_MSG_ID(4))
+#define CAN_MSG_ID_M3FC_MOCK_ENABLE          (CAN_ID_M3FC | CAN_MSG_ID(5))
+#define CAN_MSG_ID_M3FC_MOCK_ACCEL           (CAN_ID_M3FC | CAN_MSG_ID(6))
+#define CAN_MSG_ID_M3FC_MOCK_BARO            (CAN_ID_M3FC | CAN_MSG_ID(7))
+#define CAN_MSG_ID_M3FC_ARM                  (CAN_ID_M3FC | CAN_MSG_ID(8))
+#define CAN_MSG_ID_M3FC_FIRE                 (CAN_ID_M3FC | CAN_MSG_ID(9))
+#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X      (CAN_ID_M3FC | CAN_MSG_ID(10))
+#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y      (CAN_ID_M3FC | CAN_MSG_ID(11))
+#define CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z      (CAN_ID_M3FC | CAN_MSG_ID(12))
+#define CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ   (CAN_ID_M3FC | CAN_MSG_ID(13))
+#define CAN_MSG_ID_M3FC_SET_CFG_CRC          (CAN_ID_M3FC | CAN_MSG_ID(14))
+#define CAN_MSG_ID_M3FC_TIMESYNC             (CAN_ID_M3FC | CAN_MSG_ID(15))
+#define CAN_MSG_ID_M3FC_MISSION_STATE        (CAN_ID_M3FC | CAN_MSG_ID(32))
+#define CAN_MSG_ID_M3FC_ACCEL                (CAN_ID_M3FC | CAN_MSG_ID(48))
+#define CAN_MSG_ID_M3FC_BARO                 (CAN_ID_M3FC | CAN_MSG_ID(49))
+#define CAN_MSG_ID_M3FC_SE_T_H               (CAN_ID_M3FC | CAN_MSG_ID(50))
+#define CAN_MSG_ID_M3FC_SE_V_A               (CAN_ID_M3FC | CAN_MSG_ID(51))
+#define CAN_MSG_ID_M3FC_SE_VAR_H             (CAN_ID_M3FC | CAN_MSG_ID(52))
+#define CAN_MSG_ID_M3FC_SE_VAR_V_A           (CAN_ID_M3FC | CAN_MSG_ID(53))
+#define CAN_MSG_ID_M3FC_CFG_PROFILE          (CAN_ID_M3FC | CAN_MSG_ID(54))
+#define CAN_MSG_ID_M3FC_CFG_PYROS            (CAN_ID_M3FC | CAN_MSG_ID(55))
+#define CAN_MSG_ID_M3FC_CFG_ACCEL_X          (CAN_ID_M3FC | CAN_MSG_ID(56))
+#define CAN_MSG_ID_M3FC_CFG_ACCEL_Y          (CAN_ID_M3FC | CAN_MSG_ID(57))
+#define CAN_MSG_ID_M3FC_CFG_ACCEL_Z          (CAN_ID_M3FC | CAN_MSG_ID(58))
+#define CAN_MSG_ID_M3FC_CFG_RADIO_FREQ       (CAN_ID_M3FC | CAN_MSG_ID(59))
+#define CAN_MSG_ID_M3FC_CFG_CRC              (CAN_ID_M3FC | CAN_MSG_ID(60))
+
+/* M3DL */
+#define CAN_MSG_ID_M3DL_FREE_SPACE           (CAN_ID_M3DL | CAN_MSG_ID(32))
+#define CAN_MSG_ID_M3DL_RATE                 (CAN_ID_M3DL | CAN_MSG_ID(33))
+#define CAN_MSG_ID_M3DL_TEMP_1_2             (CAN_ID_M3DL | CAN_MSG_ID(48))
+#define CAN_MSG_ID_M3DL_TEMP_3_4             (CAN_ID_M3DL | CAN_MSG_ID(49))
+#define CAN_MSG_ID_M3DL_TEMP_5_6             (CAN_ID_M3DL | CAN_MSG_ID(50))
+#define CAN_MSG_ID_M3DL_TEMP_7_8             (CAN_ID_M3DL | CAN_MSG_ID(51))
+#define CAN_MSG_ID_M3DL_TEMP_9               (CAN_ID_M3DL | CAN_MSG_ID(52))
+#define CAN_MSG_ID_M3DL_PRESSURE             (CAN_ID_M3DL | CAN_MSG_ID(53))
+
+/* M3PYRO */
+#define CAN_MSG_ID_M3PYRO_FIRE_COMMAND       (CAN_ID_M3PYRO | CAN_MSG_ID(1))
+#define CAN_MSG_ID_M3PYRO_ARM_COMMAND        (CAN_ID_M3PYRO | CAN_MSG_ID(2))
+#define CAN_MSG_ID_M3PYRO_FIRE_STATUS        (CAN_ID_M3PYRO | CAN_MSG_ID(16))
+#define CAN_MSG_ID_M3PYRO_ARM_STATUS         (CAN_ID_M3PYRO | CAN_MSG_ID(17))
+#define CAN_MSG_ID_M3PYRO_CONTINUITY         (CAN_ID_M3PYRO | CAN_MSG_ID(48))
+#define CAN_MSG_ID_M3PYRO_SUPPLY_STATUS      (CAN_ID_M3PYRO | CAN_MSG_ID(49))
+
+/* GROUND */
+#define CAN_MSG_ID_GROUND_PACKET_COUNT       (CAN_ID_GROUND | CAN_MSG_ID(53))
+#define CAN_MSG_ID_GROUND_PACKET_STATS       (CAN_ID_GROUND | CAN_MSG_ID(54))
+#define CAN_MSG_ID_GROUND_PACKET_FRAMES      (CAN_ID_GROUND | CAN_MSG_ID(55))
+
+/* CAN IDs each board receives, to pass to m3can_init(). Messages the
+ * board sends in reply to a remote frame are marked M3CAN_FILTER_RTR,
+ * and common messages are received from every other board. Remote
+ * frames for the board's own common rtr messages are answered by m3can.
+ */
+#define M3CAN_RX_IDS_M3FC { \
+    CAN_MSG_ID_M3FC_SET_CFG_PROFILE, \
+    CAN_MSG_ID_M3FC_SET_CFG_PYROS, \
+    CAN_MSG_ID_M3FC_LOAD_CFG, \
+    CAN_MSG_ID_M3FC_SAVE_CFG, \
+    CAN_MSG_ID_M3FC_MOCK_ENABLE, \
+    CAN_MSG_ID_M3FC_MOCK_ACCEL, \
+    CAN_MSG_ID_M3FC_MOCK_BARO, \
+    CAN_MSG_ID_M3FC_ARM, \
+    CAN_MSG_ID_M3FC_FIRE, \
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X, \
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y, \
+    CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z, \
+    CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ, \
+    CAN_MSG_ID_M3FC_SET_CFG_CRC, \
+    CAN_MSG_ID_M3PYRO_ARM_STATUS, \
+    CAN_MSG_ID_M3PYRO_CONTINUITY, \
+    CAN_MSG_ID_M3PYRO_SUPPLY_STATUS, \
+    CAN_MSG_ID_M3FC_CFG_PROFILE | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3FC_CFG_PYROS | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3PSU_CHARGER_STATUS, \
+    CAN_MSG_ID_M3FC_CFG_ACCEL_X | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3FC_CFG_ACCEL_Y | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3FC_CFG_ACCEL_Z | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3FC_CFG_RADIO_FREQ | M3CAN_FILTER_RTR, \
+    CAN_MSG_ID_M3FC_CFG_CRC | M3CAN_FILTER_RTR, \
+    CAN_ID_M3PSU | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_M3PYRO | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_M3RADIO | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_M3IMU | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_M3DL | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_GROUND | CAN_MSG_ID_BULK_DATA, \
+    CAN_ID_M3PSU | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_M3PYRO | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_M3RADIO | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_M3IMU | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_M3DL | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_GROUND | CAN_MSG_ID_BULK_FLOW, \
+    CAN_ID_M3FC | CAN_MSG_ID_STATUS | M3CAN_FILTER_RTR, \
+    CAN_ID_M3FC | CAN_MSG_ID_STATUS_DIGEST | M3CAN_FILTER_RTR, \
+}
+#define M3CAN_RX_IDS_M3PSU { \
+    CAN_MSG_ID_M3FC_TIMESYNC, \
+    CAN_MSG_ID_M3PSU_TOGGLE_PYROS, \
+    CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL, \
+    CAN_MSG_ID_M3PSU_TOGGLE_CHARGER, \
+    CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER, \
+    CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT, \
+    CAN_ID_M3PSU | CAN_MSG_ID_STATUS | M3CAN_FILTER_RTR, \
+    CAN_ID_M3PSU | CAN_MSG_ID_STATUS_DIGEST | M3CAN_FILTER_RTR, \
+}
+#define M3CAN_RX_IDS_M3PYRO { \
+    CAN_MSG_ID_M3PYRO_FIRE_COMMAND, \
+    CAN_MSG_ID_M3PYRO_ARM_COMMAND, \
+    CAN_MSG_ID_M3FC_TIMESYNC, \
+    CAN_ID_M3PYRO | CAN_MSG_ID_STATUS | M3CAN_FILTER_RTR, \
+    CAN_ID_M3PYRO | CAN_MSG_ID_STATUS_DIGEST | M3CAN_FILTER_RTR, \
+}
+#define M3CAN_RX_IDS_M3IMU { \
+    CAN_MSG_ID_M3FC_TIMESYNC, \
+    CAN_ID_M3IMU | CAN_MSG_ID_STATUS | M3CAN_FILTER_RTR, \
+    CAN_ID_M3IMU | CAN_MSG_ID_STATUS_DIGEST | M3CAN_FILTER_RTR, \
+}
+
+
+/* Payloads and packers. The structs match the little-endian wire
+ * layout, so handlers may also cast received data to them.
+ */
+
+struct m3can_msg_status {
+    uint8_t overall;
+    uint8_t component;
+    uint8_t state;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_status) == 3,
+               "status payload size");
+
+static inline void m3can_send_status(uint8_t overall, uint8_t component,
+                                     uint8_t state)
+{
+    struct m3can_msg_status msg;
+    msg.overall = overall;
+    msg.component = component;
+    msg.state = state;
+    m3can_send(m3can_own_id | CAN_MSG_ID_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_status_digest {
+    uint8_t overall;
+    uint8_t components;
+    uint8_t initialising;
+    uint8_t errors;
+    uint16_t changes;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_status_digest) == 6,
+               "status_digest payload size");
+
+static inline void m3can_send_status_digest(uint8_t overall,
+                                            uint8_t components,
+                                            uint8_t initialising,
+                                            uint8_t errors, uint16_t changes)
+{
+    struct m3can_msg_status_digest msg;
+    msg.overall = overall;
+    msg.components = components;
+    msg.initialising = initialising;
+    msg.errors = errors;
+    msg.changes = changes;
+    m3can_send(m3can_own_id | CAN_MSG_ID_STATUS_DIGEST, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_status_batch {
+    uint8_t overall;
+    uint8_t first;
+    uint8_t states[6];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_status_batch) == 8,
+               "status_batch payload size");
+
+static inline void m3can_send_status_batch(uint8_t overall, uint8_t first,
+                                           const uint8_t states[6])
+{
+    struct m3can_msg_status_batch msg;
+    msg.overall = overall;
+    msg.first = first;
+    memcpy(msg.states, states, sizeof(msg.states));
+    m3can_send(m3can_own_id | CAN_MSG_ID_STATUS_BATCH, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_bulk_data {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_bulk_data) == 8,
+               "bulk_data payload size");
+
+static inline void m3can_send_bulk_data(const uint8_t data[8])
+{
+    struct m3can_msg_bulk_data msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(m3can_own_id | CAN_MSG_ID_BULK_DATA, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_bulk_flow {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_bulk_flow) == 8,
+               "bulk_flow payload size");
+
+static inline void m3can_send_bulk_flow(const uint8_t data[8])
+{
+    struct m3can_msg_bulk_flow msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(m3can_own_id | CAN_MSG_ID_BULK_FLOW, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_can_stats {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_can_stats) == 8,
+               "can_stats payload size");
+
+static inline void m3can_send_can_stats(const uint8_t data[8])
+{
+    struct m3can_msg_can_stats msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(m3can_own_id | CAN_MSG_ID_CAN_STATS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_thread_stats {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_thread_stats) == 8,
+               "thread_stats payload size");
+
+static inline void m3can_send_thread_stats(const uint8_t data[8])
+{
+    struct m3can_msg_thread_stats msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(m3can_own_id | CAN_MSG_ID_THREAD_STATS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_profile {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_profile) == 8,
+               "profile payload size");
+
+static inline void m3can_send_profile(const uint8_t data[8])
+{
+    struct m3can_msg_profile msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(m3can_own_id | CAN_MSG_ID_PROFILE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_version {
+    char version[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_version) == 8,
+               "version payload size");
+
+static inline void m3can_send_version(const char version[8])
+{
+    struct m3can_msg_version msg;
+    memcpy(msg.version, version, sizeof(msg.version));
+    m3can_send(m3can_own_id | CAN_MSG_ID_VERSION, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_gps_latlng {
+    int32_t lat;                    /* 1e-07 deg */
+    int32_t lng;                    /* 1e-07 deg */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_gps_latlng) == 8,
+               "m3radio_gps_latlng payload size");
+
+static inline void m3can_send_m3radio_gps_latlng(int32_t lat, int32_t lng)
+{
+    struct m3can_msg_m3radio_gps_latlng msg;
+    msg.lat = lat;
+    msg.lng = lng;
+    m3can_send(CAN_MSG_ID_M3RADIO_GPS_LATLNG, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_gps_alt {
+    int32_t height;                 /* 0.001 m */
+    int32_t h_msl;                  /* 0.001 m */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_gps_alt) == 8,
+               "m3radio_gps_alt payload size");
+
+static inline void m3can_send_m3radio_gps_alt(int32_t height, int32_t h_msl)
+{
+    struct m3can_msg_m3radio_gps_alt msg;
+    msg.height = height;
+    msg.h_msl = h_msl;
+    m3can_send(CAN_MSG_ID_M3RADIO_GPS_ALT, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_gps_time {
+    uint16_t year;
+    uint8_t month;
+    uint8_t day;
+    uint8_t hour;
+    uint8_t minute;
+    uint8_t second;
+    uint8_t valid;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_gps_time) == 8,
+               "m3radio_gps_time payload size");
+
+static inline void m3can_send_m3radio_gps_time(uint16_t year, uint8_t month,
+                                               uint8_t day, uint8_t hour,
+                                               uint8_t minute, uint8_t second,
+                                               uint8_t valid)
+{
+    struct m3can_msg_m3radio_gps_time msg;
+    msg.year = year;
+    msg.month = month;
+    msg.day = day;
+    msg.hour = hour;
+    msg.minute = minute;
+    msg.second = second;
+    msg.valid = valid;
+    m3can_send(CAN_MSG_ID_M3RADIO_GPS_TIME, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_gps_status {
+    uint8_t fix_type;
+    uint8_t flags;
+    uint8_t num_sv;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_gps_status) == 3,
+               "m3radio_gps_status payload size");
+
+static inline void m3can_send_m3radio_gps_status(uint8_t fix_type,
+                                                 uint8_t flags, uint8_t num_sv)
+{
+    struct m3can_msg_m3radio_gps_status msg;
+    msg.fix_type = fix_type;
+    msg.flags = flags;
+    msg.num_sv = num_sv;
+    m3can_send(CAN_MSG_ID_M3RADIO_GPS_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_packet_count {
+    uint32_t tx_count;
+    uint32_t rx_count;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_packet_count) == 8,
+               "m3radio_packet_count payload size");
+
+static inline void m3can_send_m3radio_packet_count(uint32_t tx_count,
+                                                   uint32_t rx_count)
+{
+    struct m3can_msg_m3radio_packet_count msg;
+    msg.tx_count = tx_count;
+    msg.rx_count = rx_count;
+    m3can_send(CAN_MSG_ID_M3RADIO_PACKET_COUNT, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3radio_packet_stats {
+    int16_t rssi;                   /* dBm */
+    int16_t freq_offset;            /* Hz */
+    uint16_t bit_errors;
+    uint16_t ldpc_iters;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_packet_stats) == 8,
+               "m3radio_packet_stats payload size");
+
+static inline void m3can_send_m3radio_packet_stats(int16_t rssi,
+                                                   int16_t freq_offset,
+                                                   uint16_t bit_errors,
+                                                   uint16_t ldpc_iters)
+{
+    struct m3can_msg_m3radio_packet_stats msg;
+    msg.rssi = rssi;
+    msg.freq_offset = freq_offset;
+    msg.bit_errors = bit_errors;
+    msg.ldpc_iters = ldpc_iters;
+    m3can_send(CAN_MSG_ID_M3RADIO_PACKET_STATS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+static inline void m3can_send_m3radio_ping(void)
+{
+    m3can_send(CAN_MSG_ID_M3RADIO_PING, false, NULL, 0);
+}
+
+struct m3can_msg_m3radio_set_freq {
+    uint32_t freq;                  /* Hz */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3radio_set_freq) == 4,
+               "m3radio_set_freq payload size");
+
+static inline void m3can_send_m3radio_set_freq(uint32_t freq)
+{
+    struct m3can_msg_m3radio_set_freq msg;
+    msg.freq = freq;
+    m3can_send(CAN_MSG_ID_M3RADIO_SET_FREQ, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_toggle_pyros {
+    uint8_t enable;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_toggle_pyros) == 1,
+               "m3psu_toggle_pyros payload size");
+
+static inline void m3can_send_m3psu_toggle_pyros(uint8_t enable)
+{
+    struct m3can_msg_m3psu_toggle_pyros msg;
+    msg.enable = enable;
+    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_PYROS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_toggle_channel {
+    uint8_t enable;
+    uint8_t channel;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_toggle_channel) == 2,
+               "m3psu_toggle_channel payload size");
+
+static inline void m3can_send_m3psu_toggle_channel(uint8_t enable,
+                                                   uint8_t channel)
+{
+    struct m3can_msg_m3psu_toggle_channel msg;
+    msg.enable = enable;
+    msg.channel = channel;
+    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_CHANNEL, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_toggle_charger {
+    uint8_t enable;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_toggle_charger) == 1,
+               "m3psu_toggle_charger payload size");
+
+static inline void m3can_send_m3psu_toggle_charger(uint8_t enable)
+{
+    struct m3can_msg_m3psu_toggle_charger msg;
+    msg.enable = enable;
+    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_CHARGER, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_toggle_lowpower {
+    uint8_t enable;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_toggle_lowpower) == 1,
+               "m3psu_toggle_lowpower payload size");
+
+static inline void m3can_send_m3psu_toggle_lowpower(uint8_t enable)
+{
+    struct m3can_msg_m3psu_toggle_lowpower msg;
+    msg.enable = enable;
+    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_LOWPOWER, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_toggle_battleshort {
+    uint8_t enable;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_toggle_battleshort) == 1,
+               "m3psu_toggle_battleshort payload size");
+
+static inline void m3can_send_m3psu_toggle_battleshort(uint8_t enable)
+{
+    struct m3can_msg_m3psu_toggle_battleshort msg;
+    msg.enable = enable;
+    m3can_send(CAN_MSG_ID_M3PSU_TOGGLE_BATTLESHORT, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_pyro_status {
+    uint16_t voltage;               /* 0.001 V */
+    uint16_t current;               /* 0.001 A */
+    uint16_t power;                 /* 0.001 W */
+    uint8_t enabled;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_pyro_status) == 7,
+               "m3psu_pyro_status payload size");
+
+static inline void m3can_send_m3psu_pyro_status(uint16_t voltage,
+                                                uint16_t current,
+                                                uint16_t power,
+                                                uint8_t enabled)
+{
+    struct m3can_msg_m3psu_pyro_status msg;
+    msg.voltage = voltage;
+    msg.current = current;
+    msg.power = power;
+    msg.enabled = enabled;
+    m3can_send(CAN_MSG_ID_M3PSU_PYRO_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_12 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_12) == 8,
+               "m3psu_channel_status_12 payload size");
+
+static inline void m3can_send_m3psu_channel_status_12(uint8_t voltage_a,
+                                                      uint8_t current_a,
+                                                      uint8_t power_a,
+                                                      uint8_t reserved_a,
+                                                      uint8_t voltage_b,
+                                                      uint8_t current_b,
+                                                      uint8_t power_b,
+                                                      uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_12 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_12, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_34 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_34) == 8,
+               "m3psu_channel_status_34 payload size");
+
+static inline void m3can_send_m3psu_channel_status_34(uint8_t voltage_a,
+                                                      uint8_t current_a,
+                                                      uint8_t power_a,
+                                                      uint8_t reserved_a,
+                                                      uint8_t voltage_b,
+                                                      uint8_t current_b,
+                                                      uint8_t power_b,
+                                                      uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_34 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_34, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_56 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_56) == 8,
+               "m3psu_channel_status_56 payload size");
+
+static inline void m3can_send_m3psu_channel_status_56(uint8_t voltage_a,
+                                                      uint8_t current_a,
+                                                      uint8_t power_a,
+                                                      uint8_t reserved_a,
+                                                      uint8_t voltage_b,
+                                                      uint8_t current_b,
+                                                      uint8_t power_b,
+                                                      uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_56 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_56, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_78 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_78) == 8,
+               "m3psu_channel_status_78 payload size");
+
+static inline void m3can_send_m3psu_channel_status_78(uint8_t voltage_a,
+                                                      uint8_t current_a,
+                                                      uint8_t power_a,
+                                                      uint8_t reserved_a,
+                                                      uint8_t voltage_b,
+                                                      uint8_t current_b,
+                                                      uint8_t power_b,
+                                                      uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_78 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_78, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_910 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_910) == 8,
+               "m3psu_channel_status_910 payload size");
+
+static inline void m3can_send_m3psu_channel_status_910(uint8_t voltage_a,
+                                                       uint8_t current_a,
+                                                       uint8_t power_a,
+                                                       uint8_t reserved_a,
+                                                       uint8_t voltage_b,
+                                                       uint8_t current_b,
+                                                       uint8_t power_b,
+                                                       uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_910 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_910, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_channel_status_1112 {
+    uint8_t voltage_a;              /* 0.03 V */
+    uint8_t current_a;              /* 0.003 A */
+    uint8_t power_a;                /* 0.02 W */
+    uint8_t reserved_a;
+    uint8_t voltage_b;              /* 0.03 V */
+    uint8_t current_b;              /* 0.003 A */
+    uint8_t power_b;                /* 0.02 W */
+    uint8_t reserved_b;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_channel_status_1112) == 8,
+               "m3psu_channel_status_1112 payload size");
+
+static inline void m3can_send_m3psu_channel_status_1112(uint8_t voltage_a,
+                                                        uint8_t current_a,
+                                                        uint8_t power_a,
+                                                        uint8_t reserved_a,
+                                                        uint8_t voltage_b,
+                                                        uint8_t current_b,
+                                                        uint8_t power_b,
+                                                        uint8_t reserved_b)
+{
+    struct m3can_msg_m3psu_channel_status_1112 msg;
+    msg.voltage_a = voltage_a;
+    msg.current_a = current_a;
+    msg.power_a = power_a;
+    msg.reserved_a = reserved_a;
+    msg.voltage_b = voltage_b;
+    msg.current_b = current_b;
+    msg.power_b = power_b;
+    msg.reserved_b = reserved_b;
+    m3can_send(CAN_MSG_ID_M3PSU_CHANNEL_STATUS_1112, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_charger_status {
+    int16_t current;                /* 0.001 A */
+    uint8_t flags;
+    uint16_t temperature;           /* 0.1 K */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_charger_status) == 5,
+               "m3psu_charger_status payload size");
+
+static inline void m3can_send_m3psu_charger_status(int16_t current,
+                                                   uint8_t flags,
+                                                   uint16_t temperature)
+{
+    struct m3can_msg_m3psu_charger_status msg;
+    msg.current = current;
+    msg.flags = flags;
+    msg.temperature = temperature;
+    m3can_send(CAN_MSG_ID_M3PSU_CHARGER_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_batt_voltages {
+    uint16_t cell1;                 /* 0.01 V */
+    uint16_t cell2;                 /* 0.01 V */
+    uint16_t battery;               /* 0.01 V */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_batt_voltages) == 6,
+               "m3psu_batt_voltages payload size");
+
+static inline void m3can_send_m3psu_batt_voltages(uint16_t cell1,
+                                                  uint16_t cell2,
+                                                  uint16_t battery)
+{
+    struct m3can_msg_m3psu_batt_voltages msg;
+    msg.cell1 = cell1;
+    msg.cell2 = cell2;
+    msg.battery = battery;
+    m3can_send(CAN_MSG_ID_M3PSU_BATT_VOLTAGES, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_capacity {
+    int16_t minutes;                /* min */
+    uint8_t percent;                /* % */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_capacity) == 3,
+               "m3psu_capacity payload size");
+
+static inline void m3can_send_m3psu_capacity(int16_t minutes, uint8_t percent)
+{
+    struct m3can_msg_m3psu_capacity msg;
+    msg.minutes = minutes;
+    msg.percent = percent;
+    m3can_send(CAN_MSG_ID_M3PSU_CAPACITY, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3psu_awake_time {
+    uint16_t seconds;               /* s */
+    uint8_t flags;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3psu_awake_time) == 3,
+               "m3psu_awake_time payload size");
+
+static inline void m3can_send_m3psu_awake_time(uint16_t seconds, uint8_t flags)
+{
+    struct m3can_msg_m3psu_awake_time msg;
+    msg.seconds = seconds;
+    msg.flags = flags;
+    m3can_send(CAN_MSG_ID_M3PSU_AWAKE_TIME, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_profile {
+    uint8_t position;
+    uint8_t accel_axis;
+    uint8_t ignition_accel;         /* m/s/s */
+    uint8_t burnout_timeout;        /* 0.1 s */
+    uint8_t apogee_timeout;         /* s */
+    uint8_t main_altitude;          /* 10 m */
+    uint8_t main_timeout;           /* s */
+    uint8_t land_timeout;           /* 10 s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_profile) == 8,
+               "m3fc_set_cfg_profile payload size");
+
+static inline void m3can_send_m3fc_set_cfg_profile(uint8_t position,
+                                                   uint8_t accel_axis,
+                                                   uint8_t ignition_accel,
+                                                   uint8_t burnout_timeout,
+                                                   uint8_t apogee_timeout,
+                                                   uint8_t main_altitude,
+                                                   uint8_t main_timeout,
+                                                   uint8_t land_timeout)
+{
+    struct m3can_msg_m3fc_set_cfg_profile msg;
+    msg.position = position;
+    msg.accel_axis = accel_axis;
+    msg.ignition_accel = ignition_accel;
+    msg.burnout_timeout = burnout_timeout;
+    msg.apogee_timeout = apogee_timeout;
+    msg.main_altitude = main_altitude;
+    msg.main_timeout = main_timeout;
+    msg.land_timeout = land_timeout;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_PROFILE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_pyros {
+    uint8_t pyros[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_pyros) == 8,
+               "m3fc_set_cfg_pyros payload size");
+
+static inline void m3can_send_m3fc_set_cfg_pyros(const uint8_t pyros[8])
+{
+    struct m3can_msg_m3fc_set_cfg_pyros msg;
+    memcpy(msg.pyros, pyros, sizeof(msg.pyros));
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_PYROS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+static inline void m3can_send_m3fc_load_cfg(void)
+{
+    m3can_send(CAN_MSG_ID_M3FC_LOAD_CFG, false, NULL, 0);
+}
+
+static inline void m3can_send_m3fc_save_cfg(void)
+{
+    m3can_send(CAN_MSG_ID_M3FC_SAVE_CFG, false, NULL, 0);
+}
+
+static inline void m3can_send_m3fc_mock_enable(void)
+{
+    m3can_send(CAN_MSG_ID_M3FC_MOCK_ENABLE, false, NULL, 0);
+}
+
+struct m3can_msg_m3fc_mock_accel {
+    int16_t x;                      /* 0.0382459 m/s/s */
+    int16_t y;                      /* 0.0382459 m/s/s */
+    int16_t z;                      /* 0.0382459 m/s/s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_mock_accel) == 6,
+               "m3fc_mock_accel payload size");
+
+static inline void m3can_send_m3fc_mock_accel(int16_t x, int16_t y, int16_t z)
+{
+    struct m3can_msg_m3fc_mock_accel msg;
+    msg.x = x;
+    msg.y = y;
+    msg.z = z;
+    m3can_send(CAN_MSG_ID_M3FC_MOCK_ACCEL, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_mock_baro {
+    int32_t temperature;            /* 0.01 degC */
+    int32_t pressure;               /* Pa */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_mock_baro) == 8,
+               "m3fc_mock_baro payload size");
+
+static inline void m3can_send_m3fc_mock_baro(int32_t temperature,
+                                             int32_t pressure)
+{
+    struct m3can_msg_m3fc_mock_baro msg;
+    msg.temperature = temperature;
+    msg.pressure = pressure;
+    m3can_send(CAN_MSG_ID_M3FC_MOCK_BARO, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+static inline void m3can_send_m3fc_arm(void)
+{
+    m3can_send(CAN_MSG_ID_M3FC_ARM, false, NULL, 0);
+}
+
+struct m3can_msg_m3fc_fire {
+    uint8_t usage;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_fire) == 1,
+               "m3fc_fire payload size");
+
+static inline void m3can_send_m3fc_fire(uint8_t usage)
+{
+    struct m3can_msg_m3fc_fire msg;
+    msg.usage = usage;
+    m3can_send(CAN_MSG_ID_M3FC_FIRE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_accel_x {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_accel_x) == 8,
+               "m3fc_set_cfg_accel_x payload size");
+
+static inline void m3can_send_m3fc_set_cfg_accel_x(float scale, float offset)
+{
+    struct m3can_msg_m3fc_set_cfg_accel_x msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_X, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_accel_y {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_accel_y) == 8,
+               "m3fc_set_cfg_accel_y payload size");
+
+static inline void m3can_send_m3fc_set_cfg_accel_y(float scale, float offset)
+{
+    struct m3can_msg_m3fc_set_cfg_accel_y msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Y, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_accel_z {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_accel_z) == 8,
+               "m3fc_set_cfg_accel_z payload size");
+
+static inline void m3can_send_m3fc_set_cfg_accel_z(float scale, float offset)
+{
+    struct m3can_msg_m3fc_set_cfg_accel_z msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_ACCEL_Z, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_radio_freq {
+    uint32_t freq;                  /* Hz */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_radio_freq) == 4,
+               "m3fc_set_cfg_radio_freq payload size");
+
+static inline void m3can_send_m3fc_set_cfg_radio_freq(uint32_t freq)
+{
+    struct m3can_msg_m3fc_set_cfg_radio_freq msg;
+    msg.freq = freq;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_RADIO_FREQ, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_set_cfg_crc {
+    uint32_t crc;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_set_cfg_crc) == 4,
+               "m3fc_set_cfg_crc payload size");
+
+static inline void m3can_send_m3fc_set_cfg_crc(uint32_t crc)
+{
+    struct m3can_msg_m3fc_set_cfg_crc msg;
+    msg.crc = crc;
+    m3can_send(CAN_MSG_ID_M3FC_SET_CFG_CRC, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_timesync {
+    uint32_t time;                  /* 0.0001 s */
+    uint8_t time_seq;
+    uint8_t seq;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_timesync) == 6,
+               "m3fc_timesync payload size");
+
+static inline void m3can_send_m3fc_timesync(uint32_t time, uint8_t time_seq,
+                                            uint8_t seq)
+{
+    struct m3can_msg_m3fc_timesync msg;
+    msg.time = time;
+    msg.time_seq = time_seq;
+    msg.seq = seq;
+    m3can_send(CAN_MSG_ID_M3FC_TIMESYNC, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_mission_state {
+    uint32_t met;                   /* 0.001 s */
+    uint8_t state;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_mission_state) == 5,
+               "m3fc_mission_state payload size");
+
+static inline void m3can_send_m3fc_mission_state(uint32_t met, uint8_t state)
+{
+    struct m3can_msg_m3fc_mission_state msg;
+    msg.met = met;
+    msg.state = state;
+    m3can_send(CAN_MSG_ID_M3FC_MISSION_STATE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_accel {
+    int16_t x;                      /* 0.0382459 m/s/s */
+    int16_t y;                      /* 0.0382459 m/s/s */
+    int16_t z;                      /* 0.0382459 m/s/s */
+    uint16_t time;                  /* 0.0001 s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_accel) == 8,
+               "m3fc_accel payload size");
+
+static inline void m3can_send_m3fc_accel(int16_t x, int16_t y, int16_t z,
+                                         uint16_t time)
+{
+    struct m3can_msg_m3fc_accel msg;
+    msg.x = x;
+    msg.y = y;
+    msg.z = z;
+    msg.time = time;
+    m3can_send(CAN_MSG_ID_M3FC_ACCEL, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_baro {
+    int32_t temperature;            /* 0.01 degC */
+    int32_t pressure;               /* Pa */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_baro) == 8,
+               "m3fc_baro payload size");
+
+static inline void m3can_send_m3fc_baro(int32_t temperature, int32_t pressure)
+{
+    struct m3can_msg_m3fc_baro msg;
+    msg.temperature = temperature;
+    msg.pressure = pressure;
+    m3can_send(CAN_MSG_ID_M3FC_BARO, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_se_t_h {
+    float dt;                       /* s */
+    float h;                        /* m */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_se_t_h) == 8,
+               "m3fc_se_t_h payload size");
+
+static inline void m3can_send_m3fc_se_t_h(float dt, float h)
+{
+    struct m3can_msg_m3fc_se_t_h msg;
+    msg.dt = dt;
+    msg.h = h;
+    m3can_send(CAN_MSG_ID_M3FC_SE_T_H, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_se_v_a {
+    float v;                        /* m/s */
+    float a;                        /* m/s/s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_se_v_a) == 8,
+               "m3fc_se_v_a payload size");
+
+static inline void m3can_send_m3fc_se_v_a(float v, float a)
+{
+    struct m3can_msg_m3fc_se_v_a msg;
+    msg.v = v;
+    msg.a = a;
+    m3can_send(CAN_MSG_ID_M3FC_SE_V_A, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_se_var_h {
+    float var_h;                    /* m^2 */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_se_var_h) == 4,
+               "m3fc_se_var_h payload size");
+
+static inline void m3can_send_m3fc_se_var_h(float var_h)
+{
+    struct m3can_msg_m3fc_se_var_h msg;
+    msg.var_h = var_h;
+    m3can_send(CAN_MSG_ID_M3FC_SE_VAR_H, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_se_var_v_a {
+    float var_v;                    /* (m/s)^2 */
+    float var_a;                    /* (m/s/s)^2 */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_se_var_v_a) == 8,
+               "m3fc_se_var_v_a payload size");
+
+static inline void m3can_send_m3fc_se_var_v_a(float var_v, float var_a)
+{
+    struct m3can_msg_m3fc_se_var_v_a msg;
+    msg.var_v = var_v;
+    msg.var_a = var_a;
+    m3can_send(CAN_MSG_ID_M3FC_SE_VAR_V_A, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_profile {
+    uint8_t position;
+    uint8_t accel_axis;
+    uint8_t ignition_accel;         /* m/s/s */
+    uint8_t burnout_timeout;        /* 0.1 s */
+    uint8_t apogee_timeout;         /* s */
+    uint8_t main_altitude;          /* 10 m */
+    uint8_t main_timeout;           /* s */
+    uint8_t land_timeout;           /* 10 s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_profile) == 8,
+               "m3fc_cfg_profile payload size");
+
+static inline void m3can_send_m3fc_cfg_profile(uint8_t position,
+                                               uint8_t accel_axis,
+                                               uint8_t ignition_accel,
+                                               uint8_t burnout_timeout,
+                                               uint8_t apogee_timeout,
+                                               uint8_t main_altitude,
+                                               uint8_t main_timeout,
+                                               uint8_t land_timeout)
+{
+    struct m3can_msg_m3fc_cfg_profile msg;
+    msg.position = position;
+    msg.accel_axis = accel_axis;
+    msg.ignition_accel = ignition_accel;
+    msg.burnout_timeout = burnout_timeout;
+    msg.apogee_timeout = apogee_timeout;
+    msg.main_altitude = main_altitude;
+    msg.main_timeout = main_timeout;
+    msg.land_timeout = land_timeout;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_PROFILE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_pyros {
+    uint8_t pyros[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_pyros) == 8,
+               "m3fc_cfg_pyros payload size");
+
+static inline void m3can_send_m3fc_cfg_pyros(const uint8_t pyros[8])
+{
+    struct m3can_msg_m3fc_cfg_pyros msg;
+    memcpy(msg.pyros, pyros, sizeof(msg.pyros));
+    m3can_send(CAN_MSG_ID_M3FC_CFG_PYROS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_accel_x {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_accel_x) == 8,
+               "m3fc_cfg_accel_x payload size");
+
+static inline void m3can_send_m3fc_cfg_accel_x(float scale, float offset)
+{
+    struct m3can_msg_m3fc_cfg_accel_x msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_ACCEL_X, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_accel_y {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_accel_y) == 8,
+               "m3fc_cfg_accel_y payload size");
+
+static inline void m3can_send_m3fc_cfg_accel_y(float scale, float offset)
+{
+    struct m3can_msg_m3fc_cfg_accel_y msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_ACCEL_Y, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_accel_z {
+    float scale;                    /* g/LSB */
+    float offset;                   /* LSB */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_accel_z) == 8,
+               "m3fc_cfg_accel_z payload size");
+
+static inline void m3can_send_m3fc_cfg_accel_z(float scale, float offset)
+{
+    struct m3can_msg_m3fc_cfg_accel_z msg;
+    msg.scale = scale;
+    msg.offset = offset;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_ACCEL_Z, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_radio_freq {
+    uint32_t freq;                  /* Hz */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_radio_freq) == 4,
+               "m3fc_cfg_radio_freq payload size");
+
+static inline void m3can_send_m3fc_cfg_radio_freq(uint32_t freq)
+{
+    struct m3can_msg_m3fc_cfg_radio_freq msg;
+    msg.freq = freq;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_RADIO_FREQ, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3fc_cfg_crc {
+    uint32_t crc;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3fc_cfg_crc) == 4,
+               "m3fc_cfg_crc payload size");
+
+static inline void m3can_send_m3fc_cfg_crc(uint32_t crc)
+{
+    struct m3can_msg_m3fc_cfg_crc msg;
+    msg.crc = crc;
+    m3can_send(CAN_MSG_ID_M3FC_CFG_CRC, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_free_space {
+    uint32_t free_clusters;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_free_space) == 4,
+               "m3dl_free_space payload size");
+
+static inline void m3can_send_m3dl_free_space(uint32_t free_clusters)
+{
+    struct m3can_msg_m3dl_free_space msg;
+    msg.free_clusters = free_clusters;
+    m3can_send(CAN_MSG_ID_M3DL_FREE_SPACE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_rate {
+    uint32_t packet_rate;           /* /s */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_rate) == 4,
+               "m3dl_rate payload size");
+
+static inline void m3can_send_m3dl_rate(uint32_t packet_rate)
+{
+    struct m3can_msg_m3dl_rate msg;
+    msg.packet_rate = packet_rate;
+    m3can_send(CAN_MSG_ID_M3DL_RATE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_temp_1_2 {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_temp_1_2) == 8,
+               "m3dl_temp_1_2 payload size");
+
+static inline void m3can_send_m3dl_temp_1_2(const uint8_t data[8])
+{
+    struct m3can_msg_m3dl_temp_1_2 msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(CAN_MSG_ID_M3DL_TEMP_1_2, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_temp_3_4 {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_temp_3_4) == 8,
+               "m3dl_temp_3_4 payload size");
+
+static inline void m3can_send_m3dl_temp_3_4(const uint8_t data[8])
+{
+    struct m3can_msg_m3dl_temp_3_4 msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(CAN_MSG_ID_M3DL_TEMP_3_4, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_temp_5_6 {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_temp_5_6) == 8,
+               "m3dl_temp_5_6 payload size");
+
+static inline void m3can_send_m3dl_temp_5_6(const uint8_t data[8])
+{
+    struct m3can_msg_m3dl_temp_5_6 msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(CAN_MSG_ID_M3DL_TEMP_5_6, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_temp_7_8 {
+    uint8_t data[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_temp_7_8) == 8,
+               "m3dl_temp_7_8 payload size");
+
+static inline void m3can_send_m3dl_temp_7_8(const uint8_t data[8])
+{
+    struct m3can_msg_m3dl_temp_7_8 msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(CAN_MSG_ID_M3DL_TEMP_7_8, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_temp_9 {
+    uint8_t data[4];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_temp_9) == 4,
+               "m3dl_temp_9 payload size");
+
+static inline void m3can_send_m3dl_temp_9(const uint8_t data[4])
+{
+    struct m3can_msg_m3dl_temp_9 msg;
+    memcpy(msg.data, data, sizeof(msg.data));
+    m3can_send(CAN_MSG_ID_M3DL_TEMP_9, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3dl_pressure {
+    uint16_t p1;                    /* 1.25 kPa */
+    uint16_t p2;                    /* 1.25 kPa */
+    uint16_t p3;                    /* 1.25 kPa */
+    uint16_t p4;                    /* 1.25 kPa */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3dl_pressure) == 8,
+               "m3dl_pressure payload size");
+
+static inline void m3can_send_m3dl_pressure(uint16_t p1, uint16_t p2,
+                                            uint16_t p3, uint16_t p4)
+{
+    struct m3can_msg_m3dl_pressure msg;
+    msg.p1 = p1;
+    msg.p2 = p2;
+    msg.p3 = p3;
+    msg.p4 = p4;
+    m3can_send(CAN_MSG_ID_M3DL_PRESSURE, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_fire_command {
+    uint8_t channels[8];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_fire_command) == 8,
+               "m3pyro_fire_command payload size");
+
+static inline void m3can_send_m3pyro_fire_command(const uint8_t channels[8])
+{
+    struct m3can_msg_m3pyro_fire_command msg;
+    memcpy(msg.channels, channels, sizeof(msg.channels));
+    m3can_send(CAN_MSG_ID_M3PYRO_FIRE_COMMAND, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_arm_command {
+    uint8_t arm;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_arm_command) == 1,
+               "m3pyro_arm_command payload size");
+
+static inline void m3can_send_m3pyro_arm_command(uint8_t arm)
+{
+    struct m3can_msg_m3pyro_arm_command msg;
+    msg.arm = arm;
+    m3can_send(CAN_MSG_ID_M3PYRO_ARM_COMMAND, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_fire_status {
+    uint8_t channels[4];
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_fire_status) == 4,
+               "m3pyro_fire_status payload size");
+
+static inline void m3can_send_m3pyro_fire_status(const uint8_t channels[4])
+{
+    struct m3can_msg_m3pyro_fire_status msg;
+    memcpy(msg.channels, channels, sizeof(msg.channels));
+    m3can_send(CAN_MSG_ID_M3PYRO_FIRE_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_arm_status {
+    uint8_t armed;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_arm_status) == 1,
+               "m3pyro_arm_status payload size");
+
+static inline void m3can_send_m3pyro_arm_status(uint8_t armed)
+{
+    struct m3can_msg_m3pyro_arm_status msg;
+    msg.armed = armed;
+    m3can_send(CAN_MSG_ID_M3PYRO_ARM_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_continuity {
+    uint8_t resistance[8];          /* 2 ohm */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_continuity) == 8,
+               "m3pyro_continuity payload size");
+
+static inline void m3can_send_m3pyro_continuity(const uint8_t resistance[8])
+{
+    struct m3can_msg_m3pyro_continuity msg;
+    memcpy(msg.resistance, resistance, sizeof(msg.resistance));
+    m3can_send(CAN_MSG_ID_M3PYRO_CONTINUITY, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_m3pyro_supply_status {
+    uint8_t supply;                 /* 0.1 V */
+    uint8_t bus;                    /* 0.1 V */
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_m3pyro_supply_status) == 2,
+               "m3pyro_supply_status payload size");
+
+static inline void m3can_send_m3pyro_supply_status(uint8_t supply, uint8_t bus)
+{
+    struct m3can_msg_m3pyro_supply_status msg;
+    msg.supply = supply;
+    msg.bus = bus;
+    m3can_send(CAN_MSG_ID_M3PYRO_SUPPLY_STATUS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_ground_packet_count {
+    uint32_t tx_count;
+    uint32_t rx_count;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_ground_packet_count) == 8,
+               "ground_packet_count payload size");
+
+static inline void m3can_send_ground_packet_count(uint32_t tx_count,
+                                                  uint32_t rx_count)
+{
+    struct m3can_msg_ground_packet_count msg;
+    msg.tx_count = tx_count;
+    msg.rx_count = rx_count;
+    m3can_send(CAN_MSG_ID_GROUND_PACKET_COUNT, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_ground_packet_stats {
+    int16_t rssi;                   /* dBm */
+    int16_t freq_offset;            /* Hz */
+    uint16_t bit_errors;
+    uint16_t ldpc_iters;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_ground_packet_stats) == 8,
+               "ground_packet_stats payload size");
+
+static inline void m3can_send_ground_packet_stats(int16_t rssi,
+                                                  int16_t freq_offset,
+                                                  uint16_t bit_errors,
+                                                  uint16_t ldpc_iters)
+{
+    struct m3can_msg_ground_packet_stats msg;
+    msg.rssi = rssi;
+    msg.freq_offset = freq_offset;
+    msg.bit_errors = bit_errors;
+    msg.ldpc_iters = ldpc_iters;
+    m3can_send(CAN_MSG_ID_GROUND_PACKET_STATS, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+struct m3can_msg_ground_packet_frames {
+    uint8_t this_packet;
+    uint8_t in_queue;
+} __attribute__((packed));
+_Static_assert(sizeof(struct m3can_msg_ground_packet_frames) == 2,
+               "ground_packet_frames payload size");
+
+static inline void m3can_send_ground_packet_frames(uint8_t this_packet,
+                                                   uint8_t in_queue)
+{
+    struct m3can_msg_ground_packet_frames msg;
+    msg.this_packet = this_packet;
+    msg.in_queue = in_queue;
+    m3can_send(CAN_MSG_ID_GROUND_PACKET_FRAMES, false,
+               (uint8_t*)&msg, sizeof(msg));
+}
+
+#endif /* M3CAN_MSGS_H */
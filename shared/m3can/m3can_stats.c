@@ -0,0 +1,308 @@
+#include "ch.h"
+#include "hal.h"
+#include "m3can.h"
+#include "m3can_stats.h"
+
+/* Standard frame fields after the stuffed region: CRC delimiter, ACK slot,
+ * ACK delimiter, end of frame and inter-frame space.
+ */
+#define M3CAN_STATS_TAIL_BITS   (1 + 1 + 1 + 7 + 3)
+
+#define M3CAN_STATS_CRC_POLY    (0x4599)
+
+/* Frame types in the low two bits of the first byte of each report */
+#define M3CAN_STATS_TYPE_LOAD   (0)
+#define M3CAN_STATS_TYPE_ERRORS (1)
+#define M3CAN_STATS_TYPE_ID     (2)
+
+#define M3CAN_STATS_OTHER_SID   (0xFFFF)
+
+/* Usage of one CAN ID since the last report. `key` is the SID plus one, so
+ * the zeroed table starts empty and counting works before init.
+ */
+struct m3can_stats_id {
+    uint16_t key;
+    uint16_t frames;
+    uint32_t bits;
+    uint8_t dir;
+};
+
+static struct m3can_stats_id m3can_stats_ids[M3CAN_STATS_MAX_IDS];
+static struct m3can_stats_id m3can_stats_other;
+
+static uint32_t m3can_stats_window_bits;
+static uint32_t m3can_stats_rx_frames, m3can_stats_tx_frames;
+static uint32_t m3can_stats_tx_blocked;
+
+/* Running CRC-15 and stuff bit count over a frame */
+struct m3can_stats_stuffer {
+    uint16_t crc;
+    uint8_t last;
+    uint8_t run;
+    uint16_t stuffed;
+};
+
+static void m3can_stats_put_bits(struct m3can_stats_stuffer* s,
+                                 uint32_t value, int n, bool crc)
+{
+    while(n--) {
+        uint8_t bit = (value >> n) & 1;
+
+        if(crc) {
+            uint8_t next = bit ^ ((s->crc >> 14) & 1);
+            s->crc = (s->crc << 1) & 0x7FFF;
+            if(next) {
+                s->crc ^= M3CAN_STATS_CRC_POLY;
+            }
+        }
+
+        /* After five equal bits the transmitter inserts one of the
+         * opposite value, which starts the next run. */
+        if(bit == s->last) {
+            if(++s->run == 5) {
+                s->stuffed++;
+                s->last = !bit;
+                s->run = 1;
+            }
+        } else {
+            s->last = bit;
+            s->run = 1;
+        }
+    }
+}
+
+uint32_t m3can_stats_frame_bits(uint16_t sid, bool rtr, uint8_t dlc,
+                                const uint8_t* data)
+{
+    struct m3can_stats_stuffer s = {.crc = 0, .last = 2, .run = 0,
+                                    .stuffed = 0};
+    uint8_t n = rtr ? 0 : (dlc > 8 ? 8 : dlc);
+
+    /* SOF, identifier, RTR, IDE, r0, DLC */
+    m3can_stats_put_bits(&s, 0, 1, true);
+    m3can_stats_put_bits(&s, sid, 11, true);
+    m3can_stats_put_bits(&s, rtr, 1, true);
+    m3can_stats_put_bits(&s, 0, 2, true);
+    m3can_stats_put_bits(&s, dlc, 4, true);
+    for(uint8_t i=0; i<n; i++) {
+        m3can_stats_put_bits(&s, data[i], 8, true);
+    }
+    m3can_stats_put_bits(&s, s.crc, 15, false);
+
+    return 1 + 11 + 3 + 4 + 8 * n + 15 + s.stuffed + M3CAN_STATS_TAIL_BITS;
+}
+
+void m3can_stats_count(uint16_t sid, bool rtr, uint8_t dlc,
+                       const uint8_t* data, bool tx)
+{
+    uint32_t bits = m3can_stats_frame_bits(sid, rtr, dlc, data);
+    uint16_t key = sid + 1;
+    size_t i = (sid ^ (sid >> 5)) % M3CAN_STATS_MAX_IDS;
+    struct m3can_stats_id* e = &m3can_stats_other;
+
+    chSysLock();
+
+    /* Open addressing with linear probing; IDs are never removed */
+    for(size_t probes=0; probes<M3CAN_STATS_MAX_IDS; probes++) {
+        if(m3can_stats_ids[i].key == key || m3can_stats_ids[i].key == 0) {
+            e = &m3can_stats_ids[i];
+            e->key = key;
+            break;
+        }
+        i = (i + 1) % M3CAN_STATS_MAX_IDS;
+    }
+
+    if(e->frames < UINT16_MAX) {
+        e->frames++;
+    }
+    e->bits += bits;
+    e->dir |= tx ? 2 : 1;
+
+    m3can_stats_window_bits += bits;
+    if(tx) {
+        m3can_stats_tx_frames++;
+    } else {
+        m3can_stats_rx_frames++;
+    }
+
+    chSysUnlock();
+}
+
+void m3can_stats_count_tx_blocked(void)
+{
+    chSysLock();
+    m3can_stats_tx_blocked++;
+    chSysUnlock();
+}
+
+static uint16_t m3can_stats_sat16(uint32_t x)
+{
+    return x > UINT16_MAX ? UINT16_MAX : (uint16_t)x;
+}
+
+/* Bus utilisation of `bits` over `ms`, in units of 0.01% */
+static uint16_t m3can_stats_util(uint32_t bits, uint32_t ms)
+{
+    uint64_t capacity = (uint64_t)(M3CAN_STATS_BITRATE / 1000) * ms;
+    return m3can_stats_sat16((uint32_t)(((uint64_t)bits * 10000) / capacity));
+}
+
+/*
+ * Each report is several frames, with the frame type in the bottom two bits
+ * of the first byte and, for per-ID frames, the rank in the top six.
+ *
+ * Load:   utilisation over the period (u16, 0.01%), utilisation in the
+ *         busiest window (u16, 0.01%), frames/s (u16), RX FIFO overflows
+ *         (u8).
+ * Errors: TEC (u8), REC (u8), ESR state (u8: EWGF, EPVF, BOFF in bits 0-2,
+ *         LEC in bits 4-6), bus errors (u16), times every TX mailbox was
+ *         busy (u16).
+ * ID:     SID (u16, 0xFFFF for IDs past M3CAN_STATS_MAX_IDS), frames/s
+ *         (u16), share of the bus (u16, 0.01%), direction (u8: bit 0 RX,
+ *         bit 1 TX).
+ */
+static void m3can_stats_report(uint32_t period_bits, uint32_t peak_bits,
+                               uint32_t bus_errors, uint32_t rx_overflows)
+{
+    struct m3can_stats_id top[M3CAN_STATS_TOP_IDS] = {{0}};
+    uint32_t frames, tx_blocked, esr;
+    uint16_t x;
+    uint8_t data[8];
+
+    chSysLock();
+    frames = m3can_stats_rx_frames + m3can_stats_tx_frames;
+    tx_blocked = m3can_stats_tx_blocked;
+    m3can_stats_rx_frames = m3can_stats_tx_frames = 0;
+    m3can_stats_tx_blocked = 0;
+    chSysUnlock();
+
+    /* Take and clear each ID's counts, keeping the busiest */
+    for(size_t i=0; i<=M3CAN_STATS_MAX_IDS; i++) {
+        struct m3can_stats_id* e = i < M3CAN_STATS_MAX_IDS ?
+                                   &m3can_stats_ids[i] : &m3can_stats_other;
+        struct m3can_stats_id cur;
+
+        chSysLock();
+        cur = *e;
+        e->frames = 0;
+        e->bits = 0;
+        e->dir = 0;
+        chSysUnlock();
+
+        if(cur.bits == 0) {
+            continue;
+        }
+
+        for(size_t j=0; j<M3CAN_STATS_TOP_IDS; j++) {
+            if(cur.bits > top[j].bits) {
+                struct m3can_stats_id tmp = top[j];
+                top[j] = cur;
+                cur = tmp;
+            }
+        }
+    }
+
+    data[0] = M3CAN_STATS_TYPE_LOAD;
+    x = m3can_stats_util(period_bits, M3CAN_STATS_REPORT_MS);
+    data[1] = x;
+    data[2] = x >> 8;
+    x = m3can_stats_util(peak_bits, M3CAN_STATS_WINDOW_MS);
+    data[3] = x;
+    data[4] = x >> 8;
+    x = m3can_stats_sat16(frames * 1000 / M3CAN_STATS_REPORT_MS);
+    data[5] = x;
+    data[6] = x >> 8;
+    data[7] = rx_overflows > 255 ? 255 : rx_overflows;
+    m3can_send_can_stats(data);
+
+    esr = CAND1.can->ESR;
+    data[0] = M3CAN_STATS_TYPE_ERRORS;
+    data[1] = (esr & CAN_ESR_TEC) >> 16;
+    data[2] = (esr & CAN_ESR_REC) >> 24;
+    data[3] = esr & (CAN_ESR_EWGF | CAN_ESR_EPVF | CAN_ESR_BOFF |
+                     CAN_ESR_LEC);
+    x = m3can_stats_sat16(bus_errors);
+    data[4] = x;
+    data[5] = x >> 8;
+    x = m3can_stats_sat16(tx_blocked);
+    data[6] = x;
+    data[7] = x >> 8;
+    m3can_send_can_stats(data);
+
+    for(size_t j=0; j<M3CAN_STATS_TOP_IDS && top[j].bits > 0; j++) {
+        /* The shared entry for uncounted IDs has no key */
+        uint16_t sid = top[j].key ? top[j].key - 1 : M3CAN_STATS_OTHER_SID;
+        data[0] = (uint8_t)(j << 2) | M3CAN_STATS_TYPE_ID;
+        data[1] = sid;
+        data[2] = sid >> 8;
+        x = m3can_stats_sat16(top[j].frames * 1000 / M3CAN_STATS_REPORT_MS);
+        data[3] = x;
+        data[4] = x >> 8;
+        x = m3can_stats_util(top[j].bits, M3CAN_STATS_REPORT_MS);
+        data[5] = x;
+        data[6] = x >> 8;
+        data[7] = top[j].dir;
+        m3can_send_can_stats(data);
+    }
+}
+
+/*
+ * CAN statistics thread.
+ * Collects the bits counted in each window to find the peak utilisation,
+ * and counts bus errors and RX overflows from the driver's error events,
+ * then reports every M3CAN_STATS_REPORT_MS. Events arriving together are
+ * merged, so the error counts are lower bounds.
+ */
+static THD_WORKING_AREA(m3can_stats_wa, 512);
+static THD_FUNCTION(m3can_stats_thd, arg) {
+    (void)arg;
+
+    event_listener_t el;
+    systime_t t_window = chVTGetSystemTime();
+    systime_t window = MS2ST(M3CAN_STATS_WINDOW_MS), elapsed;
+    uint32_t period_bits = 0, peak_bits = 0, window_bits;
+    uint32_t bus_errors = 0, rx_overflows = 0;
+    int windows = 0;
+
+    chRegSetThreadName("CAN stats");
+    chEvtRegisterMask(&CAND1.error_event, &el, EVENT_MASK(0));
+
+    while(true) {
+        while((elapsed = chVTTimeElapsedSinceX(t_window)) < window) {
+            if(chEvtWaitAnyTimeout(EVENT_MASK(0), window - elapsed) != 0) {
+                eventflags_t flags = chEvtGetAndClearFlags(&el);
+                if(flags & CAN_FRAMING_ERROR) {
+                    bus_errors++;
+                }
+                if(flags & CAN_OVERFLOW_ERROR) {
+                    rx_overflows++;
+                }
+            }
+        }
+        t_window += window;
+
+        chSysLock();
+        window_bits = m3can_stats_window_bits;
+        m3can_stats_window_bits = 0;
+        chSysUnlock();
+
+        period_bits += window_bits;
+        if(window_bits > peak_bits) {
+            peak_bits = window_bits;
+        }
+
+        if(++windows * M3CAN_STATS_WINDOW_MS >= M3CAN_STATS_REPORT_MS) {
+            m3can_stats_report(period_bits, peak_bits, bus_errors,
+                               rx_overflows);
+            period_bits = peak_bits = 0;
+            bus_errors = rx_overflows = 0;
+            windows = 0;
+        }
+    }
+}
+
+void m3can_stats_init(void)
+{
+    chThdCreateStatic(m3can_stats_wa, sizeof(m3can_stats_wa), LOWPRIO,
+                      m3can_stats_thd, NULL);
+}
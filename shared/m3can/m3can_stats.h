@@ -0,0 +1,48 @@
+#ifndef _M3CAN_STATS_H
+#define _M3CAN_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* CAN bus load and per-ID rate accounting.
+ *
+ * m3can counts every frame it receives or loads into a TX mailbox here,
+ * with its length on the wire including stuff bits. Call m3can_stats_init()
+ * after m3can_init() to start a thread which, every M3CAN_STATS_REPORT_MS,
+ * sends a summary on CAN_MSG_ID_CAN_STATS: bus utilisation over the period
+ * and in its busiest M3CAN_STATS_WINDOW_MS window, frame rate, the bxCAN
+ * error counters and state from ESR, bus errors, how often all three TX
+ * mailboxes were busy, and the M3CAN_STATS_TOP_IDS IDs using the most bus
+ * time. See gcs/m3gcs/canstats.py for the frame layout.
+ *
+ * Only frames this board sees are counted. m3dl and m3radio receive
+ * everything, so their figures are the whole bus load; other boards' show
+ * their own traffic and what their filters let in.
+ */
+
+#define M3CAN_STATS_BITRATE     (1000000)
+#define M3CAN_STATS_REPORT_MS   (1000)
+#define M3CAN_STATS_WINDOW_MS   (100)
+#define M3CAN_STATS_TOP_IDS     (4)
+
+/* Distinct IDs counted separately, after which the rest share one entry */
+#ifndef M3CAN_STATS_MAX_IDS
+#define M3CAN_STATS_MAX_IDS     (96)
+#endif
+
+/* Length in bits of a standard frame on the wire, including stuff bits,
+ * the inter-frame space and an ACK.
+ */
+uint32_t m3can_stats_frame_bits(uint16_t sid, bool rtr, uint8_t dlc,
+                                const uint8_t* data);
+
+/* Count one frame received (`tx` false) or sent. Called by m3can. */
+void m3can_stats_count(uint16_t sid, bool rtr, uint8_t dlc,
+                       const uint8_t* data, bool tx);
+
+/* Count the TX thread finding every mailbox busy. Called by m3can. */
+void m3can_stats_count_tx_blocked(void);
+
+void m3can_stats_init(void);
+
+#endif /* _M3CAN_STATS_H */
@@ -0,0 +1,200 @@
+/*
+ * Common timebase across boards over CAN
+ * Cambridge University Spaceflight
+ *
+ * See m3can_timesync.h for the protocol.
+ */
+
+#include "ch.h"
+#include "m3can.h"
+#include "m3can_timesync.h"
+
+/* Loop gains as shifts: the offset moves 1/4 of the way to each sample,
+ * and the drift by 1/16 of the frequency error it implies.
+ */
+#define M3CAN_TIMESYNC_PHASE_SHIFT  (2)
+#define M3CAN_TIMESYNC_FREQ_SHIFT   (4)
+
+/* Crystal drift beyond this, in parts per 2^32, is taken to be an error:
+ * 500ppm.
+ */
+#define M3CAN_TIMESYNC_MAX_DRIFT    (2147484)
+
+/* Samples before a follower reports itself synced */
+#define M3CAN_TIMESYNC_LOCK_SAMPLES (3)
+
+static bool m3can_timesync_master;
+
+/* Follower state, updated by the CAN RX thread */
+static struct m3can_timesync_state m3can_timesync_state;
+static bool m3can_timesync_have_rx;
+static uint8_t m3can_timesync_rx_seq;
+static systime_t m3can_timesync_rx_time;
+
+/* Master state: when the last TIMESYNC went into a mailbox */
+static bool m3can_timesync_have_tx;
+static uint8_t m3can_timesync_tx_seq;
+static systime_t m3can_timesync_tx_time;
+
+
+static int64_t m3can_timesync_predict(const struct m3can_timesync_state* s,
+                                      uint32_t local)
+{
+    int32_t dt = (int32_t)(local - s->ref);
+    return s->offset_q16 + (((int64_t)s->drift_q32 * dt) >> 16);
+}
+
+void m3can_timesync_update(struct m3can_timesync_state* state,
+                           uint32_t local, uint32_t master)
+{
+    int64_t measured = (int64_t)(int32_t)(master - local) << 16;
+    int32_t dt = (int32_t)(local - state->ref);
+
+    if(state->samples > 0 && dt <= 0) {
+        return;
+    }
+
+    int64_t predicted = m3can_timesync_predict(state, local);
+    int64_t error = measured - predicted;
+    int64_t step = (int64_t)M3CAN_TIMESYNC_STEP_TICKS << 16;
+
+    if(state->samples == 0 || error > step || error < -step) {
+        /* First sample, or the master restarted: start again */
+        state->offset_q16 = measured;
+        state->drift_q32 = 0;
+        state->samples = 1;
+    } else if(state->samples == 1) {
+        /* Second sample: take the drift straight from the two */
+        state->offset_q16 = measured;
+        state->drift_q32 += (int32_t)((error << 16) / dt);
+        state->samples++;
+    } else {
+        state->offset_q16 = predicted +
+                            error / (1 << M3CAN_TIMESYNC_PHASE_SHIFT);
+        state->drift_q32 += (int32_t)((error << 16) / dt /
+                                      (1 << M3CAN_TIMESYNC_FREQ_SHIFT));
+        state->samples++;
+    }
+
+    if(state->drift_q32 > M3CAN_TIMESYNC_MAX_DRIFT) {
+        state->drift_q32 = M3CAN_TIMESYNC_MAX_DRIFT;
+    } else if(state->drift_q32 < -M3CAN_TIMESYNC_MAX_DRIFT) {
+        state->drift_q32 = -M3CAN_TIMESYNC_MAX_DRIFT;
+    }
+
+    state->ref = local;
+}
+
+uint32_t m3can_timesync_convert(const struct m3can_timesync_state* state,
+                                uint32_t local)
+{
+    if(state->samples == 0) {
+        return local;
+    }
+
+    int64_t offset = m3can_timesync_predict(state, local);
+    return local + (uint32_t)(int32_t)((offset + 0x8000) >> 16);
+}
+
+void m3can_timesync_frame(uint16_t sid, const uint8_t* data, uint8_t dlc,
+                          bool tx)
+{
+    const struct m3can_msg_m3fc_timesync* msg =
+        (const struct m3can_msg_m3fc_timesync*)data;
+    systime_t now = chVTGetSystemTimeX();
+
+    if(sid != CAN_MSG_ID_M3FC_TIMESYNC || dlc != sizeof(*msg)) {
+        return;
+    }
+
+    chSysLock();
+    if(tx) {
+        m3can_timesync_tx_seq = msg->seq;
+        m3can_timesync_tx_time = now;
+        m3can_timesync_have_tx = true;
+    } else if(!m3can_timesync_master) {
+        /* This frame carries the master's time for an earlier one */
+        if(m3can_timesync_have_rx && msg->time_seq == m3can_timesync_rx_seq) {
+            m3can_timesync_update(&m3can_timesync_state,
+                                  m3can_timesync_rx_time, msg->time);
+        }
+        m3can_timesync_rx_seq = msg->seq;
+        m3can_timesync_rx_time = now;
+        m3can_timesync_have_rx = true;
+    }
+    chSysUnlock();
+}
+
+systime_t m3can_timesync_to_common(systime_t local)
+{
+    struct m3can_timesync_state state;
+
+    if(m3can_timesync_master) {
+        return local;
+    }
+
+    chSysLock();
+    state = m3can_timesync_state;
+    chSysUnlock();
+
+    return m3can_timesync_convert(&state, local);
+}
+
+systime_t m3can_timesync_now(void)
+{
+    return m3can_timesync_to_common(chVTGetSystemTimeX());
+}
+
+bool m3can_timesync_synced(void)
+{
+    bool synced;
+
+    if(m3can_timesync_master) {
+        return true;
+    }
+
+    chSysLock();
+    synced = m3can_timesync_state.samples >= M3CAN_TIMESYNC_LOCK_SAMPLES &&
+             ST2MS(chVTTimeElapsedSinceX(m3can_timesync_rx_time)) <
+                M3CAN_TIMESYNC_TIMEOUT_MS;
+    chSysUnlock();
+
+    return synced;
+}
+
+systime_t m3can_timesync_unwrap16(systime_t now, uint16_t time16)
+{
+    return now - (systime_t)(int16_t)((uint16_t)now - time16);
+}
+
+static THD_WORKING_AREA(m3can_timesync_thd_wa, 256);
+static THD_FUNCTION(m3can_timesync_thd, arg) {
+    (void)arg;
+
+    uint8_t seq = 0;
+    uint32_t time;
+    uint8_t time_seq;
+    systime_t t = chVTGetSystemTimeX();
+
+    chRegSetThreadName("timesync");
+
+    while(true) {
+        t += MS2ST(M3CAN_TIMESYNC_PERIOD_MS);
+        chThdSleepUntil(t);
+
+        chSysLock();
+        time = m3can_timesync_tx_time;
+        /* Before the first frame is sent, refer to one that never was */
+        time_seq = m3can_timesync_have_tx ? m3can_timesync_tx_seq : seq - 1;
+        chSysUnlock();
+
+        m3can_send_m3fc_timesync(time, time_seq, seq++);
+    }
+}
+
+void m3can_timesync_init_master(void)
+{
+    m3can_timesync_master = true;
+    chThdCreateStatic(m3can_timesync_thd_wa, sizeof(m3can_timesync_thd_wa),
+                      NORMALPRIO+6, m3can_timesync_thd, NULL);
+}
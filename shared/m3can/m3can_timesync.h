@@ -0,0 +1,84 @@
+#ifndef _M3CAN_TIMESYNC_H
+#define _M3CAN_TIMESYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ch.h"
+
+/* Common timebase across boards.
+ *
+ * M3FC is the time master: call m3can_timesync_init_master() after
+ * m3can_init() there, and it broadcasts CAN_MSG_ID_M3FC_TIMESYNC every
+ * M3CAN_TIMESYNC_PERIOD_MS. Every other board follows it with no setup,
+ * since m3can passes each TIMESYNC it receives through here before
+ * m3can_recv.
+ *
+ * Sync is two-step so queueing on the master doesn't matter: m3can notes
+ * the master's system time when each TIMESYNC is loaded into a TX mailbox,
+ * and the next TIMESYNC carries that time and the sequence number of the
+ * frame it belongs to. Followers note their own time when each TIMESYNC is
+ * received, pair it with the master time once it arrives, and track the
+ * offset to the master's clock and its drift with a phase-locked loop.
+ *
+ * Common time is in system ticks of the master, so on M3FC it is simply
+ * chVTGetSystemTimeX(), and elsewhere it is the local time until the first
+ * sync arrives.
+ */
+
+#define M3CAN_TIMESYNC_PERIOD_MS    (100)
+
+/* Followers report unsynced after this long without a TIMESYNC */
+#define M3CAN_TIMESYNC_TIMEOUT_MS   (1000)
+
+/* An offset error larger than this steps the clock instead of slewing it */
+#define M3CAN_TIMESYNC_STEP_TICKS   (MS2ST(5))
+
+/* Offset and drift of a follower's clock, as fixed point: offset to the
+ * master in 1/65536 ticks at local time `ref`, and drift of the master
+ * relative to the local clock in parts per 2^32.
+ */
+struct m3can_timesync_state {
+    uint32_t ref;
+    int64_t offset_q16;
+    int32_t drift_q32;
+    uint32_t samples;
+};
+
+/* Feed a follower `state` one sample: the master's time `master` at local
+ * time `local`. Exposed for the host tests; m3can calls it through
+ * m3can_timesync_frame.
+ */
+void m3can_timesync_update(struct m3can_timesync_state* state,
+                           uint32_t local, uint32_t master);
+
+/* Convert local time `local` to common time using `state` */
+uint32_t m3can_timesync_convert(const struct m3can_timesync_state* state,
+                                uint32_t local);
+
+/* Note a TIMESYNC frame received (`tx` false) or loaded into a mailbox.
+ * Called by m3can.
+ */
+void m3can_timesync_frame(uint16_t sid, const uint8_t* data, uint8_t dlc,
+                          bool tx);
+
+/* Convert local system time `local` to common time */
+systime_t m3can_timesync_to_common(systime_t local);
+
+/* Current common time */
+systime_t m3can_timesync_now(void);
+
+/* True on the master, and on followers which have locked to it and heard
+ * from it in the last M3CAN_TIMESYNC_TIMEOUT_MS.
+ */
+bool m3can_timesync_synced(void);
+
+/* Recover a full common time from its low 16 bits `time16`, as carried in
+ * sensor frames, given a common time `now` within 3 seconds of it.
+ */
+systime_t m3can_timesync_unwrap16(systime_t now, uint16_t time16);
+
+/* Make this board the time master and start broadcasting TIMESYNC */
+void m3can_timesync_init_master(void);
+
+#endif /* _M3CAN_TIMESYNC_H */
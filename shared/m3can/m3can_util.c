@@ -0,0 +1,84 @@
+/*
+ * M3 CAN helpers independent of the CAN driver
+ * Cambridge University Spaceflight
+ *
+ * Shared by the firmware's m3can.c and the host backend in shared/m3host.
+ */
+
+#include "m3can.h"
+#include "m3status.h"
+
+
+m3can_dispatch_result_t m3can_dispatch(const struct m3can_dispatch_table* table,
+                                       uint16_t msg_id, uint8_t* data,
+                                       uint8_t datalen)
+{
+    uint8_t slot = table->index[M3CAN_DISPATCH_SLOT(msg_id & 0x7FF)];
+    const struct m3can_handler* h;
+
+    /* Board IDs above 7 share slots with those below, so check the ID */
+    if(slot == 0 || table->handlers[slot - 1].msg_id != msg_id) {
+        return M3CAN_DISPATCH_NO_HANDLER;
+    }
+
+    h = &table->handlers[slot - 1];
+    if(datalen < h->min_len || datalen > h->max_len) {
+        uint8_t detail[3] = {msg_id & 0xFF, msg_id >> 8, datalen};
+        m3status_set_error_data(M3STATUS_COMPONENT_CAN,
+                                M3STATUS_ERROR_CAN_BAD_LENGTH,
+                                detail, sizeof(detail));
+        return M3CAN_DISPATCH_BAD_LENGTH;
+    }
+
+    h->handler(data, datalen);
+    return M3CAN_DISPATCH_OK;
+}
+
+
+void m3can_send_u8(uint16_t msg_id, uint8_t d0, uint8_t d1, uint8_t d2,
+                 uint8_t d3, uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7,
+                 size_t n)
+{
+    uint8_t buf[8] = {d0, d1, d2, d3, d4, d5, d6, d7};
+    m3can_send(msg_id, false, buf, n);
+}
+
+void m3can_send_u16(uint16_t msg_id, uint16_t d0, uint16_t d1, uint16_t d2,
+                  uint16_t d3, size_t n)
+{
+    uint8_t buf[8] = {d0, d0>>8, d1, d1>>8, d2, d2>>8, d3, d3>>8};
+    m3can_send(msg_id, false, buf, n<<1);
+}
+
+void m3can_send_u32(uint16_t msg_id, uint32_t d0, uint32_t d1, size_t n)
+{
+    uint8_t buf[8] = {d0, d0>>8, d0>>16, d0>>24, d1, d1>>8, d1>>16, d1>>24};
+    m3can_send(msg_id, false, buf, n<<2);
+}
+
+void m3can_send_i8(int16_t msg_id, int8_t d0, int8_t d1, int8_t d2,
+                 int8_t d3, int8_t d4, int8_t d5, int8_t d6, int8_t d7,
+                 size_t n)
+{
+    uint8_t buf[8] = {d0, d1, d2, d3, d4, d5, d6, d7};
+    m3can_send(msg_id, false, buf, n);
+}
+
+void m3can_send_i16(int16_t msg_id, int16_t d0, int16_t d1, int16_t d2,
+                  int16_t d3, size_t n)
+{
+    uint8_t buf[8] = {d0, d0>>8, d1, d1>>8, d2, d2>>8, d3, d3>>8};
+    m3can_send(msg_id, false, buf, n<<1);
+}
+
+void m3can_send_i32(int16_t msg_id, int32_t d0, int32_t d1, size_t n)
+{
+    uint8_t buf[8] = {d0, d0>>8, d0>>16, d0>>24, d1, d1>>8, d1>>16, d1>>24};
+    m3can_send(msg_id, false, buf, n<<2);
+}
+
+void m3can_send_f32(uint16_t msg_id, float d0, float d1, size_t n)
+{
+    float buf[2] = {d0, d1};
+    m3can_send(msg_id, false, (uint8_t*)buf, n<<2);
+}
@@ -0,0 +1,377 @@
+/*
+ * CAN bulk transfer test
+ * M3 shared
+ * Cambridge University Spaceflight
+ *
+ * Runs m3can_bulk as M3FC against a peer board written here from the frame
+ * layout in m3can_bulk.h, with frames passed straight between the two.
+ * Checks blobs in both directions survive intact, that neither side sends
+ * more than a window of consecutive frames between flow control frames,
+ * and that aborts, timeouts, bad sequence numbers, oversized blobs and
+ * requests are handled.
+ *
+ * Built against the shared/m3host ChibiOS shim. Exits non-zero if any
+ * check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ch.h"
+#include "m3can.h"
+#include "m3can_bulk.h"
+
+#define PEER        (CAN_ID_GROUND)
+#define PORT_TEST   (7)
+#define PORT_SINK   (8)
+#define PORT_READ   (9)
+
+uint8_t m3can_own_id = CAN_ID_M3FC;
+
+static int failures;
+
+/* The peer: receives what we send, pacing it with its own window */
+static struct {
+    /* Behaviour */
+    uint8_t bs;
+    uint8_t abort;
+    bool silent;
+
+    /* Blob being received */
+    bool active;
+    uint8_t port;
+    uint8_t sn;
+    uint8_t data[2048];
+    size_t len;
+    size_t got;
+    int since_fc;
+    int max_since_fc;
+    bool done;
+
+    /* Flow control frames we've sent it */
+    uint8_t fc[64][4];
+    int num_fc;
+    int cf_since_fc;
+    int max_cf_since_fc;
+} peer;
+
+/* Blob delivered to our RX callback */
+static uint8_t rx_buf[256];
+static uint8_t rx_got[256];
+static size_t rx_len;
+static uint8_t rx_src;
+static int rx_count;
+
+static void check(const char* name, bool ok)
+{
+    if(!ok) {
+        failures++;
+    }
+    printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+}
+
+static void peer_reset(void)
+{
+    chSysLock();
+    memset(&peer, 0, sizeof(peer));
+    chSysUnlock();
+}
+
+static void peer_send_fc(uint8_t status, uint8_t bs)
+{
+    uint8_t frame[4] = {M3CAN_BULK_FC | status, CAN_ID_M3FC, bs, 0};
+    m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_FLOW, frame, sizeof(frame));
+}
+
+static void peer_recv_data(const uint8_t* data, uint8_t len)
+{
+    uint8_t type = data[0] & 0xF0;
+
+    if(type == M3CAN_BULK_SF && (data[0] & 0x0F) == PEER) {
+        peer.port = data[1];
+        peer.len = peer.got = len - 2;
+        memcpy(peer.data, &data[2], peer.len);
+        peer.done = true;
+    } else if(type == M3CAN_BULK_FF && (data[0] & 0x0F) == PEER) {
+        if(peer.silent) {
+            return;
+        } else if(peer.abort) {
+            peer_send_fc(M3CAN_BULK_FC_ABORT, peer.abort);
+            return;
+        }
+        peer.active = true;
+        peer.port = data[1];
+        peer.len = data[2] | (data[3] << 8);
+        memcpy(peer.data, &data[4], 4);
+        peer.got = 4;
+        peer.sn = 1;
+        peer.since_fc = 0;
+        peer_send_fc(M3CAN_BULK_FC_CTS, peer.bs);
+    } else if(type == M3CAN_BULK_CF && peer.active) {
+        size_t n = len - 1;
+        if((data[0] & 0x0F) != (peer.sn++ & 0x0F) ||
+           peer.got + n > peer.len) {
+            peer.active = false;
+            peer_send_fc(M3CAN_BULK_FC_ABORT, M3CAN_BULK_ABORT_SEQUENCE);
+            return;
+        }
+        memcpy(&peer.data[peer.got], &data[1], n);
+        peer.got += n;
+        if(++peer.since_fc > peer.max_since_fc) {
+            peer.max_since_fc = peer.since_fc;
+        }
+        if(peer.got == peer.len) {
+            peer.active = false;
+            peer.done = true;
+            peer_send_fc(M3CAN_BULK_FC_DONE, 0);
+        } else if(peer.bs != 0 && peer.since_fc == peer.bs) {
+            peer.since_fc = 0;
+            peer_send_fc(M3CAN_BULK_FC_CTS, peer.bs);
+        }
+    }
+}
+
+/* Everything we send goes straight to the peer, which may answer at once */
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)can_rtr;
+
+    if((msg_id & 0x1F) != CAN_ID_M3FC) {
+        printf("sent with board ID %d\n", msg_id & 0x1F);
+        failures++;
+        return;
+    }
+
+    if((msg_id & ~0x1F) == CAN_MSG_ID_BULK_DATA) {
+        peer_recv_data(data, datalen);
+    } else if((msg_id & ~0x1F) == CAN_MSG_ID_BULK_FLOW &&
+              (data[0] & 0xF0) == M3CAN_BULK_FC && data[1] == PEER &&
+              peer.num_fc < 64) {
+        memcpy(peer.fc[peer.num_fc++], data, 4);
+        if(peer.cf_since_fc > peer.max_cf_since_fc) {
+            peer.max_cf_since_fc = peer.cf_since_fc;
+        }
+        peer.cf_since_fc = 0;
+    }
+}
+
+static void rx_cb(uint8_t src, uint8_t port, const uint8_t* data, size_t len)
+{
+    (void)port;
+    rx_src = src;
+    rx_len = len;
+    if(data != NULL) {
+        memcpy(rx_got, data, len);
+    }
+    rx_count++;
+}
+
+static size_t read_cb(uint8_t port, uint8_t* buf, size_t size)
+{
+    (void)port;
+    for(size_t i=0; i<size; i++) {
+        buf[i] = i * 7;
+    }
+    return size;
+}
+
+static void fill(uint8_t* buf, size_t len, uint8_t seed)
+{
+    for(size_t i=0; i<len; i++) {
+        buf[i] = (uint8_t)(i * 31 + seed);
+    }
+}
+
+static void check_send(const char* name, size_t len, uint8_t bs)
+{
+    static uint8_t blob[2048];
+    char label[64];
+
+    fill(blob, len, len);
+    peer_reset();
+    peer.bs = bs;
+
+    m3can_bulk_result_t rv = m3can_bulk_send(PEER, PORT_TEST, blob, len);
+
+    snprintf(label, sizeof(label), "send %s, %zu bytes", name, len);
+    check(label, rv == M3CAN_BULK_OK && peer.done && peer.len == len &&
+                 peer.port == PORT_TEST && memcmp(peer.data, blob, len) == 0 &&
+                 (bs == 0 || peer.max_since_fc <= bs));
+}
+
+static void check_send_fails(void)
+{
+    uint8_t blob[64] = {0};
+
+    peer_reset();
+    peer.abort = M3CAN_BULK_ABORT_PORT;
+    check("send refused by receiver",
+          m3can_bulk_send(PEER, PORT_TEST, blob, sizeof(blob)) ==
+          M3CAN_BULK_ABORTED);
+
+    peer_reset();
+    peer.silent = true;
+    check("send to silent receiver times out",
+          m3can_bulk_send(PEER, PORT_TEST, blob, sizeof(blob)) ==
+          M3CAN_BULK_TIMEOUT);
+
+    check("send empty blob",
+          m3can_bulk_send(PEER, PORT_TEST, blob, 0) == M3CAN_BULK_INVALID);
+}
+
+/* Send `len` bytes to our `port` as the peer, optionally skipping frame
+ * `skip`, answering the flow control we send.
+ */
+static void peer_send_blob(uint8_t port, const uint8_t* blob, size_t len,
+                           int skip)
+{
+    uint8_t frame[8];
+    size_t pos = 4;
+    uint8_t sn = 1;
+
+    frame[0] = M3CAN_BULK_FF | CAN_ID_M3FC;
+    frame[1] = port;
+    frame[2] = len & 0xFF;
+    frame[3] = len >> 8;
+    memcpy(&frame[4], blob, 4);
+    m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_DATA, frame, 8);
+
+    for(int i=0; pos < len; i++) {
+        size_t n = len - pos > 7 ? 7 : len - pos;
+        frame[0] = M3CAN_BULK_CF | (sn++ & 0x0F);
+        memcpy(&frame[1], &blob[pos], n);
+        pos += n;
+        if(i == skip) {
+            continue;
+        }
+        peer.cf_since_fc++;
+        m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_DATA, frame, n + 1);
+    }
+}
+
+static void check_receive(void)
+{
+    uint8_t blob[200];
+    uint8_t frame[8];
+    bool ok;
+
+    /* Whole blob, in windows */
+    fill(blob, sizeof(blob), 3);
+    peer_reset();
+    rx_count = 0;
+    peer_send_blob(PORT_TEST, blob, sizeof(blob), -1);
+    ok = rx_count == 1 && rx_src == PEER && rx_len == sizeof(blob) &&
+         memcmp(rx_got, blob, sizeof(blob)) == 0 && peer.num_fc > 1 &&
+         peer.fc[0][0] == (M3CAN_BULK_FC | M3CAN_BULK_FC_CTS) &&
+         peer.fc[0][2] == M3CAN_BULK_BLOCK_SIZE &&
+         peer.fc[peer.num_fc-1][0] == (M3CAN_BULK_FC | M3CAN_BULK_FC_DONE) &&
+         peer.max_cf_since_fc <= M3CAN_BULK_BLOCK_SIZE;
+    check("receive 200 bytes", ok);
+
+    /* Single frame */
+    rx_count = 0;
+    frame[0] = M3CAN_BULK_SF | CAN_ID_M3FC;
+    frame[1] = PORT_TEST;
+    memcpy(&frame[2], "hello", 5);
+    m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_DATA, frame, 7);
+    check("receive single frame",
+          rx_count == 1 && rx_len == 5 && memcmp(rx_got, "hello", 5) == 0);
+
+    /* Lost consecutive frame */
+    peer_reset();
+    rx_count = 0;
+    peer_send_blob(PORT_TEST, blob, sizeof(blob), 5);
+    check("receive with a frame lost aborts",
+          rx_count == 0 && peer.num_fc >= 1 &&
+          peer.fc[peer.num_fc-1][0] == (M3CAN_BULK_FC | M3CAN_BULK_FC_ABORT) &&
+          peer.fc[peer.num_fc-1][2] == M3CAN_BULK_ABORT_SEQUENCE);
+
+    /* Longer than the buffer */
+    static uint8_t big[300];
+    peer_reset();
+    peer_send_blob(PORT_TEST, big, sizeof(big), -1);
+    check("receive oversized blob aborts",
+          peer.num_fc == 1 &&
+          peer.fc[0][0] == (M3CAN_BULK_FC | M3CAN_BULK_FC_ABORT) &&
+          peer.fc[0][2] == M3CAN_BULK_ABORT_LENGTH);
+
+    /* Nobody listening */
+    peer_reset();
+    peer_send_blob(42, blob, sizeof(blob), -1);
+    check("receive on unregistered port aborts",
+          peer.num_fc == 1 && peer.fc[0][2] == M3CAN_BULK_ABORT_PORT);
+
+    /* Accepted without a buffer */
+    peer_reset();
+    rx_count = 0;
+    peer_send_blob(PORT_SINK, big, sizeof(big), -1);
+    check("receive into sink",
+          rx_count == 1 && rx_len == sizeof(big) &&
+          peer.fc[peer.num_fc-1][0] == (M3CAN_BULK_FC | M3CAN_BULK_FC_DONE));
+
+    /* For another board: ignored */
+    peer_reset();
+    frame[0] = M3CAN_BULK_FF | CAN_ID_M3DL;
+    frame[1] = PORT_TEST;
+    frame[2] = 100;
+    frame[3] = 0;
+    m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_DATA, frame, 8);
+    check("first frame for another board ignored", peer.num_fc == 0);
+}
+
+static void check_request(void)
+{
+    uint8_t frame[3] = {M3CAN_BULK_RQ, CAN_ID_M3FC, PORT_READ};
+    systime_t start = chVTGetSystemTimeX();
+    bool done = false;
+
+    peer_reset();
+    peer.bs = 4;
+    m3can_bulk_frame(PEER | CAN_MSG_ID_BULK_FLOW, frame, sizeof(frame));
+
+    while(!done && ST2MS(chVTTimeElapsedSinceX(start)) < 2000) {
+        chThdSleepMilliseconds(10);
+        chSysLock();
+        done = peer.done;
+        chSysUnlock();
+    }
+
+    bool ok = done && peer.port == PORT_READ && peer.len == 100;
+    for(size_t i=0; ok && i<peer.len; i++) {
+        ok = peer.data[i] == (uint8_t)(i * 7);
+    }
+    check("request served", ok);
+}
+
+int main(void)
+{
+    static uint8_t read_buf[100];
+
+    chSysInit();
+
+    m3can_bulk_register_rx(PORT_TEST, rx_buf, sizeof(rx_buf), rx_cb);
+    m3can_bulk_register_rx(PORT_SINK, NULL, 0, rx_cb);
+    m3can_bulk_register_tx(PORT_READ, read_buf, sizeof(read_buf), read_cb);
+    m3can_bulk_init();
+
+    check_send("single frame", 5, 8);
+    check_send("two frames", 11, 8);
+    check_send("window of 8", 1000, 8);
+    check_send("window of 1", 300, 1);
+    check_send("no window", 2048, 0);
+    check_send_fails();
+    check_send("after a timeout", 500, 8);
+
+    check_receive();
+    check_request();
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * CAN receive dispatch test
+ * M3 shared
+ * Cambridge University Spaceflight
+ *
+ * Runs every standard ID at every payload length through M3Pyro's
+ * generated dispatch table and a synthetic one with handlers for the same
+ * message from every board, and checks each frame reaches exactly the
+ * handler a linear search of the handler list would pick, only at lengths
+ * it accepts, with bad lengths reported through m3status.
+ *
+ * Built against the shared/m3host ChibiOS shim. Exits non-zero if any
+ * check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "m3can.h"
+#include "m3status.h"
+
+#define NUM_SIDS    (2048)
+
+/* Only for the packers in m3can_util.c, which aren't used here */
+uint8_t m3can_own_id;
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)msg_id;
+    (void)can_rtr;
+    (void)data;
+    (void)datalen;
+}
+
+static int bad_length_reports;
+void m3status_set_error_data(uint8_t component, uint8_t errorcode,
+                             const uint8_t* data, uint8_t datalen)
+{
+    (void)data;
+    (void)datalen;
+    if(component == M3STATUS_COMPONENT_CAN &&
+       errorcode == M3STATUS_ERROR_CAN_BAD_LENGTH) {
+        bad_length_reports++;
+    }
+}
+
+static int failures;
+static int called;
+
+static void check(const char* name, bool ok)
+{
+    if(!ok) {
+        failures++;
+    }
+    printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+}
+
+/* Each handler records its position in the list below */
+#define HANDLER(n) \
+    static void handler_##n(uint8_t* data, uint8_t datalen) \
+    { (void)data; (void)datalen; called = n; }
+HANDLER(1) HANDLER(2) HANDLER(3) HANDLER(4) HANDLER(5) HANDLER(6)
+HANDLER(7) HANDLER(8) HANDLER(9)
+
+/* M3Pyro's handlers, for its generated table */
+void m3pyro_can_handle_fire(uint8_t* data, uint8_t datalen)
+{
+    handler_1(data, datalen);
+}
+void m3pyro_can_handle_arm(uint8_t* data, uint8_t datalen)
+{
+    handler_2(data, datalen);
+}
+extern const struct m3can_dispatch_table m3pyro_can_dispatch;
+static const struct m3can_handler pyro_handlers[] = {
+    {CAN_MSG_ID_M3PYRO_FIRE_COMMAND, 1, 8, handler_1},
+    {CAN_MSG_ID_M3PYRO_ARM_COMMAND, 1, 1, handler_2},
+};
+
+/* Message 63 from every board, plus one at the lowest and highest IDs */
+static const struct m3can_handler all_handlers[] = {
+    {(63 << 5) | 1, 0, 8, handler_1},
+    {(63 << 5) | 2, 8, 8, handler_2},
+    {(63 << 5) | 3, 0, 0, handler_3},
+    {(63 << 5) | 4, 2, 4, handler_4},
+    {(63 << 5) | 5, 1, 1, handler_5},
+    {(63 << 5) | 6, 3, 8, handler_6},
+    {(63 << 5) | 7, 8, 8, handler_7},
+    {(0 << 5) | 1, 0, 8, handler_8},
+    {(1 << 5) | 7, 0, 8, handler_9},
+};
+static const uint8_t all_index[M3CAN_DISPATCH_SLOTS] = {
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 1)] = 1,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 2)] = 2,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 3)] = 3,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 4)] = 4,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 5)] = 5,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 6)] = 6,
+    [M3CAN_DISPATCH_SLOT((63 << 5) | 7)] = 7,
+    [M3CAN_DISPATCH_SLOT((0 << 5) | 1)] = 8,
+    [M3CAN_DISPATCH_SLOT((1 << 5) | 7)] = 9,
+};
+static const struct m3can_dispatch_table all_dispatch = {
+    all_index, all_handlers,
+};
+
+/* Dispatch every ID and length through `table` and compare against a
+ * linear search of the `n` handlers in `list`.
+ */
+static void check_table(const char* name,
+                        const struct m3can_dispatch_table* table,
+                        const struct m3can_handler* list, size_t n)
+{
+    uint8_t data[8] = {0};
+    int wrong = 0, dispatched = 0, rejected = 0;
+
+    bad_length_reports = 0;
+
+    for(uint16_t sid=0; sid<NUM_SIDS; sid++) {
+        for(uint8_t len=0; len<=8; len++) {
+            int expect = 0;
+            m3can_dispatch_result_t expect_rv = M3CAN_DISPATCH_NO_HANDLER;
+
+            for(size_t i=0; i<n; i++) {
+                if(list[i].msg_id == sid) {
+                    if(len >= list[i].min_len && len <= list[i].max_len) {
+                        expect = i + 1;
+                        expect_rv = M3CAN_DISPATCH_OK;
+                    } else {
+                        expect_rv = M3CAN_DISPATCH_BAD_LENGTH;
+                    }
+                }
+            }
+
+            called = 0;
+            m3can_dispatch_result_t rv = m3can_dispatch(table, sid, data, len);
+            if(rv != expect_rv || called != expect) {
+                if(wrong++ < 5) {
+                    printf("  %03x len %u: handler %d rv %d, "
+                           "expected %d rv %d\n",
+                           sid, len, called, rv, expect, expect_rv);
+                }
+            }
+            dispatched += rv == M3CAN_DISPATCH_OK;
+            rejected += rv == M3CAN_DISPATCH_BAD_LENGTH;
+        }
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s: %d dispatched, %d rejected",
+             name, dispatched, rejected);
+    check(label, wrong == 0 && bad_length_reports == rejected);
+}
+
+int main(void)
+{
+    check_table("m3pyro generated table", &m3pyro_can_dispatch,
+                pyro_handlers, sizeof(pyro_handlers)/sizeof(pyro_handlers[0]));
+    check_table("every board", &all_dispatch,
+                all_handlers, sizeof(all_handlers)/sizeof(all_handlers[0]));
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * CAN acceptance filter planner test
+ * M3 shared
+ * Cambridge University Spaceflight
+ *
+ * Plans filters for each board's generated M3CAN_RX_IDS list, then runs
+ * every standard ID, as both a data and a remote frame, through a model of
+ * the STM32 filter hardware and checks exactly the requested frames pass.
+ * Synthetic lists check that mask packing finds aligned groups, that remote
+ * frames are handled, and that lists too big for the banks fall back to
+ * accepting a superset rather than dropping anything.
+ *
+ * Exits non-zero if any check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "m3can_filter.h"
+
+/* Only for the generated packers, which aren't used here */
+extern uint8_t m3can_own_id;
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen);
+
+#include "m3can_msgs.h"
+
+#define NUM_SIDS    (2048)
+
+static int failures;
+
+static bool requested(const uint16_t* ids, size_t n, uint16_t sid, bool rtr)
+{
+    for(size_t i=0; i<n; i++) {
+        if((ids[i] & 0x7FF) == sid && (!rtr || (ids[i] & M3CAN_FILTER_RTR))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Plan filters for `ids` in `max_banks` banks and check them against the
+ * hardware model. If `exact` is set, the plan must pass exactly the
+ * requested frames in at most `expect_banks` banks (if non-zero). Otherwise
+ * it may pass extra frames. Missing a requested frame always fails.
+ */
+static void check(const char* name, const uint16_t* ids, size_t n,
+                  size_t max_banks, bool exact, size_t expect_banks)
+{
+    struct m3can_filter_bank banks[M3CAN_FILTER_BANKS];
+    size_t num_banks;
+    int missed = 0, extra = 0;
+    bool ok;
+
+    m3can_filter_result_t result = m3can_filter_plan(ids, n, banks,
+                                                     max_banks, &num_banks);
+
+    for(uint16_t sid=0; sid<NUM_SIDS; sid++) {
+        for(int rtr=0; rtr<2; rtr++) {
+            bool want = requested(ids, n, sid, rtr);
+            bool pass = m3can_filter_match(banks, num_banks, sid, rtr);
+            if(want && !pass) {
+                missed++;
+            } else if(pass && !want) {
+                extra++;
+            }
+        }
+    }
+
+    ok = missed == 0 && num_banks <= max_banks;
+    if(exact) {
+        ok = ok && result == M3CAN_FILTER_EXACT && extra == 0;
+        if(expect_banks) {
+            ok = ok && num_banks <= expect_banks;
+        }
+    } else {
+        ok = ok && result != M3CAN_FILTER_EXACT;
+    }
+
+    printf("%-28s %3zu IDs: %2zu banks, %s, %d missed, %d extra  %s\n",
+           name, n, num_banks,
+           result == M3CAN_FILTER_EXACT ? "exact" :
+           result == M3CAN_FILTER_WIDENED ? "widened" : "all",
+           missed, extra, ok ? "PASS" : "FAIL");
+    if(!ok) {
+        failures++;
+    }
+}
+
+#define CHECK_BOARD(board, expect_banks) do {                                 \
+        static const uint16_t ids[] = M3CAN_RX_IDS_##board;                   \
+        check(#board, ids, sizeof(ids)/sizeof(ids[0]),                        \
+              M3CAN_FILTER_BANKS, true, expect_banks);                        \
+    } while(0)
+
+int main(void)
+{
+    uint16_t ids[M3CAN_FILTER_MAX_IDS + 1];
+    size_t n;
+
+    /* The schema, where every board must fit exactly */
+    CHECK_BOARD(M3FC, 0);
+    CHECK_BOARD(M3PSU, 2);
+    CHECK_BOARD(M3PYRO, 2);
+
+    /* Every message from one board is a single mask filter */
+    for(n=0; n<64; n++) {
+        ids[n] = (n << 5) | CAN_ID_M3IMU;
+    }
+    check("whole board", ids, n, M3CAN_FILTER_BANKS, true, 1);
+
+    /* One message from every board is a single mask filter */
+    for(n=0; n<32; n++) {
+        ids[n] = (40 << 5) | n;
+    }
+    check("message from all boards", ids, n, M3CAN_FILTER_BANKS, true, 1);
+
+    /* Unrelated IDs go four to a list bank */
+    const uint16_t scattered[] = {
+        (1 << 5) | 1, (2 << 5) | 2, (4 << 5) | 3, (8 << 5) | 4,
+        (16 << 5) | 5, (32 << 5) | 6, (63 << 5) | 7, (33 << 5) | 4,
+    };
+    check("scattered", scattered, 8, M3CAN_FILTER_BANKS, true, 2);
+
+    /* An aligned block plus one more uses the block's spare mask slot */
+    for(n=0; n<8; n++) {
+        ids[n] = ((8 + n) << 5) | CAN_ID_M3FC;
+    }
+    ids[n++] = (50 << 5) | CAN_ID_M3DL;
+    check("block and single", ids, n, M3CAN_FILTER_BANKS, true, 1);
+
+    /* Remote frames pass only for the IDs that ask for them */
+    const uint16_t remote[] = {
+        (20 << 5) | 1 | M3CAN_FILTER_RTR, (21 << 5) | 1, (22 << 5) | 1,
+        (23 << 5) | 1 | M3CAN_FILTER_RTR, (40 << 5) | 2 | M3CAN_FILTER_RTR,
+        (40 << 5) | 2,
+    };
+    check("remote frames", remote, 6, M3CAN_FILTER_BANKS, true, 2);
+
+    /* Duplicates are merged */
+    const uint16_t dups[] = {(3 << 5) | 1, (3 << 5) | 1, (5 << 5) | 1};
+    check("duplicates", dups, 3, M3CAN_FILTER_BANKS, true, 1);
+
+    /* Too many scattered IDs for the banks: widen the busiest boards */
+    srand(1);
+    for(n=0; n<M3CAN_FILTER_MAX_IDS; n++) {
+        ids[n] = ((rand() % 64) << 5) | (1 + rand() % 7);
+    }
+    check("random, 27 banks", ids, n, M3CAN_FILTER_BANKS, true, 0);
+    check("random, 4 banks", ids, n, 4, false, 0);
+    check("random, 1 bank", ids, n, 1, false, 0);
+
+    /* More IDs than the planner holds: accept everything */
+    for(n=0; n<M3CAN_FILTER_MAX_IDS + 1; n++) {
+        ids[n] = n << 1;
+    }
+    check("too many IDs", ids, n, M3CAN_FILTER_BANKS, false, 0);
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
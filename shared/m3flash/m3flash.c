@@ -5,7 +5,6 @@
 
 #define M3FLASH_CFG_SECTOR (11)
 
-static uint32_t m3flash_crc(uint32_t* src, size_t n);
 static inline bool m3flash_wait_write(void);
 
 bool m3flash_write(uint32_t* src, uint32_t* dst, size_t n)
@@ -75,7 +74,7 @@ bool m3flash_read(uint32_t* src, uint32_t* dst, size_t n) {
     }
 }
 
-static uint32_t m3flash_crc(uint32_t* src, size_t n) {
+uint32_t m3flash_crc(uint32_t* src, size_t n) {
     uint32_t crc;
     size_t i;
     RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
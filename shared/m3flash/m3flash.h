@@ -13,4 +13,9 @@ bool m3flash_write(uint32_t* src, uint32_t* dst, size_t n);
  */
 bool m3flash_read(uint32_t* src, uint32_t* dst, size_t n);
 
+/* Compute the STM32 hardware CRC32 (CRC-32/MPEG-2, one 32bit word at a time)
+ * of n words from src, as stored after the data by m3flash_write.
+ */
+uint32_t m3flash_crc(uint32_t* src, size_t n);
+
 #endif
@@ -0,0 +1,205 @@
+/*
+ * Host ChibiOS/RT subset for running board firmware as a Linux process
+ * Cambridge University Spaceflight
+ *
+ * Only the kernel API the shared and board modules built by the host
+ * targets actually use is provided. Threads are pthreads and are not
+ * priority scheduled; the system lock is one process-wide mutex.
+ * See README.md in this directory.
+ */
+
+#ifndef M3HOST_CH_H
+#define M3HOST_CH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef TRUE
+#define TRUE    true
+#endif
+#ifndef FALSE
+#define FALSE   false
+#endif
+
+/* All boards run a 10kHz system tick */
+#define CH_CFG_ST_FREQUENCY     (10000)
+
+typedef uint32_t    systime_t;
+typedef intptr_t    msg_t;
+typedef int32_t     cnt_t;
+typedef uint8_t     tprio_t;
+typedef uint64_t    stkalign_t;
+typedef void        (*tfunc_t)(void *p);
+
+#define MSG_OK          ((msg_t)0)
+#define MSG_TIMEOUT     ((msg_t)-1)
+#define MSG_RESET       ((msg_t)-2)
+
+#define TIME_IMMEDIATE  ((systime_t)0)
+#define TIME_INFINITE   ((systime_t)-1)
+
+#define IDLEPRIO        ((tprio_t)1)
+#define LOWPRIO         ((tprio_t)2)
+#define NORMALPRIO      ((tprio_t)128)
+#define HIGHPRIO        ((tprio_t)255)
+
+/* Time conversions, rounding up as ChibiOS does */
+#define S2ST(sec)   ((systime_t)((uint32_t)(sec) * CH_CFG_ST_FREQUENCY))
+#define MS2ST(msec) ((systime_t)((((uint64_t)(msec) * CH_CFG_ST_FREQUENCY) \
+                                  + 999ULL) / 1000ULL))
+#define US2ST(usec) ((systime_t)((((uint64_t)(usec) * CH_CFG_ST_FREQUENCY) \
+                                  + 999999ULL) / 1000000ULL))
+#define ST2S(n)     ((uint32_t)(((uint64_t)(n) + CH_CFG_ST_FREQUENCY - 1ULL) \
+                                / CH_CFG_ST_FREQUENCY))
+#define ST2MS(n)    ((uint32_t)(((uint64_t)(n) * 1000ULL                    \
+                                 + CH_CFG_ST_FREQUENCY - 1ULL)              \
+                                / CH_CFG_ST_FREQUENCY))
+#define ST2US(n)    ((uint32_t)(((uint64_t)(n) * 1000000ULL                 \
+                                 + CH_CFG_ST_FREQUENCY - 1ULL)              \
+                                / CH_CFG_ST_FREQUENCY))
+
+/*===========================================================================*/
+/* Threads                                                                   */
+/*===========================================================================*/
+
+typedef struct m3host_thread thread_t;
+
+/* Static working areas only reserve their name on the host, the pthread
+ * gets its own stack.
+ */
+#define THD_WORKING_AREA(s, n)  stkalign_t s[((n) + sizeof(stkalign_t) - 1) \
+                                             / sizeof(stkalign_t)]
+#define THD_FUNCTION(tname, arg) void tname(void *arg)
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio,
+                            tfunc_t pf, void *arg);
+thread_t *chThdGetSelfX(void);
+void chThdSleep(systime_t time);
+void chThdSleepUntil(systime_t time);
+void chThdYield(void);
+void chRegSetThreadName(const char *name);
+
+#define chThdSleepSeconds(sec)          chThdSleep(S2ST(sec))
+#define chThdSleepMilliseconds(msec)    chThdSleep(MS2ST(msec))
+#define chThdSleepMicroseconds(usec)    chThdSleep(US2ST(usec))
+
+/*===========================================================================*/
+/* System lock and time                                                      */
+/*===========================================================================*/
+
+void chSysInit(void);
+void chSysLock(void);
+void chSysUnlock(void);
+#define chSysLockFromISR()      chSysLock()
+#define chSysUnlockFromISR()    chSysUnlock()
+#define chSchRescheduleS()      ((void)0)
+
+systime_t chVTGetSystemTimeX(void);
+/* Nanoseconds on the host, CPU cycles on the boards */
+typedef uint32_t    rtcnt_t;
+rtcnt_t chSysGetRealtimeCounterX(void);
+#define chVTGetSystemTime()             chVTGetSystemTimeX()
+#define chVTTimeElapsedSinceX(start)    \
+    ((systime_t)(chVTGetSystemTimeX() - (start)))
+
+void m3host_assert_fail(const char *reason, const char *file, int line);
+#define chDbgAssert(c, r) do {                                              \
+    if(!(c)) {                                                              \
+        m3host_assert_fail((r), __FILE__, __LINE__);                        \
+    }                                                                       \
+} while(0)
+#define chDbgCheck(c)   chDbgAssert((c), #c)
+
+/*===========================================================================*/
+/* Wait queues, binary semaphores, mailboxes and memory pools                */
+/*===========================================================================*/
+
+/* Threads blocked on an object, oldest first */
+typedef struct {
+    thread_t *head;
+    thread_t *tail;
+} threads_queue_t;
+
+#define _THREADS_QUEUE_DATA(name)   {NULL, NULL}
+
+typedef struct {
+    threads_queue_t queue;
+    cnt_t           cnt;
+} binary_semaphore_t;
+
+#define _BSEMAPHORE_DATA(name, taken)                                       \
+    {_THREADS_QUEUE_DATA(name.queue), (taken) ? 0 : 1}
+#define BSEMAPHORE_DECL(name, taken)                                        \
+    binary_semaphore_t name = _BSEMAPHORE_DATA(name, taken)
+
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken);
+msg_t chBSemWait(binary_semaphore_t *bsp);
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, systime_t time);
+void chBSemSignal(binary_semaphore_t *bsp);
+void chBSemSignalI(binary_semaphore_t *bsp);
+void chBSemReset(binary_semaphore_t *bsp, bool taken);
+
+typedef struct {
+    msg_t           *buffer;
+    msg_t           *top;
+    msg_t           *wrptr;
+    msg_t           *rdptr;
+    cnt_t           cnt;
+    threads_queue_t qw;
+    threads_queue_t qr;
+} mailbox_t;
+
+#define _MAILBOX_DATA(name, buffer, size) {                                 \
+    (msg_t *)(buffer),                                                      \
+    (msg_t *)(buffer) + (size),                                             \
+    (msg_t *)(buffer),                                                      \
+    (msg_t *)(buffer),                                                      \
+    0,                                                                      \
+    _THREADS_QUEUE_DATA(name.qw),                                           \
+    _THREADS_QUEUE_DATA(name.qr),                                           \
+}
+#define MAILBOX_DECL(name, buffer, size)                                    \
+    mailbox_t name = _MAILBOX_DATA(name, buffer, size)
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n);
+void chMBReset(mailbox_t *mbp);
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostS(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg);
+msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostAheadS(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg);
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+msg_t chMBFetchS(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+#define chMBGetSizeI(mbp)       ((cnt_t)((mbp)->top - (mbp)->buffer))
+#define chMBGetUsedCountI(mbp)  ((mbp)->cnt)
+#define chMBGetFreeCountI(mbp)  (chMBGetSizeI(mbp) - (mbp)->cnt)
+
+typedef void *(*memgetfunc_t)(size_t size, unsigned align);
+
+struct m3host_pool_header {
+    struct m3host_pool_header *next;
+};
+
+typedef struct {
+    struct m3host_pool_header *next;
+    size_t                    object_size;
+    memgetfunc_t              provider;
+} memory_pool_t;
+
+#define _MEMORYPOOL_DATA(name, size, provider)  {NULL, size, provider}
+#define MEMORYPOOL_DECL(name, size, provider)                               \
+    memory_pool_t name = _MEMORYPOOL_DATA(name, size, provider)
+
+void chPoolObjectInit(memory_pool_t *mp, size_t size, memgetfunc_t provider);
+void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n);
+void *chPoolAlloc(memory_pool_t *mp);
+void *chPoolAllocI(memory_pool_t *mp);
+void chPoolFree(memory_pool_t *mp, void *objp);
+void chPoolFreeI(memory_pool_t *mp, void *objp);
+#define chPoolAdd(mp, objp)     chPoolFree((mp), (objp))
+#define chPoolAddI(mp, objp)    chPoolFreeI((mp), (objp))
+
+#endif /* M3HOST_CH_H */
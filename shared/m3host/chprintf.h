@@ -0,0 +1,14 @@
+/*
+ * Host chprintf subset, formatting through the C library
+ * Cambridge University Spaceflight
+ */
+
+#ifndef M3HOST_CHPRINTF_H
+#define M3HOST_CHPRINTF_H
+
+#include <stddef.h>
+
+int chsnprintf(char *str, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#endif /* M3HOST_CHPRINTF_H */
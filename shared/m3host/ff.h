@@ -0,0 +1,85 @@
+/*
+ * Host FatFs subset, backed by files in the working directory
+ * Cambridge University Spaceflight
+ *
+ * The API, return codes and mode flags match the FatFs R0.11 in
+ * shared/fatfs, so the m3dl SD card code runs unchanged with the process's
+ * working directory standing in for the card. The drive prefix of a path
+ * is ignored. Files are one contiguous run of clusters for fast seek.
+ */
+
+#ifndef M3HOST_FF_H
+#define M3HOST_FF_H
+
+#include "integer.h"
+
+typedef char TCHAR;
+
+typedef struct {
+    BYTE    fs_type;
+    BYTE    csize;
+    DWORD   free_clust;
+} FATFS;
+
+typedef struct {
+    FATFS   *fs;
+    int     fd;
+    BYTE    flag;
+    DWORD   fptr;
+    DWORD   fsize;
+    DWORD   *cltbl;
+} FIL;
+
+typedef enum {
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_NO_FILE,
+    FR_NO_PATH,
+    FR_INVALID_NAME,
+    FR_DENIED,
+    FR_EXIST,
+    FR_INVALID_OBJECT,
+    FR_WRITE_PROTECTED,
+    FR_INVALID_DRIVE,
+    FR_NOT_ENABLED,
+    FR_NO_FILESYSTEM,
+    FR_MKFS_ABORTED,
+    FR_TIMEOUT,
+    FR_LOCKED,
+    FR_NOT_ENOUGH_CORE,
+    FR_TOO_MANY_OPEN_FILES,
+    FR_INVALID_PARAMETER
+} FRESULT;
+
+#define FA_READ             0x01
+#define FA_OPEN_EXISTING    0x00
+#define FA_WRITE            0x02
+#define FA_CREATE_NEW       0x04
+#define FA_CREATE_ALWAYS    0x08
+#define FA_OPEN_ALWAYS      0x10
+
+/* f_lseek offset to fill in the fast seek table `cltbl` */
+#define CREATE_LINKMAP      0xFFFFFFFF
+
+/* Clusters reported by f_getfree are this many 512 byte sectors, the
+ * 16KB clusters the m3dl cards are formatted with.
+ */
+#define M3HOST_FF_CLUSTER_SECTORS   (32)
+
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt);
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode);
+FRESULT f_close(FIL *fp);
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br);
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw);
+FRESULT f_lseek(FIL *fp, DWORD ofs);
+FRESULT f_truncate(FIL *fp);
+FRESULT f_sync(FIL *fp);
+FRESULT f_unlink(const TCHAR *path);
+FRESULT f_getfree(const TCHAR *path, DWORD *nclst, FATFS **fatfs);
+
+#define f_tell(fp)  ((fp)->fptr)
+#define f_size(fp)  ((fp)->fsize)
+
+#endif /* M3HOST_FF_H */
@@ -0,0 +1,137 @@
+/*
+ * Host ChibiOS/HAL subset for running board firmware as a Linux process
+ * Cambridge University Spaceflight
+ *
+ * GPIO lines are kept in a table and their changes can be traced, see
+ * m3host.h. The other drivers only provide the types and calls the host
+ * targets' modules need, with no hardware behind them.
+ */
+
+#ifndef M3HOST_HAL_H
+#define M3HOST_HAL_H
+
+#include "ch.h"
+
+/*===========================================================================*/
+/* PAL                                                                       */
+/*===========================================================================*/
+
+typedef uint32_t ioportid_t;
+typedef uint32_t ioline_t;
+
+#define GPIOA   ((ioportid_t)0)
+#define GPIOB   ((ioportid_t)1)
+#define GPIOC   ((ioportid_t)2)
+#define GPIOD   ((ioportid_t)3)
+#define GPIOE   ((ioportid_t)4)
+#define GPIOF   ((ioportid_t)5)
+#define GPIOG   ((ioportid_t)6)
+#define GPIOH   ((ioportid_t)7)
+#define GPIOI   ((ioportid_t)8)
+#define M3HOST_PAL_PORTS    (9)
+
+#define PAL_LINE(port, pad) ((ioline_t)(((port) << 4) | (pad)))
+#define PAL_PORT(line)      ((ioportid_t)((line) >> 4))
+#define PAL_PAD(line)       ((uint32_t)((line) & 0x0F))
+
+#define PAL_LOW     (0U)
+#define PAL_HIGH    (1U)
+
+void palWriteLine(ioline_t line, uint8_t bit);
+uint8_t palReadLine(ioline_t line);
+void palToggleLine(ioline_t line);
+#define palSetLine(line)            palWriteLine((line), PAL_HIGH)
+#define palClearLine(line)          palWriteLine((line), PAL_LOW)
+#define palWritePad(port, pad, bit) palWriteLine(PAL_LINE(port, pad), (bit))
+#define palReadPad(port, pad)       palReadLine(PAL_LINE(port, pad))
+#define palTogglePad(port, pad)     palToggleLine(PAL_LINE(port, pad))
+#define palSetPad(port, pad)        palWritePad((port), (pad), PAL_HIGH)
+#define palClearPad(port, pad)      palWritePad((port), (pad), PAL_LOW)
+
+/* Pin modes are fixed by the board files on hardware, so ignored here */
+#define palSetLineMode(line, mode)          ((void)(line), (void)(mode))
+#define palSetPadMode(port, pad, mode)      ((void)(port), (void)(pad))
+
+/*===========================================================================*/
+/* Driver stubs                                                              */
+/*===========================================================================*/
+
+#define HAL_SUCCESS     false
+#define HAL_FAILED      true
+
+typedef uint16_t adcsample_t;
+
+typedef struct {
+    int unused;
+} SPIDriver;
+
+typedef struct {
+    int unused;
+} EXTDriver;
+typedef uint32_t expchannel_t;
+
+typedef struct PWMDriver PWMDriver;
+typedef void (*pwmcallback_t)(PWMDriver *pwmp);
+typedef uint32_t pwmcnt_t;
+typedef uint8_t pwmchannel_t;
+
+#define PWM_CHANNELS            (4)
+#define PWM_OUTPUT_DISABLED     (0)
+#define PWM_OUTPUT_ACTIVE_HIGH  (1)
+#define PWM_OUTPUT_ACTIVE_LOW   (2)
+
+typedef struct {
+    uint32_t        mode;
+    pwmcallback_t   callback;
+} PWMChannelConfig;
+
+typedef struct {
+    uint32_t            frequency;
+    pwmcnt_t            period;
+    pwmcallback_t       callback;
+    PWMChannelConfig    channels[PWM_CHANNELS];
+    uint32_t            cr2;
+    uint32_t            dier;
+} PWMConfig;
+
+struct PWMDriver {
+    const char      *name;
+    const PWMConfig *config;
+    uint8_t         enabled;
+};
+
+extern PWMDriver PWMD5;
+
+void pwmStart(PWMDriver *pwmp, const PWMConfig *config);
+void pwmStop(PWMDriver *pwmp);
+void pwmEnableChannel(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width);
+void pwmDisableChannel(PWMDriver *pwmp, pwmchannel_t channel);
+
+#define SDC_MODE_1BIT   (0)
+#define SDC_MODE_4BIT   (1)
+#define SDC_MODE_8BIT   (2)
+
+typedef struct {
+    uint8_t     *scratchpad;
+    uint32_t    bus_width;
+} SDCConfig;
+
+typedef struct {
+    const SDCConfig *config;
+    bool            connected;
+} SDCDriver;
+
+extern SDCDriver SDCD1;
+
+/* The card is a directory on the host, so connecting always succeeds */
+void sdcStart(SDCDriver *sdcp, const SDCConfig *config);
+void sdcStop(SDCDriver *sdcp);
+bool sdcConnect(SDCDriver *sdcp);
+bool sdcDisconnect(SDCDriver *sdcp);
+
+void halInit(void);
+
+/* Each host target puts its board's firmware directory on the include path */
+#include "board.h"
+
+#endif /* M3HOST_HAL_H */
@@ -0,0 +1,20 @@
+/*
+ * FatFs integer types with their embedded widths on a 64 bit host
+ * Cambridge University Spaceflight
+ */
+
+#ifndef _FF_INTEGER
+#define _FF_INTEGER
+
+#include <stdint.h>
+
+typedef uint8_t     BYTE;
+typedef int16_t     SHORT;
+typedef uint16_t    WORD;
+typedef uint16_t    WCHAR;
+typedef int         INT;
+typedef unsigned    UINT;
+typedef int32_t     LONG;
+typedef uint32_t    DWORD;
+
+#endif
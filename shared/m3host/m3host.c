@@ -0,0 +1,793 @@
+/*
+ * Host runtime for board firmware: kernel, PAL and driver stubs on pthreads
+ * Cambridge University Spaceflight
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+#include "m3host.h"
+
+/* Host threads get a real stack instead of their working area */
+#define M3HOST_STACK_SIZE   (256 * 1024)
+
+/* Nanoseconds in one system tick */
+#define M3HOST_TICK_NS      (1000000000ULL / CH_CFG_ST_FREQUENCY)
+
+struct m3host_thread {
+    pthread_t       pthread;
+    pthread_cond_t  cond;
+    const char      *name;
+    tfunc_t         pf;
+    void            *arg;
+
+    /* Set while blocked on `queue`, cleared by whoever wakes us */
+    threads_queue_t *queue;
+    thread_t        *next;
+    msg_t           rdymsg;
+
+    bool            done;
+    thread_t        *reg_next;
+};
+
+/* The system lock. Every kernel object is only touched with it held. */
+static pthread_mutex_t m3host_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread thread_t *m3host_self;
+static thread_t *m3host_registry;
+
+static uint64_t m3host_t0_ns;
+static double m3host_speedup = 1.0;
+static bool m3host_have_duration;
+static systime_t m3host_duration;
+static volatile sig_atomic_t m3host_stop_requested;
+
+static const char *m3host_board = "host";
+static char *m3host_trace_list;
+static bool m3host_trace_all;
+
+static uint16_t m3host_pal[M3HOST_PAL_PORTS];
+
+PWMDriver PWMD5 = {"PWMD5", NULL, 0};
+SDCDriver SDCD1 = {NULL, false};
+
+/*===========================================================================*/
+/* Time                                                                      */
+/*===========================================================================*/
+
+static uint64_t m3host_monotonic_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+systime_t chVTGetSystemTimeX(void)
+{
+    uint64_t ns = m3host_monotonic_ns() - m3host_t0_ns;
+    return (systime_t)(uint64_t)((double)ns * m3host_speedup /
+                                 (double)M3HOST_TICK_NS);
+}
+
+rtcnt_t chSysGetRealtimeCounterX(void)
+{
+    return (rtcnt_t)m3host_monotonic_ns();
+}
+
+/* Absolute CLOCK_MONOTONIC time `ticks` of virtual time from now */
+static void m3host_deadline(systime_t ticks, struct timespec *ts)
+{
+    uint64_t ns = m3host_monotonic_ns() +
+                  (uint64_t)((double)ticks * (double)M3HOST_TICK_NS /
+                             m3host_speedup);
+    ts->tv_sec = ns / 1000000000ULL;
+    ts->tv_nsec = ns % 1000000000ULL;
+}
+
+int m3host_real_ms(systime_t ticks)
+{
+    return (int)((double)ticks * (double)M3HOST_TICK_NS / m3host_speedup
+                 / 1e6) + 1;
+}
+
+/*===========================================================================*/
+/* Threads                                                                   */
+/*===========================================================================*/
+
+static void m3host_thread_setup(thread_t *tp, const char *name)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&tp->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    tp->name = name;
+
+    pthread_mutex_lock(&m3host_lock);
+    tp->reg_next = m3host_registry;
+    m3host_registry = tp;
+    pthread_mutex_unlock(&m3host_lock);
+}
+
+/* The calling thread, registering it first if it wasn't created by
+ * chThdCreateStatic (the main thread, or a thread created before init).
+ */
+static thread_t *m3host_current(void)
+{
+    if(m3host_self == NULL) {
+        thread_t *tp = calloc(1, sizeof(thread_t));
+        chDbgAssert(tp != NULL, "out of memory");
+        tp->pthread = pthread_self();
+        m3host_thread_setup(tp, "main");
+        m3host_self = tp;
+    }
+    return m3host_self;
+}
+
+static void *m3host_thread_start(void *p)
+{
+    thread_t *tp = p;
+    m3host_self = tp;
+
+    tp->pf(tp->arg);
+
+    pthread_mutex_lock(&m3host_lock);
+    tp->done = true;
+    pthread_mutex_unlock(&m3host_lock);
+    return NULL;
+}
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio,
+                            tfunc_t pf, void *arg)
+{
+    (void)wsp;
+    (void)size;
+    (void)prio;
+
+    pthread_attr_t attr;
+    thread_t *tp = calloc(1, sizeof(thread_t));
+    chDbgAssert(tp != NULL, "out of memory");
+
+    tp->pf = pf;
+    tp->arg = arg;
+    m3host_thread_setup(tp, "noname");
+
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, M3HOST_STACK_SIZE);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int rv = pthread_create(&tp->pthread, &attr, m3host_thread_start, tp);
+    pthread_attr_destroy(&attr);
+    chDbgAssert(rv == 0, "pthread_create failed");
+
+    return tp;
+}
+
+thread_t *chThdGetSelfX(void)
+{
+    return m3host_current();
+}
+
+void chRegSetThreadName(const char *name)
+{
+    char pname[16];
+    thread_t *tp = m3host_current();
+
+    pthread_mutex_lock(&m3host_lock);
+    tp->name = name;
+    pthread_mutex_unlock(&m3host_lock);
+
+    /* Linux thread names are at most 15 characters */
+    strncpy(pname, name, sizeof(pname) - 1);
+    pname[sizeof(pname) - 1] = '\0';
+    pthread_setname_np(pthread_self(), pname);
+}
+
+void chThdSleep(systime_t time)
+{
+    struct timespec deadline;
+
+    if(time == TIME_IMMEDIATE) {
+        sched_yield();
+        return;
+    }
+
+    m3host_deadline(time, &deadline);
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL)
+          == EINTR);
+}
+
+void chThdSleepUntil(systime_t time)
+{
+    systime_t delta = time - chVTGetSystemTimeX();
+
+    /* A time already passed would sleep for a whole wrap of the system
+     * time on hardware; a host run never lasts that long, so don't. */
+    if(delta != 0 && delta < (systime_t)0x80000000) {
+        chThdSleep(delta);
+    }
+}
+
+void chThdYield(void)
+{
+    sched_yield();
+}
+
+bool m3host_join(const char *name, systime_t timeout)
+{
+    systime_t start = chVTGetSystemTimeX();
+
+    while(true) {
+        bool done = false;
+
+        pthread_mutex_lock(&m3host_lock);
+        for(thread_t *tp = m3host_registry; tp != NULL; tp = tp->reg_next) {
+            if(strcmp(tp->name, name) == 0) {
+                done = tp->done;
+                break;
+            }
+        }
+        pthread_mutex_unlock(&m3host_lock);
+
+        if(done) {
+            return true;
+        }
+        if(chVTTimeElapsedSinceX(start) >= timeout) {
+            return false;
+        }
+        chThdSleepMilliseconds(1);
+    }
+}
+
+/*===========================================================================*/
+/* System                                                                    */
+/*===========================================================================*/
+
+void chSysInit(void)
+{
+    m3host_current();
+    chRegSetThreadName("main");
+}
+
+void chSysLock(void)
+{
+    pthread_mutex_lock(&m3host_lock);
+}
+
+void chSysUnlock(void)
+{
+    pthread_mutex_unlock(&m3host_lock);
+}
+
+void m3host_assert_fail(const char *reason, const char *file, int line)
+{
+    fprintf(stderr, "%s:%d: assertion failed: %s\n", file, line, reason);
+    abort();
+}
+
+/*===========================================================================*/
+/* Wait queues                                                               */
+/*===========================================================================*/
+
+/* Block the calling thread on `q` until another thread wakes it or, unless
+ * `deadline` is NULL, the deadline passes. Call with the system locked.
+ * Returns the wakeup message, or MSG_TIMEOUT.
+ */
+static msg_t m3host_wait(threads_queue_t *q, const struct timespec *deadline)
+{
+    thread_t *tp = m3host_current();
+
+    tp->queue = q;
+    tp->next = NULL;
+    if(q->tail != NULL) {
+        q->tail->next = tp;
+    } else {
+        q->head = tp;
+    }
+    q->tail = tp;
+
+    while(tp->queue != NULL) {
+        if(deadline == NULL) {
+            pthread_cond_wait(&tp->cond, &m3host_lock);
+        } else if(pthread_cond_timedwait(&tp->cond, &m3host_lock, deadline)
+                  == ETIMEDOUT && tp->queue != NULL) {
+            /* Nobody woke us, so take ourselves back off the queue */
+            thread_t **pp = &q->head, *prev = NULL;
+            while(*pp != tp) {
+                prev = *pp;
+                pp = &(*pp)->next;
+            }
+            *pp = tp->next;
+            if(q->tail == tp) {
+                q->tail = prev;
+            }
+            tp->queue = NULL;
+            tp->next = NULL;
+            return MSG_TIMEOUT;
+        }
+    }
+
+    return tp->rdymsg;
+}
+
+/* As m3host_wait, with a relative timeout in system ticks */
+static msg_t m3host_wait_timeout(threads_queue_t *q, systime_t timeout)
+{
+    struct timespec deadline;
+
+    if(timeout == TIME_IMMEDIATE) {
+        return MSG_TIMEOUT;
+    } else if(timeout == TIME_INFINITE) {
+        return m3host_wait(q, NULL);
+    }
+
+    m3host_deadline(timeout, &deadline);
+    return m3host_wait(q, &deadline);
+}
+
+/* Wake the oldest thread waiting on `q` with `msg`. Call locked.
+ * Returns false if there was no thread waiting.
+ */
+static bool m3host_wakeup(threads_queue_t *q, msg_t msg)
+{
+    thread_t *tp = q->head;
+
+    if(tp == NULL) {
+        return false;
+    }
+
+    q->head = tp->next;
+    if(q->head == NULL) {
+        q->tail = NULL;
+    }
+    tp->queue = NULL;
+    tp->next = NULL;
+    tp->rdymsg = msg;
+    pthread_cond_signal(&tp->cond);
+    return true;
+}
+
+static void m3host_wakeup_all(threads_queue_t *q, msg_t msg)
+{
+    while(m3host_wakeup(q, msg));
+}
+
+/*===========================================================================*/
+/* Binary semaphores                                                         */
+/*===========================================================================*/
+
+void chBSemObjectInit(binary_semaphore_t *bsp, bool taken)
+{
+    bsp->queue.head = bsp->queue.tail = NULL;
+    bsp->cnt = taken ? 0 : 1;
+}
+
+msg_t chBSemWaitTimeout(binary_semaphore_t *bsp, systime_t time)
+{
+    msg_t msg = MSG_OK;
+
+    chSysLock();
+    if(bsp->cnt > 0) {
+        bsp->cnt = 0;
+    } else {
+        msg = m3host_wait_timeout(&bsp->queue, time);
+    }
+    chSysUnlock();
+
+    return msg;
+}
+
+msg_t chBSemWait(binary_semaphore_t *bsp)
+{
+    return chBSemWaitTimeout(bsp, TIME_INFINITE);
+}
+
+void chBSemSignalI(binary_semaphore_t *bsp)
+{
+    if(!m3host_wakeup(&bsp->queue, MSG_OK)) {
+        bsp->cnt = 1;
+    }
+}
+
+void chBSemSignal(binary_semaphore_t *bsp)
+{
+    chSysLock();
+    chBSemSignalI(bsp);
+    chSysUnlock();
+}
+
+void chBSemReset(binary_semaphore_t *bsp, bool taken)
+{
+    chSysLock();
+    m3host_wakeup_all(&bsp->queue, MSG_RESET);
+    bsp->cnt = taken ? 0 : 1;
+    chSysUnlock();
+}
+
+/*===========================================================================*/
+/* Mailboxes                                                                 */
+/*===========================================================================*/
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n)
+{
+    mbp->buffer = mbp->wrptr = mbp->rdptr = buf;
+    mbp->top = buf + n;
+    mbp->cnt = 0;
+    mbp->qw.head = mbp->qw.tail = NULL;
+    mbp->qr.head = mbp->qr.tail = NULL;
+}
+
+void chMBReset(mailbox_t *mbp)
+{
+    chSysLock();
+    mbp->wrptr = mbp->rdptr = mbp->buffer;
+    mbp->cnt = 0;
+    m3host_wakeup_all(&mbp->qw, MSG_RESET);
+    m3host_wakeup_all(&mbp->qr, MSG_RESET);
+    chSysUnlock();
+}
+
+/* Wait on `q` until `ready` holds, for at most `timeout` in total */
+#define M3HOST_WAIT_UNTIL(ready, q, timeout) do {                           \
+    struct timespec _deadline;                                              \
+    if((timeout) != TIME_INFINITE && (timeout) != TIME_IMMEDIATE) {         \
+        m3host_deadline((timeout), &_deadline);                             \
+    }                                                                       \
+    while(!(ready)) {                                                       \
+        msg_t _rdy;                                                         \
+        if((timeout) == TIME_IMMEDIATE) {                                   \
+            return MSG_TIMEOUT;                                             \
+        }                                                                   \
+        _rdy = m3host_wait((q), (timeout) == TIME_INFINITE ?                \
+                                NULL : &_deadline);                         \
+        if(_rdy != MSG_OK) {                                                \
+            return _rdy;                                                    \
+        }                                                                   \
+    }                                                                       \
+} while(0)
+
+msg_t chMBPostI(mailbox_t *mbp, msg_t msg)
+{
+    if(chMBGetFreeCountI(mbp) <= 0) {
+        return MSG_TIMEOUT;
+    }
+
+    *mbp->wrptr++ = msg;
+    if(mbp->wrptr >= mbp->top) {
+        mbp->wrptr = mbp->buffer;
+    }
+    mbp->cnt++;
+    m3host_wakeup(&mbp->qr, MSG_OK);
+    return MSG_OK;
+}
+
+msg_t chMBPostS(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+    M3HOST_WAIT_UNTIL(chMBGetFreeCountI(mbp) > 0, &mbp->qw, timeout);
+    return chMBPostI(mbp, msg);
+}
+
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+    chSysLock();
+    msg_t rdymsg = chMBPostS(mbp, msg, timeout);
+    chSysUnlock();
+    return rdymsg;
+}
+
+msg_t chMBPostAheadI(mailbox_t *mbp, msg_t msg)
+{
+    if(chMBGetFreeCountI(mbp) <= 0) {
+        return MSG_TIMEOUT;
+    }
+
+    if(--mbp->rdptr < mbp->buffer) {
+        mbp->rdptr = mbp->top - 1;
+    }
+    *mbp->rdptr = msg;
+    mbp->cnt++;
+    m3host_wakeup(&mbp->qr, MSG_OK);
+    return MSG_OK;
+}
+
+msg_t chMBPostAheadS(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+    M3HOST_WAIT_UNTIL(chMBGetFreeCountI(mbp) > 0, &mbp->qw, timeout);
+    return chMBPostAheadI(mbp, msg);
+}
+
+msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+    chSysLock();
+    msg_t rdymsg = chMBPostAheadS(mbp, msg, timeout);
+    chSysUnlock();
+    return rdymsg;
+}
+
+msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp)
+{
+    if(mbp->cnt <= 0) {
+        return MSG_TIMEOUT;
+    }
+
+    *msgp = *mbp->rdptr++;
+    if(mbp->rdptr >= mbp->top) {
+        mbp->rdptr = mbp->buffer;
+    }
+    mbp->cnt--;
+    m3host_wakeup(&mbp->qw, MSG_OK);
+    return MSG_OK;
+}
+
+msg_t chMBFetchS(mailbox_t *mbp, msg_t *msgp, systime_t timeout)
+{
+    M3HOST_WAIT_UNTIL(mbp->cnt > 0, &mbp->qr, timeout);
+    return chMBFetchI(mbp, msgp);
+}
+
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout)
+{
+    chSysLock();
+    msg_t rdymsg = chMBFetchS(mbp, msgp, timeout);
+    chSysUnlock();
+    return rdymsg;
+}
+
+/*===========================================================================*/
+/* Memory pools                                                              */
+/*===========================================================================*/
+
+void chPoolObjectInit(memory_pool_t *mp, size_t size, memgetfunc_t provider)
+{
+    chDbgAssert(size >= sizeof(void *), "pool objects too small");
+    mp->next = NULL;
+    mp->object_size = size;
+    mp->provider = provider;
+}
+
+void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n)
+{
+    while(n--) {
+        chPoolAdd(mp, p);
+        p = (uint8_t *)p + mp->object_size;
+    }
+}
+
+void *chPoolAllocI(memory_pool_t *mp)
+{
+    void *objp = mp->next;
+
+    if(objp != NULL) {
+        mp->next = mp->next->next;
+    } else if(mp->provider != NULL) {
+        objp = mp->provider(mp->object_size, sizeof(stkalign_t));
+    }
+    return objp;
+}
+
+void *chPoolAlloc(memory_pool_t *mp)
+{
+    chSysLock();
+    void *objp = chPoolAllocI(mp);
+    chSysUnlock();
+    return objp;
+}
+
+void chPoolFreeI(memory_pool_t *mp, void *objp)
+{
+    struct m3host_pool_header *php = objp;
+    php->next = mp->next;
+    mp->next = php;
+}
+
+void chPoolFree(memory_pool_t *mp, void *objp)
+{
+    chSysLock();
+    chPoolFreeI(mp, objp);
+    chSysUnlock();
+}
+
+/*===========================================================================*/
+/* HAL                                                                       */
+/*===========================================================================*/
+
+void halInit(void)
+{
+}
+
+void palWriteLine(ioline_t line, uint8_t bit)
+{
+    uint16_t mask = 1U << PAL_PAD(line), old;
+    ioportid_t port = PAL_PORT(line);
+
+    chDbgAssert(port < M3HOST_PAL_PORTS, "invalid port");
+
+    /* Lock free, as modules may write lines with the system locked */
+    if(bit) {
+        old = __atomic_fetch_or(&m3host_pal[port], mask, __ATOMIC_SEQ_CST);
+    } else {
+        old = __atomic_fetch_and(&m3host_pal[port], (uint16_t)~mask,
+                                 __ATOMIC_SEQ_CST);
+    }
+
+    if(((old & mask) != 0) != (bit != 0)) {
+        char name[8];
+        snprintf(name, sizeof(name), "P%c%u", 'A' + (char)port,
+                 PAL_PAD(line));
+        m3host_trace(name, "%u", bit ? 1U : 0U);
+    }
+}
+
+uint8_t palReadLine(ioline_t line)
+{
+    ioportid_t port = PAL_PORT(line);
+    chDbgAssert(port < M3HOST_PAL_PORTS, "invalid port");
+    return (__atomic_load_n(&m3host_pal[port], __ATOMIC_SEQ_CST) >>
+            PAL_PAD(line)) & 1;
+}
+
+void palToggleLine(ioline_t line)
+{
+    palWriteLine(line, !palReadLine(line));
+}
+
+void pwmStart(PWMDriver *pwmp, const PWMConfig *config)
+{
+    pwmp->config = config;
+}
+
+void pwmStop(PWMDriver *pwmp)
+{
+    pwmp->config = NULL;
+    pwmp->enabled = 0;
+}
+
+void pwmEnableChannel(PWMDriver *pwmp, pwmchannel_t channel, pwmcnt_t width)
+{
+    if(!(pwmp->enabled & (1 << channel))) {
+        m3host_trace(pwmp->name, "ch%u on %u", channel, width);
+    }
+    pwmp->enabled |= 1 << channel;
+}
+
+void pwmDisableChannel(PWMDriver *pwmp, pwmchannel_t channel)
+{
+    if(pwmp->enabled & (1 << channel)) {
+        m3host_trace(pwmp->name, "ch%u off", channel);
+    }
+    pwmp->enabled &= ~(1 << channel);
+}
+
+void sdcStart(SDCDriver *sdcp, const SDCConfig *config)
+{
+    sdcp->config = config;
+}
+
+void sdcStop(SDCDriver *sdcp)
+{
+    sdcp->config = NULL;
+}
+
+bool sdcConnect(SDCDriver *sdcp)
+{
+    sdcp->connected = true;
+    return HAL_SUCCESS;
+}
+
+bool sdcDisconnect(SDCDriver *sdcp)
+{
+    sdcp->connected = false;
+    return HAL_SUCCESS;
+}
+
+int chsnprintf(char *str, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(str, size, fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/*===========================================================================*/
+/* Runtime                                                                   */
+/*===========================================================================*/
+
+static void m3host_signal(int sig)
+{
+    (void)sig;
+    m3host_stop_requested = 1;
+}
+
+void m3host_init(const char *board)
+{
+    const char *env;
+    struct sigaction sa;
+
+    m3host_t0_ns = m3host_monotonic_ns();
+    m3host_board = board;
+
+    if((env = getenv("M3HOST_SPEEDUP")) != NULL && atof(env) > 0.0) {
+        m3host_speedup = atof(env);
+    }
+
+    if((env = getenv("M3HOST_DURATION")) != NULL && atof(env) > 0.0) {
+        m3host_have_duration = true;
+        m3host_duration = (systime_t)(atof(env) * CH_CFG_ST_FREQUENCY);
+    }
+
+    if((env = getenv("M3HOST_TRACE")) != NULL && env[0] != '\0') {
+        m3host_trace_all = strcmp(env, "all") == 0;
+        m3host_trace_list = strdup(env);
+    }
+
+    /* Trace lines are read by other processes as they happen */
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = m3host_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+}
+
+bool m3host_should_stop(void)
+{
+    return m3host_stop_requested ||
+           (m3host_have_duration && chVTGetSystemTimeX() >= m3host_duration);
+}
+
+bool m3host_trace_enabled(const char *source)
+{
+    const char *p = m3host_trace_list;
+    size_t n = strlen(source);
+
+    if(p == NULL) {
+        return false;
+    } else if(m3host_trace_all) {
+        return true;
+    }
+
+    while(*p) {
+        size_t len = strcspn(p, ",");
+        if(len == n && strncmp(p, source, n) == 0) {
+            return true;
+        }
+        p += len;
+        if(*p == ',') {
+            p++;
+        }
+    }
+    return false;
+}
+
+void m3host_trace(const char *source, const char *fmt, ...)
+{
+    va_list ap;
+
+    if(!m3host_trace_enabled(source)) {
+        return;
+    }
+
+    double t = (double)m3host_monotonic_ns() / 1e9;
+    systime_t st = chVTGetSystemTimeX();
+
+    flockfile(stdout);
+    printf("%.6f %u %s %s ", t, st, m3host_board, source);
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+    putchar('\n');
+    funlockfile(stdout);
+}
@@ -0,0 +1,53 @@
+/*
+ * Host runtime for board firmware
+ * Cambridge University Spaceflight
+ */
+
+#ifndef M3HOST_H
+#define M3HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ch.h"
+
+/* Runtime settings, read from the environment by m3host_init():
+ *
+ * M3HOST_SPEEDUP   Virtual time runs this many times faster than real
+ *                  time (default 1). Sleeps and timeouts shrink to match,
+ *                  so everything keeps its firmware timing relative to
+ *                  everything else, until the host can't keep up.
+ * M3HOST_DURATION  Stop after this many seconds of virtual time (default:
+ *                  run until SIGINT or SIGTERM).
+ * M3HOST_TRACE     Comma separated trace sources to print, e.g. "pyro,PA3",
+ *                  or "all". Each trace line is
+ *                      <monotonic s> <system ticks> <board> <source> <text>
+ *                  on stdout, with the monotonic time from CLOCK_MONOTONIC,
+ *                  so traces from processes on one machine can be compared.
+ * M3CAN_IFACE      CAN interface, see m3host_can.c.
+ */
+void m3host_init(const char *board);
+
+/* True once a stop was requested by a signal or M3HOST_DURATION. Host
+ * mains idle on this instead of clearing the watchdog.
+ */
+bool m3host_should_stop(void);
+
+/* True if the trace source `source` was selected in M3HOST_TRACE. */
+bool m3host_trace_enabled(const char *source);
+
+/* Print a trace line from `source`, if it is enabled. */
+void m3host_trace(const char *source, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/* Real milliseconds, rounded up, that `ticks` of virtual time last. For
+ * host code blocking in system calls.
+ */
+int m3host_real_ms(systime_t ticks);
+
+/* Wait up to `timeout` for the thread named `name` to return.
+ * Returns false if it is still running.
+ */
+bool m3host_join(const char *name, systime_t timeout);
+
+#endif /* M3HOST_H */
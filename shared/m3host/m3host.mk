@@ -0,0 +1,33 @@
+# Host build of board firmware, see shared/m3host/README.md.
+# A board's host/Makefile sets TARGET, FIRMWARE (its firmware directory),
+# SRC (its host sources plus the firmware modules it reuses) and
+# M3STATUS_MAX_COMPONENT (as its firmware Makefile does), then includes
+# this file.
+
+M3HOST_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
+SHARED := $(M3HOST_DIR)..
+
+GITVERSION := $(shell git describe --abbrev=8 --always)
+
+CFLAGS = -std=gnu99 -O2 -ggdb -Wall -Wextra -pthread \
+         -DFIRMWARE_VERSION=\"$(GITVERSION)\" -DM3PROF_ENABLE=0 \
+         -DM3STATUS_MAX_COMPONENT=$(M3STATUS_MAX_COMPONENT) \
+         -I. -I$(M3HOST_DIR) -I$(FIRMWARE) -I$(SHARED)/m3can \
+         -I$(SHARED)/m3status -I$(SHARED)/m3flash -I$(SHARED)/m3prof
+
+M3HOST_SRC = $(M3HOST_DIR)m3host.c $(M3HOST_DIR)m3host_can.c \
+             $(M3HOST_DIR)m3host_ff.c $(M3HOST_DIR)m3host_flash.c \
+             $(SHARED)/m3can/m3can_util.c $(SHARED)/m3can/m3can_filter.c \
+             $(SHARED)/m3can/m3can_timesync.c \
+             $(SHARED)/m3can/m3can_bulk.c \
+             $(SHARED)/m3status/m3status.c
+
+all: $(TARGET)
+
+$(TARGET): $(SRC) $(M3HOST_SRC) $(wildcard *.h $(M3HOST_DIR)*.h)
+	gcc $(CFLAGS) $(SRC) $(M3HOST_SRC) -lm -o $@
+
+clean:
+	rm -f $(TARGET)
+
+.PHONY: all clean
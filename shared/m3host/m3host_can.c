@@ -0,0 +1,287 @@
+/*
+ * M3 CAN backend for host builds, on SocketCAN or UDP
+ * Cambridge University Spaceflight
+ *
+ * Replaces m3can.c, so every board process started on one machine shares a
+ * virtual bus. M3CAN_IFACE selects it:
+ *
+ *   vcan0 (default), can0, ...   A SocketCAN raw socket on that interface.
+ *                                Create a virtual one with
+ *                                    ip link add dev vcan0 type vcan
+ *                                    ip link set up vcan0
+ *   udp:<port>                   Datagrams broadcast to 127.255.255.255,
+ *                                for machines without SocketCAN. Each is
+ *                                the sender's pid and a struct can_frame.
+ *
+ * Received frames pass through the same acceptance filter plan as the
+ * hardware, checked in software, and frames a process sends never come back
+ * to it except through m3can_set_loopback, as on the bus.
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "m3can.h"
+#include "m3can_filter.h"
+#include "m3can_timesync.h"
+#include "m3can_bulk.h"
+#include "m3host.h"
+#include "m3status.h"
+
+#ifndef FIRMWARE_VERSION
+#error "Please check your Makefile sets FIRMWARE_VERSION"
+#endif
+
+#ifndef PF_CAN
+#define PF_CAN 29
+#endif
+
+uint8_t m3can_own_id = 0;
+
+struct m3host_can_datagram {
+    uint32_t pid;
+    struct can_frame frame;
+};
+
+static int m3host_can_fd = -1;
+static bool m3host_can_udp;
+static struct sockaddr_in m3host_can_udp_addr;
+
+static struct m3can_filter_bank m3host_can_banks[M3CAN_FILTER_BANKS];
+static size_t m3host_can_num_banks;
+static bool m3host_can_filtered;
+
+static volatile bool m3can_loopback_enabled;
+static uint32_t m3can_tx_dropped;
+
+static void m3can_send_git_version(void);
+
+static void m3host_can_fail(const char *what, const char *iface)
+{
+    fprintf(stderr, "m3can: %s on %s: %s\n", what, iface, strerror(errno));
+    exit(1);
+}
+
+static void m3host_can_open_socketcan(const char *iface)
+{
+    struct ifreq ifr;
+    struct sockaddr_can addr;
+
+    m3host_can_fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if(m3host_can_fd < 0) {
+        m3host_can_fail("socket", iface);
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, iface, IFNAMSIZ - 1);
+    if(ioctl(m3host_can_fd, SIOCGIFINDEX, &ifr) < 0) {
+        m3host_can_fail("SIOCGIFINDEX", iface);
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if(bind(m3host_can_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        m3host_can_fail("bind", iface);
+    }
+}
+
+static void m3host_can_open_udp(const char *iface)
+{
+    int one = 1;
+    struct sockaddr_in addr;
+
+    m3host_can_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if(m3host_can_fd < 0) {
+        m3host_can_fail("socket", iface);
+    }
+    setsockopt(m3host_can_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(m3host_can_fd, SOL_SOCKET, SO_BROADCAST, &one, sizeof(one));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(atoi(iface + 4));
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if(bind(m3host_can_fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        m3host_can_fail("bind", iface);
+    }
+
+    m3host_can_udp_addr = addr;
+    m3host_can_udp_addr.sin_addr.s_addr = htonl(0x7FFFFFFF);
+    m3host_can_udp = true;
+}
+
+/* Read one frame, returning false on timeout or a frame to ignore */
+static bool m3host_can_read(struct can_frame *frame, int timeout_ms)
+{
+    struct pollfd pfd = {.fd = m3host_can_fd, .events = POLLIN};
+
+    if(poll(&pfd, 1, timeout_ms) <= 0) {
+        return false;
+    }
+
+    if(m3host_can_udp) {
+        struct m3host_can_datagram dg;
+        if(recv(m3host_can_fd, &dg, sizeof(dg), 0) != sizeof(dg) ||
+           dg.pid == (uint32_t)getpid()) {
+            return false;
+        }
+        *frame = dg.frame;
+    } else if(read(m3host_can_fd, frame, sizeof(*frame)) != sizeof(*frame)) {
+        return false;
+    }
+
+    /* Only standard frames are used on the M3 bus */
+    if(frame->can_id & (CAN_EFF_FLAG | CAN_ERR_FLAG)) {
+        return false;
+    }
+    return true;
+}
+
+void m3can_send(uint16_t msg_id, bool rtr, uint8_t *data, uint8_t datalen)
+{
+    struct m3host_can_datagram dg;
+    ssize_t rv;
+
+    chDbgAssert(datalen <= 8, "CAN packet >8 bytes");
+
+    memset(&dg, 0, sizeof(dg));
+    dg.pid = getpid();
+    dg.frame.can_id = msg_id | (rtr ? CAN_RTR_FLAG : 0);
+    dg.frame.can_dlc = datalen;
+    memcpy(dg.frame.data, data, datalen);
+
+    if(m3host_can_udp) {
+        rv = sendto(m3host_can_fd, &dg, sizeof(dg), MSG_DONTWAIT,
+                    (struct sockaddr *)&m3host_can_udp_addr,
+                    sizeof(m3host_can_udp_addr));
+    } else {
+        rv = send(m3host_can_fd, &dg.frame, sizeof(dg.frame), MSG_DONTWAIT);
+    }
+
+    /* A full socket buffer is the host's version of a frame waiting too
+     * long for the bus. */
+    if(rv < 0) {
+        uint32_t dropped;
+        chSysLock();
+        dropped = ++m3can_tx_dropped;
+        chSysUnlock();
+        uint8_t counts[4] = {0, 0, dropped, dropped >> 8};
+        m3status_set_error_data(M3STATUS_COMPONENT_CAN,
+                                M3STATUS_ERROR_CAN_TX_DROPPED, counts, 4);
+    } else {
+        m3can_timesync_frame(msg_id, data, datalen, true);
+    }
+
+    m3host_trace("can", "tx %03x %u", msg_id, datalen);
+
+    if(m3can_loopback_enabled) {
+        m3can_recv(msg_id, rtr, data, datalen);
+    }
+}
+
+void m3can_get_tx_stats(uint32_t* overflows, uint32_t* dropped)
+{
+    chSysLock();
+    *overflows = 0;
+    *dropped = m3can_tx_dropped;
+    chSysUnlock();
+}
+
+void m3can_set_loopback(bool enabled)
+{
+    m3can_loopback_enabled = enabled;
+}
+
+static THD_WORKING_AREA(can_rx_wa, 512);
+static THD_FUNCTION(can_rx_thd, arg) {
+    (void)arg;
+
+    struct can_frame frame;
+    systime_t time_last_id = chVTGetSystemTimeX();
+    systime_t time_last_digest = time_last_id;
+    int timeout_ms = m3host_real_ms(MS2ST(100));
+
+    chRegSetThreadName("CAN RX");
+
+    while(true) {
+        if(m3host_can_read(&frame, timeout_ms)) {
+            uint16_t sid = frame.can_id & CAN_SFF_MASK;
+            bool rtr = (frame.can_id & CAN_RTR_FLAG) != 0;
+            uint8_t dlc = frame.can_dlc > 8 ? 8 : frame.can_dlc;
+
+            if(!m3host_can_filtered ||
+               m3can_filter_match(m3host_can_banks, m3host_can_num_banks,
+                                  sid, rtr)) {
+                m3host_trace("can", "rx %03x %u", sid, dlc);
+                m3can_timesync_frame(sid, frame.data, dlc, false);
+                if(!rtr) {
+                    m3can_bulk_frame(sid, frame.data, dlc);
+                } else {
+                    m3status_handle_rtr(sid);
+                }
+                m3can_recv(sid, rtr, frame.data, dlc);
+            }
+        }
+
+        /* Send our status digest every second */
+        if(ST2MS(chVTTimeElapsedSinceX(time_last_digest)) >=
+           M3STATUS_DIGEST_PERIOD_MS) {
+            m3status_send_digest();
+            time_last_digest = chVTGetSystemTimeX();
+        }
+
+        /* Send our git ID every 5 seconds */
+        if(ST2MS(chVTTimeElapsedSinceX(time_last_id)) > 5000) {
+            m3can_send_git_version();
+            time_last_id = chVTGetSystemTimeX();
+        }
+    }
+}
+
+void m3can_init(uint8_t board_id, const uint16_t* rx_ids, size_t num_rx_ids)
+{
+    const char *iface = getenv("M3CAN_IFACE");
+
+    if(iface == NULL || iface[0] == '\0') {
+        iface = "vcan0";
+    }
+
+    m3can_own_id = board_id;
+    if(rx_ids != NULL && num_rx_ids > 0) {
+        m3can_filter_plan(rx_ids, num_rx_ids, m3host_can_banks,
+                          M3CAN_FILTER_BANKS, &m3host_can_num_banks);
+        m3host_can_filtered = true;
+    }
+
+    if(strncmp(iface, "udp:", 4) == 0) {
+        m3host_can_open_udp(iface);
+    } else {
+        m3host_can_open_socketcan(iface);
+    }
+
+    m3can_send_git_version();
+    chThdCreateStatic(can_rx_wa, sizeof(can_rx_wa), NORMALPRIO,
+                      can_rx_thd, NULL);
+}
+
+static void m3can_send_git_version(void) {
+    uint8_t version[8] = {0};
+    size_t n = strlen(FIRMWARE_VERSION);
+    memcpy(version, FIRMWARE_VERSION, n < 8 ? n : 8);
+    m3can_send(m3can_own_id | CAN_MSG_ID_VERSION, false, version, 8);
+}
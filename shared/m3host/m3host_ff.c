@@ -0,0 +1,203 @@
+/*
+ * Host FatFs subset, backed by files in the working directory
+ * Cambridge University Spaceflight
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+#include "ff.h"
+
+/* Strip a FatFs drive prefix such as "0:" or "A:" from `path` */
+static const char *m3host_ff_path(const TCHAR *path)
+{
+    const char *colon = strchr(path, ':');
+    path = colon != NULL ? colon + 1 : path;
+    while(*path == '/') {
+        path++;
+    }
+    return *path != '\0' ? path : ".";
+}
+
+static FRESULT m3host_ff_errno(void)
+{
+    switch(errno) {
+    case ENOENT:
+        return FR_NO_FILE;
+    case EEXIST:
+        return FR_EXIST;
+    case EACCES:
+    case EPERM:
+        return FR_DENIED;
+    case ENOSPC:
+        return FR_DENIED;
+    default:
+        return FR_DISK_ERR;
+    }
+}
+
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt)
+{
+    (void)path;
+    (void)opt;
+
+    if(fs != NULL) {
+        fs->fs_type = 3;
+        fs->csize = M3HOST_FF_CLUSTER_SECTORS;
+    }
+    return FR_OK;
+}
+
+FRESULT f_open(FIL *fp, const TCHAR *path, BYTE mode)
+{
+    int flags = 0;
+    struct stat st;
+
+    if((mode & FA_READ) && (mode & FA_WRITE)) {
+        flags = O_RDWR;
+    } else if(mode & FA_WRITE) {
+        flags = O_WRONLY;
+    } else {
+        flags = O_RDONLY;
+    }
+
+    if(mode & FA_CREATE_NEW) {
+        flags |= O_CREAT | O_EXCL;
+    } else if(mode & FA_CREATE_ALWAYS) {
+        flags |= O_CREAT | O_TRUNC;
+    } else if(mode & FA_OPEN_ALWAYS) {
+        flags |= O_CREAT;
+    }
+
+    fp->fd = open(m3host_ff_path(path), flags, 0644);
+    if(fp->fd < 0) {
+        return m3host_ff_errno();
+    }
+
+    fstat(fp->fd, &st);
+    fp->fs = NULL;
+    fp->flag = mode;
+    fp->fptr = 0;
+    fp->fsize = st.st_size;
+    fp->cltbl = NULL;
+    return FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+    if(fp->fd < 0) {
+        return FR_INVALID_OBJECT;
+    }
+
+    int rv = close(fp->fd);
+    fp->fd = -1;
+    return rv == 0 ? FR_OK : m3host_ff_errno();
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+    ssize_t n = pread(fp->fd, buff, btr, fp->fptr);
+
+    *br = 0;
+    if(n < 0) {
+        return m3host_ff_errno();
+    }
+    *br = n;
+    fp->fptr += n;
+    return FR_OK;
+}
+
+/* As on a card, running out of space is a short write rather than an
+ * error, so callers compare `bw` against `btw`. With fast seek a file
+ * can't grow, as FatFs can't follow the cluster chain past the table.
+ */
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+    if(fp->cltbl != NULL && btw > fp->fsize - fp->fptr) {
+        btw = fp->fsize - fp->fptr;
+    }
+
+    ssize_t n = pwrite(fp->fd, buff, btw, fp->fptr);
+
+    *bw = 0;
+    if(n < 0) {
+        return errno == ENOSPC ? FR_OK : m3host_ff_errno();
+    }
+    *bw = n;
+    fp->fptr += n;
+    if(fp->fptr > fp->fsize) {
+        fp->fsize = fp->fptr;
+    }
+    return FR_OK;
+}
+
+/* Seeking past the end of a file opened for writing extends it, except
+ * with fast seek. CREATE_LINKMAP maps the file as one fragment.
+ */
+FRESULT f_lseek(FIL *fp, DWORD ofs)
+{
+    if(fp->cltbl != NULL && ofs == CREATE_LINKMAP) {
+        DWORD cluster = M3HOST_FF_CLUSTER_SECTORS * 512;
+        if(fp->cltbl[0] < 4) {
+            return FR_NOT_ENOUGH_CORE;
+        }
+        fp->cltbl[0] = 4;
+        fp->cltbl[1] = (fp->fsize + cluster - 1) / cluster;
+        fp->cltbl[2] = 2;
+        fp->cltbl[3] = 0;
+        return FR_OK;
+    }
+
+    if(ofs > fp->fsize && (fp->flag & FA_WRITE) && fp->cltbl == NULL) {
+        if(ftruncate(fp->fd, ofs) != 0) {
+            return m3host_ff_errno();
+        }
+        fp->fsize = ofs;
+    } else if(ofs > fp->fsize) {
+        ofs = fp->fsize;
+    }
+    fp->fptr = ofs;
+    return FR_OK;
+}
+
+FRESULT f_truncate(FIL *fp)
+{
+    if(ftruncate(fp->fd, fp->fptr) != 0) {
+        return m3host_ff_errno();
+    }
+    fp->fsize = fp->fptr;
+    return FR_OK;
+}
+
+FRESULT f_sync(FIL *fp)
+{
+    return fdatasync(fp->fd) == 0 ? FR_OK : m3host_ff_errno();
+}
+
+FRESULT f_unlink(const TCHAR *path)
+{
+    return unlink(m3host_ff_path(path)) == 0 ? FR_OK : m3host_ff_errno();
+}
+
+FRESULT f_getfree(const TCHAR *path, DWORD *nclst, FATFS **fatfs)
+{
+    static FATFS fs;
+    struct statvfs sv;
+    uint64_t cluster = M3HOST_FF_CLUSTER_SECTORS * 512;
+
+    if(statvfs(m3host_ff_path(path), &sv) != 0) {
+        return m3host_ff_errno();
+    }
+
+    f_mount(&fs, path, 0);
+    fs.free_clust = (DWORD)((uint64_t)sv.f_bavail * sv.f_frsize / cluster);
+    *nclst = fs.free_clust;
+    *fatfs = &fs;
+    return FR_OK;
+}
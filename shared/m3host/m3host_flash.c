@@ -0,0 +1,65 @@
+/*
+ * Host m3flash, storing the configuration sector in a file
+ * Cambridge University Spaceflight
+ *
+ * Each flash address used is backed by flash_<address>.bin in the working
+ * directory, holding the words and CRC exactly as m3flash_write lays them
+ * out in flash, so a config image can be prepared by a test script.
+ */
+
+#include <stdio.h>
+
+#include "ch.h"
+#include "m3flash.h"
+
+static void m3host_flash_name(uint32_t* addr, char* name, size_t len)
+{
+    snprintf(name, len, "flash_%08lx.bin", (unsigned long)(uintptr_t)addr);
+}
+
+/* The STM32 CRC unit: CRC-32/MPEG-2, fed a 32 bit word at a time */
+uint32_t m3flash_crc(uint32_t* src, size_t n)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for(size_t i=0; i<n; i++) {
+        crc ^= src[i];
+        for(int j=0; j<32; j++) {
+            crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04C11DB7 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+bool m3flash_write(uint32_t* src, uint32_t* dst, size_t n)
+{
+    char name[32];
+    uint32_t checksum = m3flash_crc(src, n);
+    bool ok;
+
+    m3host_flash_name(dst, name, sizeof(name));
+    FILE* f = fopen(name, "wb");
+    if(f == NULL) {
+        return false;
+    }
+    ok = fwrite(src, 4, n, f) == n && fwrite(&checksum, 4, 1, f) == 1;
+    ok &= fclose(f) == 0;
+    return ok;
+}
+
+bool m3flash_read(uint32_t* src, uint32_t* dst, size_t n)
+{
+    char name[32];
+    uint32_t checksum;
+    bool ok;
+
+    m3host_flash_name(src, name, sizeof(name));
+    FILE* f = fopen(name, "rb");
+    if(f == NULL) {
+        return false;
+    }
+    ok = fread(dst, 4, n, f) == n && fread(&checksum, 4, 1, f) == 1;
+    fclose(f);
+
+    return ok && checksum == m3flash_crc(dst, n);
+}
@@ -0,0 +1,17 @@
+/*
+ * Host OSAL, which is just the host kernel subset
+ * Cambridge University Spaceflight
+ */
+
+#ifndef M3HOST_OSAL_H
+#define M3HOST_OSAL_H
+
+#include "ch.h"
+
+#define osalDbgAssert(c, r)     chDbgAssert((c), (r))
+#define osalDbgCheck(c)         chDbgCheck(c)
+#define osalThreadSleepMilliseconds(msec) chThdSleepMilliseconds(msec)
+#define osalSysLock()           chSysLock()
+#define osalSysUnlock()         chSysUnlock()
+
+#endif /* M3HOST_OSAL_H */
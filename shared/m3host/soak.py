@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+"""
+Soak test of the host builds of m3fc, m3pyro, m3radio and m3dl.
+
+Starts each board's host binary in its own temporary directory on one
+virtual bus, configures M3FC's pyro channels over CAN, arms M3Pyro, then
+repeatedly commands M3FC to fire the drogue and times each command against
+the moment M3Pyro asserts the channel, from M3Pyro's "pyro" trace. Finally
+reports the fire latencies and how much M3DL logged and M3Radio downlinked.
+
+Build the host binaries first (make in each board's host directory), then:
+
+    ./soak.py --iface udp:47000 --speedup 4 --fires 20
+
+Latencies are in real time; multiply by the speedup for firmware time.
+"""
+
+import argparse
+import os
+import shutil
+import signal
+import socket
+import statistics
+import struct
+import subprocess
+import tempfile
+import threading
+import time
+
+ROOT = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+
+BOARDS = {
+    "m3fc": "m3fc/host/m3fc_host",
+    "m3pyro": "m3pyro/host/m3pyro_host",
+    "m3radio": "m3radio/host/m3radio_host",
+    "m3dl": "m3dl/host/m3dl_host",
+}
+
+CAN_ID_M3FC = 1
+CAN_ID_M3PYRO = 3
+
+CAN_MSG_ID_M3FC_SET_CFG_PYROS = (2 << 5) | CAN_ID_M3FC
+CAN_MSG_ID_M3FC_FIRE = (9 << 5) | CAN_ID_M3FC
+CAN_MSG_ID_M3PYRO_ARM_COMMAND = (2 << 5) | CAN_ID_M3PYRO
+
+# Pyro 1 fires the drogue and pyro 2 the main, both e-matches on 1A
+PYRO_DROGUE_1A_EMATCH = 0x15
+PYRO_MAIN_1A_EMATCH = 0x25
+USAGE_DROGUE = 0x10
+
+# Matches struct m3host_can_datagram: pid, then an 8-byte aligned can_frame
+UDP_DATAGRAM = struct.Struct("<I4xIB3x8s")
+CAN_FRAME = struct.Struct("<IB3x8s")
+
+
+class Bus:
+    """Sends frames onto the same bus as the host binaries."""
+
+    def __init__(self, iface):
+        if iface.startswith("udp:"):
+            self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+            self.addr = ("127.255.255.255", int(iface[4:]))
+            self.udp = True
+        else:
+            self.sock = socket.socket(socket.AF_CAN, socket.SOCK_RAW,
+                                      socket.CAN_RAW)
+            self.sock.bind((iface,))
+            self.udp = False
+
+    def send(self, sid, data):
+        data = bytes(data)
+        if self.udp:
+            dg = UDP_DATAGRAM.pack(os.getpid(), sid, len(data), data)
+            self.sock.sendto(dg, self.addr)
+        else:
+            self.sock.send(CAN_FRAME.pack(sid, len(data), data))
+
+
+class Board:
+    """One host binary, running in its own directory, with its trace."""
+
+    def __init__(self, name, env):
+        self.name = name
+        self.dir = tempfile.mkdtemp(prefix=name + "_")
+        self.events = []
+        self.cond = threading.Condition()
+        self.proc = subprocess.Popen(
+            [os.path.join(ROOT, BOARDS[name])], cwd=self.dir, env=env,
+            stdout=subprocess.PIPE, universal_newlines=True)
+        self.reader = threading.Thread(target=self._read, daemon=True)
+        self.reader.start()
+
+    def _read(self):
+        for line in self.proc.stdout:
+            parts = line.split(None, 4)
+            if len(parts) < 5:
+                continue
+            with self.cond:
+                self.events.append(
+                    (float(parts[0]), parts[3], parts[4].strip()))
+                self.cond.notify_all()
+
+    def wait_for(self, source, text, after, timeout):
+        """Monotonic time of the first trace of `text` from `source` after
+        `after`, or None after `timeout` seconds."""
+        deadline = time.monotonic() + timeout
+        with self.cond:
+            while True:
+                for t, src, txt in self.events:
+                    if t >= after and src == source and txt == text:
+                        return t
+                remaining = deadline - time.monotonic()
+                if remaining <= 0:
+                    return None
+                self.cond.wait(remaining)
+
+    def stop(self):
+        self.proc.send_signal(signal.SIGTERM)
+        try:
+            return self.proc.wait(timeout=10)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            return self.proc.wait()
+
+    def file_size(self, name):
+        path = os.path.join(self.dir, name)
+        return os.path.getsize(path) if os.path.exists(path) else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--iface", default=os.environ.get("M3CAN_IFACE",
+                                                          "vcan0"))
+    parser.add_argument("--speedup", type=float, default=4)
+    parser.add_argument("--fires", type=int, default=20)
+    parser.add_argument("--keep", action="store_true",
+                        help="keep each board's working directory")
+    args = parser.parse_args()
+
+    env = dict(os.environ)
+    env["M3CAN_IFACE"] = args.iface
+    env["M3HOST_SPEEDUP"] = str(args.speedup)
+    env["M3HOST_TRACE"] = "pyro,downlink"
+    env.pop("M3HOST_DURATION", None)
+
+    bus = Bus(args.iface)
+    boards = {name: Board(name, env) for name in BOARDS}
+    pyro = boards["m3pyro"]
+
+    latencies = []
+    missed = 0
+    try:
+        # Let M3Pyro finish its self test before arming it
+        time.sleep(2.0 / args.speedup + 0.5)
+        bus.send(CAN_MSG_ID_M3FC_SET_CFG_PYROS,
+                 [PYRO_DROGUE_1A_EMATCH, PYRO_MAIN_1A_EMATCH, 0, 0, 0, 0, 0, 0])
+        bus.send(CAN_MSG_ID_M3PYRO_ARM_COMMAND, [1])
+        time.sleep(0.2)
+
+        for _ in range(args.fires):
+            t0 = time.monotonic()
+            bus.send(CAN_MSG_ID_M3FC_FIRE, [USAGE_DROGUE])
+            t_on = pyro.wait_for("pyro", "ch1 on", t0, 2.0)
+            if t_on is None:
+                missed += 1
+                continue
+            latencies.append(t_on - t0)
+            pyro.wait_for("pyro", "ch1 off", t_on, 5.0)
+            time.sleep(0.05)
+    finally:
+        codes = {name: board.stop() for name, board in boards.items()}
+
+    print("fires: {} commanded, {} missed".format(args.fires, missed))
+    if latencies:
+        ms = sorted(1000 * x for x in latencies)
+        print("fire latency ms: min {:.2f} median {:.2f} p95 {:.2f} max {:.2f}"
+              .format(ms[0], statistics.median(ms),
+                      ms[min(len(ms) - 1, int(0.95 * len(ms)))], ms[-1]))
+    print("m3dl log_00001.bin: {} bytes".format(
+        boards["m3dl"].file_size("log_00001.bin")))
+    print("m3radio downlink.bin: {} bytes".format(
+        boards["m3radio"].file_size("downlink.bin")))
+    for name, code in codes.items():
+        if code != 0:
+            print("{} exited with {}".format(name, code))
+
+    if not args.keep:
+        for board in boards.values():
+            shutil.rmtree(board.dir, ignore_errors=True)
+    else:
+        for name, board in boards.items():
+            print("{}: {}".format(name, board.dir))
+
+    return 1 if missed or any(codes.values()) else 0
+
+
+if __name__ == "__main__":
+    raise SystemExit(main())
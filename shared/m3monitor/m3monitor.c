@@ -0,0 +1,154 @@
+#include <string.h>
+#include "ch.h"
+#include "m3can.h"
+#include "m3monitor.h"
+
+#if CH_CFG_USE_REGISTRY != TRUE || CH_DBG_STATISTICS != TRUE || \
+    CH_DBG_ENABLE_STACK_CHECK != TRUE || CH_DBG_FILL_THREADS != TRUE
+#error "m3monitor needs the registry, statistics, stack check and stack fill"
+#endif
+
+/* The main thread runs on the process stack set up by the linker script
+ * rather than a working area, and crt0 fills it like a working area.
+ */
+extern stkalign_t __main_thread_stack_base__, __main_thread_stack_end__;
+
+/* Cumulative run time of each thread at the previous report, so we can
+ * find how much each ran during the last period.
+ */
+struct m3monitor_thread {
+    thread_t* tp;
+    rttime_t cumulative;
+};
+static struct m3monitor_thread last[M3MONITOR_MAX_THREADS];
+static size_t n_last;
+
+/* Working space for each report, kept off the monitor thread's stack */
+static struct m3monitor_thread now[M3MONITOR_MAX_THREADS];
+static uint64_t delta[M3MONITOR_MAX_THREADS];
+
+static uint32_t m3monitor_stack_size(thread_t* tp);
+static uint32_t m3monitor_stack_free(thread_t* tp, uint32_t size);
+static void m3monitor_report(void);
+
+static uint32_t m3monitor_stack_size(thread_t* tp)
+{
+    if(tp == &ch.mainthread) {
+        return (uint8_t*)&__main_thread_stack_end__ -
+               (uint8_t*)&__main_thread_stack_base__;
+    }
+
+    /* Other threads keep their thread_t at the bottom of the working area,
+     * below the stack limit, so its size can't be found from the thread_t.
+     * The CH_CFG_THREAD_INIT_HOOK in chconf.h records it at creation.
+     */
+    return tp->wa_size;
+}
+
+/* Count how many bytes at the bottom of the stack still hold the fill
+ * pattern, i.e. have never been used. The stack runs from the stack limit
+ * to the top of the working area of <size> bytes.
+ */
+static uint32_t m3monitor_stack_free(thread_t* tp, uint32_t size)
+{
+    uint8_t* stack = (uint8_t*)tp->p_stklimit;
+    uint32_t n = 0;
+    if(tp != &ch.mainthread) {
+        size = size > sizeof(thread_t) ? size - sizeof(thread_t) : 0;
+    }
+    while(n < size && stack[n] == CH_DBG_STACK_FILL_VALUE) {
+        n++;
+    }
+    return n;
+}
+
+/* Each thread is reported in two frames, with its registry index in the
+ * top seven bits of the first byte and the frame type in the bottom bit.
+ *
+ * Type 0: CPU share over the last period (u16, 0.01%), stack high-water
+ *         mark (u16, bytes), working area size (u16, bytes), priority (u8).
+ * Type 1: up to the first seven characters of the thread name.
+ */
+static void m3monitor_report()
+{
+    uint64_t total = 0;
+    uint32_t share, size, used;
+    size_t n = 0, i, j;
+    thread_t* tp;
+    uint8_t data[8];
+
+    /* Snapshot every thread's run time in one go so the shares add up */
+    chSysLock();
+    tp = ch.rlist.r_newer;
+    while(tp != (thread_t*)&ch.rlist && n < M3MONITOR_MAX_THREADS) {
+        now[n].tp = tp;
+        now[n].cumulative = tp->p_stats.cumulative;
+        n++;
+        tp = tp->p_newer;
+    }
+    chSysUnlock();
+
+    for(i=0; i<n; i++) {
+        delta[i] = now[i].cumulative;
+        for(j=0; j<n_last; j++) {
+            if(last[j].tp == now[i].tp) {
+                delta[i] -= last[j].cumulative;
+                break;
+            }
+        }
+        total += delta[i];
+    }
+
+    memcpy(last, now, n * sizeof(struct m3monitor_thread));
+    n_last = n;
+
+    for(i=0; i<n; i++) {
+        tp = now[i].tp;
+        share = total > 0 ? (uint32_t)((delta[i] * 10000) / total) : 0;
+        size = m3monitor_stack_size(tp);
+        used = size - m3monitor_stack_free(tp, size);
+        if(size > 0xFFFF) {
+            size = 0xFFFF;
+        }
+        if(used > 0xFFFF) {
+            used = 0xFFFF;
+        }
+
+        data[0] = (uint8_t)(i << 1);
+        data[1] = share & 0xFF;
+        data[2] = share >> 8;
+        data[3] = used & 0xFF;
+        data[4] = used >> 8;
+        data[5] = size & 0xFF;
+        data[6] = size >> 8;
+        data[7] = (uint8_t)tp->p_prio;
+        m3can_send(m3can_own_id | CAN_MSG_ID_THREAD_STATS, false, data, 8);
+
+        memset(data, 0, sizeof(data));
+        data[0] = (uint8_t)(i << 1) | 1;
+        if(tp->p_name != NULL) {
+            strncpy((char*)&data[1], tp->p_name, 7);
+        }
+        m3can_send(m3can_own_id | CAN_MSG_ID_THREAD_STATS, false, data, 8);
+    }
+}
+
+static THD_WORKING_AREA(m3monitor_wa, 512);
+static THD_FUNCTION(m3monitor_thd, arg) {
+    (void)arg;
+    systime_t t = chVTGetSystemTime();
+
+    chRegSetThreadName("m3monitor");
+
+    while(true) {
+        t += MS2ST(M3MONITOR_REPORT_MS);
+        chThdSleepUntil(t);
+        m3monitor_report();
+    }
+}
+
+void m3monitor_init()
+{
+    chThdCreateStatic(m3monitor_wa, sizeof(m3monitor_wa), LOWPRIO,
+                      m3monitor_thd, NULL);
+}
@@ -0,0 +1,24 @@
+#ifndef M3_MONITOR_H
+#define M3_MONITOR_H
+
+/* Per-thread CPU load and stack usage monitor.
+ *
+ * Call m3monitor_init() after m3can_init(). Every M3MONITOR_REPORT_MS it walks
+ * the thread registry and, for each thread, sends its share of CPU time over
+ * the last period, its stack high-water mark and working area size, and its
+ * name, on CAN_MSG_ID_THREAD_STATS. The datalogger records these like any
+ * other CAN frame.
+ *
+ * Needs CH_CFG_USE_REGISTRY, CH_DBG_STATISTICS (for per-thread run time),
+ * CH_DBG_ENABLE_STACK_CHECK (for each thread's stack limit) and
+ * CH_DBG_FILL_THREADS (so unused stack can be found) in chconf.h, and its
+ * CH_CFG_THREAD_EXTRA_FIELDS and CH_CFG_THREAD_INIT_HOOK to record each
+ * thread's working area size in a wa_size field, as the boards' do.
+ */
+
+#define M3MONITOR_REPORT_MS     (5000)
+#define M3MONITOR_MAX_THREADS   (16)
+
+void m3monitor_init(void);
+
+#endif /* M3_MONITOR_H */
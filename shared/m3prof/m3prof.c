@@ -0,0 +1,156 @@
+#include "ch.h"
+#include "m3prof.h"
+
+#if M3PROF_ENABLE
+
+#include "m3can.h"
+
+struct m3prof_probe {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[M3PROF_HIST_BINS];
+};
+
+static struct m3prof_probe probes[M3PROF_MAX_PROBES];
+
+static void m3prof_reset(struct m3prof_probe* p);
+static void m3prof_report(uint8_t id, struct m3prof_probe* p);
+
+void m3prof_record(uint8_t id, uint32_t cycles)
+{
+    struct m3prof_probe* p;
+    int bin;
+
+    if(id >= M3PROF_MAX_PROBES) {
+        return;
+    }
+
+    /* Bin index is (log2(cycles) - 5) / 3, clamped to the histogram */
+    bin = (31 - __builtin_clz(cycles | 1) - 5) / 3;
+    if(bin < 0) {
+        bin = 0;
+    } else if(bin >= M3PROF_HIST_BINS) {
+        bin = M3PROF_HIST_BINS - 1;
+    }
+
+    p = &probes[id];
+    chSysLock();
+    p->count++;
+    p->total += cycles;
+    if(cycles < p->min) {
+        p->min = cycles;
+    }
+    if(cycles > p->max) {
+        p->max = cycles;
+    }
+    p->hist[bin]++;
+    chSysUnlock();
+}
+
+static void m3prof_reset(struct m3prof_probe* p)
+{
+    int i;
+    p->count = 0;
+    p->min = UINT32_MAX;
+    p->max = 0;
+    p->total = 0;
+    for(i=0; i<M3PROF_HIST_BINS; i++) {
+        p->hist[i] = 0;
+    }
+}
+
+/* Each probe is reported in two frames, with the probe ID in the top seven
+ * bits of the first byte and the frame type in the bottom bit.
+ *
+ * Type 0: shift, min, mean, max; the times are u16 in units of
+ *         2^shift cycles, with shift chosen so that max fits.
+ * Type 1: count (u16, saturating), then each histogram bin's share of the
+ *         count as a u8 out of 255.
+ */
+static void m3prof_report(uint8_t id, struct m3prof_probe* p)
+{
+    uint8_t data[8];
+    uint32_t mean = (uint32_t)(p->total / p->count);
+    uint32_t count = p->count > 0xFFFF ? 0xFFFF : p->count;
+    uint32_t min = p->min, max = p->max;
+    uint8_t shift = 0;
+    int i;
+
+    while((max >> shift) > 0xFFFF) {
+        shift++;
+    }
+    min >>= shift;
+    mean >>= shift;
+    max >>= shift;
+
+    data[0] = (uint8_t)(id << 1);
+    data[1] = shift;
+    data[2] = min & 0xFF;
+    data[3] = min >> 8;
+    data[4] = mean & 0xFF;
+    data[5] = mean >> 8;
+    data[6] = max & 0xFF;
+    data[7] = max >> 8;
+    m3can_send(m3can_own_id | CAN_MSG_ID_PROFILE, false, data, 8);
+
+    data[0] = (uint8_t)(id << 1) | 1;
+    data[1] = count & 0xFF;
+    data[2] = count >> 8;
+    for(i=0; i<M3PROF_HIST_BINS; i++) {
+        data[3+i] = (uint8_t)(((uint64_t)p->hist[i] * 255) / p->count);
+    }
+    m3can_send(m3can_own_id | CAN_MSG_ID_PROFILE, false, data,
+               3 + M3PROF_HIST_BINS);
+}
+
+static THD_WORKING_AREA(m3prof_wa, 512);
+static THD_FUNCTION(m3prof_thd, arg) {
+    (void)arg;
+    struct m3prof_probe snapshot;
+    systime_t t = chVTGetSystemTime();
+    uint8_t id;
+
+    chRegSetThreadName("m3prof");
+
+    while(true) {
+        t += MS2ST(M3PROF_REPORT_MS);
+        chThdSleepUntil(t);
+
+        for(id=0; id<M3PROF_MAX_PROBES; id++) {
+            /* Take a copy and reset, so the CAN send happens unlocked */
+            chSysLock();
+            snapshot = probes[id];
+            m3prof_reset(&probes[id]);
+            chSysUnlock();
+
+            if(snapshot.count > 0) {
+                m3prof_report(id, &snapshot);
+            }
+        }
+    }
+}
+
+void m3prof_init(void)
+{
+    uint8_t id;
+
+    for(id=0; id<M3PROF_MAX_PROBES; id++) {
+        m3prof_reset(&probes[id]);
+    }
+
+    /* Enable the DWT cycle counter if it isn't already running. It is
+     * left running rather than reset, as the kernel's CH_DBG_STATISTICS
+     * measurements use it too and probes only need differences.
+     */
+    if(!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+
+    chThdCreateStatic(m3prof_wa, sizeof(m3prof_wa), LOWPRIO, m3prof_thd,
+                      NULL);
+}
+
+#endif /* M3PROF_ENABLE */
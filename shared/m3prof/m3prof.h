@@ -0,0 +1,77 @@
+#ifndef M3_PROF_H
+#define M3_PROF_H
+
+#include <stdint.h>
+
+/* Hot path profiling using the Cortex-M4 DWT cycle counter.
+ *
+ * Build with M3PROF_ENABLE=1 (`make M3PROF=1` on boards that support it) to
+ * compile the probes in. Otherwise every macro below expands to nothing and
+ * m3prof.c is empty, so probes can be left in the code permanently.
+ *
+ * Wrap the code to measure in a probe:
+ *     M3PROF_START(M3PROF_M3FC_SE_GET_STATE);
+ *     ...
+ *     M3PROF_STOP(M3PROF_M3FC_SE_GET_STATE);
+ * START declares a local, so each probe may only be started once per scope.
+ * Probes may be used from threads but not from ISRs.
+ *
+ * Call m3prof_init() after m3can_init(). Every M3PROF_REPORT_MS it sends
+ * the min, mean, max and a histogram of every probe that ran over CAN on
+ * CAN_MSG_ID_PROFILE, then resets the statistics. See
+ * gcs/m3gcs/profile.py for the frame layout.
+ */
+
+#ifndef M3PROF_ENABLE
+#define M3PROF_ENABLE 0
+#endif
+
+#define M3PROF_MAX_PROBES   (16)
+#define M3PROF_REPORT_MS    (1000)
+
+/* Histogram bins are a factor of 8 wide, starting at 256 cycles:
+ * <256, <2048, <16384, <131072, >=131072 cycles,
+ * or <1.5us, <12us, <98us, <780us, >=780us at 168MHz.
+ */
+#define M3PROF_HIST_BINS    (5)
+
+/* Probe IDs, grouped by board like the CAN message IDs, so the gcs can name
+ * them. IDs only need to be unique within a board.
+ */
+/* M3FC */
+#define M3PROF_M3FC_SE_GET_STATE    (0)
+#define M3PROF_M3FC_SE_FUSE         (1)
+#define M3PROF_M3FC_ADXL345_BATCH   (2)
+#define M3PROF_M3FC_MS5611_SAMPLE   (3)
+
+/* M3RADIO */
+#define M3PROF_M3RADIO_FILLBUF      (0)
+
+/* M3DL */
+#define M3PROF_M3DL_LOG_PACKET      (0)
+#define M3PROF_M3DL_SD_WRITE        (1)
+
+#if M3PROF_ENABLE
+
+#include "hal.h"
+
+#define M3PROF_START(id)    uint32_t m3prof_t_##id = DWT->CYCCNT
+#define M3PROF_STOP(id)     m3prof_record((id), DWT->CYCCNT - m3prof_t_##id)
+
+/* Start the cycle counter, if not already running, and the reporting thread. */
+void m3prof_init(void);
+
+/* Add one measurement of `cycles` to probe `id`. Normally called by
+ * M3PROF_STOP.
+ */
+void m3prof_record(uint8_t id, uint32_t cycles);
+
+#else
+
+#define M3PROF_START(id)    ((void)0)
+#define M3PROF_STOP(id)     ((void)0)
+#define m3prof_init()       ((void)0)
+
+#endif /* M3PROF_ENABLE */
+
+#endif /* M3_PROF_H */
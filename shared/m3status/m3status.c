@@ -1,68 +1,249 @@
+#include <string.h>
+
 #include "ch.h"
 #include "m3status.h"
 #include "m3can.h"
 
-static uint8_t components[256] = {0};
-static systime_t last_transmit[256] = {0};
+/* One slot per board specific component, then the shared ones */
+#define M3STATUS_NUM_SLOTS  (M3STATUS_MAX_COMPONENT + 1 + M3STATUS_NUM_SHARED)
+
+/* Slot flags, with the detail length in the low bits */
+#define M3STATUS_FLAG_USED      (0x80)
+#define M3STATUS_FLAG_PENDING   (0x40)
+#define M3STATUS_FLAG_SENT      (0x20)
+#define M3STATUS_FLAG_LEN_MASK  (0x07)
+
+/* Latest report for each component, kept so a remote frame for our status
+ * can replay them all.
+ */
+struct m3status_component {
+    uint8_t status;
+    uint8_t errorcode;
+    uint8_t flags;
+    uint8_t data[4];
+};
+
+static struct m3status_component components[M3STATUS_NUM_SLOTS];
+
+/* Number of reporting components in each state, indexed by status */
+static uint8_t m3status_counts[M3STATUS_ERROR + 1];
+
+/* Number of reported changes, wrapping, sent in the digest */
+static uint16_t m3status_changes;
+
+static void m3status_set(uint8_t component, uint8_t status, uint8_t errorcode,
+                         const uint8_t* data, uint8_t datalen);
+static void m3status_send(uint8_t slot);
 
-static void m3status_set(uint8_t component, uint8_t status, uint8_t errorcode);
+/* Slot for `component`, or -1 if this board doesn't store it or it is
+ * outside 0 to 255, as the end of a batch range may be.
+ */
+static inline int m3status_slot(int component)
+{
+    if(component < 0 || component > 255) {
+        return -1;
+    } else if(component <= M3STATUS_MAX_COMPONENT) {
+        return component;
+    } else if(component >= 256 - M3STATUS_NUM_SHARED) {
+        return M3STATUS_MAX_COMPONENT + 1 + (255 - component);
+    }
+    return -1;
+}
+
+/* Component stored in `slot` */
+static inline uint8_t m3status_component(int slot)
+{
+    if(slot <= M3STATUS_MAX_COMPONENT) {
+        return slot;
+    }
+    return 255 - (slot - M3STATUS_MAX_COMPONENT - 1);
+}
 
 void m3status_set_ok(uint8_t component) {
-    m3status_set(component, M3STATUS_OK, 0);
+    m3status_set(component, M3STATUS_OK, 0, NULL, 0);
 }
 
 void m3status_set_init(uint8_t component) {
-    m3status_set(component, M3STATUS_INITIALISING, 0);
+    m3status_set(component, M3STATUS_INITIALISING, 0, NULL, 0);
 }
 
 void m3status_set_error(uint8_t component, uint8_t errorcode) {
-    m3status_set(component, M3STATUS_ERROR, errorcode);
+    m3status_set(component, M3STATUS_ERROR, errorcode, NULL, 0);
 }
 
-static void m3status_set(uint8_t component, uint8_t status, uint8_t errorcode)
+void m3status_set_error_data(uint8_t component, uint8_t errorcode,
+                             const uint8_t* data, uint8_t datalen)
+{
+    m3status_set(component, M3STATUS_ERROR, errorcode, data, datalen);
+}
+
+static void m3status_set(uint8_t component, uint8_t status, uint8_t errorcode,
+                         const uint8_t* data, uint8_t datalen)
 {
     chDbgAssert(m3can_own_id != 0, "m3can_init() hasn't been called");
+    chDbgAssert(datalen <= 4, "Status detail >4 bytes");
+    chDbgAssert(status <= M3STATUS_ERROR, "Unknown status");
 
-    /* Check if we should transmit the new status */
+    int slot = m3status_slot(component);
+    chDbgAssert(slot >= 0, "Status component above M3STATUS_MAX_COMPONENT");
+    if(slot < 0) {
+        return;
+    }
+
+    struct m3status_component* c = &components[slot];
     bool transmit_status = false;
-    if(components[component] != status) {
-        /* Transmit if status has changed since last time */
+
+    chSysLock();
+    if(!(c->flags & M3STATUS_FLAG_USED)) {
+        /* First report from this component */
         transmit_status = true;
-    } else if (ST2MS(chVTTimeElapsedSinceX(last_transmit[component])) > 500) {
-        /* Transmit if we haven't sent this one in at least 500ms */
+        m3status_changes++;
+        m3status_counts[status]++;
+    } else if(c->status != status || c->errorcode != errorcode) {
+        /* Transmit straight away if the state or error has changed */
         transmit_status = true;
+        m3status_changes++;
+        m3status_counts[c->status]--;
+        m3status_counts[status]++;
+    } else if((c->flags & M3STATUS_FLAG_LEN_MASK) != datalen ||
+              (datalen > 0 && memcmp(c->data, data, datalen) != 0)) {
+        /* Only the detail (such as an error count) has changed, which may
+         * happen on every call, so send it at most once per digest and
+         * otherwise leave it for the digest to send.
+         */
+        if(c->flags & M3STATUS_FLAG_SENT) {
+            c->flags |= M3STATUS_FLAG_PENDING;
+        } else {
+            transmit_status = true;
+        }
     }
 
     /* Store new status for this component */
-    components[component] = status;
+    c->status = status;
+    c->errorcode = errorcode;
+    c->flags = (c->flags & ~M3STATUS_FLAG_LEN_MASK) | M3STATUS_FLAG_USED |
+               datalen;
+    if(datalen > 0) {
+        memcpy(c->data, data, datalen);
+    }
+    chSysUnlock();
 
     if(transmit_status) {
-        /* Compute overall status as highest of all components */
-        uint8_t overall_status = m3status_get();
+        m3status_send(slot);
+    }
+}
+
+/* Send the stored status of the component in `slot` */
+static void m3status_send(uint8_t slot)
+{
+    struct m3status_component* c = &components[slot];
+    uint8_t buf[8] = {0, m3status_component(slot)};
+    uint8_t len = 3;
+
+    chSysLock();
+    buf[0] = m3status_get();
+    buf[2] = c->status;
+    if(c->status == M3STATUS_ERROR) {
+        uint8_t datalen = c->flags & M3STATUS_FLAG_LEN_MASK;
+        buf[3] = c->errorcode;
+        memcpy(&buf[4], c->data, datalen);
+        len = 4 + datalen;
+    }
+    c->flags = (c->flags & ~M3STATUS_FLAG_PENDING) | M3STATUS_FLAG_SENT;
+    chSysUnlock();
 
-        uint8_t data[4] = {overall_status, component, status, errorcode};
-        uint8_t len = 3;
-        if(status == M3STATUS_ERROR) {
-            len = 4;
+    m3can_send(m3can_own_id | CAN_MSG_ID_STATUS, false, buf, len);
+}
+
+void m3status_send_digest(void)
+{
+    int i;
+
+    /* Detail held back since the last digest goes out now, and then each
+     * component may send its detail once more before the next one.
+     */
+    for(i=0; i<M3STATUS_NUM_SLOTS; i++) {
+        if(components[i].flags & M3STATUS_FLAG_PENDING) {
+            m3status_send(i);
         }
+    }
 
-        m3can_send(m3can_own_id | CAN_MSG_ID_STATUS, false, data, len);
-        last_transmit[component] = chVTGetSystemTimeX();
+    chSysLock();
+    for(i=0; i<M3STATUS_NUM_SLOTS; i++) {
+        components[i].flags &= ~M3STATUS_FLAG_SENT;
+    }
+    uint8_t ok = m3status_counts[M3STATUS_OK];
+    uint8_t initialising = m3status_counts[M3STATUS_INITIALISING];
+    uint8_t errors = m3status_counts[M3STATUS_ERROR];
+    uint16_t changes = m3status_changes;
+    uint8_t overall = m3status_get();
+    chSysUnlock();
+
+    m3can_send_status_digest(overall, ok + initialising + errors,
+                             initialising, errors, changes);
+}
+
+/* Send one batch frame for the components from `first` */
+static void m3status_send_batch_from(int first)
+{
+    uint8_t states[M3STATUS_BATCH_COMPONENTS / 4] = {0};
+    uint8_t overall;
+    int i;
+
+    chSysLock();
+    overall = m3status_get();
+    for(i=0; i<M3STATUS_BATCH_COMPONENTS; i++) {
+        int slot = m3status_slot(first + i);
+        uint8_t state = M3STATUS_BATCH_UNUSED;
+        if(slot >= 0 && (components[slot].flags & M3STATUS_FLAG_USED)) {
+            state = components[slot].status;
+        }
+        states[i / 4] |= state << (2 * (i % 4));
+    }
+    chSysUnlock();
+
+    m3can_send_status_batch(overall, first, states);
+}
+
+void m3status_send_batch(void)
+{
+    int first;
+    for(first=0; first<=M3STATUS_MAX_COMPONENT;
+        first+=M3STATUS_BATCH_COMPONENTS) {
+        m3status_send_batch_from(first);
+    }
+    m3status_send_batch_from(256 - M3STATUS_BATCH_COMPONENTS);
+}
+
+void m3status_handle_rtr(uint16_t msg_id)
+{
+    if(msg_id == (m3can_own_id | CAN_MSG_ID_STATUS)) {
+        int i;
+        m3status_send_batch();
+        for(i=0; i<M3STATUS_NUM_SLOTS; i++) {
+            if((components[i].flags & M3STATUS_FLAG_USED) &&
+               components[i].status == M3STATUS_ERROR) {
+                m3status_send(i);
+            }
+        }
+    } else if(msg_id == (m3can_own_id | CAN_MSG_ID_STATUS_DIGEST)) {
+        m3status_send_digest();
     }
 }
 
 uint8_t m3status_get_component(uint8_t component) {
-    return components[component];
+    int slot = m3status_slot(component);
+    if(slot < 0) {
+        return M3STATUS_OK;
+    }
+    return components[slot].status;
 }
 
 uint8_t m3status_get() {
-    uint8_t overall_status = 0;
-    int i;
-    for(i=0; i<256; i++) {
-        overall_status |= components[i];
-    }
-    if(overall_status & M3STATUS_ERROR) {
-        overall_status = M3STATUS_ERROR;
+    if(m3status_counts[M3STATUS_ERROR] > 0) {
+        return M3STATUS_ERROR;
+    } else if(m3status_counts[M3STATUS_INITIALISING] > 0) {
+        return M3STATUS_INITIALISING;
     }
-    return overall_status;
+    return M3STATUS_OK;
 }
@@ -0,0 +1,343 @@
+/*
+ * Status registry test and benchmark
+ * M3 shared
+ * Cambridge University Spaceflight
+ *
+ * Drives m3status with a random sequence of updates to every component
+ * M3STATUS_MAX_COMPONENT allows and the shared ones, and checks the
+ * overall and per-component status after each one against the previous
+ * implementation's scan of a 256 entry array, along with the status
+ * packets sent: one per change and none for repeats. Then checks detail
+ * rate limiting, the digest and the reply to a remote frame.
+ *
+ * Then times updates and m3status_get() against that scan.
+ *
+ * Built against the shared/m3host ChibiOS shim. Exits non-zero if any
+ * check fails.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "ch.h"
+#include "m3can.h"
+#include "m3status.h"
+
+#define STEPS           (200000)
+#define BENCH_CALLS     (10000000)
+
+/* Frames m3status sends, newest last */
+#define MAX_FRAMES      (64)
+struct frame {
+    uint16_t sid;
+    uint8_t len;
+    uint8_t data[8];
+};
+static struct frame frames[MAX_FRAMES];
+static int num_frames;
+
+uint8_t m3can_own_id = CAN_ID_M3FC;
+void m3can_send(uint16_t msg_id, bool can_rtr, uint8_t *data, uint8_t datalen)
+{
+    (void)can_rtr;
+    if(num_frames < MAX_FRAMES) {
+        frames[num_frames].sid = msg_id;
+        frames[num_frames].len = datalen;
+        memcpy(frames[num_frames].data, data, datalen);
+    }
+    num_frames++;
+}
+
+static int failures;
+
+static void check(const char* name, bool ok)
+{
+    if(!ok) {
+        failures++;
+    }
+    printf("%-44s %s\n", name, ok ? "PASS" : "FAIL");
+}
+
+/* The previous implementation: every component's status in a 256 entry
+ * array, with the overall status an OR over all of them.
+ */
+static uint8_t ref_components[256];
+
+static uint8_t ref_get(void)
+{
+    uint8_t overall_status = 0;
+    int i;
+    for(i=0; i<256; i++) {
+        overall_status |= ref_components[i];
+    }
+    if(overall_status & M3STATUS_ERROR) {
+        overall_status = M3STATUS_ERROR;
+    }
+    return overall_status;
+}
+
+/* Component number `i` of those this board stores */
+static uint8_t component(int i)
+{
+    if(i <= M3STATUS_MAX_COMPONENT) {
+        return i;
+    }
+    return 255 - (i - M3STATUS_MAX_COMPONENT - 1);
+}
+#define NUM_COMPONENTS (M3STATUS_MAX_COMPONENT + 1 + M3STATUS_NUM_SHARED)
+
+static uint32_t lcg = 1;
+static uint32_t rnd(uint32_t n)
+{
+    lcg = lcg * 1103515245 + 12345;
+    return (lcg >> 16) % n;
+}
+
+/* Random updates, checked against the reference after each */
+static void check_random(void)
+{
+    uint8_t ref_errors[256] = {0};
+    bool used[256] = {false};
+    int wrong = 0, missing = 0, extra = 0;
+
+    for(int step=0; step<STEPS; step++) {
+        uint8_t c = component(rnd(NUM_COMPONENTS));
+        uint8_t status = rnd(3);
+        uint8_t error = status == M3STATUS_ERROR ? 1 + rnd(2) : 0;
+        bool change = !used[c] || ref_components[c] != status ||
+                      ref_errors[c] != error;
+
+        num_frames = 0;
+        if(status == M3STATUS_OK) {
+            m3status_set_ok(c);
+        } else if(status == M3STATUS_INITIALISING) {
+            m3status_set_init(c);
+        } else {
+            m3status_set_error(c, error);
+        }
+        ref_components[c] = status;
+        ref_errors[c] = error;
+        used[c] = true;
+
+        if(m3status_get() != ref_get() ||
+           m3status_get_component(c) != status) {
+            wrong++;
+        }
+        if(change && (num_frames != 1 || frames[0].data[0] != ref_get() ||
+                      frames[0].data[1] != c || frames[0].data[2] != status)) {
+            missing++;
+        }
+        if(!change && num_frames != 0) {
+            extra++;
+        }
+    }
+
+    char label[64];
+    snprintf(label, sizeof(label), "%d random updates", STEPS);
+    check(label, wrong == 0 && missing == 0 && extra == 0);
+    if(wrong || missing || extra) {
+        printf("  %d wrong, %d changes not sent, %d repeats sent\n",
+               wrong, missing, extra);
+    }
+}
+
+/* Clear every component so later checks start from a known state */
+static void reset_all(void)
+{
+    for(int i=0; i<NUM_COMPONENTS; i++) {
+        m3status_set_ok(component(i));
+        ref_components[component(i)] = M3STATUS_OK;
+    }
+    m3status_send_digest();
+    num_frames = 0;
+}
+
+static void check_detail(void)
+{
+    uint8_t count[2] = {0, 0};
+
+    reset_all();
+
+    /* Going into error is sent straight away, then detail changes wait
+     * for the digest, which sends only the latest. */
+    m3status_set_error_data(M3STATUS_COMPONENT_CAN, 1, count, 2);
+    for(int i=1; i<=10; i++) {
+        count[0] = i;
+        m3status_set_error_data(M3STATUS_COMPONENT_CAN, 1, count, 2);
+    }
+    bool held = num_frames == 1 && frames[0].len == 6 &&
+                frames[0].data[4] == 0;
+
+    num_frames = 0;
+    m3status_send_digest();
+    bool flushed = num_frames == 2 &&
+                   frames[0].sid == (m3can_own_id | CAN_MSG_ID_STATUS) &&
+                   frames[0].data[4] == 10 &&
+                   frames[1].sid == (m3can_own_id |
+                                     CAN_MSG_ID_STATUS_DIGEST);
+    check("detail changes held for the digest", held && flushed);
+
+    /* Digest counts */
+    struct m3can_msg_status_digest* d = (void*)frames[1].data;
+    check("digest counts",
+          d->overall == M3STATUS_ERROR && d->components == NUM_COMPONENTS &&
+          d->initialising == 0 && d->errors == 1);
+
+    /* After the digest the next detail change goes straight out again */
+    num_frames = 0;
+    count[0] = 11;
+    m3status_set_error_data(M3STATUS_COMPONENT_CAN, 1, count, 2);
+    check("detail sent again after the digest",
+          num_frames == 1 && frames[0].data[4] == 11);
+}
+
+static void check_rtr(void)
+{
+    reset_all();
+
+    m3status_set_init(1);
+    m3status_set_error_data(2, 7, (const uint8_t*)"\x12\x34", 2);
+    m3status_set_error(M3STATUS_COMPONENT_CAN, 3);
+    num_frames = 0;
+
+    m3status_handle_rtr(m3can_own_id | CAN_MSG_ID_STATUS);
+
+    /* Batch frames cover every component, then each error follows with its
+     * code and detail. */
+    int batches = 0, errors = 0, wrong = 0;
+    for(int f=0; f<num_frames && f<MAX_FRAMES; f++) {
+        if(frames[f].sid == (m3can_own_id | CAN_MSG_ID_STATUS_BATCH)) {
+            struct m3can_msg_status_batch* b = (void*)frames[f].data;
+            batches++;
+            /* No batch may run past component 255 and wrap round */
+            wrong += b->first + M3STATUS_BATCH_COMPONENTS > 256;
+            for(int i=0; i<M3STATUS_BATCH_COMPONENTS; i++) {
+                int c = b->first + i;
+                uint8_t state = (b->states[i / 4] >> (2 * (i % 4))) & 3;
+                uint8_t expect = M3STATUS_BATCH_UNUSED;
+                if(c <= M3STATUS_MAX_COMPONENT ||
+                   c >= 256 - M3STATUS_NUM_SHARED) {
+                    expect = ref_components[c];
+                }
+                if(c == 1) {
+                    expect = M3STATUS_INITIALISING;
+                } else if(c == 2 || c == M3STATUS_COMPONENT_CAN) {
+                    expect = M3STATUS_ERROR;
+                }
+                wrong += state != expect || b->overall != M3STATUS_ERROR;
+            }
+        } else if(frames[f].sid == (m3can_own_id | CAN_MSG_ID_STATUS)) {
+            errors++;
+            wrong += frames[f].data[2] != M3STATUS_ERROR;
+            if(frames[f].data[1] == 2) {
+                wrong += frames[f].len != 6 || frames[f].data[3] != 7 ||
+                         frames[f].data[5] != 0x34;
+            }
+        }
+    }
+    int expect_batches = M3STATUS_MAX_COMPONENT / M3STATUS_BATCH_COMPONENTS
+                         + 2;
+    check("remote frame for status",
+          batches == expect_batches && errors == 2 && wrong == 0);
+
+    num_frames = 0;
+    m3status_handle_rtr(m3can_own_id | CAN_MSG_ID_STATUS_DIGEST);
+    check("remote frame for digest", num_frames == 1 &&
+          frames[0].sid == (m3can_own_id | CAN_MSG_ID_STATUS_DIGEST));
+
+    num_frames = 0;
+    m3status_handle_rtr(CAN_ID_M3PSU | CAN_MSG_ID_STATUS);
+    check("remote frame for another board", num_frames == 0);
+}
+
+static uint64_t cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, double t, uint64_t c)
+{
+    printf("  %-28s %7.1fns  %7.1f cycles\n", name,
+           t * 1e9 / BENCH_CALLS, (double)c / BENCH_CALLS);
+}
+
+/* Time the common cases: reading the overall status, as the LED and
+ * beeper threads and every status packet do, and repeating an unchanged
+ * status, which most calls are. Updates include taking the host shim's
+ * lock, a pthread mutex, which costs far more than the firmware's.
+ */
+static void bench(void)
+{
+    volatile uint8_t sink = 0;
+    double t0, t_old, t_new, t_set;
+    uint64_t c0, c_old, c_new, c_set;
+
+    reset_all();
+
+    t0 = now_s();
+    c0 = cycles();
+    for(int i=0; i<BENCH_CALLS; i++) {
+        sink += ref_get();
+    }
+    c_old = cycles() - c0;
+    t_old = now_s() - t0;
+
+    t0 = now_s();
+    c0 = cycles();
+    for(int i=0; i<BENCH_CALLS; i++) {
+        sink += m3status_get();
+    }
+    c_new = cycles() - c0;
+    t_new = now_s() - t0;
+
+    t0 = now_s();
+    c0 = cycles();
+    for(int i=0; i<BENCH_CALLS; i++) {
+        m3status_set_ok(i & 7);
+    }
+    c_set = cycles() - c0;
+    t_set = now_s() - t0;
+
+    printf("Per call, %d calls:\n", BENCH_CALLS);
+    report("get, scan of 256", t_old, c_old);
+    report("get, severity counts", t_new, c_new);
+    report("set, unchanged", t_set, c_set);
+    printf("  get speedup %.1fx\n", t_old / t_new);
+
+    (void)sink;
+}
+
+int main(int argc, char* argv[])
+{
+    check("nothing reported is OK", m3status_get() == M3STATUS_OK);
+
+    check_random();
+    check_detail();
+    check_rtr();
+
+    if(argc < 2 || strcmp(argv[1], "-q") != 0) {
+        bench();
+    }
+
+    if(failures) {
+        printf("FAIL: %d checks failed\n", failures);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}